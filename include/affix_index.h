@@ -0,0 +1,45 @@
+#ifndef SEARCH_ENGINE_AFFIX_INDEX_H
+#define SEARCH_ENGINE_AFFIX_INDEX_H
+
+#include "gtrie.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Sidecar files written next to an index file
+#define AFFIX_REVERSED_EXT ".rev"   // Trie of codepoint-reversed keys
+#define AFFIX_SUFFIX_EXT ".sa"      // Key dictionary plus suffix array
+
+// Suffix and infix lookup over the keys of a trie.
+// Suffix queries walk a trie of reversed keys; infix queries binary search a
+// suffix array over the sorted, NUL-separated key dictionary. Suffix array
+// and key offsets are bit-packed to ceil(log2(dictionary size)) bits each.
+// Immutable once built, so it may be shared by concurrent readers.
+typedef struct AffixIndex AffixIndex;
+
+typedef enum {
+    AFFIX_SUFFIX,       // Keys ending with the text
+    AFFIX_INFIX         // Keys containing the text
+} AffixQuery;
+
+// Build from the stored keys of trie; sets *err to 0, ENOMEM or EINVAL
+AffixIndex* affix_index_build(const GTrie* trie, int* err);
+void affix_index_destroy(AffixIndex* index);
+
+// Write or read the sidecars for the index file at index_path, which must
+// be saved first: the sidecars record its header timestamp and key count.
+// Loading checks them against trie, the index loaded from index_path, and
+// sets *err to ENOENT when no sidecar was written, ESTALE when they belong
+// to another build of the index, or EINVAL when one is malformed.
+int affix_index_save(const AffixIndex* index, const char* index_path);
+AffixIndex* affix_index_load(const char* index_path, const GTrie* trie, int* err);
+// Delete the sidecars of index_path, if any; returns 0 or the unlink error
+int affix_index_remove(const char* index_path);
+
+size_t affix_index_key_count(const AffixIndex* index);
+
+// Distinct keys matching the query in ascending byte order, at most max_keys.
+// Keys point into the index. Returns 0, ENOENT (no match), ENOMEM or EINVAL.
+int affix_index_search(const AffixIndex* index, AffixQuery query, const char* text,
+                       const char** keys, size_t max_keys, size_t* count);
+
+#endif // SEARCH_ENGINE_AFFIX_INDEX_H
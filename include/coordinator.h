@@ -0,0 +1,57 @@
+#ifndef SEARCH_ENGINE_COORDINATOR_H
+#define SEARCH_ENGINE_COORDINATOR_H
+
+#include "sharded_indexer.h"
+#include <stddef.h>
+
+#define COORDINATOR_MAX_SHARDS 64
+#define COORDINATOR_MAX_REPLICAS 4
+#define COORDINATOR_MAX_TERMS 16
+
+// Fans queries out to search_server processes that each hold a disjoint
+// subset of the documents, and merges their answers. Every shard may list
+// replicas: a request that has not been answered within hedge_ms is sent to
+// the next replica as well and the first response wins. Shards that do not
+// answer within timeout_ms are left out of the merged result.
+typedef struct Coordinator Coordinator;
+
+typedef struct {
+    int timeout_ms;     // Deadline for the whole fan-out
+    int hedge_ms;       // Delay before a backup request (0 = no hedging)
+} CoordinatorConfig;
+
+typedef struct {
+    char* doc_id;
+    double score;       // Shard's BM25 score; 0 for unranked queries
+} CoordinatorHit;
+
+typedef struct {
+    CoordinatorHit* hits;
+    size_t count;
+    size_t total;           // Postings summed over shards (coordinator_search only)
+    size_t shards_ok;
+    size_t shards_failed;   // Timed out or failed; hits are partial when non-zero
+    size_t hedged;          // Backup requests sent
+} CoordinatorResult;
+
+void coordinator_config_init(CoordinatorConfig* cfg);
+
+// Each shard is an IPv4 "host:port", optionally followed by ",host:port"
+// replicas that serve the same documents
+Coordinator* coordinator_create(const char* const* shards, size_t num_shards,
+                                const CoordinatorConfig* cfg, int* err);
+void coordinator_destroy(Coordinator* c);
+size_t coordinator_shard_count(const Coordinator* c);
+
+// The calls below are thread-safe. They return 0 when at least one shard
+// answered, ETIMEDOUT when none did, or EINVAL/ENOMEM. Hits are sorted by doc
+// id, or by descending score for ranked queries; free with coordinator_result_free.
+int coordinator_search(Coordinator* c, const char* key, size_t limit, CoordinatorResult* result);
+// Keys must not contain spaces
+int coordinator_search_bool(Coordinator* c, const char* const* keys, size_t count, ShardBoolOp op,
+                            size_t limit, CoordinatorResult* result);
+int coordinator_search_ranked(Coordinator* c, const char* const* terms, size_t count, size_t k,
+                              CoordinatorResult* result);
+void coordinator_result_free(CoordinatorResult* result);
+
+#endif // SEARCH_ENGINE_COORDINATOR_H
@@ -0,0 +1,44 @@
+#ifndef SEARCH_ENGINE_CORPUS_H
+#define SEARCH_ENGINE_CORPUS_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Synthetic key:doc_id corpus for benchmarks and scale tests. Postings draw
+// their key and document from Zipf distributions over fixed vocabularies,
+// so a few keys and documents are very common and most are rare. The same
+// configuration and seed always produce the same corpus.
+typedef struct {
+    size_t num_keys;        // Distinct keys in the vocabulary
+    size_t num_docs;        // Distinct document ids
+    size_t num_postings;    // (key, doc_id) pairs to draw
+    size_t min_key_len;     // Key length in codepoints
+    size_t max_key_len;
+    double utf8_ratio;      // Share of non-ASCII codepoints in keys, 0..1
+    double key_skew;        // Zipf exponent for key popularity (0 = uniform)
+    double doc_skew;        // Zipf exponent for document popularity
+    uint64_t seed;
+} CorpusConfig;
+
+typedef struct {
+    char** keys;            // num_keys distinct keys
+    char** docs;            // num_docs document ids
+    uint32_t* key_of;       // Key index of each posting
+    uint32_t* doc_of;       // Document index of each posting
+    size_t num_keys;
+    size_t num_docs;
+    size_t num_postings;
+    size_t key_bytes;       // Total UTF-8 bytes of the vocabulary
+} Corpus;
+
+void corpus_config_init(CorpusConfig* cfg);
+
+// Returns NULL with *err set to EINVAL (bad configuration) or ENOMEM
+Corpus* corpus_generate(const CorpusConfig* cfg, int* err);
+void corpus_destroy(Corpus* corpus);
+
+// Write one "key:doc_id" line per posting (index_writer input format)
+int corpus_write(const Corpus* corpus, FILE* fp);
+
+#endif // SEARCH_ENGINE_CORPUS_H
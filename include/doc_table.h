@@ -0,0 +1,28 @@
+#ifndef SEARCH_ENGINE_DOC_TABLE_H
+#define SEARCH_ENGINE_DOC_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Interned document ids with dense ordinals and per-document lengths
+// (number of indexed tokens), used for relevance scoring.
+typedef struct DocTable DocTable;
+
+DocTable* doc_table_create(int* err);
+void doc_table_destroy(DocTable* table);
+
+// Intern doc_id (if new) and add tokens to its length. The ordinal is stable
+// for the life of the table.
+int doc_table_add(DocTable* table, const char* doc_id, uint32_t tokens, uint32_t* ordinal);
+
+// Look up an existing document; returns 0 or ENOENT
+int doc_table_find(const DocTable* table, const char* doc_id, uint32_t* ordinal);
+
+size_t doc_table_count(const DocTable* table);
+uint64_t doc_table_total_length(const DocTable* table);
+uint32_t doc_table_length(const DocTable* table, uint32_t ordinal);
+const char* doc_table_id(const DocTable* table, uint32_t ordinal);
+// Bytes held by the table: ids, lengths, hash slots and the id strings
+size_t doc_table_bytes(const DocTable* table);
+
+#endif // SEARCH_ENGINE_DOC_TABLE_H
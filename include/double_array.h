@@ -0,0 +1,40 @@
+#ifndef SEARCH_ENGINE_DOUBLE_ARRAY_H
+#define SEARCH_ENGINE_DOUBLE_ARRAY_H
+
+#include "gtrie.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+// Read-only double-array form of a GTrie for exact lookups. Each trie node
+// is a cell; the child for slot c of cell s is cell t = base[s] + c + 1,
+// and it exists when check[t] == s, so a transition costs two array reads
+// instead of a pointer chase through a 256-slot node. Keys map codepoints
+// to slots exactly as the GTrie does, so lookups return the same postings.
+//
+// The file written by double_array_save starts with its own magic, so
+// indexer_load can tell it from a GTrie file. Loading reads the file into
+// one block (huge pages when enabled, see placement.h) and lays out every
+// posting list once; nothing is allocated per lookup. Immutable once built,
+// so it may be shared by concurrent readers.
+typedef struct DoubleArray DoubleArray;
+
+// Build from trie; sets *err to 0, ENOMEM, E2BIG (over 2^32 cells or
+// postings) or EINVAL
+DoubleArray* double_array_build(const GTrie* trie, int* err);
+void double_array_destroy(DoubleArray* da);
+
+int double_array_save(const DoubleArray* da, const char* path);
+// Sets *err to 0, ENOMEM, EINVAL for a malformed file, or the open error
+DoubleArray* double_array_load(const char* path, int* err);
+// True when path starts with the double-array magic
+bool double_array_detect(const char* path);
+
+// Postings of key, or NULL with *err set to ENOENT or EINVAL (not UTF-8).
+// The list and its doc ids live as long as da.
+const PostingList* double_array_search(const DoubleArray* da, const char* key, int* err);
+
+size_t double_array_key_count(const DoubleArray* da);
+size_t double_array_posting_count(const DoubleArray* da);  // GTrie doc_count
+size_t double_array_cell_count(const DoubleArray* da);
+
+#endif // SEARCH_ENGINE_DOUBLE_ARRAY_H
@@ -4,40 +4,108 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <errno.h>
+#include <stdint.h>
+#include "doc_table.h"
+#include "node_pool.h"
+#include "key_filter.h"
 
 #define TRIE_CHILDREN_SIZE 256  // Keep 256 since we'll index by bytes
 #define MAX_WORD_LENGTH 256
 #define ALPHABET_SIZE 26  
+#define GTRIE_MAX_EDITS 4       // Largest edit budget accepted by fuzzy search
 
 // Define the posting list structure
 typedef struct PostingEntry {
     char* doc_id;
+    uint32_t tf;          // Times the key was added for this document
+    uint32_t doc;         // Ordinal in the trie's DocTable
+    uint8_t* positions;   // Ascending token positions as delta varints (NULL if none)
+    uint32_t positions_size;  // Encoded bytes
+    uint32_t last_position;   // Last position appended, the base for the next delta
     struct PostingEntry* next;
 } PostingEntry;
 
 typedef struct PostingList {
     PostingEntry* head;
+    size_t count;         // Number of entries in the list
+    struct PostingView* view;  // Doc-ordered copy built lazily for ranking (single allocation)
 } PostingList;
 
 typedef struct TrieNode {
     struct TrieNode* children[TRIE_CHILDREN_SIZE];
     PostingList* postings;
     bool is_end;
-    char* word;  // UTF-8 encoded string
+    char* word;  // UTF-8 key ending at this node (terminal nodes only)
+    uint32_t weight;        // Popularity of the key ending here
+    uint32_t max_weight;    // Largest weight in this subtree, for top-k completion
 } TrieNode;
 
 typedef struct {
     TrieNode* root;
     size_t total_words;
     size_t node_count;    // Total number of nodes in the trie
-    size_t doc_count;     // Total number of unique documents indexed
+    size_t doc_count;     // Number of postings, not unique documents (see docs)
+    DocTable* docs;       // Document ids and lengths
+    NodePool* nodes;      // Owns every TrieNode of this trie
+    KeyFilter* filter;    // Rejects most missing keys before the walk (NULL if none)
+    bool frozen;          // Read-only after gtrie_freeze
+    uint64_t timestamp;   // Header timestamp of the file it was loaded from, 0 if built
 } GTrie;
 
+// Approximate match returned by gtrie_fuzzy_search
+typedef struct {
+    const char* word;               // Matched key (NULL for indexes saved without keys)
+    const PostingList* postings;
+    int distance;                   // Levenshtein distance to the query
+} FuzzyMatch;
+
+// Completion returned by gtrie_complete
+typedef struct {
+    const char* word;
+    const PostingList* postings;
+    uint32_t weight;
+} Completion;
+
 // GTrie operations
 GTrie* gtrie_create(int* err);
 int gtrie_destroy(GTrie* trie);
+// Relocate every node into one contiguous block in a cache-conscious order:
+// the top levels breadth-first, packed into the first huge page, then each
+// remaining subtree depth-first so a lookup's lower levels sit together.
+// The trie becomes read-only: inserts and gtrie_set_weight return EPERM.
+// Node pointers held by the caller are invalidated. Returns 0, ENOMEM
+// (the trie is left as it was) or EINVAL.
+int gtrie_freeze(GTrie* trie);
 int gtrie_insert(GTrie* trie, const char* word, const char* doc_id);
+// Insert one occurrence of word at a token position of doc_id. Positions of a
+// (word, doc_id) pair must be added in strictly increasing order, and not to
+// a pair first added by gtrie_insert; both return EINVAL.
+int gtrie_insert_at(GTrie* trie, const char* word, const char* doc_id, uint32_t position);
+// Decode up to max positions of a posting; returns 0 or EINVAL if malformed
+int gtrie_decode_positions(const uint8_t* data, size_t size, uint32_t* out, size_t max,
+                           size_t* count);
+// Bytes to allocate for size bytes of encoded positions
+size_t gtrie_positions_capacity(size_t size);
 PostingList* gtrie_search(const GTrie* trie, const char* word, int* err);
+// Batched exact lookup sharing traversal between keys with common prefixes.
+// postings[i] receives the list for words[i] (NULL if absent); errs[i], when
+// errs is not NULL, receives 0, ENOENT or EINVAL for that key.
+int gtrie_search_many(const GTrie* trie, const char* const* words, size_t count,
+                      PostingList** postings, int* errs);
+// Keys within max_edits (0..GTRIE_MAX_EDITS) insertions, deletions or
+// substitutions of word. Stores the best max_matches ranked by distance, then
+// posting count, then key. Returns 0, ENOENT (no match) or EINVAL.
+int gtrie_fuzzy_search(const GTrie* trie, const char* word, int max_edits,
+                       FuzzyMatch* matches, size_t max_matches, size_t* count);
+// Set the weight of an existing key; returns 0, ENOENT, EPERM or EINVAL
+int gtrie_set_weight(GTrie* trie, const char* word, uint32_t weight);
+// The k heaviest keys starting with prefix, heaviest first. Runs best-first
+// over the subtree weight annotations, so only O(k * depth) nodes are visited.
+// Keys from indexes saved without stored keys are not reported.
+// Returns 0, ENOENT (no completion) or EINVAL.
+int gtrie_complete(const GTrie* trie, const char* prefix, Completion* out, size_t k, size_t* count);
+// Every key starting with prefix, in trie order. The returned array points
+// into the trie; free only the array. Sets *err to 0, ENOENT, ENOMEM or EINVAL.
 char** gtrie_prefix_search(const GTrie* trie, const char* prefix, size_t* count, int* err);
 
 
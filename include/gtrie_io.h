@@ -19,6 +19,18 @@ typedef struct {
     uint64_t node_count;     // Number of nodes in trie
 } IndexInfo;
 
+// Optional sections present in a version 2+ file
+#define INDEX_FLAG_WORDS        0x1u   // Terminal nodes carry their key
+#define INDEX_FLAG_TF           0x2u   // Postings carry a term frequency
+#define INDEX_FLAG_WEIGHTS      0x4u   // Terminal nodes carry a key weight
+#define INDEX_FLAG_POSITIONS    0x8u   // Postings carry delta varint token positions
+#define INDEX_FLAG_FILTER       0x10u  // Key filter blocks follow the header
+#define INDEX_FLAGS_SUPPORTED   (INDEX_FLAG_WORDS | INDEX_FLAG_TF | INDEX_FLAG_WEIGHTS | \
+                                 INDEX_FLAG_POSITIONS | INDEX_FLAG_FILTER)
+
+// Upper bound for any length-prefixed string in an index file
+#define MAX_STRING_LENGTH (1024 * 1024)
+
 // File format header
 typedef struct {
     uint32_t magic;          // Magic number for validation
@@ -27,11 +39,16 @@ typedef struct {
     uint64_t node_count;     // Total nodes
     uint64_t doc_count;      // Total unique documents
     uint64_t total_words;    // Total words
+    uint32_t flags;          // INDEX_FLAG_* (version 2+; absent in version 1 files)
+    uint32_t reserved;
 } IndexHeader;
 
 // Core operations
 int gtrie_save(const GTrie* trie, const char* filepath, progress_cb progress, void* user_data);
 GTrie* gtrie_load(const char* filepath, int* err, progress_cb progress, void* user_data);
+// Read just the header of the index at filepath; returns 0, EINVAL (not an
+// index file) or the open error
+int gtrie_read_header(const char* filepath, IndexHeader* header);
 
 // Index file management
 IndexInfo* list_indices(const char* directory, size_t* count);
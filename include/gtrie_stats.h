@@ -0,0 +1,43 @@
+#ifndef SEARCH_ENGINE_GTRIE_STATS_H
+#define SEARCH_ENGINE_GTRIE_STATS_H
+
+#include "gtrie.h"
+#include <stdio.h>
+#include <stddef.h>
+
+#define GTRIE_STATS_MAX_DEPTH 64        // Deeper nodes are counted in the last bucket
+#define GTRIE_STATS_LENGTH_BUCKETS 32   // Posting lists by floor(log2(length))
+
+// Memory and shape of a trie. Byte counts are the sizes requested from the
+// allocator and do not include malloc's own per-allocation overhead.
+typedef struct {
+    size_t node_bytes;          // Node pool slabs
+    size_t posting_bytes;       // Lists, entries, positions and ranking views
+    size_t doc_string_bytes;    // doc_id copies held by the postings
+    size_t key_bytes;           // Keys stored at terminal nodes
+    size_t doc_table_bytes;     // Interned document ids and lengths
+    size_t filter_bytes;        // Key filter of a loaded trie
+    size_t total_bytes;
+
+    size_t nodes;
+    size_t keys;                // Nodes with postings
+    size_t postings;            // (key, doc) pairs
+    size_t unique_docs;
+    size_t max_depth;
+    size_t max_posting_length;
+    size_t child_slots;         // nodes * TRIE_CHILDREN_SIZE
+    size_t wasted_child_slots;  // NULL slots, including those past ALPHABET_SIZE
+
+    size_t fanout[ALPHABET_SIZE + 1];                   // Nodes by child count
+    size_t depth[GTRIE_STATS_MAX_DEPTH];                // Nodes by depth (root = 0)
+    size_t posting_lengths[GTRIE_STATS_LENGTH_BUCKETS]; // Lists of length [2^i, 2^(i+1))
+} GTrieStats;
+
+// Walk the whole trie; must not run concurrently with writers.
+// Returns 0 or EINVAL.
+int gtrie_stats(const GTrie* trie, GTrieStats* stats);
+
+// Human-readable summary with the non-empty histogram buckets
+void gtrie_stats_print(const GTrieStats* stats, FILE* fp);
+
+#endif // SEARCH_ENGINE_GTRIE_STATS_H
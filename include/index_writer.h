@@ -7,7 +7,16 @@
 // Process a single line of input (key:value format)
 int process_line(Indexer* idx, const char* line);
 
+// Process a single line of weighted input (key:value:weight format)
+int process_weighted_line(Indexer* idx, const char* line);
+
+// Process a tokenized document (doc_id:text format); every whitespace-separated
+// token of text becomes a key, recorded with its position for phrase queries
+int process_document_line(Indexer* idx, const char* line);
+
 // Process an entire file
 int process_file(Indexer* idx, FILE* fp, size_t* processed, size_t* failed);
+int process_weighted_file(Indexer* idx, FILE* fp, size_t* processed, size_t* failed);
+int process_document_file(Indexer* idx, FILE* fp, size_t* processed, size_t* failed);
 
 #endif // SEARCH_ENGINE_INDEX_WRITER_H 
\ No newline at end of file
@@ -4,10 +4,17 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <time.h>
+#include <stdint.h>
+#include "query_cache.h"
+#include "ranking.h"
+#include "pattern.h"
+#include "phrase.h"
+#include "gtrie_stats.h"
 
 // Forward declarations
 typedef struct Indexer Indexer;
 typedef struct SearchResult SearchResult;
+typedef struct IndexSnapshot IndexSnapshot;  // Refcounted published version of the index
 
 // Search result structure
 typedef struct SearchResult {
@@ -15,22 +22,141 @@ typedef struct SearchResult {
     struct SearchResult* next;
 } SearchResult;
 
+// Zero-allocation cursor over the postings of one key. The cursor pins the
+// index snapshot it was opened on, so its doc ids stay valid across a
+// concurrent indexer_load until indexer_cursor_close.
+typedef struct {
+    const struct PostingEntry* entry;   // Next entry to return
+    size_t position;                    // Entries consumed so far
+    size_t total;                       // Total entries for the key
+    const IndexSnapshot* snapshot;      // Pin released by indexer_cursor_close
+} SearchCursor;
+
+// Pin on the snapshot a page, ranked or phrase result points into. Pass one to
+// keep its doc ids valid across a concurrent indexer_load until indexer_unpin;
+// without a pin they are only valid while no reload can run.
+typedef struct {
+    const IndexSnapshot* snapshot;      // Held until indexer_unpin
+} IndexPin;
+
 // Create/destroy indexer
 Indexer* indexer_create(void);
 void indexer_destroy(Indexer* idx);
 
 // Index operations
 int indexer_add_document(Indexer* idx, const char* key, const char* doc_id);
+// Add one occurrence of key at a token position of doc_id, for phrase queries.
+// Positions of a (key, doc_id) pair must increase.
+int indexer_add_token(Indexer* idx, const char* key, const char* doc_id, uint32_t position);
+int indexer_set_key_weight(Indexer* idx, const char* key, uint32_t weight);  // Key must exist
 int indexer_save(Indexer* idx, const char* filepath);
+// Build suffix/infix sidecars (see affix_index.h) for the index saved at filepath
+int indexer_save_affix(Indexer* idx, const char* filepath);
+// Load an index and publish it atomically. Queries already running keep
+// using the previous index, which is freed on a background thread once the
+// last reader releases it. Writes must not run concurrently with a load.
+// Affix sidecars next to filepath are picked up when present.
+// A double-array file (see double_array.h) is detected by its magic and
+// served as is: exact lookups, cursors and batches work, writes return EPERM
+// and fuzzy, pattern, ranked, phrase and completion queries return ENOTSUP.
 int indexer_load(Indexer* idx, const char* filepath);
+// Save the index as a double array for read-only serving
+int indexer_save_double_array(Indexer* idx, const char* filepath);
 
 // Search operations
 SearchResult* indexer_search(Indexer* idx, const char* key);
 void search_results_free(SearchResult* results);
 
+// Paginated search without heap allocation: stores up to limit doc ids starting
+// at offset into out. pin may be NULL (see IndexPin); it is only held on success.
+// Returns 0, ENOENT (count and total set to 0) or EINVAL.
+int indexer_search_page(Indexer* idx, const char* key, size_t offset, size_t limit,
+                        const char** out, size_t* count, size_t* total, IndexPin* pin);
+
+// Flat result set entry for batched lookups; results[i] describes keys[i].
+// Close every cursor to release its pin.
+typedef struct {
+    SearchCursor cursor;    // Positioned at the key's postings (empty when absent)
+    int err;                // 0, ENOENT or EINVAL
+} SearchManyResult;
+
+// Look up many keys in a single sorted trie walk
+int indexer_search_many(Indexer* idx, const char* const* keys, size_t count,
+                        SearchManyResult* results);
+
+// Approximate match for a misspelled key
+typedef struct {
+    const char* key;        // Matched key (NULL for indexes saved without keys)
+    int distance;           // Edit distance from the query
+    SearchCursor cursor;    // Positioned at the matched key's postings
+} FuzzyResult;
+
+// Typo-tolerant search: keys within max_edits edits of key, best first.
+// Close every result cursor. Returns 0, ENOENT (count set to 0) or EINVAL.
+int indexer_search_fuzzy(Indexer* idx, const char* key, int max_edits,
+                         FuzzyResult* results, size_t max_results, size_t* count);
+
+// Key matching a wildcard or regex pattern
+typedef struct {
+    const char* key;        // Matched key
+    SearchCursor cursor;    // Positioned at the matched key's postings
+} PatternResult;
+
+// Keys matching pattern, in trie order, up to max_results. budget_us bounds
+// the walk (0 = no limit). When the index was loaded with affix sidecars,
+// suffix and infix patterns ("*text", "*text*", regex "text$" or "text") are
+// answered from them instead, in byte order. Close every result cursor.
+// Returns 0, ENOENT, ETIMEDOUT (partial results in count), E2BIG or EINVAL.
+int indexer_search_pattern(Indexer* idx, const char* pattern, PatternSyntax syntax,
+                           size_t max_results, uint64_t budget_us,
+                           PatternResult* results, size_t* count);
+
+// Relevance-ranked search: the k best documents for any of the terms by
+// BM25, highest first. pin may be NULL (see indexer_search_page).
+// Returns 0, ENOENT (count set to 0) or EINVAL.
+int indexer_search_ranked(Indexer* idx, const char* const* terms, size_t num_terms, size_t k,
+                          RankedDoc* results, size_t* count, IndexPin* pin);
+
+// Phrase or proximity search: documents where the terms occur in order, each
+// within slop + 1 positions of the previous one (slop 0 = exact phrase).
+// pin may be NULL (see indexer_search_page).
+// Returns 0, ENOENT (count set to 0) or EINVAL.
+int indexer_search_phrase(Indexer* idx, const char* const* terms, size_t num_terms, uint32_t slop,
+                          const char** doc_ids, size_t max_docs, size_t* count, IndexPin* pin);
+
+// Type-ahead completion entry
+typedef struct {
+    const char* key;
+    uint32_t weight;
+    SearchCursor cursor;    // Positioned at the key's postings
+} CompletionResult;
+
+// The k heaviest keys starting with prefix, heaviest first.
+// Close every result cursor. Returns 0, ENOENT (count set to 0) or EINVAL.
+int indexer_complete(Indexer* idx, const char* prefix, CompletionResult* results,
+                     size_t k, size_t* count);
+
+// Cursor interface for early termination
+int indexer_cursor_open(Indexer* idx, const char* key, SearchCursor* cursor);
+size_t indexer_cursor_skip(SearchCursor* cursor, size_t n);
+const char* indexer_cursor_next(SearchCursor* cursor);
+void indexer_cursor_close(SearchCursor* cursor);
+// Release a pin taken by a search; a no-op on an unheld pin
+void indexer_unpin(IndexPin* pin);
+
+// Freeze every index loaded from now on (see gtrie_freeze) for faster lookups;
+// writes to a frozen index fail with EPERM until the next unfrozen load
+int indexer_enable_freeze(Indexer* idx, bool enabled);
+
+// Result cache (max_bytes == 0 disables it); entries are invalidated by any index change
+int indexer_enable_cache(Indexer* idx, size_t max_bytes);
+int indexer_get_cache_stats(const Indexer* idx, QueryCacheStats* stats);
+
 // Statistics
 size_t indexer_get_doc_count(const Indexer* idx);
 size_t indexer_get_key_count(const Indexer* idx);
+int indexer_get_trie_stats(const Indexer* idx, GTrieStats* stats);  // See gtrie_stats
 time_t indexer_get_timestamp(const Indexer* idx);
+uint64_t indexer_get_generation(const Indexer* idx);  // Bumped on every index change
 
 #endif // SEARCH_ENGINE_INDEXER_H 
\ No newline at end of file
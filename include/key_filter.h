@@ -0,0 +1,34 @@
+#ifndef SEARCH_ENGINE_KEY_FILTER_H
+#define SEARCH_ENGINE_KEY_FILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define KEY_FILTER_BLOCK_BYTES 32       // One block per lookup, never crossing a cache line
+#define KEY_FILTER_BITS_PER_KEY 12      // About 0.5% false positives at capacity
+
+// Keys are hashed by the trie slots they walk rather than by their bytes, so
+// the filter answers exactly the question the lossy trie does. Fold every
+// slot with KEY_FILTER_PATH_STEP starting from KEY_FILTER_PATH_SEED.
+#define KEY_FILTER_PATH_SEED 0xcbf29ce484222325ULL
+#define KEY_FILTER_PATH_STEP(hash, slot) (((hash) ^ (uint64_t)(slot)) * 0x100000001b3ULL)
+
+// Split-block Bloom filter: a key sets one bit in each of the eight 32-bit
+// words of a single block, so a negative answer costs one cache line.
+typedef struct KeyFilter KeyFilter;
+
+// Sized for expected_keys; adding more keeps working at a higher false positive rate
+KeyFilter* key_filter_create(size_t expected_keys, int* err);
+// Empty filter of num_blocks blocks, to be filled through key_filter_data
+KeyFilter* key_filter_create_blocks(size_t num_blocks, int* err);
+void key_filter_destroy(KeyFilter* filter);
+
+void key_filter_add(KeyFilter* filter, uint64_t path_hash);
+// False only if the key was never added
+bool key_filter_may_contain(const KeyFilter* filter, uint64_t path_hash);
+
+size_t key_filter_blocks(const KeyFilter* filter);
+void* key_filter_data(KeyFilter* filter);   // key_filter_blocks * KEY_FILTER_BLOCK_BYTES bytes
+
+#endif // SEARCH_ENGINE_KEY_FILTER_H
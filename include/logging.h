@@ -3,6 +3,8 @@
 
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 // Log levels
 typedef enum {
@@ -20,9 +22,39 @@ typedef enum {
     LOG_DEST_FILE = 4       // Log to file
 } LogDestination;
 
+// What a thread does when its async log ring is full
+typedef enum {
+    LOG_OVERFLOW_DROP,      // Discard the message and count it
+    LOG_OVERFLOW_BLOCK      // Wait for the writer to make room
+} LogOverflowPolicy;
+
+typedef struct {
+    uint64_t dropped;       // Messages lost to full rings
+    uint64_t suppressed;    // Messages held back by the rate limit
+} LogStats;
+
+// Default per-call-site limit; further messages in the same second are
+// counted and reported with the next message that gets through
+#define LOG_DEFAULT_RATE_LIMIT 100
+#define LOG_RING_MIN_BYTES 16384     // Holds at least a few maximum-length lines
+
 // Initialize logging system
 int log_init(const char* app_name, LogLevel level, int destinations);
 
+// Hand formatted lines to a background writer instead of writing them on
+// the calling thread. Each thread gets its own lock-free ring of ring_bytes
+// (rounded up to a power of two); the writer drains all rings with batched
+// writev calls. Call after log_init; log_cleanup stops the writer.
+int log_start_async(size_t ring_bytes, LogOverflowPolicy policy);
+
+// Wait until every queued message has been written
+void log_flush(void);
+
+// Messages per second from one call site (0 = unlimited)
+void log_set_rate_limit(unsigned per_second);
+
+void log_get_stats(LogStats* stats);
+
 // Set log file path (if LOG_DEST_FILE is used)
 int log_set_file(const char* filepath);
 
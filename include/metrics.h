@@ -0,0 +1,85 @@
+#ifndef SEARCH_ENGINE_METRICS_H
+#define SEARCH_ENGINE_METRICS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Latency histograms and counters for the hot operations. Every thread
+// records into its own shard with plain relaxed stores (no locks, no locked
+// instructions); a snapshot sums the shards. Histograms are log-linear like
+// HdrHistogram: 16 sub-buckets per power of two, so a reported percentile is
+// within 6.25% of the true value, from 1 ns up to about 18 minutes.
+// Sub-microsecond operations are counted on every call but timed on one
+// call in METRICS_SAMPLE_PERIOD, since reading the clock would otherwise
+// cost a large fraction of the operation itself.
+// Build with -DENABLE_METRICS=OFF to compile the recording out.
+
+typedef enum {
+    METRIC_GTRIE_INSERT,
+    METRIC_GTRIE_SEARCH,
+    METRIC_INDEXER_SEARCH,
+    METRIC_GTRIE_SAVE,
+    METRIC_GTRIE_LOAD,
+    METRIC_OP_COUNT
+} MetricOp;
+
+typedef enum {
+    METRICS_FORMAT_JSON,
+    METRICS_FORMAT_PROMETHEUS
+} MetricsFormat;
+
+#define METRICS_SUB_BITS 4
+#define METRICS_MAX_EXP 40      // Slower operations land in the last bucket
+#define METRICS_BUCKETS ((METRICS_MAX_EXP - METRICS_SUB_BITS + 1) << METRICS_SUB_BITS)
+#define METRICS_SAMPLE_PERIOD 16    // Power of two
+
+typedef struct {
+    uint64_t count;         // Calls
+    uint64_t errors;        // Calls that failed (a search miss is not an error)
+    uint64_t samples;       // Calls that were timed; the buckets sum to this
+    uint64_t sum_ns;        // Over the timed calls
+    uint64_t max_ns;
+    uint64_t buckets[METRICS_BUCKETS];
+} MetricsHistogram;
+
+typedef struct {
+    MetricsHistogram ops[METRIC_OP_COUNT];
+} MetricsSnapshot;
+
+uint64_t metrics_now_ns(void);
+// Count one timed call
+void metrics_record(MetricOp op, uint64_t ns, bool failed);
+// Start time for one call in METRICS_SAMPLE_PERIOD on this thread, else 0
+uint64_t metrics_sample_start(void);
+// Count a call started with metrics_sample_start; timed only if start != 0
+void metrics_sample_stop(MetricOp op, uint64_t start, bool failed);
+
+// Sum of all threads' shards since process start
+int metrics_snapshot(MetricsSnapshot* snap);
+// Upper bound of the bucket holding the given percentile (0..100), in ns
+uint64_t metrics_percentile(const MetricsHistogram* hist, double percentile);
+const char* metrics_op_name(MetricOp op);
+
+// Write a fresh snapshot; returns 0, ENOMEM or EIO
+int metrics_write(FILE* fp, MetricsFormat format);
+
+// Start a thread that writes a snapshot to fp whenever signo arrives. Call
+// from main before any other thread is created, so that every thread
+// inherits the blocked signal. Returns 0 or an errno value.
+int metrics_dump_on_signal(int signo, MetricsFormat format, FILE* fp);
+
+#ifdef SEARCH_ENGINE_NO_METRICS
+#define METRICS_START(name) ((void)0)
+#define METRICS_STOP(op, name, failed) ((void)0)
+#define METRICS_SAMPLE_START(name) ((void)0)
+#define METRICS_SAMPLE_STOP(op, name, failed) ((void)0)
+#else
+#define METRICS_START(name) uint64_t name = metrics_now_ns()
+#define METRICS_STOP(op, name, failed) metrics_record(op, metrics_now_ns() - (name), failed)
+#define METRICS_SAMPLE_START(name) uint64_t name = metrics_sample_start()
+#define METRICS_SAMPLE_STOP(op, name, failed) metrics_sample_stop(op, name, failed)
+#endif
+
+#endif // SEARCH_ENGINE_METRICS_H
@@ -0,0 +1,28 @@
+#ifndef SEARCH_ENGINE_NODE_POOL_H
+#define SEARCH_ENGINE_NODE_POOL_H
+
+#include <stddef.h>
+
+// Bump allocator for fixed-size trie nodes. Objects are carved from slabs
+// that grow geometrically and are only released together when the pool is
+// destroyed, so a trie's nodes stay packed together and freeing a trie
+// costs one free per slab. Once slabs reach half a huge page they are
+// mapped from huge pages when placement_set_huge_pages (see placement.h)
+// was enabled before the pool was created. Not thread-safe; each trie owns
+// its own pool.
+typedef struct NodePool NodePool;
+
+NodePool* node_pool_create(size_t object_size, int* err);
+void node_pool_destroy(NodePool* pool);
+
+// Zeroed object, or NULL when out of memory
+void* node_pool_alloc(NodePool* pool);
+
+// Make the next count allocations come from one slab, back to back.
+// Returns 0, ENOMEM or EINVAL.
+int node_pool_reserve(NodePool* pool, size_t count);
+
+size_t node_pool_count(const NodePool* pool);   // Objects handed out
+size_t node_pool_bytes(const NodePool* pool);   // Bytes reserved by slabs
+
+#endif // SEARCH_ENGINE_NODE_POOL_H
@@ -0,0 +1,44 @@
+#ifndef SEARCH_ENGINE_PATTERN_H
+#define SEARCH_ENGINE_PATTERN_H
+
+#include "gtrie.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Supported pattern languages.
+// Glob: '*', '?', '[a-z]', '[!abc]', '\' escapes; always matches the whole key.
+// Regex: literals, '.', classes, '\d' '\w' '\s', groups, '|', '*' '+' '?',
+// '{m}' '{m,}' '{m,n}'. Matches anywhere in the key unless anchored with
+// a leading '^' and/or trailing '$'.
+typedef enum {
+    PATTERN_GLOB,
+    PATTERN_REGEX
+} PatternSyntax;
+
+// Compiled pattern: a Thompson NFA plus a lazily built DFA over trie child
+// slots. The DFA cache is mutated while searching, so a compiled pattern must
+// not be used by two searches at once.
+typedef struct Pattern Pattern;
+
+// Compile a pattern; returns NULL with *err set to EINVAL on a syntax error
+Pattern* pattern_compile(const char* pattern, PatternSyntax syntax, int* err);
+void pattern_free(Pattern* pattern);
+
+// Exact match of a whole UTF-8 string
+bool pattern_match(const Pattern* pattern, const char* str);
+
+typedef struct {
+    const char* word;
+    const PostingList* postings;
+} PatternMatch;
+
+// Keys matching the pattern, in trie order. The DFA is walked in lockstep with
+// the trie so subtrees that cannot match are never entered. Stops after
+// max_matches keys, or once budget_us microseconds have passed (0 = no limit).
+// Returns 0, ENOENT (no match), ETIMEDOUT (partial results), E2BIG (pattern
+// needs too many DFA states) or EINVAL.
+int gtrie_pattern_search(const GTrie* trie, Pattern* pattern, PatternMatch* out,
+                         size_t max_matches, uint64_t budget_us, size_t* count);
+
+#endif // SEARCH_ENGINE_PATTERN_H
@@ -0,0 +1,25 @@
+#ifndef SEARCH_ENGINE_PHRASE_H
+#define SEARCH_ENGINE_PHRASE_H
+
+#include "gtrie.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define PHRASE_MAX_TERMS 32
+
+// Work done by one phrase query
+typedef struct {
+    size_t postings;        // Posting entries scanned while intersecting
+    size_t candidates;      // Documents containing every term
+    size_t decoded;         // Positions decoded while verifying candidates
+} PhraseStats;
+
+// Documents where terms occur in order, each within slop + 1 positions of
+// the previous one (slop 0 = exact phrase), in doc ordinal order. Documents
+// are intersected first; positions are only decoded for documents that
+// contain every term. Postings added without positions never match.
+// Returns 0, ENOENT (no match), ENOMEM or EINVAL.
+int phrase_search(const GTrie* trie, const char* const* terms, size_t num_terms, uint32_t slop,
+                  const char** doc_ids, size_t max_docs, size_t* count, PhraseStats* stats);
+
+#endif // SEARCH_ENGINE_PHRASE_H
@@ -0,0 +1,46 @@
+#ifndef SEARCH_ENGINE_PLACEMENT_H
+#define SEARCH_ENGINE_PLACEMENT_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Memory placement for large read-mostly structures: huge-page backed
+// mappings to cut TLB misses on trie walks, and NUMA node discovery and
+// thread binding so each socket can serve queries from a local copy of the
+// index. Nodes are read from /sys/devices/system/node; memory lands on a node
+// by first touch, so build a replica on a thread bound to that node.
+
+#define PLACEMENT_HUGE_PAGE (2u * 1024 * 1024)  // x86-64 and arm64 default huge page
+#define PLACEMENT_MAX_NODES 64
+
+typedef enum {
+    HUGE_PAGES_OFF,             // Regular heap allocations
+    HUGE_PAGES_TRANSPARENT,     // Aligned mappings advised with MADV_HUGEPAGE
+    HUGE_PAGES_EXPLICIT         // MAP_HUGETLB from the reserved pool, else transparent
+} HugePageMode;
+
+// Process-wide mode for node pools created after the call (default off)
+void placement_set_huge_pages(HugePageMode mode);
+HugePageMode placement_huge_pages(void);
+
+// Parse "off", "thp" or "hugetlb"; returns 0 or EINVAL
+int placement_parse_huge_pages(const char* text, HugePageMode* mode);
+
+// Zeroed mapping of at least size bytes, aligned to PLACEMENT_HUGE_PAGE and
+// rounded up to a multiple of it; *mapped receives the length to pass to
+// placement_unmap. Returns NULL when out of memory.
+void* placement_map(size_t size, HugePageMode mode, size_t* mapped);
+void placement_unmap(void* addr, size_t mapped);
+
+// Online NUMA nodes (1 without NUMA or sysfs). The functions below number
+// them 0..count-1 in the order the kernel lists them.
+int placement_node_count(void);
+
+// Restrict the calling thread to the CPUs of node; returns 0 or an errno
+int placement_bind_node(int node);
+
+// Run fn(arg) on a new thread bound to node and wait for it; returns 0 or
+// the errno of creating or binding the thread
+int placement_run_on_node(int node, void* (*fn)(void*), void* arg);
+
+#endif // SEARCH_ENGINE_PLACEMENT_H
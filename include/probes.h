@@ -0,0 +1,69 @@
+#ifndef SEARCH_ENGINE_PROBES_H
+#define SEARCH_ENGINE_PROBES_H
+
+// USDT (sys/sdt.h) static tracepoints under the "search_engine" provider, for
+// bpftrace and perf on a running process without a rebuild. Each probe has a
+// semaphore that the tracer raises while it is attached: a probe site costs
+// one load and a predicted branch when nobody is tracing, and its arguments
+// are only evaluated while it is. Without -DENABLE_PROBES (on by default when
+// <sys/sdt.h> is installed) the sites compile to nothing.
+//
+// Probe                   Arguments
+// insert__start           key, doc_id
+// insert__done            key, key bytes, postings of key, rc
+// search__start           key
+// search__done            key, key bytes, postings of key, rc
+// indexer_search__start   key
+// indexer_search__done    key, key bytes, results, failed
+// node__create            nodes before this one, node bytes
+// save__start             path, nodes
+// save__block             section (PROBE_SECTION_*), nodes written, bytes written
+// save__done              path, bytes, rc
+// load__start             path
+// load__block             section (PROBE_SECTION_*), nodes read, bytes read
+// load__done              path, nodes, bytes, rc
+// process_file__batch     lines, failed, bytes (every PROBE_BATCH_LINES lines)
+// process_file__done      lines, failed, bytes
+
+#define PROBE_BATCH_LINES 1000      // process_file lines per batch probe
+#define PROBE_BLOCK_NODES 65536     // save/load nodes per block probe
+
+// Sections of a saved index, in file order
+#define PROBE_SECTION_HEADER 0
+#define PROBE_SECTION_FILTER 1
+#define PROBE_SECTION_NODES 2
+
+#define PROBE_LIST(X) \
+    X(insert__start) X(insert__done) X(search__start) X(search__done) \
+    X(indexer_search__start) X(indexer_search__done) X(node__create) \
+    X(save__start) X(save__block) X(save__done) \
+    X(load__start) X(load__block) X(load__done) \
+    X(process_file__batch) X(process_file__done)
+
+#ifdef SEARCH_ENGINE_PROBES
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define PROBE_SEMAPHORE(name) search_engine_##name##_semaphore
+#define PROBE_DECLARE_SEMAPHORE(name) extern unsigned short PROBE_SEMAPHORE(name);
+PROBE_LIST(PROBE_DECLARE_SEMAPHORE)
+
+#define PROBE_ENABLED(name) __builtin_expect(PROBE_SEMAPHORE(name) != 0, 0)
+#define PROBE(name, ...) \
+    do { \
+        if (PROBE_ENABLED(name)) STAP_PROBEV(search_engine, name, __VA_ARGS__); \
+    } while (0)
+#else
+#define PROBE_ENABLED(name) 0
+// Arguments stay type-checked but are never evaluated
+#define PROBE(name, ...) \
+    do { \
+        if (0) probe_unused(0, __VA_ARGS__); \
+    } while (0)
+
+static inline void probe_unused(int unused, ...) {
+    (void)unused;
+}
+#endif
+
+#endif // SEARCH_ENGINE_PROBES_H
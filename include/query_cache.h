@@ -0,0 +1,44 @@
+#ifndef SEARCH_ENGINE_QUERY_CACHE_H
+#define SEARCH_ENGINE_QUERY_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Sharded query result cache with CLOCK eviction and TinyLFU admission.
+// Entries are tagged with the index generation they were computed against;
+// a lookup with a newer generation treats older entries as misses.
+typedef struct QueryCache QueryCache;
+
+// Cache counters (aggregated over all shards)
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t insertions;
+    uint64_t evictions;     // Entries removed to make room
+    uint64_t rejections;    // Inserts refused by the admission filter
+    size_t entries;
+    size_t bytes;           // Bytes currently charged against the bound
+    size_t max_bytes;
+} QueryCacheStats;
+
+// Create/destroy a cache bounded to max_bytes of keys, values and entry overhead
+QueryCache* query_cache_create(size_t max_bytes, int* err);
+void query_cache_destroy(QueryCache* cache);
+
+// Look up key for the given generation and copy its value into out.
+// Returns 0 on a hit, ENOENT on a miss, or ENOSPC if out_size is too small
+// (value_len is set to the required size in that case).
+int query_cache_lookup(QueryCache* cache, const char* key, size_t key_len, uint64_t generation,
+                       void* out, size_t out_size, size_t* value_len);
+
+// Insert or replace the value for key; may be refused by the admission filter
+int query_cache_insert(QueryCache* cache, const char* key, size_t key_len, uint64_t generation,
+                       const void* value, size_t value_len);
+
+// Drop every entry (counters are preserved)
+void query_cache_clear(QueryCache* cache);
+
+// Snapshot of the cache counters
+void query_cache_get_stats(QueryCache* cache, QueryCacheStats* stats);
+
+#endif // SEARCH_ENGINE_QUERY_CACHE_H
@@ -0,0 +1,80 @@
+#ifndef SEARCH_ENGINE_QUERY_REPLAY_H
+#define SEARCH_ENGINE_QUERY_REPLAY_H
+
+#include "indexer.h"
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Replays a captured query log against a loaded index to reproduce
+// production latency offline. Log lines are request targets as search_server
+// receives them ("/search?q=apple&limit=10", "/complete?q=app", "/rank?q=red+green"),
+// optionally preceded by "GET " and followed by " HTTP/1.1" as in access
+// logs. A line without a leading '/' is an exact key lookup.
+
+#define REPLAY_MAX_TERMS 16
+#define REPLAY_MAX_RESULTS 100      // Cap on completion and ranked limits, as in search_server
+
+typedef enum {
+    REPLAY_SEARCH,          // Page of postings through a cursor
+    REPLAY_COMPLETE,        // indexer_complete
+    REPLAY_RANK             // indexer_search_ranked
+} ReplayQueryType;
+
+typedef struct {
+    ReplayQueryType type;
+    char* text;             // Decoded key, prefix or space-separated terms
+    size_t offset;
+    size_t limit;
+} ReplayQuery;
+
+typedef struct {
+    ReplayQuery* queries;
+    size_t count;
+    size_t skipped;         // Blank lines, other endpoints and malformed targets
+} QueryLog;
+
+// Parse a query log; NULL with *err set to EINVAL or ENOMEM on failure
+QueryLog* query_log_read(FILE* fp, int* err);
+void query_log_destroy(QueryLog* log);
+
+typedef enum {
+    REPLAY_CLOSED_LOOP,     // Every thread sends its next query as soon as one returns
+    REPLAY_OPEN_LOOP        // Poisson arrivals at target_qps, whether or not earlier queries finished
+} ReplayMode;
+
+typedef struct {
+    ReplayMode mode;
+    int num_threads;        // 0 = one per online CPU
+    double target_qps;      // Open loop only
+    size_t num_queries;     // Queries to send, cycling through the log (0 = one pass)
+    uint64_t seed;          // Arrival schedule
+} ReplayConfig;
+
+typedef struct {
+    int threads;            // Threads used
+    uint64_t queries;
+    uint64_t errors;        // Queries that failed with anything but ENOENT
+    uint64_t late;          // Open loop: queries that started over 1 ms behind schedule
+    uint64_t elapsed_ns;
+    double qps;
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+    uint64_t max_ns;
+} ReplayReport;
+
+void replay_config_init(ReplayConfig* cfg);
+
+// Run the queries of log against idx. In open loop, a query's latency is
+// measured from its scheduled arrival, not from when a thread got to it, so
+// time spent queued behind slow queries is counted (no coordinated
+// omission). Returns 0, EINVAL or ENOMEM.
+int query_replay_run(Indexer* idx, const QueryLog* log, const ReplayConfig* cfg,
+                     ReplayReport* report);
+
+// One JSON line with the configuration and results
+void replay_report_write(const ReplayReport* report, const ReplayConfig* cfg, FILE* fp);
+
+#endif // SEARCH_ENGINE_QUERY_REPLAY_H
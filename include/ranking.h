@@ -0,0 +1,38 @@
+#ifndef SEARCH_ENGINE_RANKING_H
+#define SEARCH_ENGINE_RANKING_H
+
+#include "gtrie.h"
+#include <stddef.h>
+
+#define BM25_K1 1.2
+#define BM25_B 0.75
+
+// Scored document returned by ranked retrieval
+typedef struct {
+    const char* doc_id;     // Points into the trie's DocTable
+    double score;
+} RankedDoc;
+
+// Work done by a ranked query
+typedef struct {
+    size_t postings;        // Postings across all query terms
+    size_t scored;          // Documents whose full score was computed
+} RankStats;
+
+// Top k documents for the disjunction of terms, by BM25 over stored term
+// frequencies and document lengths, highest score first. Uses block-max WAND
+// so that postings which cannot reach the current top k are skipped.
+// Returns 0, ENOENT (no term matched) or EINVAL; stats may be NULL.
+int rank_bm25_top_k(const GTrie* trie, const char* const* terms, size_t num_terms, size_t k,
+                    RankedDoc* out, size_t* count, RankStats* stats);
+
+// BM25 contribution of one term occurrence count in one document
+double rank_bm25_term_score(double idf, uint32_t tf, uint32_t doc_len, double avg_doc_len);
+
+// Inverse document frequency for a term found in df of num_docs documents
+double rank_bm25_idf(size_t df, size_t num_docs);
+
+// Bytes held by the ranking view cached on list (0 if none was built)
+size_t rank_view_bytes(const PostingList* list);
+
+#endif // SEARCH_ENGINE_RANKING_H
@@ -0,0 +1,54 @@
+#ifndef SEARCH_ENGINE_SEARCH_SERVER_H
+#define SEARCH_ENGINE_SEARCH_SERVER_H
+
+#include "indexer.h"
+#include "query_cache.h"
+#include "coordinator.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Opaque server handle
+typedef struct SearchServer SearchServer;
+
+// Server configuration
+typedef struct {
+    const char* bind_addr;      // Address to listen on (NULL = all interfaces)
+    uint16_t port;              // TCP port (0 = pick an ephemeral port)
+    int num_workers;            // Worker threads (0 = one per online CPU)
+    int backlog;                // listen() backlog
+    size_t max_request_size;    // Largest accepted request head in bytes
+    size_t cache_bytes;         // Response cache size (0 = disabled)
+    Coordinator* coordinator;   // Forward queries to shard servers instead of a local index
+    int fanout_threads;         // Threads running coordinator fan-outs (0 = four per worker)
+    // NUMA replicas (see placement.h): replicas[n] is a copy of the index
+    // built on node n; workers are spread over the nodes, bound to them and
+    // query their local replica. num_replicas 0 serves idx from every worker.
+    Indexer* const* replicas;
+    int num_replicas;
+} SearchServerConfig;
+
+// Fill a configuration with defaults
+void search_server_config_init(SearchServerConfig* cfg);
+
+// Create a server answering queries against idx (idx must outlive the server).
+// With cfg->coordinator set, idx may be NULL and /search, /bool and /rank are
+// answered by the shard servers; with cfg->replicas set, idx may be NULL and
+// the replicas must outlive the server.
+SearchServer* search_server_create(Indexer* idx, const SearchServerConfig* cfg, int* err);
+
+// Start the worker pool; returns immediately
+int search_server_start(SearchServer* srv);
+
+// Port the server is bound to (useful when cfg->port was 0)
+uint16_t search_server_port(const SearchServer* srv);
+
+// Response cache counters; returns ENOENT when the cache is disabled
+int search_server_cache_stats(const SearchServer* srv, QueryCacheStats* stats);
+
+// Stop the workers and wait for them to exit
+void search_server_stop(SearchServer* srv);
+
+// Release all resources (stops the server if still running)
+void search_server_destroy(SearchServer* srv);
+
+#endif // SEARCH_ENGINE_SEARCH_SERVER_H
@@ -0,0 +1,52 @@
+#ifndef SEARCH_ENGINE_SHARDED_INDEXER_H
+#define SEARCH_ENGINE_SHARDED_INDEXER_H
+
+#include "indexer.h"
+#include <stddef.h>
+
+#define SHARDED_MAX_SHARDS 256
+#define SHARD_FILE_SUFFIX ".shard-"     // Shard i of "path" is stored in "path.shard-i"
+
+// Keys partitioned by hash across N independent Indexers, each with its own
+// trie, node pool and writer lock. Writes to different shards run in
+// parallel; multi-key queries are split per shard, run on a shared worker
+// pool and merged. Like Indexer, cursors must not be read while their shard
+// is being written.
+typedef struct ShardedIndexer ShardedIndexer;
+
+typedef enum {
+    SHARD_QUERY_AND,    // Documents containing every key
+    SHARD_QUERY_OR      // Documents containing any key
+} ShardBoolOp;
+
+// num_shards 0 uses one shard per online CPU
+ShardedIndexer* sharded_indexer_create(size_t num_shards);
+void sharded_indexer_destroy(ShardedIndexer* si);
+
+size_t sharded_indexer_shard_count(const ShardedIndexer* si);
+size_t sharded_indexer_shard_of(const ShardedIndexer* si, const char* key);
+
+// Thread-safe; only the key's shard is locked
+int sharded_indexer_add_document(ShardedIndexer* si, const char* key, const char* doc_id);
+// Insert many pairs, every shard in parallel. failed (optional) receives the
+// number of pairs that could not be added. Returns 0 or EINVAL.
+int sharded_indexer_add_batch(ShardedIndexer* si, const char* const* keys,
+                              const char* const* doc_ids, size_t count, size_t* failed);
+
+int sharded_indexer_cursor_open(ShardedIndexer* si, const char* key, SearchCursor* cursor);
+// Batched lookup; results[i] describes keys[i]. Close every cursor.
+int sharded_indexer_search_many(ShardedIndexer* si, const char* const* keys, size_t count,
+                                SearchManyResult* results);
+// Boolean query over keys; doc ids are sorted and owned by the caller (free
+// with search_results_free). Sets *err to 0, ENOENT (no match), ENOMEM or EINVAL.
+SearchResult* sharded_indexer_search_bool(ShardedIndexer* si, const char* const* keys, size_t count,
+                                          ShardBoolOp op, int* err);
+
+// A manifest at path plus one index file per shard, written and read in parallel
+int sharded_indexer_save(ShardedIndexer* si, const char* path);
+ShardedIndexer* sharded_indexer_load(const char* path, int* err);
+
+size_t sharded_indexer_get_key_count(ShardedIndexer* si);
+size_t sharded_indexer_get_doc_count(ShardedIndexer* si);  // Postings summed over shards
+
+#endif // SEARCH_ENGINE_SHARDED_INDEXER_H
@@ -0,0 +1,28 @@
+#ifndef SEARCH_ENGINE_UTF8_H
+#define SEARCH_ENGINE_UTF8_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Strict UTF-8 (RFC 3629) validation and decoding for keys. Overlong forms,
+// surrogates, codepoints above U+10FFFF, stray continuation bytes and
+// sequences cut short by the end of the input are rejected; nothing past
+// s[len - 1] is ever read. Runs of ASCII are checked and converted 16 bytes
+// at a time with SSE2 where the target has it.
+
+// Decode the codepoint at s[0..len); returns its length in bytes, or -1
+int utf8_decode_char(const char* s, size_t len, uint32_t* cp);
+
+// True when s[0..len) is valid UTF-8
+bool utf8_validate(const char* s, size_t len);
+
+// Validate and decode s[0..len) into at most max codepoints; returns the
+// number of codepoints, or -1 when s is invalid or has more than max
+int utf8_decode(const char* s, size_t len, uint32_t* out, size_t max);
+
+// As utf8_decode, but stores codepoint % modulus (2..256) for each
+// codepoint: the child slots a trie walk takes
+int utf8_slots(const char* s, size_t len, uint8_t* out, size_t max, unsigned modulus);
+
+#endif // SEARCH_ENGINE_UTF8_H
@@ -0,0 +1,128 @@
+#include "bench.h"
+#include "logging.h"
+#include "placement.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <malloc.h>
+
+static void print_usage(const char* program) {
+    fprintf(stderr, "Usage: %s [-k keys] [-d docs] [-n postings] [-l min:max] [-u utf8_ratio]\n"
+                    "       [-s key_skew] [-z doc_skew] [-S seed] [-r repeats] [-P pages]\n", program);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -k keys        Distinct keys in the vocabulary (default: 10000)\n");
+    fprintf(stderr, "  -d docs        Distinct document ids (default: 1000)\n");
+    fprintf(stderr, "  -n postings    key:doc pairs to generate (default: 100000)\n");
+    fprintf(stderr, "  -l min:max     Key length in codepoints (default: 4:12)\n");
+    fprintf(stderr, "  -u ratio       Share of non-ASCII codepoints (default: 0.1)\n");
+    fprintf(stderr, "  -s skew        Zipf exponent of key popularity (default: 1.0)\n");
+    fprintf(stderr, "  -z skew        Zipf exponent of document popularity (default: 0.8)\n");
+    fprintf(stderr, "  -S seed        Random seed (default: 42)\n");
+    fprintf(stderr, "  -r repeats     Measured repetitions (default: 3)\n");
+    fprintf(stderr, "  -P pages       Trie node huge pages: off, thp or hugetlb (default: off)\n");
+    fprintf(stderr, "  -h             Show this help message\n");
+}
+
+int bench_parse_args(int argc, char* argv[], CorpusConfig* cfg, int* repeats) {
+    corpus_config_init(cfg);
+    if (repeats) *repeats = 3;
+    log_init(argv[0], LOG_LEVEL_ERROR, LOG_DEST_STDERR);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "k:d:n:l:u:s:z:S:r:P:h")) != -1) {
+        switch (opt) {
+            case 'k': cfg->num_keys = strtoul(optarg, NULL, 10); break;
+            case 'd': cfg->num_docs = strtoul(optarg, NULL, 10); break;
+            case 'n': cfg->num_postings = strtoul(optarg, NULL, 10); break;
+            case 'l':
+                if (sscanf(optarg, "%zu:%zu", &cfg->min_key_len, &cfg->max_key_len) != 2) {
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'u': cfg->utf8_ratio = atof(optarg); break;
+            case 's': cfg->key_skew = atof(optarg); break;
+            case 'z': cfg->doc_skew = atof(optarg); break;
+            case 'S': cfg->seed = strtoull(optarg, NULL, 10); break;
+            case 'r':
+                if (repeats) *repeats = atoi(optarg) > 0 ? atoi(optarg) : 1;
+                break;
+            case 'P': {
+                HugePageMode mode;
+                if (placement_parse_huge_pages(optarg, &mode) != 0) {
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                placement_set_huge_pages(mode);
+                break;
+            }
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    return 0;
+}
+
+uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+size_t bench_heap_bytes(void) {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+uint64_t bench_percentile(uint64_t* samples, size_t count, double percentile) {
+    if (count == 0) return 0;
+    qsort(samples, count, sizeof(uint64_t), compare_u64);
+    size_t rank = (size_t)(percentile / 100.0 * (double)(count - 1) + 0.5);
+    return samples[rank < count ? rank : count - 1];
+}
+
+static void field_name(BenchReport* report, const char* name) {
+    fprintf(report->out, "%s\"%s\":", report->fields++ ? "," : "", name);
+}
+
+void bench_report_begin(BenchReport* report, FILE* out, const char* bench, const CorpusConfig* cfg) {
+    report->out = out;
+    report->fields = 0;
+    fputc('{', out);
+    field_name(report, "bench");
+    fprintf(out, "\"%s\"", bench);
+    bench_report_int(report, "timestamp", (uint64_t)time(NULL));
+    bench_report_int(report, "keys", cfg->num_keys);
+    bench_report_int(report, "docs", cfg->num_docs);
+    bench_report_int(report, "postings", cfg->num_postings);
+    bench_report_int(report, "min_key_len", cfg->min_key_len);
+    bench_report_int(report, "max_key_len", cfg->max_key_len);
+    bench_report_num(report, "utf8_ratio", cfg->utf8_ratio);
+    bench_report_num(report, "key_skew", cfg->key_skew);
+    bench_report_num(report, "doc_skew", cfg->doc_skew);
+    bench_report_int(report, "seed", cfg->seed);
+    bench_report_int(report, "huge_pages", placement_huge_pages());
+}
+
+void bench_report_int(BenchReport* report, const char* name, uint64_t value) {
+    field_name(report, name);
+    fprintf(report->out, "%llu", (unsigned long long)value);
+}
+
+void bench_report_num(BenchReport* report, const char* name, double value) {
+    field_name(report, name);
+    fprintf(report->out, "%.6g", value);
+}
+
+void bench_report_end(BenchReport* report) {
+    fputs("}\n", report->out);
+    fflush(report->out);
+}
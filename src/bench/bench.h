@@ -0,0 +1,35 @@
+#ifndef SEARCH_ENGINE_BENCH_H
+#define SEARCH_ENGINE_BENCH_H
+
+#include "corpus.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Shared plumbing for the bench_* programs: corpus options, timing and a
+// flat JSON report printed as one line per run so results can be diffed
+// and collected over time.
+
+typedef struct {
+    FILE* out;
+    int fields;
+} BenchReport;
+
+// Parse the corpus options every benchmark accepts:
+//   -k keys -d docs -n postings -l min:max -u utf8_ratio -s key_skew
+//   -z doc_skew -S seed -r repeats -P huge_pages
+// Returns 0, or 1 after printing usage for -h or a bad option.
+int bench_parse_args(int argc, char* argv[], CorpusConfig* cfg, int* repeats);
+
+uint64_t bench_now_ns(void);
+size_t bench_heap_bytes(void);     // Bytes currently allocated by malloc
+
+// Sort samples in place and return the given percentile (0..100)
+uint64_t bench_percentile(uint64_t* samples, size_t count, double percentile);
+
+void bench_report_begin(BenchReport* report, FILE* out, const char* bench, const CorpusConfig* cfg);
+void bench_report_int(BenchReport* report, const char* name, uint64_t value);
+void bench_report_num(BenchReport* report, const char* name, double value);
+void bench_report_end(BenchReport* report);
+
+#endif // SEARCH_ENGINE_BENCH_H
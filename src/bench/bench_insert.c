@@ -0,0 +1,54 @@
+#include "bench.h"
+#include "gtrie.h"
+#include <stdlib.h>
+#include <string.h>
+
+// gtrie_insert throughput and resident bytes per distinct key
+int main(int argc, char* argv[]) {
+    CorpusConfig cfg;
+    int repeats;
+    if (bench_parse_args(argc, argv, &cfg, &repeats) != 0) return 1;
+
+    int err = 0;
+    Corpus* corpus = corpus_generate(&cfg, &err);
+    if (!corpus) {
+        fprintf(stderr, "Failed to generate corpus: %s\n", strerror(err));
+        return 1;
+    }
+
+    uint64_t best_ns = UINT64_MAX;
+    size_t heap_bytes = 0;
+    size_t nodes = 0;
+    size_t keys = 0;
+    for (int r = 0; r < repeats; r++) {
+        size_t heap_before = bench_heap_bytes();
+        GTrie* trie = gtrie_create(&err);
+        if (!trie) return 1;
+
+        uint64_t start = bench_now_ns();
+        for (size_t p = 0; p < corpus->num_postings; p++) {
+            gtrie_insert(trie, corpus->keys[corpus->key_of[p]], corpus->docs[corpus->doc_of[p]]);
+        }
+        uint64_t elapsed = bench_now_ns() - start;
+
+        if (elapsed < best_ns) best_ns = elapsed;
+        heap_bytes = bench_heap_bytes() - heap_before;
+        nodes = trie->node_count;
+        keys = trie->total_words;
+        gtrie_destroy(trie);
+    }
+
+    BenchReport report;
+    bench_report_begin(&report, stdout, "insert", &cfg);
+    bench_report_int(&report, "repeats", (uint64_t)repeats);
+    bench_report_int(&report, "trie_keys", keys);
+    bench_report_int(&report, "trie_nodes", nodes);
+    bench_report_num(&report, "inserts_per_sec", (double)corpus->num_postings * 1e9 / (double)best_ns);
+    bench_report_num(&report, "ns_per_insert", (double)best_ns / (double)corpus->num_postings);
+    bench_report_int(&report, "heap_bytes", heap_bytes);
+    bench_report_num(&report, "bytes_per_key", keys ? (double)heap_bytes / (double)keys : 0);
+    bench_report_end(&report);
+
+    corpus_destroy(corpus);
+    return 0;
+}
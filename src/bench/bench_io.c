@@ -0,0 +1,69 @@
+#include "bench.h"
+#include "gtrie.h"
+#include "gtrie_io.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// gtrie_save and gtrie_load throughput in MB/s of index file
+int main(int argc, char* argv[]) {
+    CorpusConfig cfg;
+    int repeats;
+    if (bench_parse_args(argc, argv, &cfg, &repeats) != 0) return 1;
+
+    int err = 0;
+    Corpus* corpus = corpus_generate(&cfg, &err);
+    GTrie* trie = corpus ? gtrie_create(&err) : NULL;
+    if (!trie) {
+        fprintf(stderr, "Failed to build the index: %s\n", strerror(err));
+        return 1;
+    }
+    for (size_t p = 0; p < corpus->num_postings; p++) {
+        gtrie_insert(trie, corpus->keys[corpus->key_of[p]], corpus->docs[corpus->doc_of[p]]);
+    }
+
+    const char* tmpdir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/bench_io_XXXXXX", tmpdir);
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to create a file in %s\n", tmpdir);
+        return 1;
+    }
+    close(fd);
+
+    uint64_t best_save = UINT64_MAX, best_load = UINT64_MAX;
+    struct stat st = {0};
+    for (int r = 0; r < repeats; r++) {
+        uint64_t start = bench_now_ns();
+        if (gtrie_save(trie, path, NULL, NULL) != 0) return 1;
+        uint64_t elapsed = bench_now_ns() - start;
+        if (elapsed < best_save) best_save = elapsed;
+
+        start = bench_now_ns();
+        GTrie* loaded = gtrie_load(path, &err, NULL, NULL);
+        elapsed = bench_now_ns() - start;
+        if (!loaded) return 1;
+        if (elapsed < best_load) best_load = elapsed;
+        gtrie_destroy(loaded);
+    }
+    stat(path, &st);
+    unlink(path);
+
+    double mb = (double)st.st_size / (1024.0 * 1024.0);
+    BenchReport report;
+    bench_report_begin(&report, stdout, "io", &cfg);
+    bench_report_int(&report, "repeats", (uint64_t)repeats);
+    bench_report_int(&report, "file_bytes", (uint64_t)st.st_size);
+    bench_report_num(&report, "bytes_per_key", trie->total_words ? (double)st.st_size / (double)trie->total_words : 0);
+    bench_report_num(&report, "save_ms", (double)best_save / 1e6);
+    bench_report_num(&report, "load_ms", (double)best_load / 1e6);
+    bench_report_num(&report, "save_mb_per_sec", mb * 1e9 / (double)best_save);
+    bench_report_num(&report, "load_mb_per_sec", mb * 1e9 / (double)best_load);
+    bench_report_end(&report);
+
+    gtrie_destroy(trie);
+    corpus_destroy(corpus);
+    return 0;
+}
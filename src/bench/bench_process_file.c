@@ -0,0 +1,56 @@
+#include "bench.h"
+#include "indexer.h"
+#include "index_writer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+// index_writer's process_file: lines per second from a key:doc_id file
+int main(int argc, char* argv[]) {
+    CorpusConfig cfg;
+    int repeats;
+    if (bench_parse_args(argc, argv, &cfg, &repeats) != 0) return 1;
+
+    int err = 0;
+    Corpus* corpus = corpus_generate(&cfg, &err);
+    FILE* fp = corpus ? tmpfile() : NULL;
+    if (!fp || corpus_write(corpus, fp) != 0) {
+        fprintf(stderr, "Failed to write the corpus: %s\n", strerror(err ? err : errno));
+        return 1;
+    }
+    long file_bytes = ftell(fp);
+
+    uint64_t best_ns = UINT64_MAX;
+    size_t processed = 0, failed = 0, heap_bytes = 0, keys = 0;
+    for (int r = 0; r < repeats; r++) {
+        rewind(fp);
+        size_t heap_before = bench_heap_bytes();
+        Indexer* idx = indexer_create();
+        if (!idx) return 1;
+
+        uint64_t start = bench_now_ns();
+        process_file(idx, fp, &processed, &failed);
+        uint64_t elapsed = bench_now_ns() - start;
+
+        if (elapsed < best_ns) best_ns = elapsed;
+        heap_bytes = bench_heap_bytes() - heap_before;
+        keys = indexer_get_key_count(idx);
+        indexer_destroy(idx);
+    }
+
+    BenchReport report;
+    bench_report_begin(&report, stdout, "process_file", &cfg);
+    bench_report_int(&report, "repeats", (uint64_t)repeats);
+    bench_report_int(&report, "lines", processed);
+    bench_report_int(&report, "failed", failed);
+    bench_report_int(&report, "input_bytes", (uint64_t)file_bytes);
+    bench_report_num(&report, "lines_per_sec", (double)processed * 1e9 / (double)best_ns);
+    bench_report_num(&report, "input_mb_per_sec", (double)file_bytes / (1024.0 * 1024.0) * 1e9 / (double)best_ns);
+    bench_report_int(&report, "heap_bytes", heap_bytes);
+    bench_report_num(&report, "bytes_per_key", keys ? (double)heap_bytes / (double)keys : 0);
+    bench_report_end(&report);
+
+    fclose(fp);
+    corpus_destroy(corpus);
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include "bench.h"
+#include "gtrie.h"
+#include "gtrie_io.h"
+#include "double_array.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define BENCH_SEARCH_QUERIES 200000
+
+// Exact lookup in one index representation
+typedef const PostingList* (*LookupFn)(const void* index, const char* key, int* err);
+
+static const PostingList* trie_lookup(const void* index, const char* key, int* err) {
+    return gtrie_search(index, key, err);
+}
+
+static const PostingList* double_array_lookup(const void* index, const char* key, int* err) {
+    return double_array_search(index, key, err);
+}
+
+// Time each lookup separately; returns the number of hits
+static size_t run_queries(LookupFn lookup, const void* index, char* const* queries, size_t count,
+                          uint64_t* samples) {
+    size_t hits = 0;
+    for (size_t q = 0; q < count; q++) {
+        int err = 0;
+        uint64_t start = bench_now_ns();
+        const PostingList* list = lookup(index, queries[q], &err);
+        samples[q] = bench_now_ns() - start;
+        hits += list != NULL;
+    }
+    return hits;
+}
+
+// Back-to-back lookups without per-query timing, in queries per second
+static uint64_t run_throughput(LookupFn lookup, const void* index, char* const* queries,
+                               size_t count, int repeats) {
+    uint64_t best = UINT64_MAX;
+    for (int r = 0; r <= repeats; r++) {
+        uint64_t start = bench_now_ns();
+        for (size_t q = 0; q < count; q++) {
+            int err = 0;
+            lookup(index, queries[q], &err);
+        }
+        uint64_t elapsed = bench_now_ns() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    return best ? (uint64_t)(count * 1e9 / best) : 0;
+}
+
+static void report_latency(BenchReport* report, const char* prefix, uint64_t* samples, size_t count) {
+    static const struct { const char* name; double p; } points[] = {
+        { "p50_ns", 50 }, { "p90_ns", 90 }, { "p99_ns", 99 }, { "p999_ns", 99.9 }, { "max_ns", 100 }
+    };
+    char name[64];
+    for (size_t i = 0; i < sizeof(points) / sizeof(points[0]); i++) {
+        snprintf(name, sizeof(name), "%s_%s", prefix, points[i].name);
+        bench_report_int(report, name, bench_percentile(samples, count, points[i].p));
+    }
+}
+
+// Warm up, then keep the repeat with the lowest median of hits and of misses
+static void measure(LookupFn lookup, const void* index, char* const* hit_queries,
+                    char* const* miss_queries, size_t count, int repeats, uint64_t* hit_samples,
+                    uint64_t* miss_samples, uint64_t* scratch, size_t* hits, size_t* false_hits) {
+    *hits = run_queries(lookup, index, hit_queries, count, hit_samples);
+    *false_hits = run_queries(lookup, index, miss_queries, count, miss_samples);
+    uint64_t best_hit = UINT64_MAX, best_miss = UINT64_MAX;
+    for (int r = 0; r < repeats; r++) {
+        run_queries(lookup, index, hit_queries, count, scratch);
+        uint64_t median = bench_percentile(scratch, count, 50);
+        if (median < best_hit) {
+            best_hit = median;
+            memcpy(hit_samples, scratch, count * sizeof(uint64_t));
+        }
+        run_queries(lookup, index, miss_queries, count, scratch);
+        median = bench_percentile(scratch, count, 50);
+        if (median < best_miss) {
+            best_miss = median;
+            memcpy(miss_samples, scratch, count * sizeof(uint64_t));
+        }
+    }
+}
+
+// gtrie_search latency percentiles for hits and misses on a saved and
+// reloaded index, as a server would see it, before and after gtrie_freeze,
+// then double_array_search on the same keys, with hit throughput for each
+int main(int argc, char* argv[]) {
+    CorpusConfig cfg;
+    int repeats;
+    if (bench_parse_args(argc, argv, &cfg, &repeats) != 0) return 1;
+
+    int err = 0;
+    Corpus* corpus = corpus_generate(&cfg, &err);
+    CorpusConfig miss_cfg = cfg;
+    miss_cfg.seed = cfg.seed ^ 0x5bd1e995;
+    miss_cfg.num_postings = 0;
+    Corpus* misses = corpus ? corpus_generate(&miss_cfg, &err) : NULL;
+    if (!misses) {
+        fprintf(stderr, "Failed to generate corpus: %s\n", strerror(err));
+        return 1;
+    }
+
+    GTrie* built = gtrie_create(&err);
+    for (size_t p = 0; p < corpus->num_postings; p++) {
+        gtrie_insert(built, corpus->keys[corpus->key_of[p]], corpus->docs[corpus->doc_of[p]]);
+    }
+    const char* tmpdir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/bench_search_XXXXXX", tmpdir);
+    int fd = mkstemp(path);
+    if (fd < 0 || gtrie_save(built, path, NULL, NULL) != 0) {
+        fprintf(stderr, "Failed to save the index to %s\n", path);
+        return 1;
+    }
+    close(fd);
+    GTrie* trie = gtrie_load(path, &err, NULL, NULL);
+    unlink(path);
+    gtrie_destroy(built);
+    if (!trie) return 1;
+
+    // Hits follow the key popularity of the corpus; misses are fresh keys
+    size_t count = BENCH_SEARCH_QUERIES;
+    char** hit_queries = malloc(count * sizeof(char*));
+    char** miss_queries = malloc(count * sizeof(char*));
+    uint64_t* hit_samples = malloc(count * sizeof(uint64_t));
+    uint64_t* miss_samples = malloc(count * sizeof(uint64_t));
+    if (!hit_queries || !miss_queries || !hit_samples || !miss_samples || corpus->num_postings == 0) {
+        return 1;
+    }
+    for (size_t q = 0; q < count; q++) {
+        hit_queries[q] = corpus->keys[corpus->key_of[q % corpus->num_postings]];
+        miss_queries[q] = misses->keys[q % misses->num_keys];
+    }
+
+    uint64_t* scratch = malloc(count * sizeof(uint64_t));
+    if (!scratch) return 1;
+    size_t hits = 0, false_hits = 0;
+    measure(trie_lookup, trie, hit_queries, miss_queries, count, repeats, hit_samples,
+            miss_samples, scratch, &hits, &false_hits);
+
+    BenchReport report;
+    bench_report_begin(&report, stdout, "search", &cfg);
+    bench_report_int(&report, "repeats", (uint64_t)repeats);
+    bench_report_int(&report, "queries", count);
+    bench_report_int(&report, "hits", hits);
+    // Fresh keys that still reach postings through a lossy slot collision
+    bench_report_int(&report, "miss_queries_found", false_hits);
+    report_latency(&report, "hit", hit_samples, count);
+    report_latency(&report, "miss", miss_samples, count);
+    bench_report_int(&report, "hit_qps", run_throughput(trie_lookup, trie, hit_queries, count, repeats));
+
+    // The same queries once the trie is laid out for reading (gtrie_freeze)
+    uint64_t start = bench_now_ns();
+    if (gtrie_freeze(trie) != 0) return 1;
+    bench_report_int(&report, "freeze_ns", bench_now_ns() - start);
+    measure(trie_lookup, trie, hit_queries, miss_queries, count, repeats, hit_samples,
+            miss_samples, scratch, &hits, &false_hits);
+    report_latency(&report, "frozen_hit", hit_samples, count);
+    report_latency(&report, "frozen_miss", miss_samples, count);
+    bench_report_int(&report, "frozen_hit_qps",
+                     run_throughput(trie_lookup, trie, hit_queries, count, repeats));
+
+    // And from a double array built from it (index_writer -d)
+    start = bench_now_ns();
+    DoubleArray* da = double_array_build(trie, &err);
+    if (!da) return 1;
+    bench_report_int(&report, "da_build_ns", bench_now_ns() - start);
+    bench_report_int(&report, "da_cells", double_array_cell_count(da));
+    measure(double_array_lookup, da, hit_queries, miss_queries, count, repeats, hit_samples,
+            miss_samples, scratch, &hits, &false_hits);
+    report_latency(&report, "da_hit", hit_samples, count);
+    report_latency(&report, "da_miss", miss_samples, count);
+    bench_report_int(&report, "da_hit_qps",
+                     run_throughput(double_array_lookup, da, hit_queries, count, repeats));
+    bench_report_end(&report);
+    double_array_destroy(da);
+
+    free(scratch);
+    free(hit_queries);
+    free(miss_queries);
+    free(hit_samples);
+    free(miss_samples);
+    gtrie_destroy(trie);
+    corpus_destroy(misses);
+    corpus_destroy(corpus);
+    return 0;
+}
@@ -0,0 +1,25 @@
+#include "bench.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Write a synthetic key:doc_id corpus to stdout, e.g.
+//   corpus_gen -k 100000 -n 1000000 -u 0.3 > corpus.txt
+//   index_writer -i corpus.txt -o corpus.idx
+int main(int argc, char* argv[]) {
+    CorpusConfig cfg;
+    if (bench_parse_args(argc, argv, &cfg, NULL) != 0) return 1;
+
+    int err = 0;
+    Corpus* corpus = corpus_generate(&cfg, &err);
+    if (!corpus) {
+        fprintf(stderr, "Failed to generate corpus: %s\n", strerror(err));
+        return 1;
+    }
+    int rc = corpus_write(corpus, stdout);
+    corpus_destroy(corpus);
+    if (rc != 0) {
+        fprintf(stderr, "Failed to write corpus: %s\n", strerror(rc));
+        return 1;
+    }
+    return 0;
+}
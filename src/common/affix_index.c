@@ -0,0 +1,529 @@
+#include "affix_index.h"
+#include "gtrie_io.h"
+#include "logging.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define AFFIX_MAGIC 0x58534641  // "AFSX" in hex
+#define AFFIX_VERSION 2         // Version 1 did not record the index it was built for
+
+// Header of the .sa sidecar; followed by the dictionary, the packed key
+// offsets and the packed suffix array
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key_count;
+    uint64_t dict_len;          // Bytes, including each key's NUL
+    uint64_t suffix_count;
+    uint32_t width;             // Bits per packed offset
+    uint32_t reserved;
+    uint64_t index_timestamp;   // Header timestamp of the index the sidecars belong to
+    uint64_t index_keys;        // And its key count
+} AffixHeader;
+
+struct AffixIndex {
+    GTrie* reversed;            // Reversed keys; each posting is a decimal key id
+    char* dict;                 // Sorted keys, each followed by NUL
+    size_t dict_len;
+    size_t key_count;
+    size_t suffix_count;
+    unsigned width;
+    uint64_t index_timestamp;   // Identify the index file the sidecars were written for
+    uint64_t index_keys;
+    uint64_t* starts;           // Packed dictionary offset of every key
+    uint64_t* sa;               // Packed suffix offsets, in suffix order
+};
+
+typedef struct {
+    const char* text;
+    size_t offset;
+} Suffix;
+
+static size_t packed_words(size_t count, unsigned width) {
+    return (count * width + 63) / 64;
+}
+
+static uint64_t packed_get(const uint64_t* words, unsigned width, size_t i) {
+    uint64_t bit = (uint64_t)i * width;
+    size_t w = bit / 64;
+    unsigned off = bit % 64;
+    uint64_t v = words[w] >> off;
+    if (off + width > 64) v |= words[w + 1] << (64 - off);
+    return width == 64 ? v : v & ((1ULL << width) - 1);
+}
+
+// words must be zeroed before the first set
+static void packed_set(uint64_t* words, unsigned width, size_t i, uint64_t value) {
+    uint64_t bit = (uint64_t)i * width;
+    size_t w = bit / 64;
+    unsigned off = bit % 64;
+    words[w] |= value << off;
+    if (off + width > 64) words[w + 1] |= value >> (64 - off);
+}
+
+static unsigned bits_for(size_t n) {
+    unsigned bits = 1;
+    while (bits < 64 && (n >> bits) != 0) bits++;
+    return bits;
+}
+
+static int compare_keys(const void* a, const void* b) {
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+static int compare_suffixes(const void* a, const void* b) {
+    const Suffix* x = a;
+    const Suffix* y = b;
+    int c = strcmp(x->text, y->text);
+    if (c != 0) return c;
+    return (x->offset > y->offset) - (x->offset < y->offset);
+}
+
+static int compare_ids(const void* a, const void* b) {
+    size_t x = *(const size_t*)a, y = *(const size_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Reverse a UTF-8 string codepoint by codepoint into out (len + 1 bytes)
+static void reverse_codepoints(const char* s, size_t len, char* out) {
+    size_t i = 0;
+    while (i < len) {
+        size_t n = 1;
+        while (i + n < len && ((unsigned char)s[i + n] & 0xC0) == 0x80) n++;
+        memcpy(out + len - i - n, s + i, n);
+        i += n;
+    }
+    out[len] = '\0';
+}
+
+static char* sidecar_path(const char* index_path, const char* ext) {
+    size_t len = strlen(index_path);
+    char* path = malloc(len + strlen(ext) + 1);
+    if (!path) return NULL;
+    memcpy(path, index_path, len);
+    strcpy(path + len, ext);
+    return path;
+}
+
+void affix_index_destroy(AffixIndex* index) {
+    if (!index) return;
+    gtrie_destroy(index->reversed);
+    free(index->dict);
+    free(index->starts);
+    free(index->sa);
+    free(index);
+}
+
+size_t affix_index_key_count(const AffixIndex* index) {
+    return index ? index->key_count : 0;
+}
+
+static size_t key_start(const AffixIndex* index, size_t id) {
+    return (size_t)packed_get(index->starts, index->width, id);
+}
+
+// Id of the key containing dictionary offset off
+static size_t key_at(const AffixIndex* index, size_t off) {
+    size_t lo = 0, hi = index->key_count;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (key_start(index, mid) <= off) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static int build_reversed(AffixIndex* index) {
+    int err = 0;
+    index->reversed = gtrie_create(&err);
+    if (!index->reversed) return err;
+
+    size_t max_len = 0;
+    for (size_t i = 0; i < index->key_count; i++) {
+        size_t end = i + 1 < index->key_count ? key_start(index, i + 1) : index->dict_len;
+        if (end - key_start(index, i) > max_len) max_len = end - key_start(index, i);
+    }
+    char* buf = malloc(max_len + 1);
+    if (!buf) return ENOMEM;
+
+    char id[24];
+    for (size_t i = 0; i < index->key_count && err == 0; i++) {
+        const char* key = index->dict + key_start(index, i);
+        reverse_codepoints(key, strlen(key), buf);
+        snprintf(id, sizeof(id), "%zu", i);
+        err = gtrie_insert(index->reversed, buf, id);
+    }
+    free(buf);
+    return err;
+}
+
+static int build_suffix_array(AffixIndex* index) {
+    for (size_t off = 0; off < index->dict_len; off++) {
+        unsigned char c = (unsigned char)index->dict[off];
+        if (c != '\0' && (c & 0xC0) != 0x80) index->suffix_count++;
+    }
+
+    Suffix* suffixes = malloc((index->suffix_count ? index->suffix_count : 1) * sizeof(Suffix));
+    index->sa = calloc(packed_words(index->suffix_count, index->width) + 1, sizeof(uint64_t));
+    if (!suffixes || !index->sa) {
+        free(suffixes);
+        return ENOMEM;
+    }
+
+    // Suffixes start at codepoint boundaries; NUL ends each one at its key
+    size_t n = 0;
+    for (size_t off = 0; off < index->dict_len; off++) {
+        unsigned char c = (unsigned char)index->dict[off];
+        if (c != '\0' && (c & 0xC0) != 0x80) {
+            suffixes[n].text = index->dict + off;
+            suffixes[n].offset = off;
+            n++;
+        }
+    }
+    qsort(suffixes, n, sizeof(Suffix), compare_suffixes);
+    for (size_t i = 0; i < n; i++) {
+        packed_set(index->sa, index->width, i, suffixes[i].offset);
+    }
+    free(suffixes);
+    return 0;
+}
+
+AffixIndex* affix_index_build(const GTrie* trie, int* err) {
+    if (!trie) {
+        ERROR_LOG("Invalid arguments: trie=%p", (void*)trie);
+        if (err) *err = EINVAL;
+        return NULL;
+    }
+
+    int rc = 0;
+    size_t count = 0;
+    char** keys = gtrie_prefix_search(trie, "", &count, &rc);
+    if (!keys && rc != ENOENT) {
+        if (err) *err = rc;
+        return NULL;
+    }
+
+    AffixIndex* index = calloc(1, sizeof(AffixIndex));
+    if (!index) {
+        free(keys);
+        if (err) *err = ENOMEM;
+        return NULL;
+    }
+
+    // Sorted, distinct keys give ids in byte order
+    if (count > 0) qsort(keys, count, sizeof(char*), compare_keys);
+    size_t distinct = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (distinct > 0 && strcmp(keys[distinct - 1], keys[i]) == 0) continue;
+        keys[distinct++] = keys[i];
+        index->dict_len += strlen(keys[i]) + 1;
+    }
+    index->key_count = distinct;
+    index->width = bits_for(index->dict_len);
+
+    index->dict = malloc(index->dict_len ? index->dict_len : 1);
+    index->starts = calloc(packed_words(distinct, index->width) + 1, sizeof(uint64_t));
+    rc = (index->dict && index->starts) ? 0 : ENOMEM;
+
+    size_t off = 0;
+    for (size_t i = 0; i < distinct && rc == 0; i++) {
+        size_t len = strlen(keys[i]) + 1;
+        memcpy(index->dict + off, keys[i], len);
+        packed_set(index->starts, index->width, i, off);
+        off += len;
+    }
+    free(keys);
+
+    if (rc == 0) rc = build_suffix_array(index);
+    if (rc == 0) rc = build_reversed(index);
+    if (rc != 0) {
+        ERROR_LOG("Failed to build affix index: %s", strerror(rc));
+        affix_index_destroy(index);
+        if (err) *err = rc;
+        return NULL;
+    }
+
+    DEBUG_LOG("Built affix index: %zu keys, %zu suffixes, %u-bit offsets",
+              index->key_count, index->suffix_count, index->width);
+    if (err) *err = 0;
+    return index;
+}
+
+int affix_index_save(const AffixIndex* index, const char* index_path) {
+    if (!index || !index_path) {
+        ERROR_LOG("Invalid arguments: index=%p, index_path=%p", (void*)index, (void*)index_path);
+        return EINVAL;
+    }
+
+    char* rev_path = sidecar_path(index_path, AFFIX_REVERSED_EXT);
+    char* sa_path = sidecar_path(index_path, AFFIX_SUFFIX_EXT);
+    if (!rev_path || !sa_path) {
+        free(rev_path);
+        free(sa_path);
+        return ENOMEM;
+    }
+
+    // The sidecars are only valid next to the index saved at index_path
+    IndexHeader main_header;
+    int rc = gtrie_read_header(index_path, &main_header);
+    if (rc != 0) ERROR_LOG("Cannot write sidecars without the index %s: %s", index_path, strerror(rc));
+    if (rc == 0) rc = gtrie_save(index->reversed, rev_path, NULL, NULL);
+    FILE* fp = rc == 0 ? fopen(sa_path, "wb") : NULL;
+    if (rc == 0 && !fp) {
+        rc = errno;
+        ERROR_LOG("Failed to open file %s for writing: %s", sa_path, strerror(rc));
+    }
+
+    if (fp) {
+        AffixHeader header = {
+            .magic = AFFIX_MAGIC,
+            .version = AFFIX_VERSION,
+            .key_count = index->key_count,
+            .dict_len = index->dict_len,
+            .suffix_count = index->suffix_count,
+            .width = index->width,
+            .index_timestamp = main_header.timestamp,
+            .index_keys = main_header.total_words
+        };
+        size_t start_words = packed_words(index->key_count, index->width);
+        size_t sa_words = packed_words(index->suffix_count, index->width);
+        if (fwrite(&header, sizeof(header), 1, fp) != 1 ||
+            fwrite(index->dict, 1, index->dict_len, fp) != index->dict_len ||
+            fwrite(index->starts, sizeof(uint64_t), start_words, fp) != start_words ||
+            fwrite(index->sa, sizeof(uint64_t), sa_words, fp) != sa_words) {
+            rc = EIO;
+        }
+        if (fclose(fp) != 0 && rc == 0) rc = EIO;
+        if (rc != 0) ERROR_LOG("Failed to write %s: %s", sa_path, strerror(rc));
+    }
+
+    if (rc == 0) INFO_LOG("Saved affix sidecars for %s (%zu keys)", index_path, index->key_count);
+    free(rev_path);
+    free(sa_path);
+    return rc;
+}
+
+int affix_index_remove(const char* index_path) {
+    if (!index_path) {
+        ERROR_LOG("Invalid arguments: index_path=%p", (void*)index_path);
+        return EINVAL;
+    }
+
+    const char* exts[] = { AFFIX_REVERSED_EXT, AFFIX_SUFFIX_EXT };
+    int rc = 0;
+    for (size_t i = 0; i < sizeof(exts) / sizeof(exts[0]); i++) {
+        char* path = sidecar_path(index_path, exts[i]);
+        if (!path) return ENOMEM;
+        if (unlink(path) == 0) {
+            INFO_LOG("Removed stale sidecar %s", path);
+        } else if (errno != ENOENT && rc == 0) {
+            rc = errno;
+            ERROR_LOG("Failed to remove %s: %s", path, strerror(rc));
+        }
+        free(path);
+    }
+    return rc;
+}
+
+// Check every packed offset before trusting the file
+static int validate_loaded(const AffixIndex* index) {
+    if (index->dict_len > 0 && index->dict[index->dict_len - 1] != '\0') return EINVAL;
+    if (index->key_count > 0 && key_start(index, 0) != 0) return EINVAL;
+
+    for (size_t i = 0; i < index->key_count; i++) {
+        size_t start = key_start(index, i);
+        size_t end = i + 1 < index->key_count ? key_start(index, i + 1) : index->dict_len;
+        if (end <= start || end > index->dict_len || index->dict[end - 1] != '\0' ||
+            strlen(index->dict + start) != end - start - 1) {
+            return EINVAL;
+        }
+    }
+    for (size_t i = 0; i < index->suffix_count; i++) {
+        if (packed_get(index->sa, index->width, i) >= index->dict_len) return EINVAL;
+    }
+    return 0;
+}
+
+static int load_suffix_array(AffixIndex* index, const char* path) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return errno;
+
+    int rc = 0;
+    AffixHeader header;
+    struct stat st;
+    if (fread(&header, sizeof(header), 1, fp) != 1 || fstat(fileno(fp), &st) != 0) {
+        rc = EINVAL;
+    } else if (header.magic != AFFIX_MAGIC || header.version != AFFIX_VERSION ||
+               header.width == 0 || header.width > 64 ||
+               header.key_count > header.dict_len || header.suffix_count > header.dict_len ||
+               header.dict_len > (uint64_t)st.st_size) {
+        rc = EINVAL;
+    } else {
+        index->key_count = header.key_count;
+        index->dict_len = header.dict_len;
+        index->suffix_count = header.suffix_count;
+        index->width = header.width;
+        index->index_timestamp = header.index_timestamp;
+        index->index_keys = header.index_keys;
+
+        size_t start_words = packed_words(index->key_count, index->width);
+        size_t sa_words = packed_words(index->suffix_count, index->width);
+        uint64_t expected = sizeof(header) + index->dict_len + (start_words + sa_words) * sizeof(uint64_t);
+        if (expected != (uint64_t)st.st_size) {
+            rc = EINVAL;
+        } else {
+            index->dict = malloc(index->dict_len ? index->dict_len : 1);
+            index->starts = calloc(start_words + 1, sizeof(uint64_t));
+            index->sa = calloc(sa_words + 1, sizeof(uint64_t));
+            if (!index->dict || !index->starts || !index->sa) {
+                rc = ENOMEM;
+            } else if (fread(index->dict, 1, index->dict_len, fp) != index->dict_len ||
+                       fread(index->starts, sizeof(uint64_t), start_words, fp) != start_words ||
+                       fread(index->sa, sizeof(uint64_t), sa_words, fp) != sa_words) {
+                rc = EINVAL;
+            } else {
+                rc = validate_loaded(index);
+            }
+        }
+    }
+
+    fclose(fp);
+    return rc;
+}
+
+AffixIndex* affix_index_load(const char* index_path, const GTrie* trie, int* err) {
+    if (!index_path || !trie) {
+        ERROR_LOG("Invalid arguments: index_path=%p, trie=%p", (void*)index_path, (void*)trie);
+        if (err) *err = EINVAL;
+        return NULL;
+    }
+
+    char* rev_path = sidecar_path(index_path, AFFIX_REVERSED_EXT);
+    char* sa_path = sidecar_path(index_path, AFFIX_SUFFIX_EXT);
+    AffixIndex* index = calloc(1, sizeof(AffixIndex));
+    int rc = (rev_path && sa_path && index) ? 0 : ENOMEM;
+
+    struct stat st;
+    if (rc == 0 && (stat(rev_path, &st) != 0 || stat(sa_path, &st) != 0)) {
+        rc = ENOENT;  // No sidecars for this index
+    }
+    if (rc == 0) {
+        rc = load_suffix_array(index, sa_path);
+        if (rc != 0) ERROR_LOG("Failed to load suffix array %s: %s", sa_path, strerror(rc));
+    }
+    // Left behind by an earlier build of the index, e.g. one run with -x
+    if (rc == 0 && (index->index_timestamp != trie->timestamp ||
+                    index->index_keys != trie->total_words)) {
+        WARN_LOG("Sidecars %s were written for another build of %s", sa_path, index_path);
+        rc = ESTALE;
+    }
+    if (rc == 0) {
+        index->reversed = gtrie_load(rev_path, &rc, NULL, NULL);
+        if (index->reversed && index->reversed->total_words != index->key_count) {
+            ERROR_LOG("Reversed key trie %s does not match %s", rev_path, sa_path);
+            rc = EINVAL;
+        }
+    }
+
+    free(rev_path);
+    free(sa_path);
+    if (rc != 0) {
+        affix_index_destroy(index);
+        if (err) *err = rc;
+        return NULL;
+    }
+
+    if (err) *err = 0;
+    return index;
+}
+
+// Key ids of reversed-trie entries starting with the reversed suffix
+static int suffix_ids(const AffixIndex* index, const char* text, size_t** ids, size_t* n) {
+    size_t len = strlen(text);
+    char* reversed = malloc(len + 1);
+    if (!reversed) return ENOMEM;
+    reverse_codepoints(text, len, reversed);
+
+    int rc = 0;
+    size_t count = 0;
+    char** words = gtrie_prefix_search(index->reversed, reversed, &count, &rc);
+    free(reversed);
+    if (!words) return rc;
+
+    *ids = malloc(count * sizeof(size_t));
+    if (!*ids) {
+        free(words);
+        return ENOMEM;
+    }
+    for (size_t i = 0; i < count; i++) {
+        PostingList* postings = gtrie_search(index->reversed, words[i], &rc);
+        if (!postings || !postings->head) continue;
+        char* end = NULL;
+        size_t id = strtoul(postings->head->doc_id, &end, 10);
+        if (*end == '\0' && id < index->key_count) (*ids)[(*n)++] = id;
+    }
+    free(words);
+    return 0;
+}
+
+// Key ids owning the suffixes that start with text: O(|text| log n) to find
+// the suffix array range, then one key lookup per occurrence
+static int infix_ids(const AffixIndex* index, const char* text, size_t** ids, size_t* n) {
+    size_t len = strlen(text);
+    size_t lo = 0, hi = index->suffix_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const char* s = index->dict + packed_get(index->sa, index->width, mid);
+        if (strncmp(s, text, len) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    size_t first = lo;
+    hi = index->suffix_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const char* s = index->dict + packed_get(index->sa, index->width, mid);
+        if (strncmp(s, text, len) <= 0) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == first) return ENOENT;
+
+    *ids = malloc((lo - first) * sizeof(size_t));
+    if (!*ids) return ENOMEM;
+    for (size_t i = first; i < lo; i++) {
+        (*ids)[(*n)++] = key_at(index, (size_t)packed_get(index->sa, index->width, i));
+    }
+    return 0;
+}
+
+int affix_index_search(const AffixIndex* index, AffixQuery query, const char* text,
+                       const char** keys, size_t max_keys, size_t* count) {
+    if (count) *count = 0;
+    if (!index || !text || !keys || max_keys == 0 ||
+        (query != AFFIX_SUFFIX && query != AFFIX_INFIX)) {
+        ERROR_LOG("Invalid arguments: index=%p, query=%d, text=%p, keys=%p, max_keys=%zu",
+                 (void*)index, (int)query, (void*)text, (void*)keys, max_keys);
+        return EINVAL;
+    }
+    if (index->key_count == 0) return ENOENT;
+
+    size_t* ids = NULL;
+    size_t n = 0;
+    int rc = query == AFFIX_SUFFIX ? suffix_ids(index, text, &ids, &n)
+                                   : infix_ids(index, text, &ids, &n);
+    if (rc != 0) return rc;
+
+    qsort(ids, n, sizeof(size_t), compare_ids);
+    size_t out = 0;
+    for (size_t i = 0; i < n && out < max_keys; i++) {
+        if (i > 0 && ids[i] == ids[i - 1]) continue;
+        keys[out++] = index->dict + key_start(index, ids[i]);
+    }
+    free(ids);
+
+    if (count) *count = out;
+    return out > 0 ? 0 : ENOENT;
+}
@@ -0,0 +1,657 @@
+#define _GNU_SOURCE
+#include "coordinator.h"
+#include "logging.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define COORDINATOR_DEFAULT_TIMEOUT_MS 1000
+#define COORDINATOR_DEFAULT_HEDGE_MS 50
+#define COORDINATOR_READ_CHUNK 16384
+#define COORDINATOR_MAX_RESPONSE (64 * 1024 * 1024)
+
+typedef struct {
+    struct sockaddr_in replicas[COORDINATOR_MAX_REPLICAS];
+    size_t num_replicas;
+} ShardTarget;
+
+struct Coordinator {
+    ShardTarget* shards;
+    size_t num_shards;
+    CoordinatorConfig cfg;
+};
+
+// Growable byte buffer; data stays NUL-terminated for parsing
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+} Buffer;
+
+// One request to one replica
+typedef struct {
+    int fd;                 // -1 when not in flight
+    size_t sent;
+    Buffer response;
+} Attempt;
+
+// Progress of one shard within a fan-out
+typedef struct {
+    Attempt attempts[COORDINATOR_MAX_REPLICAS];
+    size_t launched;        // Replicas tried so far
+    int64_t hedge_at;       // When the next backup request is due
+    bool done;
+    bool failed;
+    const char* body;       // Winning response body
+} ShardCall;
+
+static int buffer_reserve(Buffer* buf, size_t extra) {
+    if (buf->len + extra + 1 <= buf->cap) return 0;
+
+    size_t cap = buf->cap ? buf->cap : 256;
+    while (cap < buf->len + extra + 1) cap *= 2;
+    char* data = realloc(buf->data, cap);
+    if (!data) return ENOMEM;
+    buf->data = data;
+    buf->cap = cap;
+    return 0;
+}
+
+static int buffer_append(Buffer* buf, const char* data, size_t len) {
+    if (buffer_reserve(buf, len) != 0) return ENOMEM;
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+    buf->data[buf->len] = '\0';
+    return 0;
+}
+
+static int buffer_append_str(Buffer* buf, const char* str) {
+    return buffer_append(buf, str, strlen(str));
+}
+
+// Percent-encode everything but unreserved characters
+static int buffer_append_encoded(Buffer* buf, const char* str) {
+    static const char hex[] = "0123456789ABCDEF";
+    for (const unsigned char* p = (const unsigned char*)str; *p; p++) {
+        if ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') || (*p >= '0' && *p <= '9') ||
+            *p == '-' || *p == '_' || *p == '.' || *p == '~') {
+            if (buffer_append(buf, (const char*)p, 1) != 0) return ENOMEM;
+        } else {
+            char esc[3] = { '%', hex[*p >> 4], hex[*p & 0xF] };
+            if (buffer_append(buf, esc, 3) != 0) return ENOMEM;
+        }
+    }
+    return 0;
+}
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// ---- Lifecycle ----
+
+void coordinator_config_init(CoordinatorConfig* cfg) {
+    if (!cfg) return;
+    cfg->timeout_ms = COORDINATOR_DEFAULT_TIMEOUT_MS;
+    cfg->hedge_ms = COORDINATOR_DEFAULT_HEDGE_MS;
+}
+
+// Parse "host:port[,host:port...]"
+static int parse_target(const char* spec, ShardTarget* target) {
+    const char* p = spec;
+    target->num_replicas = 0;
+
+    while (*p) {
+        const char* comma = strchr(p, ',');
+        size_t len = comma ? (size_t)(comma - p) : strlen(p);
+        const char* colon = memchr(p, ':', len);
+        if (!colon || target->num_replicas == COORDINATOR_MAX_REPLICAS) return EINVAL;
+
+        char host[INET_ADDRSTRLEN];
+        size_t host_len = (size_t)(colon - p);
+        if (host_len == 0 || host_len >= sizeof(host)) return EINVAL;
+        memcpy(host, p, host_len);
+        host[host_len] = '\0';
+
+        char* end = NULL;
+        long port = strtol(colon + 1, &end, 10);
+        if (end != p + len || port <= 0 || port > 65535) return EINVAL;
+
+        struct sockaddr_in* addr = &target->replicas[target->num_replicas++];
+        memset(addr, 0, sizeof(*addr));
+        addr->sin_family = AF_INET;
+        addr->sin_port = htons((uint16_t)port);
+        if (inet_pton(AF_INET, host, &addr->sin_addr) != 1) return EINVAL;
+
+        if (!comma) break;
+        p = comma + 1;
+        if (!*p) return EINVAL;
+    }
+    return target->num_replicas > 0 ? 0 : EINVAL;
+}
+
+Coordinator* coordinator_create(const char* const* shards, size_t num_shards,
+                                const CoordinatorConfig* cfg, int* err) {
+    if (!shards || num_shards == 0 || num_shards > COORDINATOR_MAX_SHARDS) {
+        ERROR_LOG("Invalid arguments: shards=%p, num_shards=%zu", (void*)shards, num_shards);
+        if (err) *err = EINVAL;
+        return NULL;
+    }
+
+    Coordinator* c = calloc(1, sizeof(Coordinator));
+    if (c) c->shards = calloc(num_shards, sizeof(ShardTarget));
+    if (!c || !c->shards) {
+        free(c);
+        if (err) *err = ENOMEM;
+        return NULL;
+    }
+    c->num_shards = num_shards;
+    if (cfg) {
+        c->cfg = *cfg;
+    } else {
+        coordinator_config_init(&c->cfg);
+    }
+    if (c->cfg.timeout_ms <= 0) c->cfg.timeout_ms = COORDINATOR_DEFAULT_TIMEOUT_MS;
+    if (c->cfg.hedge_ms < 0) c->cfg.hedge_ms = 0;
+
+    for (size_t s = 0; s < num_shards; s++) {
+        if (!shards[s] || parse_target(shards[s], &c->shards[s]) != 0) {
+            ERROR_LOG("Invalid shard address: %s", shards[s] ? shards[s] : "(null)");
+            coordinator_destroy(c);
+            if (err) *err = EINVAL;
+            return NULL;
+        }
+    }
+
+    INFO_LOG("Coordinator over %zu shards (timeout %d ms, hedge %d ms)",
+             num_shards, c->cfg.timeout_ms, c->cfg.hedge_ms);
+    if (err) *err = 0;
+    return c;
+}
+
+void coordinator_destroy(Coordinator* c) {
+    if (!c) return;
+    free(c->shards);
+    free(c);
+}
+
+size_t coordinator_shard_count(const Coordinator* c) {
+    return c ? c->num_shards : 0;
+}
+
+void coordinator_result_free(CoordinatorResult* result) {
+    if (!result) return;
+    for (size_t i = 0; i < result->count; i++) free(result->hits[i].doc_id);
+    free(result->hits);
+    memset(result, 0, sizeof(*result));
+}
+
+// ---- Scatter ----
+
+static void attempt_close(Attempt* a) {
+    if (a->fd >= 0) close(a->fd);
+    a->fd = -1;
+}
+
+// Start a request to the shard's next replica; false when none is left
+static bool launch_next(ShardCall* call, const ShardTarget* target) {
+    while (call->launched < target->num_replicas) {
+        Attempt* a = &call->attempts[call->launched];
+        const struct sockaddr_in* addr = &target->replicas[call->launched++];
+
+        a->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (a->fd < 0) continue;
+        int one = 1;
+        setsockopt(a->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (connect(a->fd, (const struct sockaddr*)addr, sizeof(*addr)) == 0 || errno == EINPROGRESS) {
+            return true;
+        }
+        attempt_close(a);
+    }
+    return false;
+}
+
+// Accept a complete response if it is a 200; returns false otherwise
+static bool accept_response(ShardCall* call, Attempt* a) {
+    Buffer* r = &a->response;
+    if (!r->data || r->len < 12 || memcmp(r->data, "HTTP/1.1 200", 12) != 0) return false;
+
+    char* head_end = strstr(r->data, "\r\n\r\n");
+    if (!head_end) return false;
+    call->body = head_end + 4;
+    call->done = true;
+    return true;
+}
+
+// Drive one attempt after poll reported events on it
+static void attempt_progress(ShardCall* call, const ShardTarget* target, Attempt* a,
+                             short revents, const char* request, size_t request_len) {
+    bool failed = (revents & POLLERR) != 0;
+
+    if (!failed && a->sent < request_len && (revents & POLLOUT)) {
+        int so_error = 0;
+        socklen_t len = sizeof(so_error);
+        getsockopt(a->fd, SOL_SOCKET, SO_ERROR, &so_error, &len);
+        ssize_t n = so_error ? -1 : send(a->fd, request + a->sent, request_len - a->sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            a->sent += (size_t)n;
+        } else if (so_error || (errno != EAGAIN && errno != EINTR)) {
+            failed = true;
+        }
+    }
+
+    if (!failed && a->sent == request_len && (revents & (POLLIN | POLLHUP))) {
+        for (;;) {
+            if (a->response.len > COORDINATOR_MAX_RESPONSE ||
+                buffer_reserve(&a->response, COORDINATOR_READ_CHUNK) != 0) {
+                failed = true;
+                break;
+            }
+            ssize_t n = recv(a->fd, a->response.data + a->response.len,
+                             a->response.cap - a->response.len - 1, 0);
+            if (n > 0) {
+                a->response.len += (size_t)n;
+                a->response.data[a->response.len] = '\0';
+            } else if (n == 0) {
+                // Connection: close marks the end of the response
+                attempt_close(a);
+                if (accept_response(call, a)) return;
+                failed = true;
+                break;
+            } else {
+                if (errno != EAGAIN && errno != EINTR) failed = true;
+                break;
+            }
+        }
+    }
+
+    if (failed) {
+        attempt_close(a);
+        bool in_flight = false;
+        for (size_t i = 0; i < call->launched; i++) in_flight |= call->attempts[i].fd >= 0;
+        // Fail over at once rather than waiting for the hedge timer
+        if (!in_flight && !launch_next(call, target)) call->failed = true;
+    }
+}
+
+// Send request to every shard and collect one response per shard until the deadline
+static int scatter(Coordinator* c, const char* request, size_t request_len,
+                   ShardCall* calls, CoordinatorResult* result) {
+    size_t max_fds = c->num_shards * COORDINATOR_MAX_REPLICAS;
+    struct pollfd* fds = malloc(max_fds * sizeof(struct pollfd));
+    Attempt** owners = malloc(max_fds * sizeof(Attempt*));
+    size_t* owner_shard = malloc(max_fds * sizeof(size_t));
+    if (!fds || !owners || !owner_shard) {
+        free(fds);
+        free(owners);
+        free(owner_shard);
+        return ENOMEM;
+    }
+
+    int64_t start = now_ms();
+    int64_t deadline = start + c->cfg.timeout_ms;
+    for (size_t s = 0; s < c->num_shards; s++) {
+        for (size_t r = 0; r < COORDINATOR_MAX_REPLICAS; r++) calls[s].attempts[r].fd = -1;
+        calls[s].hedge_at = start + c->cfg.hedge_ms;
+        if (!launch_next(&calls[s], &c->shards[s])) calls[s].failed = true;
+    }
+
+    for (;;) {
+        int64_t now = now_ms();
+        int64_t wake = deadline;
+        size_t nfds = 0;
+
+        for (size_t s = 0; s < c->num_shards; s++) {
+            ShardCall* call = &calls[s];
+            if (call->done || call->failed) continue;
+
+            // Hedge: the replica in flight is slow, ask the next one as well
+            if (c->cfg.hedge_ms > 0 && now >= call->hedge_at &&
+                call->launched < c->shards[s].num_replicas) {
+                if (launch_next(call, &c->shards[s])) result->hedged++;
+                call->hedge_at = now + c->cfg.hedge_ms;
+            }
+            if (c->cfg.hedge_ms > 0 && call->launched < c->shards[s].num_replicas &&
+                call->hedge_at < wake) {
+                wake = call->hedge_at;
+            }
+
+            for (size_t i = 0; i < call->launched; i++) {
+                Attempt* a = &call->attempts[i];
+                if (a->fd < 0) continue;
+                fds[nfds].fd = a->fd;
+                fds[nfds].events = a->sent < request_len ? POLLOUT : POLLIN;
+                fds[nfds].revents = 0;
+                owners[nfds] = a;
+                owner_shard[nfds++] = s;
+            }
+        }
+        if (nfds == 0 || now >= deadline) break;
+
+        int n = poll(fds, nfds, (int)(wake > now ? wake - now : 0));
+        if (n < 0 && errno != EINTR) break;
+
+        for (size_t i = 0; n > 0 && i < nfds; i++) {
+            ShardCall* call = &calls[owner_shard[i]];
+            if (fds[i].revents == 0 || call->done || owners[i]->fd < 0) continue;
+            attempt_progress(call, &c->shards[owner_shard[i]], owners[i], fds[i].revents,
+                             request, request_len);
+            if (call->done) {
+                // First answer wins; drop the other replicas
+                for (size_t r = 0; r < call->launched; r++) attempt_close(&call->attempts[r]);
+            }
+        }
+    }
+
+    for (size_t s = 0; s < c->num_shards; s++) {
+        for (size_t r = 0; r < calls[s].launched; r++) attempt_close(&calls[s].attempts[r]);
+        if (calls[s].done) {
+            result->shards_ok++;
+        } else {
+            result->shards_failed++;
+            WARN_LOG("Shard %zu did not answer within %d ms", s, c->cfg.timeout_ms);
+        }
+    }
+
+    free(fds);
+    free(owners);
+    free(owner_shard);
+    return result->shards_ok > 0 ? 0 : ETIMEDOUT;
+}
+
+static void free_calls(ShardCall* calls, size_t n) {
+    for (size_t s = 0; s < n; s++) {
+        for (size_t r = 0; r < COORDINATOR_MAX_REPLICAS; r++) free(calls[s].attempts[r].response.data);
+    }
+    free(calls);
+}
+
+// ---- Response parsing ----
+
+static const char* skip_ws(const char* p) {
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+    return p;
+}
+
+// Locate the value of a top-level field. Quotes inside strings are escaped,
+// so "name": cannot match inside one.
+static const char* find_field(const char* body, const char* name) {
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", name);
+    const char* p = strstr(body, pattern);
+    return p ? skip_ws(p + strlen(pattern)) : NULL;
+}
+
+// Parse a JSON string literal at *p into a new allocation
+static char* parse_string(const char** p) {
+    const char* s = *p;
+    if (*s != '"') return NULL;
+    s++;
+
+    Buffer out = { NULL, 0, 0 };
+    if (buffer_reserve(&out, 16) != 0) return NULL;
+    out.data[0] = '\0';
+    while (*s && *s != '"') {
+        char ch = *s++;
+        if (ch == '\\') {
+            ch = *s++;
+            if (ch == 'u') {
+                // The server only escapes control bytes as \u00XX
+                unsigned value = 0;
+                for (int i = 0; i < 4; i++) {
+                    char h = *s++;
+                    int v = (h >= '0' && h <= '9') ? h - '0' :
+                            (h >= 'a' && h <= 'f') ? h - 'a' + 10 :
+                            (h >= 'A' && h <= 'F') ? h - 'A' + 10 : -1;
+                    if (v < 0) {
+                        free(out.data);
+                        return NULL;
+                    }
+                    value = value * 16 + (unsigned)v;
+                }
+                if (value > 0xFF) {
+                    free(out.data);
+                    return NULL;
+                }
+                ch = (char)value;
+            } else if (ch == 'n') {
+                ch = '\n';
+            } else if (ch == 't') {
+                ch = '\t';
+            } else if (ch != '"' && ch != '\\' && ch != '/') {
+                free(out.data);
+                return NULL;
+            }
+        }
+        if (buffer_append(&out, &ch, 1) != 0) {
+            free(out.data);
+            return NULL;
+        }
+    }
+    if (*s != '"') {
+        free(out.data);
+        return NULL;
+    }
+    *p = s + 1;
+    return out.data;
+}
+
+static int add_hit(CoordinatorResult* result, size_t* cap, char* doc_id, double score) {
+    if (result->count == *cap) {
+        size_t new_cap = *cap ? *cap * 2 : 64;
+        CoordinatorHit* hits = realloc(result->hits, new_cap * sizeof(CoordinatorHit));
+        if (!hits) return ENOMEM;
+        result->hits = hits;
+        *cap = new_cap;
+    }
+    result->hits[result->count++] = (CoordinatorHit){ doc_id, score };
+    return 0;
+}
+
+// Append the "results" array of one shard: doc id strings or {"doc","score"} objects
+static int parse_results(const char* body, CoordinatorResult* result, size_t* cap) {
+    const char* p = find_field(body, "results");
+    if (!p || *p != '[') return EINVAL;
+    p = skip_ws(p + 1);
+
+    while (*p && *p != ']') {
+        char* doc_id = NULL;
+        double score = 0;
+        if (*p == '"') {
+            doc_id = parse_string(&p);
+        } else if (*p == '{') {
+            p = skip_ws(p + 1);
+            while (*p == '"') {
+                char* name = parse_string(&p);
+                p = name ? skip_ws(p) : p;
+                if (!name || *p != ':') {
+                    free(name);
+                    free(doc_id);
+                    return EINVAL;
+                }
+                p = skip_ws(p + 1);
+                if (strcmp(name, "doc") == 0 && !doc_id) {
+                    doc_id = parse_string(&p);
+                } else {
+                    char* end = NULL;
+                    double value = strtod(p, &end);
+                    if (end == p) {
+                        free(name);
+                        free(doc_id);
+                        return EINVAL;
+                    }
+                    if (strcmp(name, "score") == 0) score = value;
+                    p = end;
+                }
+                free(name);
+                p = skip_ws(p);
+                if (*p == ',') p = skip_ws(p + 1);
+            }
+            if (*p != '}') {
+                free(doc_id);
+                return EINVAL;
+            }
+            p++;
+        }
+        if (!doc_id) return EINVAL;
+        if (add_hit(result, cap, doc_id, score) != 0) {
+            free(doc_id);
+            return ENOMEM;
+        }
+
+        p = skip_ws(p);
+        if (*p == ',') p = skip_ws(p + 1);
+    }
+    return *p == ']' ? 0 : EINVAL;
+}
+
+static int compare_by_doc(const void* a, const void* b) {
+    return strcmp(((const CoordinatorHit*)a)->doc_id, ((const CoordinatorHit*)b)->doc_id);
+}
+
+static int compare_by_score(const void* a, const void* b) {
+    const CoordinatorHit* x = a;
+    const CoordinatorHit* y = b;
+    if (x->score != y->score) return x->score > y->score ? -1 : 1;
+    return strcmp(x->doc_id, y->doc_id);
+}
+
+static void truncate_hits(CoordinatorResult* result, size_t limit) {
+    while (result->count > limit) free(result->hits[--result->count].doc_id);
+}
+
+// Send path to every shard, then merge the answers into result
+static int gather(Coordinator* c, const Buffer* path, bool ranked, size_t limit,
+                  CoordinatorResult* result) {
+    Buffer request = { NULL, 0, 0 };
+    if (buffer_append_str(&request, "GET ") != 0 ||
+        buffer_append(&request, path->data, path->len) != 0 ||
+        buffer_append_str(&request, " HTTP/1.1\r\nHost: shard\r\nConnection: close\r\n\r\n") != 0) {
+        free(request.data);
+        return ENOMEM;
+    }
+
+    ShardCall* calls = calloc(c->num_shards, sizeof(ShardCall));
+    if (!calls) {
+        free(request.data);
+        return ENOMEM;
+    }
+
+    int rc = scatter(c, request.data, request.len, calls, result);
+    size_t cap = 0;
+    for (size_t s = 0; rc == 0 && s < c->num_shards; s++) {
+        if (!calls[s].done) continue;
+        int parse_rc = parse_results(calls[s].body, result, &cap);
+        if (parse_rc == ENOMEM) {
+            rc = ENOMEM;
+        } else if (parse_rc != 0) {
+            WARN_LOG("Shard %zu sent a malformed response", s);
+            result->shards_ok--;
+            result->shards_failed++;
+        }
+        const char* total = find_field(calls[s].body, "total");
+        if (parse_rc == 0 && total) result->total += strtoull(total, NULL, 10);
+    }
+    if (rc == 0 && result->shards_ok == 0) rc = ETIMEDOUT;
+
+    if (rc == 0) {
+        qsort(result->hits, result->count, sizeof(CoordinatorHit),
+              ranked ? compare_by_score : compare_by_doc);
+        truncate_hits(result, limit);
+    }
+
+    DEBUG_LOG("Gathered %zu hits from %zu/%zu shards (%zu hedged)", result->count,
+              result->shards_ok, c->num_shards, result->hedged);
+    free_calls(calls, c->num_shards);
+    free(request.data);
+    return rc;
+}
+
+// Join terms into a "+"-separated query value
+static int append_terms(Buffer* path, const char* const* terms, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (!terms[i] || strchr(terms[i], ' ')) return EINVAL;
+        if ((i > 0 && buffer_append(path, "+", 1) != 0) || buffer_append_encoded(path, terms[i]) != 0) {
+            return ENOMEM;
+        }
+    }
+    return 0;
+}
+
+static int append_limit(Buffer* path, const char* name, size_t limit) {
+    if (limit == SIZE_MAX) return 0;
+    char param[48];
+    snprintf(param, sizeof(param), "&%s=%zu", name, limit);
+    return buffer_append_str(path, param);
+}
+
+int coordinator_search(Coordinator* c, const char* key, size_t limit, CoordinatorResult* result) {
+    if (result) memset(result, 0, sizeof(*result));
+    if (!c || !key || !result) {
+        ERROR_LOG("Invalid arguments: c=%p, key=%p, result=%p", (void*)c, (void*)key, (void*)result);
+        return EINVAL;
+    }
+
+    Buffer path = { NULL, 0, 0 };
+    int rc = buffer_append_str(&path, "/search?q=");
+    if (rc == 0) rc = buffer_append_encoded(&path, key);
+    if (rc == 0) rc = append_limit(&path, "limit", limit);
+    if (rc == 0) rc = gather(c, &path, false, limit, result);
+    free(path.data);
+    if (rc != 0) coordinator_result_free(result);
+    return rc;
+}
+
+int coordinator_search_bool(Coordinator* c, const char* const* keys, size_t count, ShardBoolOp op,
+                            size_t limit, CoordinatorResult* result) {
+    if (result) memset(result, 0, sizeof(*result));
+    if (!c || !keys || count == 0 || count > COORDINATOR_MAX_TERMS || !result ||
+        (op != SHARD_QUERY_AND && op != SHARD_QUERY_OR)) {
+        ERROR_LOG("Invalid arguments: c=%p, keys=%p, count=%zu, op=%d",
+                 (void*)c, (void*)keys, count, (int)op);
+        return EINVAL;
+    }
+
+    Buffer path = { NULL, 0, 0 };
+    int rc = buffer_append_str(&path, op == SHARD_QUERY_AND ? "/bool?op=and&q=" : "/bool?op=or&q=");
+    if (rc == 0) rc = append_terms(&path, keys, count);
+    if (rc == 0) rc = append_limit(&path, "limit", limit);
+    if (rc == 0) rc = gather(c, &path, false, limit, result);
+    free(path.data);
+    if (rc != 0) coordinator_result_free(result);
+    return rc;
+}
+
+int coordinator_search_ranked(Coordinator* c, const char* const* terms, size_t count, size_t k,
+                              CoordinatorResult* result) {
+    if (result) memset(result, 0, sizeof(*result));
+    if (!c || !terms || count == 0 || count > COORDINATOR_MAX_TERMS || k == 0 || !result) {
+        ERROR_LOG("Invalid arguments: c=%p, terms=%p, count=%zu, k=%zu",
+                 (void*)c, (void*)terms, count, k);
+        return EINVAL;
+    }
+
+    // Every shard returns its own top k, so the merged top k is exact for
+    // shard-local scores
+    Buffer path = { NULL, 0, 0 };
+    int rc = buffer_append_str(&path, "/rank?q=");
+    if (rc == 0) rc = append_terms(&path, terms, count);
+    if (rc == 0) rc = append_limit(&path, "limit", k);
+    if (rc == 0) rc = gather(c, &path, true, k, result);
+    free(path.data);
+    if (rc != 0) coordinator_result_free(result);
+    return rc;
+}
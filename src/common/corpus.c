@@ -0,0 +1,237 @@
+#include "corpus.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <math.h>
+
+#define CORPUS_MAX_ATTEMPTS 64      // Redraws of a duplicate key before giving up
+
+static const char ascii_chars[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+
+void corpus_config_init(CorpusConfig* cfg) {
+    if (!cfg) return;
+    cfg->num_keys = 10000;
+    cfg->num_docs = 1000;
+    cfg->num_postings = 100000;
+    cfg->min_key_len = 4;
+    cfg->max_key_len = 12;
+    cfg->utf8_ratio = 0.1;
+    cfg->key_skew = 1.0;
+    cfg->doc_skew = 0.8;
+    cfg->seed = 42;
+}
+
+// splitmix64: small, fast and good enough for synthetic data
+static uint64_t next_random(uint64_t* state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static double next_unit(uint64_t* state) {
+    return (double)(next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Cumulative Zipf weights 1/(rank+1)^skew, normalized to end at 1
+static double* zipf_cdf(size_t n, double skew) {
+    double* cdf = malloc(n * sizeof(double));
+    if (!cdf) return NULL;
+    double sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += 1.0 / pow((double)(i + 1), skew);
+        cdf[i] = sum;
+    }
+    for (size_t i = 0; i < n; i++) cdf[i] /= sum;
+    return cdf;
+}
+
+static uint32_t zipf_sample(const double* cdf, size_t n, uint64_t* state) {
+    double u = next_unit(state);
+    size_t lo = 0, hi = n - 1;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (cdf[mid] < u) lo = mid + 1;
+        else hi = mid;
+    }
+    return (uint32_t)lo;
+}
+
+static size_t encode_utf8(uint32_t cp, char* out) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+// Non-ASCII codepoint: Latin-1 and Cyrillic letters (2 bytes), CJK (3) or emoji (4)
+static uint32_t random_codepoint(uint64_t* state) {
+    uint64_t r = next_random(state);
+    switch ((r >> 32) % 20) {
+        case 0: case 1: case 2: case 3: case 4:
+            return 0x00E0 + (uint32_t)(r % 0x20);
+        case 5: case 6: case 7: case 8: case 9:
+            return 0x0430 + (uint32_t)(r % 0x20);
+        case 10: case 11: case 12: case 13: case 14: case 15: case 16:
+            return 0x4E00 + (uint32_t)(r % 0x200);
+        default:
+            return 0x1F600 + (uint32_t)(r % 0x50);
+    }
+}
+
+static char* random_key(const CorpusConfig* cfg, uint64_t* state) {
+    size_t span = cfg->max_key_len - cfg->min_key_len + 1;
+    size_t len = cfg->min_key_len + (size_t)(next_random(state) % span);
+    char* key = malloc(len * 4 + 1);
+    if (!key) return NULL;
+
+    size_t n = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (next_unit(state) < cfg->utf8_ratio) {
+            n += encode_utf8(random_codepoint(state), key + n);
+        } else {
+            key[n++] = ascii_chars[next_random(state) % (sizeof(ascii_chars) - 1)];
+        }
+    }
+    key[n] = '\0';
+    return key;
+}
+
+static uint64_t hash_string(const char* s) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (; *s; s++) h = (h ^ (unsigned char)*s) * 0x100000001b3ULL;
+    return h;
+}
+
+// Insert into an open-addressing set; false if key was already present
+static bool set_insert(char** set, size_t mask, char* key) {
+    size_t i = (size_t)hash_string(key) & mask;
+    while (set[i]) {
+        if (strcmp(set[i], key) == 0) return false;
+        i = (i + 1) & mask;
+    }
+    set[i] = key;
+    return true;
+}
+
+static int generate_keys(Corpus* corpus, const CorpusConfig* cfg, uint64_t* state) {
+    size_t cap = 16;
+    while (cap < corpus->num_keys * 2) cap *= 2;
+    char** set = calloc(cap, sizeof(char*));
+    if (!set) return ENOMEM;
+
+    int rc = 0;
+    for (size_t k = 0; k < corpus->num_keys && rc == 0; k++) {
+        int attempts = 0;
+        for (;;) {
+            char* key = random_key(cfg, state);
+            if (!key) {
+                rc = ENOMEM;
+                break;
+            }
+            if (set_insert(set, cap - 1, key)) {
+                corpus->keys[k] = key;
+                corpus->key_bytes += strlen(key);
+                break;
+            }
+            free(key);
+            if (++attempts == CORPUS_MAX_ATTEMPTS) {
+                rc = EINVAL;  // Key space too small for the vocabulary
+                break;
+            }
+        }
+    }
+    free(set);
+    return rc;
+}
+
+Corpus* corpus_generate(const CorpusConfig* cfg, int* err) {
+    if (!cfg || cfg->num_keys == 0 || cfg->num_docs == 0 || cfg->num_keys > UINT32_MAX ||
+        cfg->num_docs > UINT32_MAX || cfg->min_key_len == 0 || cfg->min_key_len > cfg->max_key_len ||
+        cfg->utf8_ratio < 0 || cfg->utf8_ratio > 1 || cfg->key_skew < 0 || cfg->doc_skew < 0) {
+        if (err) *err = EINVAL;
+        return NULL;
+    }
+
+    Corpus* corpus = calloc(1, sizeof(Corpus));
+    if (!corpus) {
+        if (err) *err = ENOMEM;
+        return NULL;
+    }
+    corpus->num_keys = cfg->num_keys;
+    corpus->num_docs = cfg->num_docs;
+    corpus->num_postings = cfg->num_postings;
+    corpus->keys = calloc(cfg->num_keys, sizeof(char*));
+    corpus->docs = calloc(cfg->num_docs, sizeof(char*));
+    corpus->key_of = malloc((cfg->num_postings + 1) * sizeof(uint32_t));
+    corpus->doc_of = malloc((cfg->num_postings + 1) * sizeof(uint32_t));
+    double* key_cdf = zipf_cdf(cfg->num_keys, cfg->key_skew);
+    double* doc_cdf = zipf_cdf(cfg->num_docs, cfg->doc_skew);
+
+    int rc = 0;
+    if (!corpus->keys || !corpus->docs || !corpus->key_of || !corpus->doc_of || !key_cdf || !doc_cdf) {
+        rc = ENOMEM;
+    }
+
+    uint64_t state = cfg->seed;
+    if (rc == 0) rc = generate_keys(corpus, cfg, &state);
+    for (size_t d = 0; rc == 0 && d < cfg->num_docs; d++) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "doc%zu", d);
+        corpus->docs[d] = strdup(buf);
+        if (!corpus->docs[d]) rc = ENOMEM;
+    }
+    for (size_t p = 0; rc == 0 && p < cfg->num_postings; p++) {
+        corpus->key_of[p] = zipf_sample(key_cdf, cfg->num_keys, &state);
+        corpus->doc_of[p] = zipf_sample(doc_cdf, cfg->num_docs, &state);
+    }
+
+    free(key_cdf);
+    free(doc_cdf);
+    if (rc != 0) {
+        corpus_destroy(corpus);
+        if (err) *err = rc;
+        return NULL;
+    }
+    if (err) *err = 0;
+    return corpus;
+}
+
+void corpus_destroy(Corpus* corpus) {
+    if (!corpus) return;
+    for (size_t k = 0; corpus->keys && k < corpus->num_keys; k++) free(corpus->keys[k]);
+    for (size_t d = 0; corpus->docs && d < corpus->num_docs; d++) free(corpus->docs[d]);
+    free(corpus->keys);
+    free(corpus->docs);
+    free(corpus->key_of);
+    free(corpus->doc_of);
+    free(corpus);
+}
+
+int corpus_write(const Corpus* corpus, FILE* fp) {
+    if (!corpus || !fp) return EINVAL;
+    for (size_t p = 0; p < corpus->num_postings; p++) {
+        if (fprintf(fp, "%s:%s\n", corpus->keys[corpus->key_of[p]], corpus->docs[corpus->doc_of[p]]) < 0) {
+            return EIO;
+        }
+    }
+    return 0;
+}
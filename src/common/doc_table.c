@@ -0,0 +1,165 @@
+#include "doc_table.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#define DOC_TABLE_INITIAL_CAPACITY 64
+#define DOC_TABLE_EMPTY UINT32_MAX
+
+struct DocTable {
+    char** ids;             // Ordinal -> doc id
+    uint32_t* lengths;      // Ordinal -> token count
+    size_t count;
+    size_t capacity;        // Allocated ordinals
+    uint32_t* slots;        // Open-addressed hash of ordinals
+    size_t num_slots;       // Power of two, kept at most half full
+    uint64_t total_length;
+};
+
+static uint64_t hash_doc_id(const char* doc_id) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    while (*doc_id) {
+        h ^= (uint8_t)*doc_id++;
+        h *= 0x100000001b3ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Slot holding doc_id, or the empty slot where it would go
+static size_t find_slot(const DocTable* table, const char* doc_id) {
+    size_t mask = table->num_slots - 1;
+    size_t i = hash_doc_id(doc_id) & mask;
+    while (table->slots[i] != DOC_TABLE_EMPTY &&
+           strcmp(table->ids[table->slots[i]], doc_id) != 0) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+static int grow(DocTable* table) {
+    size_t capacity = table->capacity * 2;
+    uint32_t* slots = malloc(capacity * 2 * sizeof(uint32_t));
+    if (!slots) return ENOMEM;
+
+    char** ids = realloc(table->ids, capacity * sizeof(char*));
+    if (!ids) {
+        free(slots);
+        return ENOMEM;
+    }
+    table->ids = ids;
+    uint32_t* lengths = realloc(table->lengths, capacity * sizeof(uint32_t));
+    if (!lengths) {
+        free(slots);
+        return ENOMEM;
+    }
+    table->lengths = lengths;
+
+    // Rehash into the larger slot array
+    memset(slots, 0xFF, capacity * 2 * sizeof(uint32_t));
+    free(table->slots);
+    table->slots = slots;
+    table->num_slots = capacity * 2;
+    table->capacity = capacity;
+
+    for (size_t ord = 0; ord < table->count; ord++) {
+        table->slots[find_slot(table, table->ids[ord])] = (uint32_t)ord;
+    }
+    return 0;
+}
+
+DocTable* doc_table_create(int* err) {
+    DocTable* table = calloc(1, sizeof(DocTable));
+    if (!table) {
+        if (err) *err = ENOMEM;
+        return NULL;
+    }
+
+    table->capacity = DOC_TABLE_INITIAL_CAPACITY;
+    table->num_slots = DOC_TABLE_INITIAL_CAPACITY * 2;
+    table->ids = malloc(table->capacity * sizeof(char*));
+    table->lengths = malloc(table->capacity * sizeof(uint32_t));
+    table->slots = malloc(table->num_slots * sizeof(uint32_t));
+    if (!table->ids || !table->lengths || !table->slots) {
+        doc_table_destroy(table);
+        if (err) *err = ENOMEM;
+        return NULL;
+    }
+    memset(table->slots, 0xFF, table->num_slots * sizeof(uint32_t));
+
+    if (err) *err = 0;
+    return table;
+}
+
+void doc_table_destroy(DocTable* table) {
+    if (!table) return;
+
+    for (size_t i = 0; i < table->count; i++) {
+        free(table->ids[i]);
+    }
+    free(table->ids);
+    free(table->lengths);
+    free(table->slots);
+    free(table);
+}
+
+int doc_table_add(DocTable* table, const char* doc_id, uint32_t tokens, uint32_t* ordinal) {
+    if (!table || !doc_id) return EINVAL;
+
+    size_t slot = find_slot(table, doc_id);
+    if (table->slots[slot] == DOC_TABLE_EMPTY) {
+        if (table->count == DOC_TABLE_EMPTY) return ENOSPC;
+        if (table->count == table->capacity) {
+            int rc = grow(table);
+            if (rc != 0) return rc;
+            slot = find_slot(table, doc_id);
+        }
+
+        char* copy = strdup(doc_id);
+        if (!copy) return ENOMEM;
+        table->ids[table->count] = copy;
+        table->lengths[table->count] = 0;
+        table->slots[slot] = (uint32_t)table->count++;
+    }
+
+    uint32_t ord = table->slots[slot];
+    table->lengths[ord] += tokens;
+    table->total_length += tokens;
+    if (ordinal) *ordinal = ord;
+    return 0;
+}
+
+int doc_table_find(const DocTable* table, const char* doc_id, uint32_t* ordinal) {
+    if (!table || !doc_id) return EINVAL;
+
+    uint32_t ord = table->slots[find_slot(table, doc_id)];
+    if (ord == DOC_TABLE_EMPTY) return ENOENT;
+    if (ordinal) *ordinal = ord;
+    return 0;
+}
+
+size_t doc_table_count(const DocTable* table) {
+    return table ? table->count : 0;
+}
+
+uint64_t doc_table_total_length(const DocTable* table) {
+    return table ? table->total_length : 0;
+}
+
+uint32_t doc_table_length(const DocTable* table, uint32_t ordinal) {
+    return table && ordinal < table->count ? table->lengths[ordinal] : 0;
+}
+
+const char* doc_table_id(const DocTable* table, uint32_t ordinal) {
+    return table && ordinal < table->count ? table->ids[ordinal] : NULL;
+}
+
+size_t doc_table_bytes(const DocTable* table) {
+    if (!table) return 0;
+    size_t bytes = sizeof(DocTable) + table->capacity * (sizeof(char*) + sizeof(uint32_t)) +
+                   table->num_slots * sizeof(uint32_t);
+    for (size_t ord = 0; ord < table->count; ord++) bytes += strlen(table->ids[ord]) + 1;
+    return bytes;
+}
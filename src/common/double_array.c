@@ -0,0 +1,568 @@
+#include "double_array.h"
+#include "placement.h"
+#include "utf8.h"
+#include "logging.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#define DOUBLE_ARRAY_MAGIC 0x41445254  // "TRDA" in hex
+#define DOUBLE_ARRAY_VERSION 1
+
+#define DA_ROOT 1                   // Cell 0 is never used, so check 0 means free
+#define DA_NO_KEY UINT32_MAX        // Value of cells where no key ends
+#define DA_MAX_TRIES 16             // Failed placements before a free cell is skipped
+#define DA_KEY_CHUNK 64             // Key bytes mapped to slots at a time
+
+// Header of a double-array file; followed by the sections below, each
+// padded to 8 bytes, in this order
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t timestamp;
+    uint64_t num_cells;
+    uint64_t num_keys;
+    uint64_t num_postings;
+    uint64_t num_docs;
+    uint64_t doc_bytes;             // Document ids, each followed by NUL
+    uint64_t total_words;           // GTrie counters, for indexer statistics
+    uint64_t doc_count;
+} DoubleArrayHeader;
+
+typedef struct {
+    uint32_t base;                  // Children of this cell start at base + 1
+    uint32_t check;                 // Parent cell, 0 when free
+} DaCell;
+
+struct DoubleArray {
+    char* image;                    // Header and sections, exactly as in the file
+    size_t image_size;
+    size_t mapped;                  // placement_map length, 0 when image is from malloc
+    const DoubleArrayHeader* header;
+    const DaCell* cells;            // [num_cells]
+    const uint32_t* values;         // [num_cells] key of each cell, or DA_NO_KEY
+    const uint32_t* post_offsets;   // [num_keys + 1] into postings
+    const uint32_t* postings;       // [num_postings] document ordinals
+    const uint32_t* tfs;            // [num_postings] term frequencies
+    const uint64_t* doc_offsets;    // [num_docs + 1] into docs
+    const char* docs;
+    PostingList* lists;             // [num_keys] laid out over entries
+    PostingEntry* entries;          // [num_postings]
+};
+
+// ---- Building ----
+
+// Growable cells plus a circular list of free cells threaded through cell 0
+typedef struct {
+    DaCell* cells;
+    uint32_t* values;
+    uint32_t* next_free;
+    uint32_t* prev_free;
+    uint8_t* used;
+    uint8_t* tries;                 // Failed placements; DA_MAX_TRIES = off the list
+    size_t capacity;
+    size_t end;                     // One past the highest cell a lookup can reach
+} DaBuilder;
+
+typedef struct {
+    const TrieNode* node;
+    uint32_t cell;
+} DaItem;
+
+static size_t padded(size_t bytes) {
+    return (bytes + 7) & ~(size_t)7;
+}
+
+static void unlink_free(DaBuilder* b, uint32_t cell) {
+    if (b->tries[cell] >= DA_MAX_TRIES) return;  // Already skipped
+    b->next_free[b->prev_free[cell]] = b->next_free[cell];
+    b->prev_free[b->next_free[cell]] = b->prev_free[cell];
+    b->tries[cell] = DA_MAX_TRIES;
+}
+
+static int builder_grow(DaBuilder* b, size_t need) {
+    if (need <= b->capacity) return 0;
+    if (need > UINT32_MAX) return E2BIG;
+    size_t capacity = b->capacity ? b->capacity : 1024;
+    while (capacity < need) capacity *= 2;
+    if (capacity > UINT32_MAX) capacity = UINT32_MAX;
+
+    DaCell* cells = realloc(b->cells, capacity * sizeof(DaCell));
+    if (cells) b->cells = cells;
+    uint32_t* values = realloc(b->values, capacity * sizeof(uint32_t));
+    if (values) b->values = values;
+    uint32_t* next_free = realloc(b->next_free, capacity * sizeof(uint32_t));
+    if (next_free) b->next_free = next_free;
+    uint32_t* prev_free = realloc(b->prev_free, capacity * sizeof(uint32_t));
+    if (prev_free) b->prev_free = prev_free;
+    uint8_t* used = realloc(b->used, capacity);
+    if (used) b->used = used;
+    uint8_t* tries = realloc(b->tries, capacity);
+    if (tries) b->tries = tries;
+    if (!cells || !values || !next_free || !prev_free || !used || !tries) return ENOMEM;
+
+    // New cells are free and join the tail of the list (cell 0 is its head)
+    size_t first = b->capacity;
+    if (first == 0) {
+        b->next_free[0] = b->prev_free[0] = 0;
+        b->used[0] = 1;
+        b->tries[0] = DA_MAX_TRIES;
+        b->cells[0] = (DaCell){ 0, 0 };
+        b->values[0] = DA_NO_KEY;
+        first = 1;
+    }
+    for (size_t c = first; c < capacity; c++) {
+        b->cells[c] = (DaCell){ 0, 0 };
+        b->values[c] = DA_NO_KEY;
+        b->used[c] = 0;
+        b->tries[c] = 0;
+        uint32_t last = b->prev_free[0];
+        b->next_free[last] = (uint32_t)c;
+        b->prev_free[c] = last;
+        b->next_free[c] = 0;
+        b->prev_free[0] = (uint32_t)c;
+    }
+    b->capacity = capacity;
+    return 0;
+}
+
+static void builder_free(DaBuilder* b) {
+    free(b->cells);
+    free(b->values);
+    free(b->next_free);
+    free(b->prev_free);
+    free(b->used);
+    free(b->tries);
+}
+
+// Lowest base from the free list whose cells base + code are all free
+static int find_base(DaBuilder* b, const uint8_t* codes, int n, uint32_t* base) {
+    for (;;) {
+        uint32_t cell = b->next_free[0];
+        while (cell != 0) {
+            uint32_t next = b->next_free[cell];
+            if (cell > codes[0]) {
+                uint32_t candidate = cell - codes[0];
+                bool fits = true;
+                for (int i = 1; i < n && fits; i++) {
+                    size_t target = (size_t)candidate + codes[i];
+                    fits = target >= b->capacity || !b->used[target];
+                }
+                if (fits) {
+                    *base = candidate;
+                    return 0;
+                }
+                // Cells that keep failing are left unused rather than rescanned
+                if (++b->tries[cell] >= DA_MAX_TRIES) {
+                    b->tries[cell] = 0;
+                    unlink_free(b, cell);
+                }
+            }
+            cell = next;
+        }
+        int rc = builder_grow(b, b->capacity * 2);
+        if (rc != 0) return rc;
+    }
+}
+
+static void mark_used(DaBuilder* b, uint32_t cell, uint32_t parent) {
+    b->used[cell] = 1;
+    b->cells[cell].check = parent;
+    unlink_free(b, cell);
+    if ((size_t)cell + 1 > b->end) b->end = (size_t)cell + 1;
+}
+
+// Lay out the trie depth-first, so that the cells along one key are placed
+// close together; keys[k] receives the postings of key k
+static int build_cells(DaBuilder* b, const GTrie* trie, const PostingList*** keys,
+                       size_t* num_keys, size_t* num_postings) {
+    size_t capacity = node_pool_count(trie->nodes);
+    DaItem* stack = malloc((capacity ? capacity : 1) * sizeof(DaItem));
+    const PostingList** lists = malloc((capacity ? capacity : 1) * sizeof(PostingList*));
+    int rc = stack && lists ? builder_grow(b, DA_ROOT + ALPHABET_SIZE + 1) : ENOMEM;
+    if (rc != 0) {
+        free(stack);
+        free(lists);
+        return rc;
+    }
+
+    mark_used(b, DA_ROOT, 0);
+    b->end = DA_ROOT + ALPHABET_SIZE + 1;  // Leaves have base 0 and reach cell 26
+    size_t depth = 0;
+    stack[depth++] = (DaItem){ trie->root, DA_ROOT };
+    size_t keys_found = 0, postings = 0;
+    while (depth > 0 && rc == 0) {
+        DaItem item = stack[--depth];
+        if (item.node->postings) {
+            if (keys_found == DA_NO_KEY || postings + item.node->postings->count > UINT32_MAX) {
+                rc = E2BIG;
+                break;
+            }
+            b->values[item.cell] = (uint32_t)keys_found;
+            lists[keys_found++] = item.node->postings;
+            postings += item.node->postings->count;
+        }
+
+        uint8_t codes[ALPHABET_SIZE];
+        int n = 0;
+        for (int i = 0; i < ALPHABET_SIZE; i++) {
+            if (item.node->children[i]) codes[n++] = (uint8_t)(i + 1);
+        }
+        if (n == 0) continue;  // Base 0 reaches cells 1..26, whose parents are never a leaf
+
+        uint32_t base;
+        rc = find_base(b, codes, n, &base);
+        if (rc == 0) rc = builder_grow(b, (size_t)base + ALPHABET_SIZE + 1);
+        if (rc != 0) break;
+        b->cells[item.cell].base = base;
+        if ((size_t)base + ALPHABET_SIZE + 1 > b->end) b->end = (size_t)base + ALPHABET_SIZE + 1;
+        // Pushed last slot first, so children are visited in slot order
+        for (int i = n - 1; i >= 0; i--) {
+            uint32_t child = base + codes[i];
+            mark_used(b, child, item.cell);
+            if (depth == capacity) {
+                rc = EINVAL;  // More reachable nodes than the pool holds
+                break;
+            }
+            stack[depth++] = (DaItem){ item.node->children[codes[i] - 1], child };
+        }
+    }
+
+    free(stack);
+    if (rc != 0) {
+        free(lists);
+        return rc;
+    }
+    *keys = lists;
+    *num_keys = keys_found;
+    *num_postings = postings;
+    return 0;
+}
+
+// Point the section pointers into the image; with validate, check every
+// offset first so that lookups never leave the arrays
+static int attach_sections(DoubleArray* da, bool validate) {
+    const DoubleArrayHeader* h = (const DoubleArrayHeader*)da->image;
+    if (da->image_size < sizeof(*h) || h->magic != DOUBLE_ARRAY_MAGIC ||
+        h->version != DOUBLE_ARRAY_VERSION || h->num_cells <= DA_ROOT + ALPHABET_SIZE ||
+        h->num_cells > UINT32_MAX || h->num_keys > h->num_cells ||
+        h->num_postings > UINT32_MAX || h->num_docs > UINT32_MAX || h->doc_bytes > da->image_size) {
+        return EINVAL;
+    }
+
+    // Section sizes. The counts are below 2^32, and doc_bytes is no larger
+    // than the image, so neither these sums nor padding doc_bytes can wrap.
+    size_t cells = h->num_cells * sizeof(DaCell);
+    size_t values = padded(h->num_cells * sizeof(uint32_t));
+    size_t post_offsets = padded((h->num_keys + 1) * sizeof(uint32_t));
+    size_t postings = padded(h->num_postings * sizeof(uint32_t));
+    size_t tfs = postings;
+    size_t doc_offsets = (h->num_docs + 1) * sizeof(uint64_t);
+    size_t fixed = sizeof(*h) + cells + values + post_offsets + postings + tfs + doc_offsets;
+    if (da->image_size < fixed || da->image_size - fixed != padded(h->doc_bytes)) return EINVAL;
+
+    const char* p = da->image + sizeof(*h);
+    da->header = h;
+    da->cells = (const DaCell*)p;
+    da->values = (const uint32_t*)(p += cells);
+    da->post_offsets = (const uint32_t*)(p += values);
+    da->postings = (const uint32_t*)(p += post_offsets);
+    da->tfs = (const uint32_t*)(p += postings);
+    da->doc_offsets = (const uint64_t*)(p += tfs);
+    da->docs = p + doc_offsets;
+    if (!validate) return 0;
+
+    for (size_t c = 0; c < h->num_cells; c++) {
+        if ((uint64_t)da->cells[c].base + ALPHABET_SIZE >= h->num_cells ||
+            da->cells[c].check >= h->num_cells ||
+            (da->values[c] != DA_NO_KEY && da->values[c] >= h->num_keys)) {
+            return EINVAL;
+        }
+    }
+    if (da->post_offsets[0] != 0 || da->post_offsets[h->num_keys] != h->num_postings) return EINVAL;
+    for (size_t k = 0; k < h->num_keys; k++) {
+        if (da->post_offsets[k] > da->post_offsets[k + 1]) return EINVAL;
+    }
+    for (size_t i = 0; i < h->num_postings; i++) {
+        if (da->postings[i] >= h->num_docs || da->tfs[i] == 0) return EINVAL;
+    }
+    if (da->doc_offsets[0] != 0 || da->doc_offsets[h->num_docs] != h->doc_bytes) return EINVAL;
+    for (size_t d = 0; d < h->num_docs; d++) {
+        uint64_t start = da->doc_offsets[d], end = da->doc_offsets[d + 1];
+        if (end <= start || end > h->doc_bytes || da->docs[end - 1] != '\0' ||
+            memchr(da->docs + start, '\0', end - start - 1)) {
+            return EINVAL;
+        }
+    }
+    return 0;
+}
+
+// Posting lists over the image, in the layout the indexer's cursors walk
+static int attach_postings(DoubleArray* da) {
+    const DoubleArrayHeader* h = da->header;
+    da->lists = calloc(h->num_keys ? h->num_keys : 1, sizeof(PostingList));
+    da->entries = calloc(h->num_postings ? h->num_postings : 1, sizeof(PostingEntry));
+    if (!da->lists || !da->entries) return ENOMEM;
+
+    for (size_t k = 0; k < h->num_keys; k++) {
+        uint32_t start = da->post_offsets[k], end = da->post_offsets[k + 1];
+        da->lists[k].count = end - start;
+        da->lists[k].head = end > start ? &da->entries[start] : NULL;
+        for (uint32_t i = start; i < end; i++) {
+            PostingEntry* entry = &da->entries[i];
+            entry->doc = da->postings[i];
+            entry->doc_id = (char*)da->docs + da->doc_offsets[entry->doc];
+            entry->tf = da->tfs[i];
+            entry->next = i + 1 < end ? entry + 1 : NULL;
+        }
+    }
+    return 0;
+}
+
+// Image buffer of size bytes: huge pages when enabled, else the heap
+static int alloc_image(DoubleArray* da, size_t size) {
+    da->image_size = size;
+    HugePageMode mode = placement_huge_pages();
+    if (mode != HUGE_PAGES_OFF && size >= PLACEMENT_HUGE_PAGE / 2) {
+        da->image = placement_map(size, mode, &da->mapped);
+    } else {
+        da->image = malloc(size);
+    }
+    return da->image ? 0 : ENOMEM;
+}
+
+DoubleArray* double_array_build(const GTrie* trie, int* err) {
+    if (!trie || !trie->root) {
+        ERROR_LOG("Invalid arguments: trie=%p", (void*)trie);
+        if (err) *err = EINVAL;
+        return NULL;
+    }
+
+    DaBuilder b = { 0 };
+    const PostingList** keys = NULL;
+    size_t num_keys = 0, num_postings = 0;
+    int rc = build_cells(&b, trie, &keys, &num_keys, &num_postings);
+
+    size_t num_docs = doc_table_count(trie->docs);
+    size_t doc_bytes = 0;
+    for (size_t d = 0; rc == 0 && d < num_docs; d++) {
+        doc_bytes += strlen(doc_table_id(trie->docs, (uint32_t)d)) + 1;
+    }
+
+    DoubleArray* da = rc == 0 ? calloc(1, sizeof(DoubleArray)) : NULL;
+    if (rc == 0 && !da) rc = ENOMEM;
+    if (rc == 0 && num_docs > UINT32_MAX) rc = E2BIG;
+    if (rc == 0) {
+        size_t num_cells = b.end;
+        size_t size = sizeof(DoubleArrayHeader) + num_cells * sizeof(DaCell) +
+                      padded(num_cells * sizeof(uint32_t)) + padded((num_keys + 1) * sizeof(uint32_t)) +
+                      2 * padded(num_postings * sizeof(uint32_t)) + (num_docs + 1) * sizeof(uint64_t) +
+                      padded(doc_bytes);
+        rc = alloc_image(da, size);
+        if (rc == 0) {
+            memset(da->image, 0, size);
+            DoubleArrayHeader* h = (DoubleArrayHeader*)da->image;
+            *h = (DoubleArrayHeader){
+                .magic = DOUBLE_ARRAY_MAGIC,
+                .version = DOUBLE_ARRAY_VERSION,
+                .timestamp = (uint64_t)time(NULL),
+                .num_cells = num_cells,
+                .num_keys = num_keys,
+                .num_postings = num_postings,
+                .num_docs = num_docs,
+                .doc_bytes = doc_bytes,
+                .total_words = trie->total_words,
+                .doc_count = trie->doc_count
+            };
+            rc = attach_sections(da, false);
+        }
+    }
+
+    if (rc == 0) {
+        // The sections are only written here, through the build's own pointers
+        memcpy((DaCell*)da->cells, b.cells, b.end * sizeof(DaCell));
+        memcpy((uint32_t*)da->values, b.values, b.end * sizeof(uint32_t));
+        uint32_t* post_offsets = (uint32_t*)da->post_offsets;
+        uint32_t* postings = (uint32_t*)da->postings;
+        uint32_t* tfs = (uint32_t*)da->tfs;
+        uint32_t n = 0;
+        for (size_t k = 0; k < num_keys; k++) {
+            post_offsets[k] = n;
+            for (const PostingEntry* e = keys[k]->head; e && rc == 0; e = e->next) {
+                if (e->doc >= num_docs || n == num_postings) {
+                    rc = EINVAL;  // A list's count disagrees with its entries
+                    break;
+                }
+                tfs[n] = e->tf ? e->tf : 1;
+                postings[n++] = e->doc;
+            }
+        }
+        post_offsets[num_keys] = n;
+        if (n != num_postings) rc = EINVAL;
+
+        uint64_t* doc_offsets = (uint64_t*)da->doc_offsets;
+        char* docs = (char*)da->docs;
+        uint64_t offset = 0;
+        for (size_t d = 0; d < num_docs; d++) {
+            const char* id = doc_table_id(trie->docs, (uint32_t)d);
+            size_t len = strlen(id) + 1;
+            doc_offsets[d] = offset;
+            memcpy(docs + offset, id, len);
+            offset += len;
+        }
+        doc_offsets[num_docs] = offset;
+    }
+    if (rc == 0) rc = attach_postings(da);
+
+    builder_free(&b);
+    free(keys);
+    if (rc != 0) {
+        ERROR_LOG("Failed to build double array: %s", strerror(rc));
+        double_array_destroy(da);
+        if (err) *err = rc;
+        return NULL;
+    }
+    DEBUG_LOG("Built double array: %zu cells for %zu nodes, %zu keys",
+              b.end, trie->node_count, num_keys);
+    if (err) *err = 0;
+    return da;
+}
+
+void double_array_destroy(DoubleArray* da) {
+    if (!da) return;
+    if (da->mapped) {
+        placement_unmap(da->image, da->mapped);
+    } else {
+        free(da->image);
+    }
+    free(da->lists);
+    free(da->entries);
+    free(da);
+}
+
+// ---- Files ----
+
+int double_array_save(const DoubleArray* da, const char* path) {
+    if (!da || !path) {
+        ERROR_LOG("Invalid arguments: da=%p, path=%p", (void*)da, (void*)path);
+        return EINVAL;
+    }
+
+    FILE* fp = fopen(path, "wb");
+    if (!fp) {
+        int rc = errno;
+        ERROR_LOG("Failed to open file %s for writing: %s", path, strerror(rc));
+        return rc;
+    }
+    int rc = 0;
+    if (fwrite(da->image, 1, da->image_size, fp) != da->image_size) rc = EIO;
+    if (fclose(fp) != 0 && rc == 0) rc = EIO;
+    if (rc != 0) {
+        ERROR_LOG("Failed to write %s: %s", path, strerror(rc));
+    } else {
+        INFO_LOG("Saved double array to %s (%zu cells, %zu keys)", path,
+                 (size_t)da->header->num_cells, (size_t)da->header->num_keys);
+    }
+    return rc;
+}
+
+bool double_array_detect(const char* path) {
+    FILE* fp = path ? fopen(path, "rb") : NULL;
+    if (!fp) return false;
+    uint32_t magic = 0;
+    bool found = fread(&magic, sizeof(magic), 1, fp) == 1 && magic == DOUBLE_ARRAY_MAGIC;
+    fclose(fp);
+    return found;
+}
+
+DoubleArray* double_array_load(const char* path, int* err) {
+    if (!path) {
+        ERROR_LOG("Invalid arguments: path=%p", (void*)path);
+        if (err) *err = EINVAL;
+        return NULL;
+    }
+
+    int rc = 0;
+    DoubleArray* da = NULL;
+    struct stat st;
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        rc = errno;
+    } else if (fstat(fileno(fp), &st) != 0 || st.st_size < (off_t)sizeof(DoubleArrayHeader)) {
+        rc = EINVAL;
+    } else if (!(da = calloc(1, sizeof(DoubleArray)))) {
+        rc = ENOMEM;
+    } else {
+        rc = alloc_image(da, (size_t)st.st_size);
+        if (rc == 0 && fread(da->image, 1, da->image_size, fp) != da->image_size) rc = EINVAL;
+        if (rc == 0) rc = attach_sections(da, true);
+        if (rc == 0) rc = attach_postings(da);
+    }
+    if (fp) fclose(fp);
+
+    if (rc != 0) {
+        ERROR_LOG("Failed to load double array %s: %s", path, strerror(rc));
+        double_array_destroy(da);
+        if (err) *err = rc;
+        return NULL;
+    }
+    if (err) *err = 0;
+    return da;
+}
+
+// ---- Lookup ----
+
+const PostingList* double_array_search(const DoubleArray* da, const char* key, int* err) {
+    if (!da || !key) {
+        if (err) *err = EINVAL;
+        return NULL;
+    }
+
+    // Map the key to slots a chunk at a time, split on codepoint boundaries
+    const DaCell* cells = da->cells;
+    uint32_t cell = DA_ROOT;
+    size_t len = strlen(key);
+    uint8_t slots[DA_KEY_CHUNK];
+    for (size_t i = 0; i < len;) {
+        size_t chunk = len - i < DA_KEY_CHUNK ? len - i : DA_KEY_CHUNK;
+        while (chunk < len - i && chunk > 0 && ((uint8_t)key[i + chunk] & 0xC0) == 0x80) chunk--;
+        int n = utf8_slots(key + i, chunk, slots, sizeof(slots), ALPHABET_SIZE);
+        if (n < 0 || chunk == 0) {
+            if (err) *err = EINVAL;
+            return NULL;
+        }
+        for (int s = 0; s < n; s++) {
+            uint32_t next = cells[cell].base + slots[s] + 1;
+            if (cells[next].check != cell) {
+                if (err) *err = ENOENT;
+                return NULL;
+            }
+            cell = next;
+        }
+        i += chunk;
+    }
+
+    uint32_t value = da->values[cell];
+    if (value == DA_NO_KEY) {
+        if (err) *err = ENOENT;
+        return NULL;
+    }
+    if (err) *err = 0;
+    return &da->lists[value];
+}
+
+size_t double_array_key_count(const DoubleArray* da) {
+    return da ? da->header->total_words : 0;
+}
+
+size_t double_array_posting_count(const DoubleArray* da) {
+    return da ? da->header->doc_count : 0;
+}
+
+size_t double_array_cell_count(const DoubleArray* da) {
+    return da ? da->header->num_cells : 0;
+}
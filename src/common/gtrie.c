@@ -1,4 +1,8 @@
 #include "gtrie.h"
+#include "metrics.h"
+#include "probes.h"
+#include "utf8.h"
+#include "placement.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -6,54 +10,50 @@
 #include <stdint.h>
 
 #define GTRIE_DB_SIZE 1024 * 1024 * 10  // 10MB max database size
-#define UTF8_MAX_BYTES 4
-#define UNICODE_MAX 0x10FFFF
 
-static int utf8_byte_count(uint8_t first_byte) {
-    if ((first_byte & 0x80) == 0) return 1;
-    if ((first_byte & 0xE0) == 0xC0) return 2;
-    if ((first_byte & 0xF0) == 0xE0) return 3;
-    if ((first_byte & 0xF8) == 0xF0) return 4;
-    return -1;  // Invalid UTF-8 leading byte
+#define KEY_STACK_SLOTS 128  // Longer keys spill their slots to the heap
+// Nodes gtrie_freeze lays out breadth-first: the top levels share a huge page
+#define GTRIE_FREEZE_TOP_NODES (PLACEMENT_HUGE_PAGE / sizeof(TrieNode))
+
+// A key validated and mapped to the child slot of each codepoint
+typedef struct {
+    uint8_t* slots;
+    int count;
+    uint8_t stack[KEY_STACK_SLOTS];
+} KeySlots;
+
+// Filter hash of the slot path a key walks
+static inline uint64_t slots_path_hash(const uint8_t* slots, int count) {
+    uint64_t path_hash = KEY_FILTER_PATH_SEED;
+    for (int i = 0; i < count; i++) path_hash = KEY_FILTER_PATH_STEP(path_hash, slots[i]);
+    return path_hash;
 }
 
-static uint32_t utf8_to_codepoint(const char* utf8_char, int* bytes_read) {
-    const uint8_t* bytes = (const uint8_t*)utf8_char;
-    int len = utf8_byte_count(bytes[0]);
-    uint32_t codepoint = 0;
-    
-    if (len < 0) {
-        *bytes_read = 1;  // Skip invalid byte
-        return UINT32_MAX;
-    }
-    
-    switch (len) {
-        case 1:
-            codepoint = bytes[0];
-            break;
-        case 2:
-            codepoint = ((bytes[0] & 0x1F) << 6) | (bytes[1] & 0x3F);
-            break;
-        case 3:
-            codepoint = ((bytes[0] & 0x0F) << 12) | ((bytes[1] & 0x3F) << 6) | (bytes[2] & 0x3F);
-            break;
-        case 4:
-            codepoint = ((bytes[0] & 0x07) << 18) | ((bytes[1] & 0x3F) << 12) |
-                       ((bytes[2] & 0x3F) << 6) | (bytes[3] & 0x3F);
-            break;
+static void key_slots_release(KeySlots* key) {
+    if (key->slots != key->stack) free(key->slots);
+}
+
+// Validate and transcode word in one pass before any node is touched;
+// returns 0, EINVAL (not UTF-8) or ENOMEM
+static int key_slots(const char* word, KeySlots* key) {
+    size_t len = strlen(word);
+    key->slots = len <= KEY_STACK_SLOTS ? key->stack : malloc(len);
+    if (!key->slots) return ENOMEM;
+    key->count = utf8_slots(word, len, key->slots, len, ALPHABET_SIZE);
+    if (key->count < 0) {
+        key_slots_release(key);
+        return EINVAL;
     }
-    
-    *bytes_read = len;
-    return codepoint;
+    return 0;
 }
 
-static TrieNode* create_node(int* err) {
-    TrieNode* node = calloc(1, sizeof(TrieNode));
+static TrieNode* create_node(GTrie* trie, int* err) {
+    PROBE(node__create, trie->node_count, sizeof(TrieNode));
+    TrieNode* node = node_pool_alloc(trie->nodes);
     if (!node) {
         *err = ENOMEM;
         return NULL;
     }
-    node->postings = NULL;
     *err = 0;
     return node;
 }
@@ -75,13 +75,15 @@ static int destroy_node(TrieNode* node) {
         while (current) {
             PostingEntry* next = current->next;
             free(current->doc_id);
+            free(current->positions);
             free(current);
             current = next;
         }
+        free(node->postings->view);
         free(node->postings);
     }
     
-    free(node);
+    free(node->word);  // The node itself belongs to the trie's pool
     return 0;
 }
 
@@ -92,8 +94,22 @@ GTrie* gtrie_create(int* err) {
         return NULL;
     }
     
-    trie->root = create_node(err);
+    trie->nodes = node_pool_create(sizeof(TrieNode), err);
+    if (!trie->nodes) {
+        free(trie);
+        return NULL;
+    }
+
+    trie->root = create_node(trie, err);
     if (!trie->root) {
+        node_pool_destroy(trie->nodes);
+        free(trie);
+        return NULL;
+    }
+
+    trie->docs = doc_table_create(err);
+    if (!trie->docs) {
+        node_pool_destroy(trie->nodes);
         free(trie);
         return NULL;
     }
@@ -112,6 +128,9 @@ int gtrie_destroy(GTrie* trie) {
     
 
     destroy_node(trie->root);
+    node_pool_destroy(trie->nodes);
+    key_filter_destroy(trie->filter);
+    doc_table_destroy(trie->docs);
     
     free(trie);
     
@@ -119,89 +138,800 @@ int gtrie_destroy(GTrie* trie) {
 }
 
 
-int gtrie_insert(GTrie* trie, const char* word, const char* doc_id) {
+// A node waiting to be placed by gtrie_freeze, and the pointer to redirect
+// to its new copy
+typedef struct {
+    const TrieNode* node;
+    TrieNode** link;
+} FreezeItem;
+
+// Copy item's node to the next slot of pool and point its parent at the copy
+static TrieNode* freeze_place(NodePool* pool, const FreezeItem* item) {
+    TrieNode* copy = node_pool_alloc(pool);  // Reserved up front, never NULL
+    *copy = *item->node;
+    *item->link = copy;
+    return copy;
+}
+
+int gtrie_freeze(GTrie* trie) {
+    if (!trie) return EINVAL;
+    if (trie->frozen) return 0;
+
+    int rc = 0;
+    size_t total = node_pool_count(trie->nodes);
+    NodePool* pool = node_pool_create(sizeof(TrieNode), &rc);
+    FreezeItem* items = pool ? malloc(total * sizeof(FreezeItem)) : NULL;
+    if (!items || node_pool_reserve(pool, total) != 0) {
+        free(items);
+        node_pool_destroy(pool);
+        return ENOMEM;
+    }
+
+    // Breadth-first while whole levels fit in the top block. The children of
+    // the nodes placed so far are queued in items[head..tail).
+    TrieNode* root = NULL;
+    size_t head = 0, tail = 0;
+    items[tail++] = (FreezeItem){ trie->root, &root };
+    size_t placed = 0;
+    while (head < tail && placed + (tail - head) <= GTRIE_FREEZE_TOP_NODES) {
+        size_t level_end = tail;
+        while (head < level_end) {
+            TrieNode* copy = freeze_place(pool, &items[head++]);
+            placed++;
+            for (int i = 0; i < ALPHABET_SIZE; i++) {
+                if (copy->children[i]) items[tail++] = (FreezeItem){ copy->children[i], &copy->children[i] };
+            }
+        }
+    }
+
+    // Then each queued subtree depth-first. Its stack lives in items[tail..):
+    // everything pushed there is a node not yet queued, so it always fits.
+    for (; head < tail; head++) {
+        FreezeItem* stack = items + tail;
+        size_t depth = 0;
+        TrieNode* copy = freeze_place(pool, &items[head]);
+        for (;;) {
+            // Reversed so the lowest slot is placed right after its parent
+            for (int i = ALPHABET_SIZE - 1; i >= 0; i--) {
+                if (copy->children[i]) stack[depth++] = (FreezeItem){ copy->children[i], &copy->children[i] };
+            }
+            if (depth == 0) break;
+            copy = freeze_place(pool, &stack[--depth]);
+        }
+    }
+    free(items);
+
+    // Words and postings moved with the nodes; only the old slabs are freed
+    node_pool_destroy(trie->nodes);
+    trie->nodes = pool;
+    trie->root = root;
+    trie->frozen = true;
+    return 0;
+}
+
+size_t gtrie_positions_capacity(size_t size) {
+    size_t cap = 16;
+    while (cap < size) cap *= 2;
+    return cap;
+}
+
+int gtrie_decode_positions(const uint8_t* data, size_t size, uint32_t* out, size_t max,
+                           size_t* count) {
+    size_t n = 0;
+    uint64_t position = 0;
+    size_t i = 0;
+    while (i < size && n < max) {
+        uint64_t delta = 0;
+        int shift = 0;
+        for (;;) {
+            if (i == size || shift > 28) return EINVAL;  // Truncated or over 32 bits
+            uint8_t b = data[i++];
+            delta |= (uint64_t)(b & 0x7F) << shift;
+            shift += 7;
+            if (!(b & 0x80)) break;
+        }
+        if (n > 0 && delta == 0) return EINVAL;  // Positions strictly increase
+        position += delta;
+        if (position > UINT32_MAX) return EINVAL;
+        out[n++] = (uint32_t)position;
+    }
+    if (count) *count = n;
+    return 0;
+}
+
+// Append position to an entry's delta varint list
+static int append_position(PostingEntry* entry, uint32_t position) {
+    uint32_t delta = entry->positions ? position - entry->last_position : position;
+    uint8_t bytes[5];
+    size_t n = 0;
+    do {
+        bytes[n] = delta & 0x7F;
+        delta >>= 7;
+        if (delta) bytes[n] |= 0x80;
+        n++;
+    } while (delta);
+
+    size_t size = entry->positions_size;
+    size_t cap = gtrie_positions_capacity(size);
+    if (!entry->positions || size + n > cap) {
+        uint8_t* grown = realloc(entry->positions, gtrie_positions_capacity(size + n));
+        if (!grown) return ENOMEM;
+        entry->positions = grown;
+    }
+    memcpy(entry->positions + size, bytes, n);
+    entry->positions_size = (uint32_t)(size + n);
+    entry->last_position = position;
+    return 0;
+}
+
+// Add one occurrence of word in doc_id, optionally at a token position
+static int insert_occurrence(GTrie* trie, const char* word, const char* doc_id,
+                             const uint32_t* position) {
     if (!trie || !word || !doc_id) return EINVAL;
+    if (trie->frozen) return EPERM;
     
+    const char* key = word;
     TrieNode* current = trie->root;
-    int err = 0;
+    uint64_t path_hash = KEY_FILTER_PATH_SEED;
+    KeySlots slots;
+    int err = key_slots(word, &slots);
+    if (err) return err;
     
-    while (*word) {
-        int bytes_read;
-        uint32_t codepoint = utf8_to_codepoint(word, &bytes_read);
-        
-        if (codepoint == UINT32_MAX || codepoint > UNICODE_MAX) {
-            return EINVAL;  // Invalid UTF-8 sequence
-        }
-        
-        // Use the codepoint as the index, you might want to add a mapping function
-        // if you want to optimize the memory usage
-        int index = codepoint % ALPHABET_SIZE;  // Simple mapping, you might want to improve this
+    for (int i = 0; i < slots.count; i++) {
+        // Codepoints share child slots modulo ALPHABET_SIZE
+        int index = slots.slots[i];
         
         if (!current->children[index]) {
-            current->children[index] = create_node(&err);
-            if (!current->children[index]) return err;
+            current->children[index] = create_node(trie, &err);
+            if (!current->children[index]) {
+                key_slots_release(&slots);
+                return err;
+            }
             trie->node_count++; // Increment node count when creating new node
         }
         
         current = current->children[index];
-        word += bytes_read;  // Advance by the number of bytes read
+        path_hash = KEY_FILTER_PATH_STEP(path_hash, index);
     }
+    key_slots_release(&slots);
     
-    // Create or update posting list
-    if (!current->postings) {
-        current->postings = malloc(sizeof(PostingList));
-        if (!current->postings) return err;
-        current->postings->head = NULL;
-        trie->total_words++;
+    // A new key gets its posting list, stored key and filter entry only once
+    // its first posting is in place, so a failure below publishes nothing
+    PostingList* list = current->postings;
+    bool new_key = !list;
+
+    // Remember the key so that traversals can report what they matched
+    if (!new_key && !current->word) {
+        current->word = strdup(key);
+        if (!current->word) return ENOMEM;
+        current->is_end = true;
     }
     
-    // Add doc_id to posting list if not already present
-    PostingEntry* entry = current->postings->head;
-    while (entry) {
-        if (strcmp(entry->doc_id, doc_id) == 0) return 0;
-        entry = entry->next;
+    // Reject out-of-order positions before anything is counted
+    uint32_t doc;
+    PostingEntry* entry = NULL;
+    if (!new_key && doc_table_find(trie->docs, doc_id, &doc) == 0) {
+        entry = list->head;
+        while (entry && entry->doc != doc) entry = entry->next;
+    }
+    // A pair first added without a position cannot start a position list
+    if (position && entry && (!entry->positions || *position <= entry->last_position)) {
+        return EINVAL;
+    }
+
+    // Repeated (key, doc_id) pairs raise the term frequency. The document is
+    // already in the table, so counting the occurrence cannot fail.
+    int rc;
+    if (entry) {
+        if (position && (rc = append_position(entry, *position)) != 0) return rc;
+        if ((rc = doc_table_add(trie->docs, doc_id, 1, &doc)) != 0) return rc;
+        entry->tf++;
+        free(list->view);  // Ranking views are rebuilt on next use
+        list->view = NULL;
+        return 0;
     }
     
-    // Add new posting entry
-    PostingEntry* new_entry = malloc(sizeof(PostingEntry));
-    if (!new_entry) return err;
-    
-    new_entry->doc_id = strdup(doc_id);
-    new_entry->next = current->postings->head;
-    current->postings->head = new_entry;
+    // Build the new posting entry (and list) before touching the doc table
+    PostingEntry* new_entry = calloc(1, sizeof(PostingEntry));
+    char* stored_key = new_key ? strdup(key) : NULL;
+    if (new_key) list = calloc(1, sizeof(PostingList));
+    rc = new_entry && list && (!new_key || stored_key) ? 0 : ENOMEM;
+    if (rc == 0) {
+        new_entry->doc_id = strdup(doc_id);
+        if (!new_entry->doc_id) rc = ENOMEM;
+    }
+    if (rc == 0) {
+        new_entry->tf = 1;
+        if (position) rc = append_position(new_entry, *position);
+    }
+    // Every occurrence counts towards the document length
+    if (rc == 0) rc = doc_table_add(trie->docs, doc_id, 1, &doc);
+    if (rc != 0) {
+        if (new_entry) {
+            free(new_entry->doc_id);
+            free(new_entry->positions);
+        }
+        free(new_entry);
+        free(stored_key);
+        if (new_key) free(list);
+        return rc;
+    }
+
+    new_entry->doc = doc;
+    new_entry->next = list->head;
+    list->head = new_entry;
+    list->count++;
+    free(list->view);
+    list->view = NULL;
+    if (new_key) {
+        current->postings = list;
+        current->word = stored_key;
+        current->is_end = true;
+        trie->total_words++;
+        key_filter_add(trie->filter, path_hash);
+    }
     
     trie->doc_count++; // Increment doc count when adding new document
     
     return 0;
 }
 
-PostingList* gtrie_search(const GTrie* trie, const char* word, int* err) {
+static PostingList* search_key(const GTrie* trie, const char* word, int* err);
+
+// Postings of word after an insert; only evaluated while the probe is traced
+static size_t probe_posting_count(const GTrie* trie, const char* word) {
+    int err = 0;
+    PostingList* postings = trie && word ? search_key(trie, word, &err) : NULL;
+    return postings ? postings->count : 0;
+}
+
+int gtrie_insert(GTrie* trie, const char* word, const char* doc_id) {
+    PROBE(insert__start, word, doc_id);
+    METRICS_SAMPLE_START(start);
+    int rc = insert_occurrence(trie, word, doc_id, NULL);
+    METRICS_SAMPLE_STOP(METRIC_GTRIE_INSERT, start, rc != 0);
+    PROBE(insert__done, word, word ? strlen(word) : 0, probe_posting_count(trie, word), rc);
+    return rc;
+}
+
+int gtrie_insert_at(GTrie* trie, const char* word, const char* doc_id, uint32_t position) {
+    PROBE(insert__start, word, doc_id);
+    METRICS_SAMPLE_START(start);
+    int rc = insert_occurrence(trie, word, doc_id, &position);
+    METRICS_SAMPLE_STOP(METRIC_GTRIE_INSERT, start, rc != 0);
+    PROBE(insert__done, word, word ? strlen(word) : 0, probe_posting_count(trie, word), rc);
+    return rc;
+}
+
+static PostingList* search_key(const GTrie* trie, const char* word, int* err) {
     if (!trie || !word) {
         if (err) *err = EINVAL;
         return NULL;
     }
-    
-    const TrieNode* current = trie->root;
-    
-    while (*word) {
-        int bytes_read;
-        uint32_t codepoint = utf8_to_codepoint(word, &bytes_read);
-        
-        if (codepoint == UINT32_MAX || codepoint > UNICODE_MAX) {
-            if (err) *err = EINVAL;
-            return NULL;
-        }
-        
-        int index = codepoint % ALPHABET_SIZE;
-        
-        if (!current->children[index]) {
+
+    KeySlots key;
+    int rc = key_slots(word, &key);
+    if (rc) {
+        if (err) *err = rc;
+        return NULL;
+    }
+
+    // Most misses end here without touching a trie node
+    if (trie->filter) {
+        if (!key_filter_may_contain(trie->filter, slots_path_hash(key.slots, key.count))) {
+            key_slots_release(&key);
             if (err) *err = ENOENT;
             return NULL;
         }
-        
-        current = current->children[index];
-        word += bytes_read;
     }
     
+    const TrieNode* current = trie->root;
+    for (int i = 0; i < key.count && current; i++) {
+        current = current->children[key.slots[i]];
+    }
+    key_slots_release(&key);
+    
+    if (!current || !current->postings) {
+        if (err) *err = ENOENT;
+        return NULL;
+    }
     return current->postings;
 }
+
+PostingList* gtrie_search(const GTrie* trie, const char* word, int* err) {
+    PROBE(search__start, word);
+    METRICS_SAMPLE_START(start);
+    int rc = 0;
+    PostingList* postings = search_key(trie, word, &rc);
+    METRICS_SAMPLE_STOP(METRIC_GTRIE_SEARCH, start, !postings && rc != ENOENT);
+    PROBE(search__done, word, word ? strlen(word) : 0, postings ? postings->count : 0, rc);
+    if (err && !postings) *err = rc;
+    return postings;
+}
+
+typedef struct {
+    const char* word;
+    size_t index;
+} BatchKey;
+
+static int compare_batch_keys(const void* a, const void* b) {
+    return strcmp(((const BatchKey*)a)->word, ((const BatchKey*)b)->word);
+}
+
+int gtrie_search_many(const GTrie* trie, const char* const* words, size_t count,
+                      PostingList** postings, int* errs) {
+    if (!trie || (count > 0 && (!words || !postings))) return EINVAL;
+    if (count == 0) return 0;
+
+    // Sort keys so that shared prefixes are adjacent
+    size_t max_len = 0;
+    BatchKey* keys = malloc(count * sizeof(BatchKey));
+    if (!keys) return ENOMEM;
+    for (size_t i = 0; i < count; i++) {
+        keys[i].word = words[i] ? words[i] : "";
+        keys[i].index = i;
+        size_t len = strlen(keys[i].word);
+        if (len > max_len) max_len = len;
+    }
+    qsort(keys, count, sizeof(BatchKey), compare_batch_keys);
+
+    // path[d] is the node reached after d slots of the previous key, whose
+    // slots are kept in prev_slots
+    const TrieNode** path = malloc((max_len + 1) * sizeof(TrieNode*));
+    uint8_t* slots = malloc(max_len + 1);
+    uint8_t* prev_slots = malloc(max_len + 1);
+    if (!path || !slots || !prev_slots) {
+        free(path);
+        free(slots);
+        free(prev_slots);
+        free(keys);
+        return ENOMEM;
+    }
+    path[0] = trie->root;
+    size_t prev_depth = 0;  // Valid entries in path beyond the root
+
+    for (size_t k = 0; k < count; k++) {
+        const char* word = keys[k].word;
+        size_t slot = keys[k].index;
+        int err = 0;
+
+        int n = words[slot] ? utf8_slots(word, strlen(word), slots, max_len, ALPHABET_SIZE) : -1;
+        if (n < 0) {
+            postings[slot] = NULL;
+            if (errs) errs[slot] = EINVAL;
+            continue;
+        }
+        if (trie->filter && !key_filter_may_contain(trie->filter, slots_path_hash(slots, n))) {
+            postings[slot] = NULL;
+            if (errs) errs[slot] = ENOENT;
+            continue;
+        }
+
+        // Resume from the deepest node the previous key's path shares
+        size_t depth = 0;
+        while (depth < prev_depth && depth < (size_t)n && prev_slots[depth] == slots[depth]) depth++;
+
+        const TrieNode* current = path[depth];
+        for (; depth < (size_t)n; depth++) {
+            const TrieNode* child = current->children[slots[depth]];
+            if (!child) {
+                err = ENOENT;
+                break;
+            }
+
+            // Prefetch the child slot the next codepoint will read
+            if (depth + 1 < (size_t)n) {
+                __builtin_prefetch(&child->children[slots[depth + 1]]);
+            } else {
+                __builtin_prefetch(&child->postings);
+            }
+
+            current = child;
+            path[depth + 1] = current;
+        }
+
+        uint8_t* tmp = prev_slots;
+        prev_slots = slots;
+        slots = tmp;
+        prev_depth = depth;
+
+        if (!err && !current->postings) err = ENOENT;
+        postings[slot] = err ? NULL : current->postings;
+        if (errs) errs[slot] = err;
+    }
+
+    free(path);
+    free(slots);
+    free(prev_slots);
+    free(keys);
+    return 0;
+}
+
+// Decode a UTF-8 string into codepoints; returns the count or -1 if invalid
+// or longer than max_len
+static int decode_codepoints(const char* word, uint32_t* out, size_t max_len) {
+    return utf8_decode(word, strlen(word), out, max_len);
+}
+
+typedef struct {
+    const uint32_t* query;      // Query codepoints
+    size_t len;
+    int max_edits;
+    size_t max_depth;           // Deepest node that can still match
+    int* rows;                  // One DP row of len + 1 entries per depth
+    int* scratch;               // Two rows for verifying stored keys
+    uint32_t* word;             // Decoded stored key
+    FuzzyMatch* matches;
+    size_t max_matches;
+    size_t count;
+} FuzzyWalk;
+
+// Ranking: distance, then more postings, then key order
+static int compare_fuzzy_matches(const void* a, const void* b) {
+    const FuzzyMatch* x = a;
+    const FuzzyMatch* y = b;
+    if (x->distance != y->distance) return x->distance < y->distance ? -1 : 1;
+    if (x->postings->count != y->postings->count) {
+        return x->postings->count > y->postings->count ? -1 : 1;
+    }
+    if (!x->word || !y->word) return (x->word == NULL) - (y->word == NULL);
+    return strcmp(x->word, y->word);
+}
+
+// Index of the lowest ranked match (only meaningful when the buffer is full)
+static size_t worst_fuzzy_match(const FuzzyWalk* w) {
+    size_t worst = 0;
+    for (size_t i = 1; i < w->count; i++) {
+        if (compare_fuzzy_matches(&w->matches[i], &w->matches[worst]) > 0) worst = i;
+    }
+    return worst;
+}
+
+// Largest distance still worth exploring
+static int fuzzy_budget(const FuzzyWalk* w) {
+    if (w->count < w->max_matches) return w->max_edits;
+    return w->matches[worst_fuzzy_match(w)].distance;
+}
+
+// Exact codepoint distance between the query and a stored key, or
+// max_edits + 1 if it exceeds the budget
+static int verify_distance(FuzzyWalk* w, const char* key) {
+    int n = decode_codepoints(key, w->word, w->len + (size_t)w->max_edits);
+    if (n < 0) return w->max_edits + 1;
+
+    int* prev = w->scratch;
+    int* cur = w->scratch + w->len + 1;
+    for (size_t j = 0; j <= w->len; j++) prev[j] = (int)j;
+
+    for (int i = 1; i <= n; i++) {
+        cur[0] = i;
+        int best = cur[0];
+        for (size_t j = 1; j <= w->len; j++) {
+            int v = prev[j - 1] + (w->word[i - 1] != w->query[j - 1]);
+            if (prev[j] + 1 < v) v = prev[j] + 1;
+            if (cur[j - 1] + 1 < v) v = cur[j - 1] + 1;
+            cur[j] = v;
+            if (v < best) best = v;
+        }
+        if (best > w->max_edits) return w->max_edits + 1;
+        int* tmp = prev;
+        prev = cur;
+        cur = tmp;
+    }
+    return prev[w->len];
+}
+
+static void add_fuzzy_match(FuzzyWalk* w, const TrieNode* node, int distance) {
+    FuzzyMatch match = { node->word, node->postings, distance };
+
+    if (w->count < w->max_matches) {
+        w->matches[w->count++] = match;
+        return;
+    }
+
+    size_t worst = worst_fuzzy_match(w);
+    if (compare_fuzzy_matches(&match, &w->matches[worst]) < 0) {
+        w->matches[worst] = match;
+    }
+}
+
+// Depth-first walk carrying one Levenshtein row per level. Child buckets stand
+// in for codepoints, so row values are lower bounds on the true distance and
+// a subtree is pruned once its row minimum exceeds the budget.
+static void fuzzy_walk(FuzzyWalk* w, const TrieNode* node, size_t depth) {
+    const int* row = w->rows + depth * (w->len + 1);
+
+    if (node->postings && node->postings->count > 0 && row[w->len] <= fuzzy_budget(w)) {
+        int distance = node->word ? verify_distance(w, node->word) : row[w->len];
+        if (distance <= fuzzy_budget(w)) add_fuzzy_match(w, node, distance);
+    }
+
+    if (depth == w->max_depth) return;
+
+    int* next = w->rows + (depth + 1) * (w->len + 1);
+    for (int c = 0; c < ALPHABET_SIZE; c++) {
+        const TrieNode* child = node->children[c];
+        if (!child) continue;
+
+        next[0] = row[0] + 1;
+        int best = next[0];
+        for (size_t j = 1; j <= w->len; j++) {
+            int v = row[j - 1] + (w->query[j - 1] % ALPHABET_SIZE != (uint32_t)c);
+            if (row[j] + 1 < v) v = row[j] + 1;
+            if (next[j - 1] + 1 < v) v = next[j - 1] + 1;
+            next[j] = v;
+            if (v < best) best = v;
+        }
+
+        if (best <= fuzzy_budget(w)) fuzzy_walk(w, child, depth + 1);
+    }
+}
+
+int gtrie_fuzzy_search(const GTrie* trie, const char* word, int max_edits,
+                       FuzzyMatch* matches, size_t max_matches, size_t* count) {
+    if (count) *count = 0;
+    if (!trie || !word || !matches || max_matches == 0 ||
+        max_edits < 0 || max_edits > GTRIE_MAX_EDITS) {
+        return EINVAL;
+    }
+
+    uint32_t query[MAX_WORD_LENGTH];
+    int len = decode_codepoints(word, query, MAX_WORD_LENGTH);
+    if (len < 0) return EINVAL;
+
+    FuzzyWalk w = {
+        .query = query,
+        .len = (size_t)len,
+        .max_edits = max_edits,
+        .max_depth = (size_t)len + (size_t)max_edits,
+        .matches = matches,
+        .max_matches = max_matches,
+        .count = 0
+    };
+
+    size_t row_size = w.len + 1;
+    w.rows = malloc((w.max_depth + 1) * row_size * sizeof(int));
+    w.scratch = malloc(2 * row_size * sizeof(int));
+    w.word = malloc((w.max_depth + 1) * sizeof(uint32_t));
+    if (!w.rows || !w.scratch || !w.word) {
+        free(w.rows);
+        free(w.scratch);
+        free(w.word);
+        return ENOMEM;
+    }
+
+    for (size_t j = 0; j <= w.len; j++) w.rows[j] = (int)j;
+    fuzzy_walk(&w, trie->root, 0);
+
+    free(w.rows);
+    free(w.scratch);
+    free(w.word);
+
+    qsort(matches, w.count, sizeof(FuzzyMatch), compare_fuzzy_matches);
+    if (count) *count = w.count;
+    return w.count > 0 ? 0 : ENOENT;
+}
+
+// Node reached by walking prefix, or NULL
+static const TrieNode* find_prefix_node(const GTrie* trie, const char* prefix, int* err) {
+    KeySlots key;
+    *err = key_slots(prefix, &key);
+    if (*err) return NULL;
+
+    const TrieNode* current = trie->root;
+    for (int i = 0; i < key.count && current; i++) {
+        current = current->children[key.slots[i]];
+    }
+    key_slots_release(&key);
+    *err = current ? 0 : ENOENT;
+    return current;
+}
+
+// Child slots are shared between codepoints, so candidates are checked
+// against their stored key
+static inline bool has_prefix(const TrieNode* node, const char* prefix, size_t prefix_len) {
+    return node->word && strncmp(node->word, prefix, prefix_len) == 0;
+}
+
+int gtrie_set_weight(GTrie* trie, const char* word, uint32_t weight) {
+    if (!trie || !word) return EINVAL;
+    if (trie->frozen) return EPERM;
+
+    KeySlots key;
+    int rc = key_slots(word, &key);
+    if (rc) return rc;
+    TrieNode** path = malloc(((size_t)key.count + 1) * sizeof(TrieNode*));
+    if (!path) {
+        key_slots_release(&key);
+        return ENOMEM;
+    }
+
+    size_t depth = 0;
+    path[0] = trie->root;
+    for (int i = 0; i < key.count; i++) {
+        TrieNode* child = path[depth]->children[key.slots[i]];
+        if (!child) {
+            key_slots_release(&key);
+            free(path);
+            return ENOENT;
+        }
+        path[++depth] = child;
+    }
+    key_slots_release(&key);
+
+    if (!path[depth]->postings) {
+        free(path);
+        return ENOENT;
+    }
+    path[depth]->weight = weight;
+
+    // Recompute subtree maxima up to the root, stopping once unchanged
+    for (size_t d = depth + 1; d-- > 0;) {
+        TrieNode* node = path[d];
+        uint32_t max_weight = node->postings ? node->weight : 0;
+        for (int i = 0; i < ALPHABET_SIZE; i++) {
+            if (node->children[i] && node->children[i]->max_weight > max_weight) {
+                max_weight = node->children[i]->max_weight;
+            }
+        }
+        if (node->max_weight == max_weight && d < depth) break;
+        node->max_weight = max_weight;
+    }
+
+    free(path);
+    return 0;
+}
+
+typedef struct {
+    uint32_t priority;      // Key weight or subtree bound
+    bool terminal;          // Emit node's key rather than expand it
+    const TrieNode* node;
+} CompletionItem;
+
+// Max-heap order; a key outranks a subtree with the same bound
+static inline bool completion_before(const CompletionItem* a, const CompletionItem* b) {
+    if (a->priority != b->priority) return a->priority > b->priority;
+    return a->terminal && !b->terminal;
+}
+
+static int completion_push(CompletionItem** heap, size_t* size, size_t* cap, CompletionItem item) {
+    if (*size == *cap) {
+        size_t new_cap = *cap * 2;
+        CompletionItem* grown = realloc(*heap, new_cap * sizeof(CompletionItem));
+        if (!grown) return ENOMEM;
+        *heap = grown;
+        *cap = new_cap;
+    }
+
+    CompletionItem* h = *heap;
+    size_t i = (*size)++;
+    h[i] = item;
+    while (i > 0 && completion_before(&h[i], &h[(i - 1) / 2])) {
+        CompletionItem tmp = h[i];
+        h[i] = h[(i - 1) / 2];
+        h[(i - 1) / 2] = tmp;
+        i = (i - 1) / 2;
+    }
+    return 0;
+}
+
+static CompletionItem completion_pop(CompletionItem* heap, size_t* size) {
+    CompletionItem top = heap[0];
+    heap[0] = heap[--(*size)];
+
+    size_t i = 0;
+    for (;;) {
+        size_t best = i;
+        size_t l = 2 * i + 1, r = l + 1;
+        if (l < *size && completion_before(&heap[l], &heap[best])) best = l;
+        if (r < *size && completion_before(&heap[r], &heap[best])) best = r;
+        if (best == i) break;
+        CompletionItem tmp = heap[i];
+        heap[i] = heap[best];
+        heap[best] = tmp;
+        i = best;
+    }
+    return top;
+}
+
+int gtrie_complete(const GTrie* trie, const char* prefix, Completion* out, size_t k, size_t* count) {
+    if (count) *count = 0;
+    if (!trie || !prefix || !out || k == 0) return EINVAL;
+
+    int err = 0;
+    const TrieNode* start = find_prefix_node(trie, prefix, &err);
+    if (!start) return err;
+
+    size_t cap = 64;
+    size_t size = 0;
+    CompletionItem* heap = malloc(cap * sizeof(CompletionItem));
+    if (!heap) return ENOMEM;
+
+    size_t prefix_len = strlen(prefix);
+    size_t n = 0;
+    int rc = completion_push(&heap, &size, &cap, (CompletionItem){ start->max_weight, false, start });
+
+    // Pop in weight order: keys come out heaviest first, subtrees are only
+    // opened while their bound can still beat the remaining keys
+    while (rc == 0 && size > 0 && n < k) {
+        CompletionItem item = completion_pop(heap, &size);
+        const TrieNode* node = item.node;
+
+        if (item.terminal) {
+            if (has_prefix(node, prefix, prefix_len)) {
+                out[n].word = node->word;
+                out[n].postings = node->postings;
+                out[n].weight = node->weight;
+                n++;
+            }
+            continue;
+        }
+
+        if (node->postings && node->postings->count > 0) {
+            rc = completion_push(&heap, &size, &cap, (CompletionItem){ node->weight, true, node });
+        }
+        for (int i = 0; i < ALPHABET_SIZE && rc == 0; i++) {
+            const TrieNode* child = node->children[i];
+            if (child) {
+                rc = completion_push(&heap, &size, &cap, (CompletionItem){ child->max_weight, false, child });
+            }
+        }
+    }
+
+    free(heap);
+    if (rc != 0) return rc;
+    if (count) *count = n;
+    return n > 0 ? 0 : ENOENT;
+}
+
+static int collect_prefix(const TrieNode* node, const char* prefix, size_t prefix_len,
+                          char*** words, size_t* count, size_t* cap) {
+    if (node->postings && node->postings->count > 0 && has_prefix(node, prefix, prefix_len)) {
+        if (*count == *cap) {
+            size_t new_cap = *cap ? *cap * 2 : 16;
+            char** grown = realloc(*words, new_cap * sizeof(char*));
+            if (!grown) return ENOMEM;
+            *words = grown;
+            *cap = new_cap;
+        }
+        (*words)[(*count)++] = node->word;
+    }
+
+    for (int i = 0; i < ALPHABET_SIZE; i++) {
+        if (node->children[i]) {
+            int rc = collect_prefix(node->children[i], prefix, prefix_len, words, count, cap);
+            if (rc != 0) return rc;
+        }
+    }
+    return 0;
+}
+
+char** gtrie_prefix_search(const GTrie* trie, const char* prefix, size_t* count, int* err) {
+    if (count) *count = 0;
+    if (!trie || !prefix) {
+        if (err) *err = EINVAL;
+        return NULL;
+    }
+
+    int rc = 0;
+    const TrieNode* start = find_prefix_node(trie, prefix, &rc);
+    if (!start) {
+        if (err) *err = rc;
+        return NULL;
+    }
+
+    char** words = NULL;
+    size_t n = 0;
+    size_t cap = 0;
+    rc = collect_prefix(start, prefix, strlen(prefix), &words, &n, &cap);
+    if (rc == 0 && n == 0) rc = ENOENT;
+    if (rc != 0) {
+        free(words);
+        if (err) *err = rc;
+        return NULL;
+    }
+
+    if (count) *count = n;
+    if (err) *err = 0;
+    return words;
+}
@@ -1,5 +1,7 @@
 #define _GNU_SOURCE
 #include "gtrie_io.h"
+#include "metrics.h"
+#include "probes.h"
 #include "logging.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -10,11 +12,13 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <stdint.h>
+#include <stddef.h>
 
 #define TRIE_MAGIC 0x45495254  // "TRIE" in hex
-#define CURRENT_VERSION 1
+#define CURRENT_VERSION 2
+#define INDEX_HEADER_V1_SIZE offsetof(IndexHeader, flags)
 
-static void write_node_with_progress(FILE* fp, const TrieNode* node, size_t* processed, 
+static void write_node_with_progress(FILE* fp, const TrieNode* node, uint32_t flags, size_t* processed, 
                                    size_t total, progress_cb progress, void* user_data) {
     if (!node) {
         TRACE_LOG("Skipping NULL node");
@@ -41,7 +45,7 @@ static void write_node_with_progress(FILE* fp, const TrieNode* node, size_t* pro
                 ERROR_LOG("Failed to write child index %d: %s", i, strerror(errno));
                 return;
             }
-            write_node_with_progress(fp, node->children[i], processed, total, progress, user_data);
+            write_node_with_progress(fp, node->children[i], flags, processed, total, progress, user_data);
         }
     }
 
@@ -70,17 +74,75 @@ static void write_node_with_progress(FILE* fp, const TrieNode* node, size_t* pro
             ERROR_LOG("Failed to write doc_id content: %s", strerror(errno));
             return;
         }
+        if ((flags & INDEX_FLAG_TF) && fwrite(&posting->tf, sizeof(uint32_t), 1, fp) != 1) {
+            ERROR_LOG("Failed to write term frequency: %s", strerror(errno));
+            return;
+        }
+        if ((flags & INDEX_FLAG_POSITIONS) &&
+            (fwrite(&posting->positions_size, sizeof(uint32_t), 1, fp) != 1 ||
+             fwrite(posting->positions, 1, posting->positions_size, fp) != posting->positions_size)) {
+            ERROR_LOG("Failed to write positions: %s", strerror(errno));
+            return;
+        }
         TRACE_LOG("Wrote doc_id: %s", posting->doc_id);
         posting = posting->next;
     }
 
+    // Key stored at terminal nodes (length 0 when absent)
+    if (flags & INDEX_FLAG_WORDS) {
+        size_t word_len = node->word ? strlen(node->word) + 1 : 0;
+        if (fwrite(&word_len, sizeof(size_t), 1, fp) != 1 ||
+            (word_len > 0 && fwrite(node->word, 1, word_len, fp) != word_len)) {
+            ERROR_LOG("Failed to write word: %s", strerror(errno));
+            return;
+        }
+    }
+
+    // Key weight; subtree maxima are recomputed on load
+    if ((flags & INDEX_FLAG_WEIGHTS) && posting_count > 0 &&
+        fwrite(&node->weight, sizeof(uint32_t), 1, fp) != 1) {
+        ERROR_LOG("Failed to write weight: %s", strerror(errno));
+        return;
+    }
+
     (*processed)++;
+    if (PROBE_ENABLED(save__block) && *processed % PROBE_BLOCK_NODES == 0) {
+        PROBE(save__block, PROBE_SECTION_NODES, *processed, ftell(fp));
+    }
     if (progress) {
         progress(*processed, total, user_data);
     }
 }
 
-int gtrie_save(const GTrie* trie, const char* filepath, progress_cb progress, void* user_data) {
+// Add every key below node to the filter; path_hash covers the slots down to node
+static void add_filter_keys(KeyFilter* filter, const TrieNode* node, uint64_t path_hash) {
+    if (node->postings && node->postings->head) key_filter_add(filter, path_hash);
+    for (int i = 0; i < ALPHABET_SIZE; i++) {
+        if (node->children[i]) {
+            add_filter_keys(filter, node->children[i], KEY_FILTER_PATH_STEP(path_hash, i));
+        }
+    }
+}
+
+// Filter section: block count, then the raw blocks
+static int write_filter(FILE* fp, const GTrie* trie) {
+    int rc = 0;
+    KeyFilter* filter = key_filter_create(trie->total_words, &rc);
+    if (!filter) return rc;
+    add_filter_keys(filter, trie->root, KEY_FILTER_PATH_SEED);
+
+    uint64_t num_blocks = key_filter_blocks(filter);
+    size_t bytes = num_blocks * KEY_FILTER_BLOCK_BYTES;
+    if (fwrite(&num_blocks, sizeof(uint64_t), 1, fp) != 1 ||
+        fwrite(key_filter_data(filter), 1, bytes, fp) != bytes) {
+        rc = errno ? errno : EIO;
+    }
+    DEBUG_LOG("Wrote key filter: %zu keys in %zu bytes", trie->total_words, bytes);
+    key_filter_destroy(filter);
+    return rc;
+}
+
+static int save_trie(const GTrie* trie, const char* filepath, progress_cb progress, void* user_data) {
     if (!trie || !filepath) {
         ERROR_LOG("Invalid arguments: trie=%p, filepath=%p", (void*)trie, (void*)filepath);
         return EINVAL;
@@ -101,7 +163,9 @@ int gtrie_save(const GTrie* trie, const char* filepath, progress_cb progress, vo
         .timestamp = time(NULL),
         .node_count = trie->node_count,
         .doc_count = trie->doc_count,
-        .total_words = trie->total_words
+        .total_words = trie->total_words,
+        .flags = INDEX_FLAG_WORDS | INDEX_FLAG_TF | INDEX_FLAG_WEIGHTS | INDEX_FLAG_POSITIONS |
+                 INDEX_FLAG_FILTER
     };
 
     DEBUG_LOG("Writing header: magic=0x%x, version=%u, timestamp=%lu", 
@@ -115,113 +179,263 @@ int gtrie_save(const GTrie* trie, const char* filepath, progress_cb progress, vo
         return save_errno;
     }
 
+    PROBE(save__block, PROBE_SECTION_HEADER, 0, ftell(fp));
+
+    int rc = write_filter(fp, trie);
+    if (rc != 0) {
+        ERROR_LOG("Failed to write key filter: %s", strerror(rc));
+        fclose(fp);
+        return rc;
+    }
+    PROBE(save__block, PROBE_SECTION_FILTER, 0, ftell(fp));
+
     size_t processed = 0;
     DEBUG_LOG("Starting to write trie nodes...");
-    write_node_with_progress(fp, trie->root, &processed, trie->node_count, progress, user_data);
+    write_node_with_progress(fp, trie->root, header.flags, &processed, trie->node_count, progress, user_data);
     DEBUG_LOG("Finished writing %zu nodes", processed);
+    PROBE(save__block, PROBE_SECTION_NODES, processed, ftell(fp));
 
     INFO_LOG("Successfully saved trie to %s", filepath);
     fclose(fp);
     return 0;
 }
 
-static TrieNode* read_node_with_progress(FILE* fp, int* err, size_t* processed,
+// Size of a saved or loaded index; only evaluated while a probe is traced
+static long probe_file_bytes(const char* filepath) {
+    struct stat st;
+    return filepath && stat(filepath, &st) == 0 ? (long)st.st_size : 0;
+}
+
+int gtrie_save(const GTrie* trie, const char* filepath, progress_cb progress, void* user_data) {
+    PROBE(save__start, filepath, trie ? trie->node_count : 0);
+    METRICS_START(start);
+    int rc = save_trie(trie, filepath, progress, user_data);
+    METRICS_STOP(METRIC_GTRIE_SAVE, start, rc != 0);
+    PROBE(save__done, filepath, probe_file_bytes(filepath), rc);
+    return rc;
+}
+
+// Release what a partially loaded subtree owns; nodes go with the pool
+static void free_loaded_node(TrieNode* node) {
+    if (!node) return;
+
+    for (int i = 0; i < ALPHABET_SIZE; i++) {
+        free_loaded_node(node->children[i]);
+    }
+    if (node->postings) {
+        PostingEntry* entry = node->postings->head;
+        while (entry) {
+            PostingEntry* next = entry->next;
+            free(entry->doc_id);
+            free(entry->positions);
+            free(entry);
+            entry = next;
+        }
+        free(node->postings);
+    }
+    free(node->word);
+}
+
+// Read a length-prefixed, NUL-terminated string
+static char* read_string(FILE* fp, size_t len, int* err) {
+    if (len == 0 || len > MAX_STRING_LENGTH) {
+        *err = EIO;
+        return NULL;
+    }
+
+    char* str = malloc(len);
+    if (!str) {
+        *err = ENOMEM;
+        return NULL;
+    }
+    if (fread(str, 1, len, fp) != len || str[len - 1] != '\0') {
+        free(str);
+        *err = EIO;
+        return NULL;
+    }
+    return str;
+}
+
+// Read and validate a posting's encoded positions
+static int read_positions(FILE* fp, PostingEntry* entry) {
+    uint32_t size;
+    if (fread(&size, sizeof(uint32_t), 1, fp) != 1 || size > MAX_STRING_LENGTH) {
+        return EIO;
+    }
+    if (size == 0) return 0;
+
+    entry->positions = malloc(gtrie_positions_capacity(size));
+    uint32_t* decoded = malloc(size * sizeof(uint32_t));  // At least one byte each
+    int rc = (entry->positions && decoded) ? 0 : ENOMEM;
+    if (rc == 0 && fread(entry->positions, 1, size, fp) != size) rc = EIO;
+
+    size_t count = 0;
+    if (rc == 0 && (gtrie_decode_positions(entry->positions, size, decoded, size, &count) != 0 ||
+                    count == 0 || count > entry->tf)) {
+        rc = EIO;
+    }
+    if (rc == 0) {
+        entry->positions_size = size;
+        entry->last_position = decoded[count - 1];
+    }
+    free(decoded);
+    return rc;
+}
+
+static TrieNode* read_node_with_progress(FILE* fp, GTrie* trie, uint32_t flags, int* err, size_t* processed,
                                        size_t total, progress_cb progress, void* user_data) {
-    TrieNode* node = malloc(sizeof(TrieNode));
+    TrieNode* node = node_pool_alloc(trie->nodes);
     if (!node) {
         *err = ENOMEM;
         return NULL;
     }
-    memset(node, 0, sizeof(TrieNode));
 
     uint32_t child_count;
-    if (fread(&child_count, sizeof(uint32_t), 1, fp) != 1) {
+    if (fread(&child_count, sizeof(uint32_t), 1, fp) != 1 || child_count > ALPHABET_SIZE) {
         *err = EIO;
-        free(node);
-        return NULL;
+        goto fail;
     }
 
     // Read children
     for (uint32_t i = 0; i < child_count; i++) {
         uint32_t index;
-        if (fread(&index, sizeof(uint32_t), 1, fp) != 1) {
+        if (fread(&index, sizeof(uint32_t), 1, fp) != 1 || index >= ALPHABET_SIZE ||
+            node->children[index]) {
             *err = EIO;
-            free(node);
-            return NULL;
-        }
-        node->children[index] = read_node_with_progress(fp, err, processed, total, progress, user_data);
-        if (*err) {
-            free(node);
-            return NULL;
+            goto fail;
         }
+        node->children[index] = read_node_with_progress(fp, trie, flags, err, processed, total, progress, user_data);
+        if (*err) goto fail;
     }
 
     // Read postings
     uint32_t posting_count;
     if (fread(&posting_count, sizeof(uint32_t), 1, fp) != 1) {
         *err = EIO;
-        free(node);
-        return NULL;
+        goto fail;
     }
 
     if (posting_count > 0) {
         node->postings = malloc(sizeof(PostingList));
         if (!node->postings) {
             *err = ENOMEM;
-            free(node);
-            return NULL;
+            goto fail;
         }
         node->postings->head = NULL;
+        node->postings->count = 0;
+        node->postings->view = NULL;
     }
 
     for (uint32_t i = 0; i < posting_count; i++) {
         size_t len;
         if (fread(&len, sizeof(size_t), 1, fp) != 1) {
             *err = EIO;
-            free(node->postings);
-            free(node);
-            return NULL;
+            goto fail;
         }
 
-        char* doc_id = malloc(len);
-        if (!doc_id) {
-            *err = ENOMEM;
-            free(node->postings);
-            free(node);
-            return NULL;
-        }
+        char* doc_id = read_string(fp, len, err);
+        if (!doc_id) goto fail;
 
-        if (fread(doc_id, 1, len, fp) != len) {
-            free(doc_id);
-            free(node->postings);
-            free(node);
+        // Files without term frequencies count each posting once
+        uint32_t tf = 1;
+        uint32_t doc = 0;
+        if ((flags & INDEX_FLAG_TF) && (fread(&tf, sizeof(uint32_t), 1, fp) != 1 || tf == 0)) {
             *err = EIO;
-            return NULL;
+        } else {
+            *err = doc_table_add(trie->docs, doc_id, tf, &doc);
+        }
+        if (*err) {
+            free(doc_id);
+            goto fail;
         }
 
         // Create new posting entry
         PostingEntry* entry = malloc(sizeof(PostingEntry));
         if (!entry) {
             free(doc_id);
-            free(node->postings);
-            free(node);
             *err = ENOMEM;
-            return NULL;
+            goto fail;
         }
         entry->doc_id = doc_id;
+        entry->tf = tf;
+        entry->doc = doc;
+        entry->positions = NULL;
+        entry->positions_size = 0;
+        entry->last_position = 0;
         entry->next = node->postings->head;
         node->postings->head = entry;
+        node->postings->count++;
+
+        if ((flags & INDEX_FLAG_POSITIONS) && (*err = read_positions(fp, entry)) != 0) {
+            goto fail;
+        }
+    }
+
+    // Read the stored key
+    if (flags & INDEX_FLAG_WORDS) {
+        size_t word_len;
+        if (fread(&word_len, sizeof(size_t), 1, fp) != 1) {
+            *err = EIO;
+            goto fail;
+        }
+        if (word_len > 0) {
+            node->word = read_string(fp, word_len, err);
+            if (!node->word) goto fail;
+            node->is_end = true;
+        }
+    }
+
+    if ((flags & INDEX_FLAG_WEIGHTS) && posting_count > 0 &&
+        fread(&node->weight, sizeof(uint32_t), 1, fp) != 1) {
+        *err = EIO;
+        goto fail;
+    }
+    node->max_weight = posting_count > 0 ? node->weight : 0;
+    for (int i = 0; i < ALPHABET_SIZE; i++) {
+        if (node->children[i] && node->children[i]->max_weight > node->max_weight) {
+            node->max_weight = node->children[i]->max_weight;
+        }
     }
 
     (*processed)++;
+    if (PROBE_ENABLED(load__block) && *processed % PROBE_BLOCK_NODES == 0) {
+        PROBE(load__block, PROBE_SECTION_NODES, *processed, ftell(fp));
+    }
     if (progress) {
         progress(*processed, total, user_data);
     }
 
     return node;
+
+fail:
+    free_loaded_node(node);
+    return NULL;
 }
 
-GTrie* gtrie_load(const char* filepath, int* err, progress_cb progress, void* user_data) {
+// Read the header; version 1 files end before the flags field
+static int read_header(FILE* fp, IndexHeader* header) {
+    memset(header, 0, sizeof(*header));
+    if (fread(header, INDEX_HEADER_V1_SIZE, 1, fp) != 1) {
+        return EIO;
+    }
+    if (header->magic == TRIE_MAGIC && header->version >= 2 &&
+        fread((char*)header + INDEX_HEADER_V1_SIZE, sizeof(*header) - INDEX_HEADER_V1_SIZE, 1, fp) != 1) {
+        return EIO;
+    }
+    return 0;
+}
+
+int gtrie_read_header(const char* filepath, IndexHeader* header) {
+    if (!filepath || !header) return EINVAL;
+
+    FILE* fp = fopen(filepath, "rb");
+    if (!fp) return errno;
+    int rc = read_header(fp, header) == 0 && header->magic == TRIE_MAGIC ? 0 : EINVAL;
+    fclose(fp);
+    return rc;
+}
+
+static GTrie* load_trie(const char* filepath, int* err, progress_cb progress, void* user_data) {
     if (!filepath) {
         ERROR_LOG("Invalid filepath argument (NULL)");
         if (err) *err = EINVAL;
@@ -238,7 +452,7 @@ GTrie* gtrie_load(const char* filepath, int* err, progress_cb progress, void* us
     }
 
     IndexHeader header;
-    if (fread(&header, sizeof(header), 1, fp) != 1) {
+    if (read_header(fp, &header) != 0) {
         ERROR_LOG("Failed to read index header: %s", strerror(errno));
         if (err) *err = EIO;
         fclose(fp);
@@ -261,6 +475,14 @@ GTrie* gtrie_load(const char* filepath, int* err, progress_cb progress, void* us
         return NULL;
     }
 
+    if (header.flags & ~INDEX_FLAGS_SUPPORTED) {
+        ERROR_LOG("Unsupported feature flags in file %s: 0x%x", filepath, header.flags);
+        if (err) *err = EINVAL;
+        fclose(fp);
+        return NULL;
+    }
+    PROBE(load__block, PROBE_SECTION_HEADER, 0, ftell(fp));
+
     GTrie* trie = malloc(sizeof(GTrie));
     if (!trie) {
         ERROR_LOG("Failed to allocate GTrie structure");
@@ -273,21 +495,75 @@ GTrie* gtrie_load(const char* filepath, int* err, progress_cb progress, void* us
     trie->node_count = header.node_count;
     trie->doc_count = header.doc_count;
     trie->total_words = header.total_words;
+    trie->timestamp = header.timestamp;
+
+    int rc = 0;
+    trie->docs = doc_table_create(&rc);
+    trie->nodes = trie->docs ? node_pool_create(sizeof(TrieNode), &rc) : NULL;
+    if (!trie->nodes) {
+        if (err) *err = rc;
+        doc_table_destroy(trie->docs);
+        free(trie);
+        fclose(fp);
+        return NULL;
+    }
+
+    // The filter is sized from total_words, so a valid one is never larger
+    if (header.flags & INDEX_FLAG_FILTER) {
+        uint64_t num_blocks = 0;
+        size_t max_blocks = header.total_words * KEY_FILTER_BITS_PER_KEY / (KEY_FILTER_BLOCK_BYTES * 8) + 1;
+        if (fread(&num_blocks, sizeof(uint64_t), 1, fp) != 1 || num_blocks == 0 ||
+            num_blocks > max_blocks) {
+            rc = EINVAL;
+        } else if ((trie->filter = key_filter_create_blocks(num_blocks, &rc)) != NULL &&
+                   fread(key_filter_data(trie->filter), KEY_FILTER_BLOCK_BYTES, num_blocks, fp) != num_blocks) {
+            rc = EINVAL;
+        }
+        if (rc) {
+            ERROR_LOG("Failed to read key filter from %s: %s", filepath, strerror(rc));
+            if (err) *err = rc;
+            key_filter_destroy(trie->filter);
+            doc_table_destroy(trie->docs);
+            node_pool_destroy(trie->nodes);
+            free(trie);
+            fclose(fp);
+            return NULL;
+        }
+        PROBE(load__block, PROBE_SECTION_FILTER, 0, ftell(fp));
+    }
 
     size_t processed = 0;
-    trie->root = read_node_with_progress(fp, err, &processed, header.node_count, 
+    trie->root = read_node_with_progress(fp, trie, header.flags, &rc, &processed, header.node_count, 
                                        progress, user_data);
 
-    if (*err) {
+    if (rc) {
+        ERROR_LOG("Failed to read trie nodes from %s: %s", filepath, strerror(rc));
+        if (err) *err = rc;
+        key_filter_destroy(trie->filter);
+        doc_table_destroy(trie->docs);
+        node_pool_destroy(trie->nodes);
         free(trie);
         fclose(fp);
         return NULL;
     }
 
+    PROBE(load__block, PROBE_SECTION_NODES, processed, ftell(fp));
+    if (err) *err = 0;
     fclose(fp);
     return trie;
 }
 
+GTrie* gtrie_load(const char* filepath, int* err, progress_cb progress, void* user_data) {
+    PROBE(load__start, filepath);
+    METRICS_START(start);
+    int rc = 0;
+    GTrie* trie = load_trie(filepath, &rc, progress, user_data);
+    METRICS_STOP(METRIC_GTRIE_LOAD, start, !trie);
+    PROBE(load__done, filepath, trie ? trie->node_count : 0, probe_file_bytes(filepath), rc);
+    if (err) *err = rc;
+    return trie;
+}
+
 IndexInfo* list_indices(const char* directory, size_t* count) {
     if (!directory || !count) {
         ERROR_LOG("Invalid arguments: directory=%p, count=%p", (void*)directory, (void*)count);
@@ -317,7 +593,7 @@ IndexInfo* list_indices(const char* directory, size_t* count) {
         FILE* fp = fopen(filepath, "rb");
         if (fp) {
             IndexHeader header;
-            if (fread(&header, sizeof(header), 1, fp) == 1 && 
+            if (read_header(fp, &header) == 0 && 
                 header.magic == TRIE_MAGIC) {
                 
                 DEBUG_LOG("Found valid index: %s (nodes: %zu, docs: %zu)", 
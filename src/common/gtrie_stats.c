@@ -0,0 +1,100 @@
+#include "gtrie_stats.h"
+#include "ranking.h"
+#include "logging.h"
+#include <string.h>
+#include <errno.h>
+
+static size_t floor_log2(size_t n) {
+    size_t log = 0;
+    while (n >>= 1) log++;
+    return log;
+}
+
+static void visit_postings(GTrieStats* stats, const PostingList* list) {
+    stats->posting_bytes += sizeof(PostingList) + rank_view_bytes(list);
+    for (const PostingEntry* e = list->head; e; e = e->next) {
+        stats->posting_bytes += sizeof(PostingEntry);
+        if (e->positions) stats->posting_bytes += gtrie_positions_capacity(e->positions_size);
+        stats->doc_string_bytes += strlen(e->doc_id) + 1;
+    }
+    if (list->count == 0) return;
+
+    stats->keys++;
+    stats->postings += list->count;
+    if (list->count > stats->max_posting_length) stats->max_posting_length = list->count;
+    size_t bucket = floor_log2(list->count);
+    if (bucket >= GTRIE_STATS_LENGTH_BUCKETS) bucket = GTRIE_STATS_LENGTH_BUCKETS - 1;
+    stats->posting_lengths[bucket]++;
+}
+
+static void visit_node(GTrieStats* stats, const TrieNode* node, size_t depth) {
+    size_t children = 0;
+    for (int i = 0; i < ALPHABET_SIZE; i++) {
+        if (node->children[i]) {
+            children++;
+            visit_node(stats, node->children[i], depth + 1);
+        }
+    }
+
+    stats->nodes++;
+    stats->fanout[children]++;
+    stats->wasted_child_slots += TRIE_CHILDREN_SIZE - children;
+    stats->depth[depth < GTRIE_STATS_MAX_DEPTH ? depth : GTRIE_STATS_MAX_DEPTH - 1]++;
+    if (depth > stats->max_depth) stats->max_depth = depth;
+    if (node->word) stats->key_bytes += strlen(node->word) + 1;
+    if (node->postings) visit_postings(stats, node->postings);
+}
+
+int gtrie_stats(const GTrie* trie, GTrieStats* stats) {
+    if (!trie || !stats) {
+        ERROR_LOG("Invalid arguments: trie=%p, stats=%p", (void*)trie, (void*)stats);
+        return EINVAL;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    visit_node(stats, trie->root, 0);
+    stats->child_slots = stats->nodes * TRIE_CHILDREN_SIZE;
+    stats->unique_docs = doc_table_count(trie->docs);
+    stats->node_bytes = node_pool_bytes(trie->nodes);
+    stats->doc_table_bytes = doc_table_bytes(trie->docs);
+    stats->filter_bytes = key_filter_blocks(trie->filter) * KEY_FILTER_BLOCK_BYTES;
+    stats->total_bytes = sizeof(GTrie) + stats->node_bytes + stats->posting_bytes +
+                         stats->doc_string_bytes + stats->key_bytes + stats->doc_table_bytes +
+                         stats->filter_bytes;
+    return 0;
+}
+
+static void print_bytes(FILE* fp, const char* name, size_t bytes, size_t total) {
+    fprintf(fp, "  %-14s %14zu  %5.1f%%\n", name, bytes, total ? 100.0 * (double)bytes / (double)total : 0.0);
+}
+
+void gtrie_stats_print(const GTrieStats* stats, FILE* fp) {
+    if (!stats || !fp) return;
+
+    fprintf(fp, "Trie: %zu nodes, %zu keys, %zu postings, %zu unique documents\n",
+            stats->nodes, stats->keys, stats->postings, stats->unique_docs);
+    fprintf(fp, "Memory: %zu bytes (%.1f per key)\n", stats->total_bytes,
+            stats->keys ? (double)stats->total_bytes / (double)stats->keys : 0.0);
+    print_bytes(fp, "nodes", stats->node_bytes, stats->total_bytes);
+    print_bytes(fp, "postings", stats->posting_bytes, stats->total_bytes);
+    print_bytes(fp, "doc strings", stats->doc_string_bytes, stats->total_bytes);
+    print_bytes(fp, "keys", stats->key_bytes, stats->total_bytes);
+    print_bytes(fp, "doc table", stats->doc_table_bytes, stats->total_bytes);
+    print_bytes(fp, "key filter", stats->filter_bytes, stats->total_bytes);
+    fprintf(fp, "Child slots: %zu of %zu empty (%.1f%%)\n", stats->wasted_child_slots, stats->child_slots,
+            stats->child_slots ? 100.0 * (double)stats->wasted_child_slots / (double)stats->child_slots : 0.0);
+
+    fprintf(fp, "Fanout:");
+    for (size_t i = 0; i <= ALPHABET_SIZE; i++) {
+        if (stats->fanout[i]) fprintf(fp, " %zu:%zu", i, stats->fanout[i]);
+    }
+    fprintf(fp, "\nDepth (max %zu):", stats->max_depth);
+    for (size_t i = 0; i < GTRIE_STATS_MAX_DEPTH; i++) {
+        if (stats->depth[i]) fprintf(fp, " %zu%s:%zu", i, i == GTRIE_STATS_MAX_DEPTH - 1 ? "+" : "", stats->depth[i]);
+    }
+    fprintf(fp, "\nPosting lengths (max %zu):", stats->max_posting_length);
+    for (size_t i = 0; i < GTRIE_STATS_LENGTH_BUCKETS; i++) {
+        if (stats->posting_lengths[i]) fprintf(fp, " %zu+:%zu", (size_t)1 << i, stats->posting_lengths[i]);
+    }
+    fprintf(fp, "\n");
+}
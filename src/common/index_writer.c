@@ -1,10 +1,45 @@
 #include "index_writer.h"
 #include "logging.h"
+#include "probes.h"
 #include <string.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
 
-int process_line(Indexer* idx, const char* line) {
+// Parse "weight" into a uint32_t; returns false on anything else
+static bool parse_weight(const char* str, uint32_t* weight) {
+    if (*str < '0' || *str > '9') return false;
+
+    char* end = NULL;
+    errno = 0;
+    unsigned long value = strtoul(str, &end, 10);
+    if (errno != 0 || *end != '\0' || value > UINT32_MAX) return false;
+
+    *weight = (uint32_t)value;
+    return true;
+}
+
+typedef enum {
+    LINE_PAIR,          // key:value
+    LINE_WEIGHTED,      // key:value:weight
+    LINE_DOCUMENT       // doc_id:text, tokens indexed with positions
+} LineFormat;
+
+// Index every whitespace-separated token of text at its position
+static int index_tokens(Indexer* idx, const char* doc_id, char* text) {
+    uint32_t position = 0;
+    char* save = NULL;
+    for (char* token = strtok_r(text, " \t\r\n", &save); token;
+         token = strtok_r(NULL, " \t\r\n", &save)) {
+        int rc = indexer_add_token(idx, token, doc_id, position++);
+        if (rc != 0) return rc;
+    }
+    return 0;
+}
+
+static int process_entry(Indexer* idx, const char* line, LineFormat format) {
+    bool weighted = format == LINE_WEIGHTED;
     if (!idx || !line) {
         ERROR_LOG("Invalid arguments: idx=%p, line=%p", (void*)idx, (void*)line);
         return EINVAL;
@@ -34,6 +69,14 @@ int process_line(Indexer* idx, const char* line) {
         *value = '\0';
         value++;
 
+        if (format == LINE_DOCUMENT) {
+            DEBUG_LOG("Adding document '%s'", key);
+            rc = index_tokens(idx, key, value);
+            if (rc != 0) ERROR_LOG("Failed to add document %s: %s", key, strerror(rc));
+            free(line_copy);
+            return rc;
+        }
+
         // Trim whitespace
         char* end = value + strlen(value) - 1;
         while (end > value && (*end == '\n' || *end == '\r' || *end == ' ')) {
@@ -41,9 +84,22 @@ int process_line(Indexer* idx, const char* line) {
             end--;
         }
 
+        // Weighted lines end with ":weight"
+        uint32_t weight = 0;
+        char* weight_str = weighted ? strrchr(value, ':') : NULL;
+        if (weighted && (!weight_str || !parse_weight(weight_str + 1, &weight))) {
+            ERROR_LOG("Invalid line format (missing or bad weight): %s", line);
+            free(line_copy);
+            return EINVAL;
+        }
+        if (weight_str) *weight_str = '\0';
+
         // Add to index
         DEBUG_LOG("Adding key='%s' value='%s'", key, value);
         rc = indexer_add_document(idx, key, value);
+        if (rc == 0 && weighted) {
+            rc = indexer_set_key_weight(idx, key, weight);
+        }
         if (rc != 0) {
             ERROR_LOG("Failed to add document: %s", strerror(rc));
         }
@@ -55,7 +111,19 @@ int process_line(Indexer* idx, const char* line) {
     return rc;
 }
 
-int process_file(Indexer* idx, FILE* fp, size_t* processed, size_t* failed) {
+int process_line(Indexer* idx, const char* line) {
+    return process_entry(idx, line, LINE_PAIR);
+}
+
+int process_weighted_line(Indexer* idx, const char* line) {
+    return process_entry(idx, line, LINE_WEIGHTED);
+}
+
+int process_document_line(Indexer* idx, const char* line) {
+    return process_entry(idx, line, LINE_DOCUMENT);
+}
+
+static int process_stream(Indexer* idx, FILE* fp, LineFormat format, size_t* processed, size_t* failed) {
     if (!idx || !fp) {
         ERROR_LOG("Invalid arguments: idx=%p, fp=%p", (void*)idx, (void*)fp);
         return EINVAL;
@@ -65,24 +133,40 @@ int process_file(Indexer* idx, FILE* fp, size_t* processed, size_t* failed) {
     size_t line_number = 0;
     size_t local_processed = 0;
     size_t local_failed = 0;
+    size_t bytes = 0;
 
     while (fgets(line, sizeof(line), fp)) {
         line_number++;
-        
-        int rc = process_line(idx, line);
+        bytes += strlen(line);
+
+        int rc = process_entry(idx, line, format);
         if (rc == 0) {
             local_processed++;
         } else { // Don't count comments as failures
             local_failed++;
         }
 
-        if (line_number % 1000 == 0) {
+        if (line_number % PROBE_BATCH_LINES == 0) {
             INFO_LOG("Processed %zu lines (%zu failed)", local_processed, local_failed);
+            PROBE(process_file__batch, line_number, local_failed, bytes);
         }
     }
+    PROBE(process_file__done, line_number, local_failed, bytes);
 
     if (processed) *processed = local_processed;
     if (failed) *failed = local_failed;
 
     return 0;
-} 
\ No newline at end of file
+}
+
+int process_file(Indexer* idx, FILE* fp, size_t* processed, size_t* failed) {
+    return process_stream(idx, fp, LINE_PAIR, processed, failed);
+}
+
+int process_weighted_file(Indexer* idx, FILE* fp, size_t* processed, size_t* failed) {
+    return process_stream(idx, fp, LINE_WEIGHTED, processed, failed);
+}
+
+int process_document_file(Indexer* idx, FILE* fp, size_t* processed, size_t* failed) {
+    return process_stream(idx, fp, LINE_DOCUMENT, processed, failed);
+}
@@ -1,32 +1,206 @@
 #include "indexer.h"
 #include "gtrie.h"
 #include "gtrie_io.h"
+#include "affix_index.h"
+#include "double_array.h"
+#include "metrics.h"
+#include "probes.h"
 #include "logging.h"
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
 
-struct Indexer {
-    GTrie* trie;
+#define INDEXER_CACHE_STACK_BUFFER 4096
+
+// A published version of the index. Readers pin it for the duration of a
+// query (or for the life of a cursor); the indexer holds one reference while
+// it is current. The last release hands it to the reclaimer thread, so a
+// large trie is never destroyed on a request path.
+struct IndexSnapshot {
+    GTrie* trie;                    // NULL when served from a double array
+    DoubleArray* da;                // Read-only exact lookups, NULL for a trie
     time_t timestamp;
+    uint64_t generation;            // Incremented whenever the indexed data changes
+    AffixIndex* affix;              // Suffix/infix sidecars, NULL when not loaded
+    uint64_t affix_generation;      // Sidecars are only used while generation matches
+    size_t refs;                    // Pins plus one while current
+    Indexer* owner;
+    struct IndexSnapshot* next;     // Reclaimer queue link
+};
+
+struct Indexer {
+    IndexSnapshot* current;         // Swapped atomically by indexer_load
+    unsigned epoch;                 // Parity selects the reader counter below
+    size_t readers[2];              // Readers between loading current and pinning it
+    QueryCache* cache;              // Optional result cache, NULL when disabled
+    bool freeze;                    // Freeze indexes as they are loaded
+
+    pthread_mutex_t lock;           // Serializes swaps and guards the queues
+    pthread_cond_t wake;
+    IndexSnapshot* retired;         // Swapped out, still holding the current reference
+    IndexSnapshot* dead;            // Unreferenced, waiting to be freed
+    pthread_t reclaimer;
+    bool reclaimer_running;
+    bool stopping;
 };
 
+static IndexSnapshot* snapshot_create(Indexer* idx, GTrie* trie, uint64_t generation) {
+    IndexSnapshot* snap = malloc(sizeof(IndexSnapshot));
+    if (!snap) return NULL;
+
+    snap->trie = trie;
+    snap->da = NULL;
+    snap->timestamp = time(NULL);
+    snap->generation = generation;
+    snap->affix = NULL;
+    snap->affix_generation = 0;
+    snap->refs = 1;
+    snap->owner = idx;
+    snap->next = NULL;
+    return snap;
+}
+
+static void snapshot_free(IndexSnapshot* snap) {
+    gtrie_destroy(snap->trie);
+    double_array_destroy(snap->da);
+    affix_index_destroy(snap->affix);
+    free(snap);
+}
+
+// Exact lookup in whichever representation the snapshot holds
+static const PostingList* snapshot_search(const IndexSnapshot* snap, const char* key, int* err) {
+    if (snap->da) return double_array_search(snap->da, key, err);
+    return gtrie_search(snap->trie, key, err);
+}
+
+// Pin the current snapshot. The epoch counter tells the reclaimer when no
+// reader can still be holding a pointer it loaded before a swap.
+static IndexSnapshot* snapshot_pin(Indexer* idx) {
+    unsigned e = __atomic_load_n(&idx->epoch, __ATOMIC_SEQ_CST) & 1;
+    __atomic_fetch_add(&idx->readers[e], 1, __ATOMIC_SEQ_CST);
+    IndexSnapshot* snap = __atomic_load_n(&idx->current, __ATOMIC_SEQ_CST);
+    __atomic_fetch_add(&snap->refs, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_sub(&idx->readers[e], 1, __ATOMIC_RELEASE);
+    return snap;
+}
+
+static void snapshot_release(IndexSnapshot* snap) {
+    if (__atomic_fetch_sub(&snap->refs, 1, __ATOMIC_ACQ_REL) != 1) return;
+
+    // Without a reclaimer nothing would ever take it off the dead list
+    Indexer* idx = snap->owner;
+    pthread_mutex_lock(&idx->lock);
+    bool running = idx->reclaimer_running;
+    if (running) {
+        snap->next = idx->dead;
+        idx->dead = snap;
+        pthread_cond_signal(&idx->wake);
+    }
+    pthread_mutex_unlock(&idx->lock);
+    if (!running) snapshot_free(snap);
+}
+
+// Wait until every reader that might have loaded the old current pointer
+// has either pinned it or moved on. A reader can read the epoch, stall, and
+// only then enter its slot, after the parity it read has been drained, so
+// one flip is not enough: flip twice, draining each slot in turn, like the
+// two grace-period phases of userspace RCU. Readers arriving meanwhile
+// enter the other slot, so neither wait can be starved.
+static void wait_for_readers(Indexer* idx) {
+    for (int phase = 0; phase < 2; phase++) {
+        unsigned old = __atomic_fetch_add(&idx->epoch, 1, __ATOMIC_SEQ_CST) & 1;
+        while (__atomic_load_n(&idx->readers[old], __ATOMIC_ACQUIRE) != 0) {
+            sched_yield();
+        }
+    }
+}
+
+static void* reclaimer_main(void* arg) {
+    Indexer* idx = arg;
+
+    pthread_mutex_lock(&idx->lock);
+    for (;;) {
+        while (!idx->stopping && !idx->retired && !idx->dead) {
+            pthread_cond_wait(&idx->wake, &idx->lock);
+        }
+        IndexSnapshot* retired = idx->retired;
+        IndexSnapshot* dead = idx->dead;
+        idx->retired = NULL;
+        idx->dead = NULL;
+        bool stopping = idx->stopping;
+        pthread_mutex_unlock(&idx->lock);
+
+        if (retired) wait_for_readers(idx);
+        while (retired) {
+            IndexSnapshot* next = retired->next;
+            snapshot_release(retired);  // Drop the current reference
+            retired = next;
+        }
+        while (dead) {
+            IndexSnapshot* next = dead->next;
+            DEBUG_LOG("Freeing index generation %llu", (unsigned long long)dead->generation);
+            snapshot_free(dead);
+            dead = next;
+        }
+
+        pthread_mutex_lock(&idx->lock);
+        if (stopping && !idx->retired && !idx->dead) break;
+    }
+    pthread_mutex_unlock(&idx->lock);
+    return NULL;
+}
+
+// Hand a swapped-out snapshot to the reclaimer (started on first use)
+static void snapshot_retire(Indexer* idx, IndexSnapshot* snap) {
+    pthread_mutex_lock(&idx->lock);
+    if (!idx->reclaimer_running &&
+        pthread_create(&idx->reclaimer, NULL, reclaimer_main, idx) == 0) {
+        idx->reclaimer_running = true;
+    }
+    bool running = idx->reclaimer_running;
+    if (running) {
+        snap->next = idx->retired;
+        idx->retired = snap;
+        pthread_cond_signal(&idx->wake);
+    }
+    pthread_mutex_unlock(&idx->lock);
+
+    if (!running) {
+        // No background thread: release inline; the last reader frees it
+        ERROR_LOG("Failed to start index reclaimer thread");
+        wait_for_readers(idx);
+        snapshot_release(snap);
+    }
+}
+
 Indexer* indexer_create(void) {
-    Indexer* idx = malloc(sizeof(Indexer));
+    Indexer* idx = calloc(1, sizeof(Indexer));
     if (!idx) {
         ERROR_LOG("Failed to allocate Indexer");
         return NULL;
     }
 
     int err = 0;
-    idx->trie = gtrie_create(&err);
-    if (!idx->trie) {
+    GTrie* trie = gtrie_create(&err);
+    if (!trie) {
         ERROR_LOG("Failed to create trie: %s", strerror(err));
         free(idx);
         return NULL;
     }
 
-    idx->timestamp = time(NULL);
+    idx->current = snapshot_create(idx, trie, 0);
+    if (!idx->current) {
+        ERROR_LOG("Failed to allocate index snapshot");
+        gtrie_destroy(trie);
+        free(idx);
+        return NULL;
+    }
+
+    pthread_mutex_init(&idx->lock, NULL);
+    pthread_cond_init(&idx->wake, NULL);
     DEBUG_LOG("Created new indexer instance");
     return idx;
 }
@@ -35,7 +209,28 @@ void indexer_destroy(Indexer* idx) {
     if (!idx) return;
 
     DEBUG_LOG("Destroying indexer instance");
-    gtrie_destroy(idx->trie);
+
+    // Let the reclaimer drain its queues before freeing the current index
+    pthread_mutex_lock(&idx->lock);
+    idx->stopping = true;
+    pthread_cond_signal(&idx->wake);
+    bool running = idx->reclaimer_running;
+    pthread_mutex_unlock(&idx->lock);
+    if (running) pthread_join(idx->reclaimer, NULL);
+
+    // Whatever the reclaimer did not get to
+    IndexSnapshot* lists[] = { idx->retired, idx->dead };
+    for (size_t i = 0; i < 2; i++) {
+        while (lists[i]) {
+            IndexSnapshot* next = lists[i]->next;
+            snapshot_free(lists[i]);
+            lists[i] = next;
+        }
+    }
+    snapshot_free(idx->current);
+    query_cache_destroy(idx->cache);
+    pthread_cond_destroy(&idx->wake);
+    pthread_mutex_destroy(&idx->lock);
     free(idx);
 }
 
@@ -47,11 +242,48 @@ int indexer_add_document(Indexer* idx, const char* key, const char* doc_id) {
     }
 
     TRACE_LOG("Adding document %s for key '%s'", doc_id, key);
-    int rc = gtrie_insert(idx->trie, key, doc_id);
+    IndexSnapshot* snap = snapshot_pin(idx);
+    int rc = snap->da ? EPERM : gtrie_insert(snap->trie, key, doc_id);
     if (rc != 0) {
         ERROR_LOG("Failed to insert key '%s': %s", key, strerror(rc));
+    } else {
+        __atomic_fetch_add(&snap->generation, 1, __ATOMIC_RELEASE);
+    }
+    snapshot_release(snap);
+
+    return rc;
+}
+
+int indexer_add_token(Indexer* idx, const char* key, const char* doc_id, uint32_t position) {
+    if (!idx || !key || !doc_id) {
+        ERROR_LOG("Invalid arguments: idx=%p, key=%p, doc_id=%p",
+                 (void*)idx, (void*)key, (void*)doc_id);
+        return EINVAL;
+    }
+
+    IndexSnapshot* snap = snapshot_pin(idx);
+    int rc = snap->da ? EPERM : gtrie_insert_at(snap->trie, key, doc_id, position);
+    if (rc != 0) {
+        ERROR_LOG("Failed to insert key '%s' at position %u: %s", key, position, strerror(rc));
+    } else {
+        __atomic_fetch_add(&snap->generation, 1, __ATOMIC_RELEASE);
+    }
+    snapshot_release(snap);
+    return rc;
+}
+
+int indexer_set_key_weight(Indexer* idx, const char* key, uint32_t weight) {
+    if (!idx || !key) {
+        ERROR_LOG("Invalid arguments: idx=%p, key=%p", (void*)idx, (void*)key);
+        return EINVAL;
     }
 
+    IndexSnapshot* snap = snapshot_pin(idx);
+    int rc = snap->da ? EPERM : gtrie_set_weight(snap->trie, key, weight);
+    if (rc == 0) {
+        __atomic_fetch_add(&snap->generation, 1, __ATOMIC_RELEASE);
+    }
+    snapshot_release(snap);
     return rc;
 }
 
@@ -63,7 +295,29 @@ int indexer_save(Indexer* idx, const char* filepath) {
     }
 
     INFO_LOG("Saving index to %s", filepath);
-    return gtrie_save(idx->trie, filepath, NULL, NULL);
+    IndexSnapshot* snap = snapshot_pin(idx);
+    int rc = snap->da ? ENOTSUP : gtrie_save(snap->trie, filepath, NULL, NULL);
+    snapshot_release(snap);
+    return rc;
+}
+
+int indexer_save_affix(Indexer* idx, const char* filepath) {
+    if (!idx || !filepath) {
+        ERROR_LOG("Invalid arguments: idx=%p, filepath=%p",
+                 (void*)idx, (void*)filepath);
+        return EINVAL;
+    }
+
+    int rc = 0;
+    IndexSnapshot* snap = snapshot_pin(idx);
+    AffixIndex* affix = snap->da ? NULL : affix_index_build(snap->trie, &rc);
+    if (snap->da) rc = ENOTSUP;
+    snapshot_release(snap);
+    if (!affix) return rc;
+
+    rc = affix_index_save(affix, filepath);
+    affix_index_destroy(affix);
+    return rc;
 }
 
 int indexer_load(Indexer* idx, const char* filepath) {
@@ -76,41 +330,96 @@ int indexer_load(Indexer* idx, const char* filepath) {
     INFO_LOG("Loading index from %s", filepath);
     
     int err = 0;
-    GTrie* new_trie = gtrie_load(filepath, &err, NULL, NULL);
-    if (!new_trie) {
-        ERROR_LOG("Failed to load index: %s", strerror(err));
-        return err;
+    IndexSnapshot* snap = NULL;
+    size_t keys = 0;
+    if (double_array_detect(filepath)) {
+        DoubleArray* da = double_array_load(filepath, &err);
+        if (!da) {
+            ERROR_LOG("Failed to load index: %s", strerror(err));
+            return err;
+        }
+        snap = snapshot_create(idx, NULL, 0);
+        if (!snap) {
+            ERROR_LOG("Failed to allocate index snapshot");
+            double_array_destroy(da);
+            return ENOMEM;
+        }
+        snap->da = da;
+        keys = double_array_key_count(da);
+    } else {
+        GTrie* new_trie = gtrie_load(filepath, &err, NULL, NULL);
+        if (!new_trie) {
+            ERROR_LOG("Failed to load index: %s", strerror(err));
+            return err;
+        }
+
+        // A frozen layout is only an optimization; serve the trie as loaded without it
+        if (idx->freeze) {
+            err = gtrie_freeze(new_trie);
+            if (err != 0) WARN_LOG("Serving %s unfrozen: %s", filepath, strerror(err));
+        }
+
+        snap = snapshot_create(idx, new_trie, 0);
+        if (!snap) {
+            ERROR_LOG("Failed to allocate index snapshot");
+            gtrie_destroy(new_trie);
+            return ENOMEM;
+        }
+
+        // Suffix/infix sidecars are optional; without them patterns walk the trie
+        snap->affix = affix_index_load(filepath, new_trie, &err);
+        if (!snap->affix && err != ENOENT) {
+            WARN_LOG("Ignoring affix sidecars for %s: %s", filepath, strerror(err));
+        }
+        keys = new_trie->total_words;
     }
 
-    // Replace existing trie
-    gtrie_destroy(idx->trie);
-    idx->trie = new_trie;
-    idx->timestamp = time(NULL);
+    // Publish the new index; readers of the old one keep it alive
+    pthread_mutex_lock(&idx->lock);
+    IndexSnapshot* old = idx->current;
+    snap->generation = __atomic_load_n(&old->generation, __ATOMIC_ACQUIRE) + 1;
+    snap->affix_generation = snap->generation;
+    __atomic_store_n(&idx->current, snap, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&idx->lock);
+
+    query_cache_clear(idx->cache);  // Old entries can never match again
+    snapshot_retire(idx, old);
     
-    INFO_LOG("Successfully loaded index with %zu keys", idx->trie->total_words);
+    INFO_LOG("Successfully loaded index with %zu keys", keys);
     return 0;
 }
 
-SearchResult* indexer_search(Indexer* idx, const char* key) {
-    if (!idx || !key) {
-        ERROR_LOG("Invalid arguments: idx=%p, key=%p", (void*)idx, (void*)key);
-        return NULL;
+int indexer_save_double_array(Indexer* idx, const char* filepath) {
+    if (!idx || !filepath) {
+        ERROR_LOG("Invalid arguments: idx=%p, filepath=%p",
+                 (void*)idx, (void*)filepath);
+        return EINVAL;
     }
 
-    DEBUG_LOG("Searching for key '%s'", key);
-    
-    int err = 0;
-    PostingList* postings = gtrie_search(idx->trie, key, &err);
-    if (!postings) {
-        if (err == ENOENT) {
-            DEBUG_LOG("No results found for key '%s'", key);
-        } else {
-            ERROR_LOG("Search failed for key '%s': %s", key, strerror(err));
-        }
-        return NULL;
+    INFO_LOG("Saving double array to %s", filepath);
+    int rc = 0;
+    IndexSnapshot* snap = snapshot_pin(idx);
+    if (snap->da) {
+        rc = double_array_save(snap->da, filepath);
+    } else {
+        DoubleArray* da = double_array_build(snap->trie, &rc);
+        if (da) rc = double_array_save(da, filepath);
+        double_array_destroy(da);
     }
+    snapshot_release(snap);
+    return rc;
+}
 
-    // Convert PostingList to SearchResult
+// Point a cursor at a posting list, pinning the snapshot it belongs to
+static void cursor_attach(SearchCursor* cursor, IndexSnapshot* snap, const PostingList* postings) {
+    __atomic_fetch_add(&snap->refs, 1, __ATOMIC_RELAXED);
+    cursor->snapshot = snap;
+    cursor->entry = postings->head;
+    cursor->total = postings->count;
+}
+
+// Build a result list from a posting list
+static SearchResult* results_from_postings(const PostingList* postings) {
     SearchResult* results = NULL;
     SearchResult* last = NULL;
     PostingEntry* entry = postings->head;
@@ -135,10 +444,484 @@ SearchResult* indexer_search(Indexer* idx, const char* key) {
         entry = entry->next;
     }
 
+    return results;
+}
+
+// Build a result list from cached doc ids packed as consecutive NUL-terminated strings
+static SearchResult* results_from_packed(const char* packed, size_t len) {
+    SearchResult* results = NULL;
+    SearchResult* last = NULL;
+    const char* end = packed + len;
+
+    while (packed < end) {
+        SearchResult* result = malloc(sizeof(SearchResult));
+        if (!result) {
+            ERROR_LOG("Failed to allocate SearchResult");
+            search_results_free(results);
+            return NULL;
+        }
+
+        size_t doc_len = strlen(packed);
+        result->doc_id = strdup(packed);
+        result->next = NULL;
+
+        if (!results) {
+            results = result;
+        } else {
+            last->next = result;
+        }
+        last = result;
+        packed += doc_len + 1;
+    }
+
+    return results;
+}
+
+// Store a result list in the cache (an empty list caches the miss)
+static void cache_results(Indexer* idx, uint64_t generation, const char* key, const SearchResult* results) {
+    size_t len = 0;
+    for (const SearchResult* r = results; r; r = r->next) {
+        len += strlen(r->doc_id) + 1;
+    }
+
+    char stack_buf[INDEXER_CACHE_STACK_BUFFER];
+    char* packed = len <= sizeof(stack_buf) ? stack_buf : malloc(len);
+    if (!packed) return;
+
+    char* p = packed;
+    for (const SearchResult* r = results; r; r = r->next) {
+        size_t doc_len = strlen(r->doc_id) + 1;
+        memcpy(p, r->doc_id, doc_len);
+        p += doc_len;
+    }
+
+    query_cache_insert(idx->cache, key, strlen(key), generation, packed, len);
+    if (packed != stack_buf) free(packed);
+}
+
+// Serve a search from the cache; returns true on a hit
+static bool search_cached(Indexer* idx, uint64_t generation, const char* key, SearchResult** results) {
+    char stack_buf[INDEXER_CACHE_STACK_BUFFER];
+    size_t key_len = strlen(key);
+    size_t len = 0;
+
+    int rc = query_cache_lookup(idx->cache, key, key_len, generation,
+                                stack_buf, sizeof(stack_buf), &len);
+    if (rc == 0) {
+        *results = results_from_packed(stack_buf, len);
+        return true;
+    }
+    if (rc != ENOSPC) return false;
+
+    char* packed = malloc(len);
+    if (!packed) return false;
+    rc = query_cache_lookup(idx->cache, key, key_len, generation, packed, len, &len);
+    if (rc == 0) {
+        *results = results_from_packed(packed, len);
+    }
+    free(packed);
+    return rc == 0;
+}
+
+// Length of a result list; only evaluated while the probe is traced
+static size_t probe_result_count(const SearchResult* results) {
+    size_t count = 0;
+    for (; results; results = results->next) count++;
+    return count;
+}
+
+// indexer_search without the timing; *failed is set for errors other than a miss
+static SearchResult* search_results(Indexer* idx, const char* key, bool* failed) {
+    DEBUG_LOG("Searching for key '%s'", key);
+
+    IndexSnapshot* snap = snapshot_pin(idx);
+    uint64_t generation = __atomic_load_n(&snap->generation, __ATOMIC_ACQUIRE);
+
+    SearchResult* results = NULL;
+    if (idx->cache && search_cached(idx, generation, key, &results)) {
+        DEBUG_LOG("Cache hit for key '%s'", key);
+        snapshot_release(snap);
+        return results;
+    }
+    
+    int err = 0;
+    const PostingList* postings = snapshot_search(snap, key, &err);
+    if (!postings) {
+        if (err == ENOENT) {
+            DEBUG_LOG("No results found for key '%s'", key);
+            if (idx->cache) cache_results(idx, generation, key, NULL);
+        } else {
+            ERROR_LOG("Search failed for key '%s': %s", key, strerror(err));
+            *failed = true;
+        }
+        snapshot_release(snap);
+        return NULL;
+    }
+
+    // Convert PostingList to SearchResult
+    results = results_from_postings(postings);
+    if (results && idx->cache) {
+        cache_results(idx, generation, key, results);
+    }
+    snapshot_release(snap);
+
+    *failed = !results && postings->head;  // Allocation failure
     DEBUG_LOG("Found results for key '%s'", key);
     return results;
 }
 
+SearchResult* indexer_search(Indexer* idx, const char* key) {
+    if (!idx || !key) {
+        ERROR_LOG("Invalid arguments: idx=%p, key=%p", (void*)idx, (void*)key);
+        return NULL;
+    }
+
+    PROBE(indexer_search__start, key);
+    METRICS_START(start);
+    bool failed = false;
+    SearchResult* results = search_results(idx, key, &failed);
+    METRICS_STOP(METRIC_INDEXER_SEARCH, start, failed);
+    PROBE(indexer_search__done, key, strlen(key), probe_result_count(results), failed);
+    return results;
+}
+
+int indexer_cursor_open(Indexer* idx, const char* key, SearchCursor* cursor) {
+    if (!cursor) return EINVAL;
+    memset(cursor, 0, sizeof(*cursor));
+
+    if (!idx || !key) {
+        ERROR_LOG("Invalid arguments: idx=%p, key=%p", (void*)idx, (void*)key);
+        return EINVAL;
+    }
+
+    IndexSnapshot* snap = snapshot_pin(idx);
+    int err = 0;
+    const PostingList* postings = snapshot_search(snap, key, &err);
+    if (postings) {
+        cursor_attach(cursor, snap, postings);
+    }
+    snapshot_release(snap);
+    return postings ? 0 : (err ? err : ENOENT);
+}
+
+size_t indexer_cursor_skip(SearchCursor* cursor, size_t n) {
+    if (!cursor) return 0;
+
+    size_t skipped = 0;
+    while (skipped < n && cursor->entry) {
+        cursor->entry = cursor->entry->next;
+        skipped++;
+    }
+    cursor->position += skipped;
+    return skipped;
+}
+
+const char* indexer_cursor_next(SearchCursor* cursor) {
+    if (!cursor || !cursor->entry) return NULL;
+
+    const char* doc_id = cursor->entry->doc_id;
+    cursor->entry = cursor->entry->next;
+    cursor->position++;
+    return doc_id;
+}
+
+void indexer_cursor_close(SearchCursor* cursor) {
+    if (!cursor) return;
+    if (cursor->snapshot) snapshot_release((IndexSnapshot*)cursor->snapshot);
+    memset(cursor, 0, sizeof(*cursor));
+}
+
+void indexer_unpin(IndexPin* pin) {
+    if (!pin) return;
+    if (pin->snapshot) snapshot_release((IndexSnapshot*)pin->snapshot);
+    pin->snapshot = NULL;
+}
+
+// Hand the caller's reference on snap to pin when it wants one and the
+// search succeeded, otherwise drop it
+static void pin_or_release(IndexSnapshot* snap, IndexPin* pin, int rc) {
+    if (pin && rc == 0) {
+        pin->snapshot = snap;
+    } else {
+        snapshot_release(snap);
+    }
+}
+
+int indexer_search_page(Indexer* idx, const char* key, size_t offset, size_t limit,
+                        const char** out, size_t* count, size_t* total, IndexPin* pin) {
+    if (count) *count = 0;
+    if (total) *total = 0;
+    if (pin) pin->snapshot = NULL;
+    if (!out && limit > 0) return EINVAL;
+
+    SearchCursor cursor;
+    int rc = indexer_cursor_open(idx, key, &cursor);
+    if (rc != 0) return rc;
+
+    // Pages before offset are skipped without touching the doc ids
+    indexer_cursor_skip(&cursor, offset);
+
+    size_t n = 0;
+    const char* doc_id;
+    while (n < limit && (doc_id = indexer_cursor_next(&cursor)) != NULL) {
+        out[n++] = doc_id;
+    }
+
+    if (count) *count = n;
+    if (total) *total = cursor.total;
+    if (pin) {
+        pin->snapshot = cursor.snapshot;    // Take over the cursor's pin
+        cursor.snapshot = NULL;
+    }
+    indexer_cursor_close(&cursor);
+    return 0;
+}
+
+int indexer_search_many(Indexer* idx, const char* const* keys, size_t count,
+                        SearchManyResult* results) {
+    if (!idx || (count > 0 && (!keys || !results))) {
+        ERROR_LOG("Invalid arguments: idx=%p, keys=%p, results=%p",
+                 (void*)idx, (void*)keys, (void*)results);
+        return EINVAL;
+    }
+    if (count == 0) return 0;
+
+    PostingList** postings = malloc(count * sizeof(PostingList*));
+    int* errs = malloc(count * sizeof(int));
+    if (!postings || !errs) {
+        free(postings);
+        free(errs);
+        return ENOMEM;
+    }
+
+    IndexSnapshot* snap = snapshot_pin(idx);
+    int rc = 0;
+    if (snap->da) {
+        // Double-array lookups share nothing, so there is no reason to sort
+        for (size_t i = 0; i < count; i++) {
+            if (!keys[i]) {
+                postings[i] = NULL;     // As gtrie_search_many reports it
+                errs[i] = EINVAL;
+                continue;
+            }
+            postings[i] = (PostingList*)snapshot_search(snap, keys[i], &errs[i]);
+            if (postings[i]) errs[i] = 0;
+        }
+    } else {
+        rc = gtrie_search_many(snap->trie, keys, count, postings, errs);
+    }
+    if (rc == 0) {
+        for (size_t i = 0; i < count; i++) {
+            memset(&results[i], 0, sizeof(results[i]));
+            results[i].err = errs[i];
+            if (postings[i]) {
+                cursor_attach(&results[i].cursor, snap, postings[i]);
+            }
+        }
+    } else {
+        ERROR_LOG("Batched search failed: %s", strerror(rc));
+    }
+    snapshot_release(snap);
+
+    DEBUG_LOG("Batched search for %zu keys", count);
+    free(postings);
+    free(errs);
+    return rc;
+}
+
+int indexer_search_fuzzy(Indexer* idx, const char* key, int max_edits,
+                         FuzzyResult* results, size_t max_results, size_t* count) {
+    if (count) *count = 0;
+    if (!idx || !key || !results || max_results == 0) {
+        ERROR_LOG("Invalid arguments: idx=%p, key=%p, results=%p, max_results=%zu",
+                 (void*)idx, (void*)key, (void*)results, max_results);
+        return EINVAL;
+    }
+
+    FuzzyMatch* matches = malloc(max_results * sizeof(FuzzyMatch));
+    if (!matches) return ENOMEM;
+
+    size_t n = 0;
+    IndexSnapshot* snap = snapshot_pin(idx);
+    int rc = snap->da ? ENOTSUP
+                      : gtrie_fuzzy_search(snap->trie, key, max_edits, matches, max_results, &n);
+    for (size_t i = 0; i < n; i++) {
+        memset(&results[i], 0, sizeof(results[i]));
+        results[i].key = matches[i].word;
+        results[i].distance = matches[i].distance;
+        cursor_attach(&results[i].cursor, snap, matches[i].postings);
+    }
+    snapshot_release(snap);
+
+    DEBUG_LOG("Fuzzy search for '%s' (max_edits=%d): %zu matches", key, max_edits, n);
+    free(matches);
+    if (count) *count = n;
+    return rc;
+}
+
+// Patterns the sidecars answer directly: globs "*text" / "*text*" and
+// unanchored regexes "text$" / "text" where text has no operators
+static char* affix_route(const char* pattern, PatternSyntax syntax, AffixQuery* query) {
+    const char* specials = syntax == PATTERN_GLOB ? "*?[\\" : ".[]()|*+?{}^$\\";
+    size_t len = strlen(pattern);
+    size_t start = 0;
+
+    if (syntax == PATTERN_GLOB) {
+        if (len < 2 || pattern[0] != '*') return NULL;
+        start = 1;
+        *query = pattern[len - 1] == '*' ? AFFIX_INFIX : AFFIX_SUFFIX;
+    } else {
+        *query = len > 0 && pattern[len - 1] == '$' ? AFFIX_SUFFIX : AFFIX_INFIX;
+    }
+    if (*query == AFFIX_SUFFIX && syntax == PATTERN_REGEX) len--;
+    if (*query == AFFIX_INFIX && syntax == PATTERN_GLOB) len--;
+    if (len <= start) return NULL;
+
+    for (size_t i = start; i < len; i++) {
+        if (strchr(specials, pattern[i])) return NULL;
+    }
+    char* text = malloc(len - start + 1);
+    if (!text) return NULL;
+    memcpy(text, pattern + start, len - start);
+    text[len - start] = '\0';
+    return text;
+}
+
+static int search_affix(IndexSnapshot* snap, AffixQuery query, const char* text,
+                        size_t max_results, PatternResult* results, size_t* count) {
+    const char** keys = malloc(max_results * sizeof(char*));
+    if (!keys) return ENOMEM;
+
+    size_t n = 0;
+    int rc = affix_index_search(snap->affix, query, text, keys, max_results, &n);
+    for (size_t i = 0; i < n; i++) {
+        int err = 0;
+        PostingList* postings = gtrie_search(snap->trie, keys[i], &err);
+        if (!postings) continue;
+        memset(&results[*count], 0, sizeof(results[*count]));
+        results[*count].key = keys[i];
+        cursor_attach(&results[*count].cursor, snap, postings);
+        (*count)++;
+    }
+    free(keys);
+    return rc == 0 && *count == 0 ? ENOENT : rc;
+}
+
+int indexer_search_pattern(Indexer* idx, const char* pattern, PatternSyntax syntax,
+                           size_t max_results, uint64_t budget_us,
+                           PatternResult* results, size_t* count) {
+    if (count) *count = 0;
+    if (!idx || !pattern || !results || max_results == 0) {
+        ERROR_LOG("Invalid arguments: idx=%p, pattern=%p, results=%p, max_results=%zu",
+                 (void*)idx, (void*)pattern, (void*)results, max_results);
+        return EINVAL;
+    }
+
+    int rc = 0;
+    Pattern* compiled = pattern_compile(pattern, syntax, &rc);
+    if (!compiled) return rc;
+
+    size_t n = 0;
+    IndexSnapshot* snap = snapshot_pin(idx);
+    AffixQuery query;
+    char* text = NULL;
+    if (snap->affix &&
+        snap->affix_generation == __atomic_load_n(&snap->generation, __ATOMIC_ACQUIRE)) {
+        text = affix_route(pattern, syntax, &query);
+    }
+
+    if (snap->da) {
+        rc = ENOTSUP;
+    } else if (text) {
+        rc = search_affix(snap, query, text, max_results, results, &n);
+        DEBUG_LOG("Pattern search for '%s' answered by %s sidecar: %zu matches",
+                  pattern, query == AFFIX_SUFFIX ? "suffix" : "infix", n);
+        free(text);
+    } else {
+        PatternMatch* matches = malloc(max_results * sizeof(PatternMatch));
+        rc = matches ? gtrie_pattern_search(snap->trie, compiled, matches, max_results,
+                                            budget_us, &n)
+                     : ENOMEM;
+        for (size_t i = 0; i < n; i++) {
+            memset(&results[i], 0, sizeof(results[i]));
+            results[i].key = matches[i].word;
+            cursor_attach(&results[i].cursor, snap, matches[i].postings);
+        }
+        DEBUG_LOG("Pattern search for '%s': %zu matches (%s)", pattern, n, strerror(rc));
+        free(matches);
+    }
+    snapshot_release(snap);
+
+    pattern_free(compiled);
+    if (count) *count = n;
+    return rc;
+}
+
+int indexer_search_ranked(Indexer* idx, const char* const* terms, size_t num_terms, size_t k,
+                          RankedDoc* results, size_t* count, IndexPin* pin) {
+    if (count) *count = 0;
+    if (pin) pin->snapshot = NULL;
+    if (!idx || !terms || !results || k == 0) {
+        ERROR_LOG("Invalid arguments: idx=%p, terms=%p, results=%p, k=%zu",
+                 (void*)idx, (void*)terms, (void*)results, k);
+        return EINVAL;
+    }
+
+    RankStats stats = { 0 };
+    IndexSnapshot* snap = snapshot_pin(idx);
+    int rc = snap->da ? ENOTSUP
+                      : rank_bm25_top_k(snap->trie, terms, num_terms, k, results, count, &stats);
+    pin_or_release(snap, pin, rc);
+    DEBUG_LOG("Ranked search over %zu terms: scored %zu of %zu postings",
+              num_terms, stats.scored, stats.postings);
+    return rc;
+}
+
+int indexer_search_phrase(Indexer* idx, const char* const* terms, size_t num_terms, uint32_t slop,
+                          const char** doc_ids, size_t max_docs, size_t* count, IndexPin* pin) {
+    if (count) *count = 0;
+    if (pin) pin->snapshot = NULL;
+    if (!idx || !terms || !doc_ids || max_docs == 0) {
+        ERROR_LOG("Invalid arguments: idx=%p, terms=%p, doc_ids=%p, max_docs=%zu",
+                 (void*)idx, (void*)terms, (void*)doc_ids, max_docs);
+        return EINVAL;
+    }
+
+    IndexSnapshot* snap = snapshot_pin(idx);
+    int rc = snap->da ? ENOTSUP
+                      : phrase_search(snap->trie, terms, num_terms, slop, doc_ids, max_docs, count, NULL);
+    pin_or_release(snap, pin, rc);
+    return rc;
+}
+
+int indexer_complete(Indexer* idx, const char* prefix, CompletionResult* results,
+                     size_t k, size_t* count) {
+    if (count) *count = 0;
+    if (!idx || !prefix || !results || k == 0) {
+        ERROR_LOG("Invalid arguments: idx=%p, prefix=%p, results=%p, k=%zu",
+                 (void*)idx, (void*)prefix, (void*)results, k);
+        return EINVAL;
+    }
+
+    Completion* completions = malloc(k * sizeof(Completion));
+    if (!completions) return ENOMEM;
+
+    size_t n = 0;
+    IndexSnapshot* snap = snapshot_pin(idx);
+    int rc = snap->da ? ENOTSUP : gtrie_complete(snap->trie, prefix, completions, k, &n);
+    for (size_t i = 0; i < n; i++) {
+        memset(&results[i], 0, sizeof(results[i]));
+        results[i].key = completions[i].word;
+        results[i].weight = completions[i].weight;
+        cursor_attach(&results[i].cursor, snap, completions[i].postings);
+    }
+    snapshot_release(snap);
+
+    free(completions);
+    if (count) *count = n;
+    return rc;
+}
+
 void search_results_free(SearchResult* results) {
     while (results) {
         SearchResult* next = results->next;
@@ -149,13 +932,83 @@ void search_results_free(SearchResult* results) {
 }
 
 size_t indexer_get_doc_count(const Indexer* idx) {
-    return idx ? idx->trie->doc_count : 0;
+    if (!idx) return 0;
+    IndexSnapshot* snap = snapshot_pin((Indexer*)idx);
+    size_t count = snap->da ? double_array_posting_count(snap->da) : snap->trie->doc_count;
+    snapshot_release(snap);
+    return count;
 }
 
 size_t indexer_get_key_count(const Indexer* idx) {
-    return idx ? idx->trie->total_words : 0;
+    if (!idx) return 0;
+    IndexSnapshot* snap = snapshot_pin((Indexer*)idx);
+    size_t count = snap->da ? double_array_key_count(snap->da) : snap->trie->total_words;
+    snapshot_release(snap);
+    return count;
+}
+
+int indexer_get_trie_stats(const Indexer* idx, GTrieStats* stats) {
+    if (!idx || !stats) {
+        ERROR_LOG("Invalid arguments: idx=%p, stats=%p", (void*)idx, (void*)stats);
+        return EINVAL;
+    }
+    IndexSnapshot* snap = snapshot_pin((Indexer*)idx);
+    int rc = snap->da ? ENOTSUP : gtrie_stats(snap->trie, stats);
+    snapshot_release(snap);
+    return rc;
 }
 
 time_t indexer_get_timestamp(const Indexer* idx) {
-    return idx ? idx->timestamp : 0;
+    if (!idx) return 0;
+    IndexSnapshot* snap = snapshot_pin((Indexer*)idx);
+    time_t timestamp = snap->timestamp;
+    snapshot_release(snap);
+    return timestamp;
+}
+
+uint64_t indexer_get_generation(const Indexer* idx) {
+    if (!idx) return 0;
+    IndexSnapshot* snap = snapshot_pin((Indexer*)idx);
+    uint64_t generation = __atomic_load_n(&snap->generation, __ATOMIC_ACQUIRE);
+    snapshot_release(snap);
+    return generation;
+}
+
+int indexer_enable_freeze(Indexer* idx, bool enabled) {
+    if (!idx) {
+        ERROR_LOG("Invalid arguments: idx=%p", (void*)idx);
+        return EINVAL;
+    }
+    idx->freeze = enabled;
+    return 0;
+}
+
+int indexer_enable_cache(Indexer* idx, size_t max_bytes) {
+    if (!idx) {
+        ERROR_LOG("Invalid arguments: idx=%p", (void*)idx);
+        return EINVAL;
+    }
+
+    query_cache_destroy(idx->cache);
+    idx->cache = NULL;
+    if (max_bytes == 0) {
+        DEBUG_LOG("Result cache disabled");
+        return 0;
+    }
+
+    int err = 0;
+    idx->cache = query_cache_create(max_bytes, &err);
+    if (!idx->cache) {
+        ERROR_LOG("Failed to create result cache: %s", strerror(err));
+        return err;
+    }
+
+    INFO_LOG("Enabled result cache (%zu bytes)", max_bytes);
+    return 0;
+}
+
+int indexer_get_cache_stats(const Indexer* idx, QueryCacheStats* stats) {
+    if (!idx || !stats) return EINVAL;
+    query_cache_get_stats(idx->cache, stats);
+    return idx->cache ? 0 : ENOENT;
 } 
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "key_filter.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#define KEY_FILTER_WORDS (KEY_FILTER_BLOCK_BYTES / sizeof(uint32_t))
+
+struct KeyFilter {
+    uint32_t* blocks;
+    size_t num_blocks;
+};
+
+// Odd multipliers picking one bit per word (as in Parquet's split-block filter)
+static const uint32_t salts[KEY_FILTER_WORDS] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+// Finish the path hash so that every output bit depends on every slot
+static uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+KeyFilter* key_filter_create_blocks(size_t num_blocks, int* err) {
+    if (num_blocks == 0 || num_blocks > UINT32_MAX) {
+        if (err) *err = EINVAL;
+        return NULL;
+    }
+
+    KeyFilter* filter = malloc(sizeof(KeyFilter));
+    void* blocks = NULL;
+    if (!filter || posix_memalign(&blocks, 64, num_blocks * KEY_FILTER_BLOCK_BYTES) != 0) {
+        free(filter);
+        if (err) *err = ENOMEM;
+        return NULL;
+    }
+    memset(blocks, 0, num_blocks * KEY_FILTER_BLOCK_BYTES);
+    filter->blocks = blocks;
+    filter->num_blocks = num_blocks;
+
+    if (err) *err = 0;
+    return filter;
+}
+
+KeyFilter* key_filter_create(size_t expected_keys, int* err) {
+    size_t bits = expected_keys * KEY_FILTER_BITS_PER_KEY;
+    size_t num_blocks = (bits + KEY_FILTER_BLOCK_BYTES * 8 - 1) / (KEY_FILTER_BLOCK_BYTES * 8);
+    return key_filter_create_blocks(num_blocks ? num_blocks : 1, err);
+}
+
+void key_filter_destroy(KeyFilter* filter) {
+    if (!filter) return;
+    free(filter->blocks);
+    free(filter);
+}
+
+static uint32_t* block_of(const KeyFilter* filter, uint64_t h) {
+    // Multiply-shift maps the high half onto [0, num_blocks) without a division
+    size_t block = (size_t)(((h >> 32) * filter->num_blocks) >> 32);
+    return filter->blocks + block * KEY_FILTER_WORDS;
+}
+
+void key_filter_add(KeyFilter* filter, uint64_t path_hash) {
+    if (!filter) return;
+    uint64_t h = mix(path_hash);
+    uint32_t* block = block_of(filter, h);
+    for (size_t i = 0; i < KEY_FILTER_WORDS; i++) {
+        block[i] |= 1U << (((uint32_t)h * salts[i]) >> 27);
+    }
+}
+
+bool key_filter_may_contain(const KeyFilter* filter, uint64_t path_hash) {
+    if (!filter) return true;
+    uint64_t h = mix(path_hash);
+    const uint32_t* block = block_of(filter, h);
+    for (size_t i = 0; i < KEY_FILTER_WORDS; i++) {
+        if (!(block[i] & (1U << (((uint32_t)h * salts[i]) >> 27)))) return false;
+    }
+    return true;
+}
+
+size_t key_filter_blocks(const KeyFilter* filter) {
+    return filter ? filter->num_blocks : 0;
+}
+
+void* key_filter_data(KeyFilter* filter) {
+    return filter ? filter->blocks : NULL;
+}
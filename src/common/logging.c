@@ -3,26 +3,84 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
-#include <sys/time.h>
 #include <syslog.h>
 #include <pthread.h>
+#include <sched.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#define LOG_LINE_MAX 4608           // Prefix plus a 4 KiB message
+#define LOG_RATE_SLOTS 1024         // Call sites hash into these; collisions share a budget
+#define LOG_BLOCK_WAIT_NS 50000     // Producer back-off while its ring is full
+#define LOG_IOV_BATCH 64
+
+// Header of a queued line; the line follows without its terminating NUL
+typedef struct {
+    uint32_t len;
+    uint16_t level;
+    uint16_t body;          // Offset of "[LEVEL]"; syslog adds its own timestamp
+} LogRecord;
+
+// Single-producer single-consumer byte ring; head and tail only grow
+typedef struct LogRing {
+    uint64_t tail;          // Written by the owning thread
+    char pad1[56];
+    uint64_t head;          // Written by the writer thread
+    char pad2[56];
+    uint64_t dropped;       // Owning thread only
+    int pushing;            // Owning thread is between its async check and publishing
+    char* data;
+    size_t size;            // Power of two
+    int in_use;             // Claimed by a live thread
+    struct LogRing* next;   // Rings are never freed, so the writer needs no lock
+} LogRing;
+
+typedef struct {
+    uint64_t window;        // Second << 32 | messages logged in that second
+    uint64_t suppressed;    // Held back since the last message that got through
+} RateSlot;
 
 static struct {
     LogLevel level;
     int destinations;
-    FILE* log_file;
+    int log_fd;
     char* app_name;
-    pthread_mutex_t mutex;
+    pthread_mutex_t mutex;  // Guards log_fd against log_set_file
     bool initialized;
+    unsigned rate_limit;
+    uint64_t suppressed;
+    // Async backend
+    bool async;
+    bool stop;
+    size_t ring_bytes;
+    LogOverflowPolicy policy;
+    pthread_t writer;
+    LogRing* rings;
+    pthread_key_t ring_key;
+    bool writer_sleeping;   // Producers signal wake only while this is set
+    pthread_mutex_t wake_lock;
+    pthread_cond_t wake;
 } log_ctx = {
     .level = LOG_LEVEL_DEBUG,
     .destinations = LOG_DEST_STDERR,
-    .log_file = NULL,
+    .log_fd = -1,
     .app_name = NULL,
-    .initialized = false
+    .initialized = false,
+    .rate_limit = LOG_DEFAULT_RATE_LIMIT,
+    .wake_lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER
 };
 
+static RateSlot rate_slots[LOG_RATE_SLOTS];
+static pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+static __thread LogRing* local_ring;
+
+// Timestamp prefix, reformatted only when the second changes
+static __thread time_t cached_second = -1;
+static __thread char cached_timestamp[32];
+
 static const char* level_strings[] = {
     "ERROR",
     "WARN ",
@@ -50,7 +108,7 @@ int log_init(const char* app_name, LogLevel level, int destinations) {
 
     log_ctx.level = level;
     log_ctx.destinations = destinations;
-    
+
     if (app_name) {
         log_ctx.app_name = strdup(app_name);
     }
@@ -68,79 +126,407 @@ int log_set_file(const char* filepath) {
         return EINVAL;
     }
 
+    int fd = open(filepath, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return errno;
+    }
+
     pthread_mutex_lock(&log_ctx.mutex);
+    if (log_ctx.log_fd >= 0) {
+        close(log_ctx.log_fd);
+    }
+    log_ctx.log_fd = fd;
+    pthread_mutex_unlock(&log_ctx.mutex);
+    return 0;
+}
+
+void log_set_level(LogLevel level) {
+    __atomic_store_n(&log_ctx.level, level, __ATOMIC_RELAXED);
+}
+
+void log_set_rate_limit(unsigned per_second) {
+    __atomic_store_n(&log_ctx.rate_limit, per_second, __ATOMIC_RELAXED);
+}
+
+void log_get_stats(LogStats* stats) {
+    if (!stats) return;
+    stats->suppressed = __atomic_load_n(&log_ctx.suppressed, __ATOMIC_RELAXED);
+    stats->dropped = 0;
+    for (LogRing* r = __atomic_load_n(&log_ctx.rings, __ATOMIC_ACQUIRE); r; r = r->next) {
+        stats->dropped += __atomic_load_n(&r->dropped, __ATOMIC_RELAXED);
+    }
+}
+
+// Admit at most rate_limit messages per second from one call site
+static bool rate_admit(const char* file, int line, time_t now, uint64_t* suppressed) {
+    *suppressed = 0;
+    unsigned limit = __atomic_load_n(&log_ctx.rate_limit, __ATOMIC_RELAXED);
+    if (limit == 0) return true;
+
+    uint64_t site = ((uintptr_t)file ^ ((uint64_t)line * 0x9E3779B97F4A7C15ULL)) * 0xff51afd7ed558ccdULL;
+    RateSlot* slot = &rate_slots[(site >> 32) % LOG_RATE_SLOTS];
+    uint64_t second = (uint64_t)now & 0xFFFFFFFFu;
+
+    uint64_t state = __atomic_load_n(&slot->window, __ATOMIC_RELAXED);
+    for (;;) {
+        uint64_t next;
+        if ((state >> 32) != second) {
+            next = (second << 32) | 1;
+        } else if ((uint32_t)state < limit) {
+            next = state + 1;
+        } else {
+            __atomic_fetch_add(&slot->suppressed, 1, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&log_ctx.suppressed, 1, __ATOMIC_RELAXED);
+            return false;
+        }
+        if (__atomic_compare_exchange_n(&slot->window, &state, next, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+    if (__atomic_load_n(&slot->suppressed, __ATOMIC_RELAXED)) {
+        *suppressed = __atomic_exchange_n(&slot->suppressed, 0, __ATOMIC_RELAXED);
+    }
+    return true;
+}
+
+static const char* timestamp_prefix(time_t second) {
+    if (second != cached_second) {
+        struct tm tm_info;
+        localtime_r(&second, &tm_info);
+        strftime(cached_timestamp, sizeof(cached_timestamp), "%Y-%m-%d %H:%M:%S", &tm_info);
+        cached_second = second;
+    }
+    return cached_timestamp;
+}
+
+static size_t clamp_len(int n, size_t avail) {
+    if (n < 0) return 0;
+    return (size_t)n < avail ? (size_t)n : avail - 1;
+}
+
+// Format one complete line ending in '\n'; returns its length
+static size_t format_line(char* buf, const struct timespec* now, LogLevel level, const char* file,
+                          const char* func, int line, uint64_t suppressed, size_t* body,
+                          const char* fmt, va_list args) {
+    size_t avail = LOG_LINE_MAX - 1;  // Room for the newline
+    size_t len = clamp_len(snprintf(buf, avail, "%s.%06ld ", timestamp_prefix(now->tv_sec),
+                                    now->tv_nsec / 1000), avail);
+    *body = len;
+    len += clamp_len(snprintf(buf + len, avail - len, "[%s] %s:%d %s(): ",
+                              level_strings[level], file, line, func), avail - len);
+    len += clamp_len(vsnprintf(buf + len, avail - len, fmt, args), avail - len);
+    if (suppressed) {
+        len += clamp_len(snprintf(buf + len, avail - len, " (%llu similar messages suppressed)",
+                                  (unsigned long long)suppressed), avail - len);
+    }
+    buf[len++] = '\n';
+    return len;
+}
 
-    if (log_ctx.log_file) {
-        fclose(log_ctx.log_file);
-        log_ctx.log_file = NULL;
+static void write_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        data += n;
+        len -= (size_t)n;
     }
+}
 
-    log_ctx.log_file = fopen(filepath, "a");
-    if (!log_ctx.log_file) {
-        int err = errno;
+static void write_sync(LogLevel level, const char* line, size_t len, size_t body) {
+    if (log_ctx.destinations & LOG_DEST_STDERR) {
+        write_all(STDERR_FILENO, line, len);
+    }
+    if (log_ctx.destinations & LOG_DEST_FILE) {
+        pthread_mutex_lock(&log_ctx.mutex);
+        if (log_ctx.log_fd >= 0) write_all(log_ctx.log_fd, line, len);
         pthread_mutex_unlock(&log_ctx.mutex);
-        return err;
     }
+    if (log_ctx.destinations & LOG_DEST_SYSLOG) {
+        syslog(level_to_syslog[level], "%.*s", (int)(len - body - 1), line + body);
+    }
+}
 
-    // Enable line buffering for the log file
-    setvbuf(log_ctx.log_file, NULL, _IOLBF, 0);
+static void release_ring(void* ring) {
+    __atomic_store_n(&((LogRing*)ring)->in_use, 0, __ATOMIC_RELEASE);
+}
 
-    pthread_mutex_unlock(&log_ctx.mutex);
-    return 0;
+static void create_ring_key(void) {
+    pthread_key_create(&log_ctx.ring_key, release_ring);
 }
 
-void log_set_level(LogLevel level) {
-    pthread_mutex_lock(&log_ctx.mutex);
-    log_ctx.level = level;
-    pthread_mutex_unlock(&log_ctx.mutex);
+// This thread's ring; an exited thread's ring is reused with its backlog
+static LogRing* claim_ring(void) {
+    pthread_once(&ring_key_once, create_ring_key);
+
+    LogRing* ring = __atomic_load_n(&log_ctx.rings, __ATOMIC_ACQUIRE);
+    for (; ring; ring = ring->next) {
+        int expected = 0;
+        if (ring->size == log_ctx.ring_bytes &&
+            __atomic_compare_exchange_n(&ring->in_use, &expected, 1, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+    if (!ring) {
+        ring = calloc(1, sizeof(LogRing));
+        char* data = malloc(log_ctx.ring_bytes);
+        if (!ring || !data) {
+            free(ring);
+            free(data);
+            return NULL;
+        }
+        ring->data = data;
+        ring->size = log_ctx.ring_bytes;
+        ring->in_use = 1;
+        ring->next = __atomic_load_n(&log_ctx.rings, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&log_ctx.rings, &ring->next, ring, true,
+                                            __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        }
+    }
+    pthread_setspecific(log_ctx.ring_key, ring);
+    local_ring = ring;
+    return ring;
 }
 
-void _log_write(LogLevel level, const char* file, const char* func, 
-                int line, const char* fmt, ...) {
-    if (!log_ctx.initialized || level > log_ctx.level) {
-        return;
+static void ring_copy_in(LogRing* r, uint64_t pos, const void* src, size_t len) {
+    size_t offset = pos & (r->size - 1);
+    size_t first = len < r->size - offset ? len : r->size - offset;
+    memcpy(r->data + offset, src, first);
+    memcpy(r->data, (const char*)src + first, len - first);
+}
+
+static void ring_copy_out(const LogRing* r, uint64_t pos, void* dst, size_t len) {
+    size_t offset = pos & (r->size - 1);
+    size_t first = len < r->size - offset ? len : r->size - offset;
+    memcpy(dst, r->data + offset, first);
+    memcpy((char*)dst + first, r->data, len - first);
+}
+
+static void wake_writer(void) {
+    pthread_mutex_lock(&log_ctx.wake_lock);
+    pthread_cond_signal(&log_ctx.wake);
+    pthread_mutex_unlock(&log_ctx.wake_lock);
+}
+
+// Queue a line; false when it must be written synchronously instead.
+// pushing is raised before async is checked, so once log_cleanup has cleared
+// async and seen pushing drop, no line can land behind the writer's last drain.
+static bool ring_push(LogLevel level, const char* line, size_t len, size_t body) {
+    LogRing* r = local_ring ? local_ring : claim_ring();
+    if (!r) return false;
+
+    __atomic_store_n(&r->pushing, 1, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&log_ctx.async, __ATOMIC_SEQ_CST)) {
+        __atomic_store_n(&r->pushing, 0, __ATOMIC_RELEASE);
+        return false;
     }
 
-    pthread_mutex_lock(&log_ctx.mutex);
+    LogRecord rec = { .len = (uint32_t)len, .level = (uint16_t)level, .body = (uint16_t)body };
+    size_t need = sizeof(rec) + len;
+    uint64_t tail = r->tail;
+    while (tail + need - __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) > r->size) {
+        if (log_ctx.policy == LOG_OVERFLOW_DROP || need > r->size) {
+            __atomic_store_n(&r->dropped, r->dropped + 1, __ATOMIC_RELAXED);
+            __atomic_store_n(&r->pushing, 0, __ATOMIC_RELEASE);
+            return true;
+        }
+        if (!__atomic_load_n(&log_ctx.async, __ATOMIC_ACQUIRE)) {
+            __atomic_store_n(&r->pushing, 0, __ATOMIC_RELEASE);
+            return false;
+        }
+        struct timespec wait = { 0, LOG_BLOCK_WAIT_NS };
+        nanosleep(&wait, NULL);
+    }
 
-    // Get current time with microsecond precision
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    
-    struct tm* tm_info = localtime(&tv.tv_sec);
-    char timestamp[32];
-    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", tm_info);
+    ring_copy_in(r, tail, &rec, sizeof(rec));
+    ring_copy_in(r, tail + sizeof(rec), line, len);
+    __atomic_store_n(&r->tail, tail + need, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&r->pushing, 0, __ATOMIC_RELEASE);
 
-    // Format the message
-    va_list args;
-    va_start(args, fmt);
-    char msg_buf[4096];
-    vsnprintf(msg_buf, sizeof(msg_buf), fmt, args);
-    va_end(args);
+    // Pairs with writer_idle: either it sees the new tail or we see it asleep
+    if (__atomic_load_n(&log_ctx.writer_sleeping, __ATOMIC_SEQ_CST)) wake_writer();
+    return true;
+}
 
-    // Write to stderr if enabled
+static void write_batch(const struct iovec* iov, int count) {
+    if (count == 0) return;
     if (log_ctx.destinations & LOG_DEST_STDERR) {
-        fprintf(stderr, "%s.%06ld [%s] %s:%d %s(): %s\n",
-                timestamp, tv.tv_usec, level_strings[level],
-                file, line, func, msg_buf);
-        fflush(stderr);
+        // Short writes are rare for stderr; finish them piecewise
+        ssize_t n = writev(STDERR_FILENO, iov, count);
+        for (int i = 0; i < count && n >= 0; i++) {
+            if ((size_t)n >= iov[i].iov_len) {
+                n -= (ssize_t)iov[i].iov_len;
+            } else {
+                write_all(STDERR_FILENO, (const char*)iov[i].iov_base + n, iov[i].iov_len - (size_t)n);
+                n = 0;
+            }
+        }
     }
+    if (log_ctx.destinations & LOG_DEST_FILE) {
+        pthread_mutex_lock(&log_ctx.mutex);
+        if (log_ctx.log_fd >= 0) {
+            for (int i = 0; i < count; i++) write_all(log_ctx.log_fd, iov[i].iov_base, iov[i].iov_len);
+        }
+        pthread_mutex_unlock(&log_ctx.mutex);
+    }
+}
+
+// Write everything queued in r; returns the number of lines
+static size_t drain_ring(LogRing* r) {
+    uint64_t head = r->head;
+    uint64_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+    struct iovec iov[LOG_IOV_BATCH];
+    int count = 0;
+    size_t lines = 0;
+
+    while (head < tail) {
+        LogRecord rec;
+        ring_copy_out(r, head, &rec, sizeof(rec));
+        uint64_t start = head + sizeof(rec);
+        size_t offset = start & (r->size - 1);
+        size_t first = rec.len < r->size - offset ? rec.len : r->size - offset;
 
-    // Write to file if enabled
-    if ((log_ctx.destinations & LOG_DEST_FILE) && log_ctx.log_file) {
-        fprintf(log_ctx.log_file, "%s.%06ld [%s] %s:%d %s(): %s\n",
-                timestamp, tv.tv_usec, level_strings[level],
-                file, line, func, msg_buf);
-        fflush(log_ctx.log_file);
+        if (count + 2 > LOG_IOV_BATCH) {
+            write_batch(iov, count);
+            __atomic_store_n(&r->head, head, __ATOMIC_RELEASE);
+            count = 0;
+        }
+        iov[count++] = (struct iovec){ r->data + offset, first };
+        if (first < rec.len) iov[count++] = (struct iovec){ r->data, rec.len - first };
+
+        if (log_ctx.destinations & LOG_DEST_SYSLOG) {
+            char line[LOG_LINE_MAX];
+            ring_copy_out(r, start, line, rec.len);
+            syslog(level_to_syslog[rec.level], "%.*s", (int)(rec.len - rec.body - 1), line + rec.body);
+        }
+        head = start + rec.len;
+        lines++;
     }
+    write_batch(iov, count);
+    __atomic_store_n(&r->head, head, __ATOMIC_RELEASE);
+    return lines;
+}
 
-    // Write to syslog if enabled
-    if (log_ctx.destinations & LOG_DEST_SYSLOG) {
-        syslog(level_to_syslog[level], "[%s] %s:%d %s(): %s",
-               level_strings[level], file, line, func, msg_buf);
+static bool rings_empty(void) {
+    for (LogRing* r = __atomic_load_n(&log_ctx.rings, __ATOMIC_SEQ_CST); r; r = r->next) {
+        if (__atomic_load_n(&r->head, __ATOMIC_RELAXED) < __atomic_load_n(&r->tail, __ATOMIC_SEQ_CST)) {
+            return false;
+        }
     }
+    return true;
+}
 
-    pthread_mutex_unlock(&log_ctx.mutex);
+// Sleep until a producer queues a line or log_cleanup stops the writer
+static void writer_idle(void) {
+    pthread_mutex_lock(&log_ctx.wake_lock);
+    __atomic_store_n(&log_ctx.writer_sleeping, true, __ATOMIC_SEQ_CST);
+    while (!__atomic_load_n(&log_ctx.stop, __ATOMIC_SEQ_CST) && rings_empty()) {
+        pthread_cond_wait(&log_ctx.wake, &log_ctx.wake_lock);
+    }
+    __atomic_store_n(&log_ctx.writer_sleeping, false, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&log_ctx.wake_lock);
+}
+
+static void* writer_thread(void* arg) {
+    (void)arg;
+    LogStats stats;
+    log_get_stats(&stats);
+    uint64_t reported_drops = stats.dropped;  // Earlier sessions reported theirs
+    for (;;) {
+        bool stopping = __atomic_load_n(&log_ctx.stop, __ATOMIC_ACQUIRE);
+        size_t lines = 0;
+        uint64_t drops = 0;
+        for (LogRing* r = __atomic_load_n(&log_ctx.rings, __ATOMIC_ACQUIRE); r; r = r->next) {
+            lines += drain_ring(r);
+            drops += __atomic_load_n(&r->dropped, __ATOMIC_RELAXED);
+        }
+        if (drops > reported_drops) {
+            char line[128];
+            struct timespec now;
+            clock_gettime(CLOCK_REALTIME, &now);
+            int len = snprintf(line, sizeof(line), "%s.%06ld [WARN ] %llu log messages dropped, ring full\n",
+                               timestamp_prefix(now.tv_sec), now.tv_nsec / 1000,
+                               (unsigned long long)(drops - reported_drops));
+            struct iovec iov = { line, (size_t)len };
+            write_batch(&iov, 1);
+            reported_drops = drops;
+        }
+        if (stopping) break;
+        if (lines == 0) writer_idle();
+    }
+    return NULL;
+}
+
+static void flush_at_exit(void) {
+    log_flush();
+}
+
+int log_start_async(size_t ring_bytes, LogOverflowPolicy policy) {
+    if (!log_ctx.initialized) {
+        return EINVAL;
+    }
+    if (log_ctx.async) {
+        return 0;
+    }
+
+    size_t size = LOG_RING_MIN_BYTES;
+    while (size < ring_bytes) size <<= 1;
+    log_ctx.ring_bytes = size;
+    log_ctx.policy = policy;
+    log_ctx.stop = false;
+
+    int rc = pthread_create(&log_ctx.writer, NULL, writer_thread, NULL);
+    if (rc != 0) {
+        return rc;
+    }
+    __atomic_store_n(&log_ctx.async, true, __ATOMIC_RELEASE);
+
+    static bool registered = false;
+    if (!registered) {
+        atexit(flush_at_exit);
+        registered = true;
+    }
+    return 0;
+}
+
+void log_flush(void) {
+    if (!__atomic_load_n(&log_ctx.async, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    for (LogRing* r = __atomic_load_n(&log_ctx.rings, __ATOMIC_ACQUIRE); r; r = r->next) {
+        while (__atomic_load_n(&r->head, __ATOMIC_ACQUIRE) < __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE)) {
+            struct timespec wait = { 0, LOG_BLOCK_WAIT_NS };
+            nanosleep(&wait, NULL);
+        }
+    }
+}
+
+void _log_write(LogLevel level, const char* file, const char* func,
+                int line, const char* fmt, ...) {
+    if (!log_ctx.initialized || level > __atomic_load_n(&log_ctx.level, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    uint64_t suppressed;
+    if (!rate_admit(file, line, now.tv_sec, &suppressed)) {
+        return;
+    }
+
+    char buf[LOG_LINE_MAX];
+    size_t body;
+    va_list args;
+    va_start(args, fmt);
+    size_t len = format_line(buf, &now, level, file, func, line, suppressed, &body, fmt, args);
+    va_end(args);
+
+    if (__atomic_load_n(&log_ctx.async, __ATOMIC_ACQUIRE) && ring_push(level, buf, len, body)) {
+        return;
+    }
+    write_sync(level, buf, len, body);
 }
 
 void log_cleanup(void) {
@@ -148,22 +534,31 @@ void log_cleanup(void) {
         return;
     }
 
-    pthread_mutex_lock(&log_ctx.mutex);
+    // New messages go out synchronously. Wait out pushes that saw async
+    // still set, so the writer's last drain finds every queued line.
+    if (log_ctx.async) {
+        __atomic_store_n(&log_ctx.async, false, __ATOMIC_SEQ_CST);
+        for (LogRing* r = __atomic_load_n(&log_ctx.rings, __ATOMIC_SEQ_CST); r; r = r->next) {
+            while (__atomic_load_n(&r->pushing, __ATOMIC_ACQUIRE)) sched_yield();
+        }
+        __atomic_store_n(&log_ctx.stop, true, __ATOMIC_SEQ_CST);
+        wake_writer();
+        pthread_join(log_ctx.writer, NULL);
+    }
 
     if (log_ctx.destinations & LOG_DEST_SYSLOG) {
         closelog();
     }
 
-    if (log_ctx.log_file) {
-        fclose(log_ctx.log_file);
-        log_ctx.log_file = NULL;
+    if (log_ctx.log_fd >= 0) {
+        close(log_ctx.log_fd);
+        log_ctx.log_fd = -1;
     }
 
     free(log_ctx.app_name);
     log_ctx.app_name = NULL;
 
-    pthread_mutex_unlock(&log_ctx.mutex);
     pthread_mutex_destroy(&log_ctx.mutex);
 
     log_ctx.initialized = false;
-} 
\ No newline at end of file
+}
@@ -0,0 +1,292 @@
+#include "metrics.h"
+#include "logging.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+
+// One thread's counters; only the owning thread writes them
+typedef struct MetricsShard {
+    MetricsHistogram ops[METRIC_OP_COUNT];
+    int in_use;                 // Claimed by a live thread
+    struct MetricsShard* next;  // Shards are never freed, so readers need no lock
+} MetricsShard;
+
+static MetricsShard* shards;
+static pthread_key_t shard_key;
+static pthread_once_t shard_key_once = PTHREAD_ONCE_INIT;
+static __thread MetricsShard* local_shard;
+static __thread uint32_t sample_tick;
+
+static const char* const op_names[METRIC_OP_COUNT] = {
+    "gtrie_insert",
+    "gtrie_search",
+    "indexer_search",
+    "gtrie_save",
+    "gtrie_load",
+};
+
+const char* metrics_op_name(MetricOp op) {
+    return op < METRIC_OP_COUNT ? op_names[op] : "unknown";
+}
+
+uint64_t metrics_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Exiting threads hand their shard, counts included, to the next new thread
+static void release_shard(void* shard) {
+    __atomic_store_n(&((MetricsShard*)shard)->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void create_shard_key(void) {
+    pthread_key_create(&shard_key, release_shard);
+}
+
+static MetricsShard* claim_shard(void) {
+    pthread_once(&shard_key_once, create_shard_key);
+
+    MetricsShard* shard = __atomic_load_n(&shards, __ATOMIC_ACQUIRE);
+    for (; shard; shard = shard->next) {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&shard->in_use, &expected, 1, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+    if (!shard) {
+        shard = calloc(1, sizeof(MetricsShard));
+        if (!shard) return NULL;
+        shard->in_use = 1;
+        shard->next = __atomic_load_n(&shards, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&shards, &shard->next, shard, true,
+                                            __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        }
+    }
+    pthread_setspecific(shard_key, shard);
+    local_shard = shard;
+    return shard;
+}
+
+static size_t bucket_of(uint64_t ns) {
+    if (ns < (1u << METRICS_SUB_BITS)) return (size_t)ns;
+    size_t exp = 63 - (size_t)__builtin_clzll(ns);
+    if (exp >= METRICS_MAX_EXP) return METRICS_BUCKETS - 1;
+    size_t sub = (size_t)(ns >> (exp - METRICS_SUB_BITS)) & ((1u << METRICS_SUB_BITS) - 1);
+    return ((exp - METRICS_SUB_BITS + 1) << METRICS_SUB_BITS) + sub;
+}
+
+// Largest value that falls into bucket
+static uint64_t bucket_limit(size_t bucket) {
+    if (bucket < (1u << METRICS_SUB_BITS)) return bucket;
+    size_t exp = (bucket >> METRICS_SUB_BITS) + METRICS_SUB_BITS - 1;
+    uint64_t sub = bucket & ((1u << METRICS_SUB_BITS) - 1);
+    uint64_t width = 1ULL << (exp - METRICS_SUB_BITS);
+    return (((1ULL << METRICS_SUB_BITS) + sub) << (exp - METRICS_SUB_BITS)) + width - 1;
+}
+
+// Single writer: a relaxed load and store is enough, and avoids a locked add
+static inline void bump(uint64_t* counter, uint64_t n) {
+    __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + n, __ATOMIC_RELAXED);
+}
+
+static inline MetricsHistogram* local_histogram(MetricOp op) {
+    if (op >= METRIC_OP_COUNT) return NULL;
+    MetricsShard* shard = local_shard ? local_shard : claim_shard();
+    return shard ? &shard->ops[op] : NULL;
+}
+
+static void record_sample(MetricsHistogram* hist, uint64_t ns) {
+    bump(&hist->samples, 1);
+    bump(&hist->sum_ns, ns);
+    if (ns > __atomic_load_n(&hist->max_ns, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&hist->max_ns, ns, __ATOMIC_RELAXED);
+    }
+    bump(&hist->buckets[bucket_of(ns)], 1);
+}
+
+void metrics_record(MetricOp op, uint64_t ns, bool failed) {
+    MetricsHistogram* hist = local_histogram(op);
+    if (!hist) return;
+    bump(&hist->count, 1);
+    if (failed) bump(&hist->errors, 1);
+    record_sample(hist, ns);
+}
+
+uint64_t metrics_sample_start(void) {
+    return (sample_tick++ & (METRICS_SAMPLE_PERIOD - 1)) == 0 ? metrics_now_ns() : 0;
+}
+
+void metrics_sample_stop(MetricOp op, uint64_t start, bool failed) {
+    MetricsHistogram* hist = local_histogram(op);
+    if (!hist) return;
+    bump(&hist->count, 1);
+    if (failed) bump(&hist->errors, 1);
+    if (start) record_sample(hist, metrics_now_ns() - start);
+}
+
+int metrics_snapshot(MetricsSnapshot* snap) {
+    if (!snap) {
+        ERROR_LOG("Invalid arguments: snap=%p", (void*)snap);
+        return EINVAL;
+    }
+
+    memset(snap, 0, sizeof(*snap));
+    for (MetricsShard* shard = __atomic_load_n(&shards, __ATOMIC_ACQUIRE); shard; shard = shard->next) {
+        for (size_t op = 0; op < METRIC_OP_COUNT; op++) {
+            const MetricsHistogram* src = &shard->ops[op];
+            MetricsHistogram* dst = &snap->ops[op];
+            dst->count += __atomic_load_n(&src->count, __ATOMIC_RELAXED);
+            dst->errors += __atomic_load_n(&src->errors, __ATOMIC_RELAXED);
+            dst->samples += __atomic_load_n(&src->samples, __ATOMIC_RELAXED);
+            dst->sum_ns += __atomic_load_n(&src->sum_ns, __ATOMIC_RELAXED);
+            uint64_t max = __atomic_load_n(&src->max_ns, __ATOMIC_RELAXED);
+            if (max > dst->max_ns) dst->max_ns = max;
+            for (size_t b = 0; b < METRICS_BUCKETS; b++) {
+                dst->buckets[b] += __atomic_load_n(&src->buckets[b], __ATOMIC_RELAXED);
+            }
+        }
+    }
+    return 0;
+}
+
+uint64_t metrics_percentile(const MetricsHistogram* hist, double percentile) {
+    if (!hist) return 0;
+
+    // Buckets may lag count slightly in a snapshot taken during recording
+    uint64_t total = 0;
+    for (size_t b = 0; b < METRICS_BUCKETS; b++) total += hist->buckets[b];
+    if (total == 0) return 0;
+
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)total + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > total) rank = total;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < METRICS_BUCKETS; b++) {
+        seen += hist->buckets[b];
+        if (seen >= rank) {
+            if (b == METRICS_BUCKETS - 1) break;  // Unbounded overflow bucket
+            uint64_t limit = bucket_limit(b);
+            return limit < hist->max_ns ? limit : hist->max_ns;
+        }
+    }
+    return hist->max_ns;
+}
+
+static const struct {
+    const char* name;
+    const char* label;
+    double value;
+} quantiles[] = {
+    { "p50_ns", "0.5", 50 },
+    { "p90_ns", "0.9", 90 },
+    { "p99_ns", "0.99", 99 },
+    { "p999_ns", "0.999", 99.9 },
+};
+
+#define NUM_QUANTILES (sizeof(quantiles) / sizeof(quantiles[0]))
+
+static void write_json(FILE* fp, const MetricsSnapshot* snap) {
+    fputc('{', fp);
+    for (size_t op = 0; op < METRIC_OP_COUNT; op++) {
+        const MetricsHistogram* hist = &snap->ops[op];
+        fprintf(fp, "%s\"%s\":{\"count\":%llu,\"errors\":%llu,\"samples\":%llu,"
+                "\"sum_ns\":%llu,\"max_ns\":%llu",
+                op ? "," : "", op_names[op], (unsigned long long)hist->count,
+                (unsigned long long)hist->errors, (unsigned long long)hist->samples,
+                (unsigned long long)hist->sum_ns, (unsigned long long)hist->max_ns);
+        for (size_t q = 0; q < NUM_QUANTILES; q++) {
+            fprintf(fp, ",\"%s\":%llu", quantiles[q].name,
+                    (unsigned long long)metrics_percentile(hist, quantiles[q].value));
+        }
+        fputc('}', fp);
+    }
+    fputs("}\n", fp);
+}
+
+static void write_prometheus(FILE* fp, const MetricsSnapshot* snap) {
+    fputs("# HELP search_engine_op_duration_seconds Latency of index operations.\n"
+          "# TYPE search_engine_op_duration_seconds summary\n", fp);
+    for (size_t op = 0; op < METRIC_OP_COUNT; op++) {
+        const MetricsHistogram* hist = &snap->ops[op];
+        for (size_t q = 0; q < NUM_QUANTILES; q++) {
+            fprintf(fp, "search_engine_op_duration_seconds{op=\"%s\",quantile=\"%s\"} %.9g\n",
+                    op_names[op], quantiles[q].label,
+                    (double)metrics_percentile(hist, quantiles[q].value) / 1e9);
+        }
+        // Scale the timed calls up to all calls
+        double sum = hist->samples ? (double)hist->sum_ns * (double)hist->count / (double)hist->samples : 0;
+        fprintf(fp, "search_engine_op_duration_seconds_sum{op=\"%s\"} %.9g\n",
+                op_names[op], sum / 1e9);
+        fprintf(fp, "search_engine_op_duration_seconds_count{op=\"%s\"} %llu\n",
+                op_names[op], (unsigned long long)hist->count);
+    }
+    fputs("# HELP search_engine_op_errors_total Index operations that failed.\n"
+          "# TYPE search_engine_op_errors_total counter\n", fp);
+    for (size_t op = 0; op < METRIC_OP_COUNT; op++) {
+        fprintf(fp, "search_engine_op_errors_total{op=\"%s\"} %llu\n",
+                op_names[op], (unsigned long long)snap->ops[op].errors);
+    }
+}
+
+int metrics_write(FILE* fp, MetricsFormat format) {
+    if (!fp) {
+        ERROR_LOG("Invalid arguments: fp=%p", (void*)fp);
+        return EINVAL;
+    }
+
+    MetricsSnapshot* snap = malloc(sizeof(MetricsSnapshot));
+    if (!snap) return ENOMEM;
+    metrics_snapshot(snap);
+    if (format == METRICS_FORMAT_PROMETHEUS) {
+        write_prometheus(fp, snap);
+    } else {
+        write_json(fp, snap);
+    }
+    free(snap);
+    return fflush(fp) == 0 && !ferror(fp) ? 0 : EIO;
+}
+
+typedef struct {
+    sigset_t signals;
+    MetricsFormat format;
+    FILE* fp;
+} SignalDumper;
+
+static void* dump_thread(void* arg) {
+    SignalDumper* dumper = arg;
+    int sig;
+    while (sigwait(&dumper->signals, &sig) == 0) {
+        metrics_write(dumper->fp, dumper->format);
+    }
+    free(dumper);
+    return NULL;
+}
+
+int metrics_dump_on_signal(int signo, MetricsFormat format, FILE* fp) {
+    if (!fp || signo <= 0) {
+        ERROR_LOG("Invalid arguments: signo=%d, fp=%p", signo, (void*)fp);
+        return EINVAL;
+    }
+
+    SignalDumper* dumper = malloc(sizeof(SignalDumper));
+    if (!dumper) return ENOMEM;
+    sigemptyset(&dumper->signals);
+    sigaddset(&dumper->signals, signo);
+    dumper->format = format;
+    dumper->fp = fp;
+
+    int rc = pthread_sigmask(SIG_BLOCK, &dumper->signals, NULL);
+    pthread_t thread;
+    if (rc == 0) rc = pthread_create(&thread, NULL, dump_thread, dumper);
+    if (rc != 0) {
+        free(dumper);
+        return rc;
+    }
+    pthread_detach(thread);
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include "node_pool.h"
+#include "placement.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+
+#define NODE_POOL_FIRST_SLAB 16     // Objects in the first slab
+#define NODE_POOL_MAX_SLAB 1024     // Slabs stop doubling here
+
+typedef struct Slab {
+    struct Slab* next;
+    size_t capacity;                // Objects in this slab
+    size_t mapped;                  // Length of a huge-page mapping, 0 when from calloc
+    max_align_t data[];
+} Slab;
+
+struct NodePool {
+    size_t object_size;             // Rounded up to keep objects aligned
+    Slab* slabs;                    // Newest first
+    size_t used;                    // Objects handed out from the newest slab
+    size_t count;
+    size_t bytes;
+    HugePageMode huge_pages;        // Placement of slabs of half a huge page or more
+};
+
+NodePool* node_pool_create(size_t object_size, int* err) {
+    if (object_size == 0) {
+        if (err) *err = EINVAL;
+        return NULL;
+    }
+
+    NodePool* pool = calloc(1, sizeof(NodePool));
+    if (!pool) {
+        if (err) *err = ENOMEM;
+        return NULL;
+    }
+    size_t align = sizeof(max_align_t);
+    pool->object_size = (object_size + align - 1) / align * align;
+    pool->huge_pages = placement_huge_pages();
+
+    if (err) *err = 0;
+    return pool;
+}
+
+void node_pool_destroy(NodePool* pool) {
+    if (!pool) return;
+
+    Slab* slab = pool->slabs;
+    while (slab) {
+        Slab* next = slab->next;
+        if (slab->mapped) {
+            placement_unmap(slab, slab->mapped);
+        } else {
+            free(slab);
+        }
+        slab = next;
+    }
+    free(pool);
+}
+
+// Start a new slab of at least capacity objects; returns 0 or ENOMEM
+static int add_slab(NodePool* pool, size_t capacity) {
+    if (capacity > (SIZE_MAX - sizeof(Slab) - PLACEMENT_HUGE_PAGE) / pool->object_size) return ENOMEM;
+
+    // calloc and fresh mappings keep objects zeroed without a separate memset
+    size_t size = sizeof(Slab) + capacity * pool->object_size;
+    size_t mapped = 0;
+    Slab* slab;
+    if (pool->huge_pages != HUGE_PAGES_OFF && size >= PLACEMENT_HUGE_PAGE / 2) {
+        // Fill whole huge pages so every node of the slab shares their TLB entries
+        slab = placement_map(size, pool->huge_pages, &mapped);
+        if (!slab) return ENOMEM;
+        size = mapped;
+        capacity = (mapped - sizeof(Slab)) / pool->object_size;
+    } else {
+        slab = calloc(1, size);
+        if (!slab) return ENOMEM;
+    }
+    slab->capacity = capacity;
+    slab->mapped = mapped;
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->used = 0;
+    pool->bytes += size;
+    return 0;
+}
+
+void* node_pool_alloc(NodePool* pool) {
+    if (!pool) return NULL;
+
+    if (!pool->slabs || pool->used == pool->slabs->capacity) {
+        size_t capacity = pool->slabs ? pool->slabs->capacity * 2 : NODE_POOL_FIRST_SLAB;
+        if (capacity > NODE_POOL_MAX_SLAB) capacity = NODE_POOL_MAX_SLAB;
+        if (add_slab(pool, capacity) != 0) return NULL;
+    }
+
+    void* object = (char*)pool->slabs->data + pool->used * pool->object_size;
+    pool->used++;
+    pool->count++;
+    return object;
+}
+
+int node_pool_reserve(NodePool* pool, size_t count) {
+    if (!pool) return EINVAL;
+    if (count == 0 || (pool->slabs && pool->slabs->capacity - pool->used >= count)) return 0;
+    // The rest of the current slab is left unused
+    return add_slab(pool, count);
+}
+
+size_t node_pool_count(const NodePool* pool) {
+    return pool ? pool->count : 0;
+}
+
+size_t node_pool_bytes(const NodePool* pool) {
+    return pool ? pool->bytes : 0;
+}
@@ -0,0 +1,864 @@
+#include "pattern.h"
+#include "logging.h"
+#include "utf8.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#define PATTERN_MAX_REPEAT 100          // Largest {m,n} bound
+#define PATTERN_MAX_NFA_STATES 65536
+#define DFA_MAX_STATES 4096
+#define DFA_UNKNOWN -2
+#define DFA_DEAD -1
+#define PATTERN_CLOCK_INTERVAL 1024     // Nodes visited between budget checks
+
+typedef enum {
+    NFA_CLASS,      // Consume one codepoint in class, then go to out
+    NFA_SPLIT,      // Epsilon to out and out1
+    NFA_EPS,        // Epsilon to out
+    NFA_MATCH
+} NfaKind;
+
+typedef struct {
+    NfaKind kind;
+    int out;
+    int out1;
+    int cls;        // Index into the class table for NFA_CLASS
+} NfaState;
+
+typedef struct {
+    uint32_t* ranges;   // Inclusive [lo, hi] pairs
+    size_t count;       // Number of pairs
+    bool negate;
+} CharClass;
+
+typedef struct {
+    int* states;        // Sorted NFA states (NFA_CLASS and NFA_MATCH only)
+    size_t count;
+    bool accepting;
+    int next[ALPHABET_SIZE];
+} DfaState;
+
+struct Pattern {
+    NfaState* nfa;
+    size_t nfa_count;
+    size_t nfa_cap;
+    int start;
+
+    CharClass* classes;
+    size_t class_count;
+    size_t class_cap;
+
+    // Lazy DFA over child slots
+    DfaState* dfa;
+    size_t dfa_count;
+    size_t dfa_cap;
+    int* dfa_slots;         // Open-addressed hash of DFA ids by state set
+    size_t dfa_num_slots;
+
+    // Scratch for closures
+    unsigned* marks;
+    unsigned mark;
+    int* stack;
+    int* set;
+};
+
+typedef struct {
+    int start;
+    int end;        // NFA_EPS whose out is patched by the caller
+} Fragment;
+
+typedef struct {
+    Pattern* p;
+    const char* src;
+    size_t pos;
+    size_t len;
+    int err;
+} Parser;
+
+// ---- NFA construction ----
+
+static int add_state(Pattern* p, NfaKind kind, int out, int out1, int cls) {
+    if (p->nfa_count == p->nfa_cap) {
+        if (p->nfa_cap >= PATTERN_MAX_NFA_STATES) return -1;
+        size_t cap = p->nfa_cap ? p->nfa_cap * 2 : 64;
+        NfaState* grown = realloc(p->nfa, cap * sizeof(NfaState));
+        if (!grown) return -1;
+        p->nfa = grown;
+        p->nfa_cap = cap;
+    }
+    p->nfa[p->nfa_count] = (NfaState){ kind, out, out1, cls };
+    return (int)p->nfa_count++;
+}
+
+static int add_class(Pattern* p, CharClass* cls) {
+    if (p->class_count == p->class_cap) {
+        size_t cap = p->class_cap ? p->class_cap * 2 : 16;
+        CharClass* grown = realloc(p->classes, cap * sizeof(CharClass));
+        if (!grown) return -1;
+        p->classes = grown;
+        p->class_cap = cap;
+    }
+    p->classes[p->class_count] = *cls;
+    return (int)p->class_count++;
+}
+
+static int class_add_range(CharClass* cls, uint32_t lo, uint32_t hi) {
+    uint32_t* grown = realloc(cls->ranges, (cls->count + 1) * 2 * sizeof(uint32_t));
+    if (!grown) return ENOMEM;
+    cls->ranges = grown;
+    cls->ranges[cls->count * 2] = lo;
+    cls->ranges[cls->count * 2 + 1] = hi;
+    cls->count++;
+    return 0;
+}
+
+// Fragment consuming one codepoint from cls (ownership of ranges moves to p)
+static bool class_fragment(Parser* ps, CharClass* cls, Fragment* frag) {
+    int c = add_class(ps->p, cls);
+    if (c < 0) {
+        free(cls->ranges);
+        ps->err = ENOMEM;
+        return false;
+    }
+    int end = add_state(ps->p, NFA_EPS, -1, -1, -1);
+    int start = add_state(ps->p, NFA_CLASS, end, -1, c);
+    if (end < 0 || start < 0) {
+        ps->err = ENOMEM;
+        return false;
+    }
+    *frag = (Fragment){ start, end };
+    return true;
+}
+
+static bool literal_fragment(Parser* ps, uint32_t cp, Fragment* frag) {
+    CharClass cls = { NULL, 0, false };
+    if (class_add_range(&cls, cp, cp) != 0) {
+        ps->err = ENOMEM;
+        return false;
+    }
+    return class_fragment(ps, &cls, frag);
+}
+
+static bool any_fragment(Parser* ps, Fragment* frag) {
+    CharClass cls = { NULL, 0, true };  // Empty negated class matches everything
+    return class_fragment(ps, &cls, frag);
+}
+
+static bool empty_fragment(Parser* ps, Fragment* frag) {
+    int e = add_state(ps->p, NFA_EPS, -1, -1, -1);
+    if (e < 0) {
+        ps->err = ENOMEM;
+        return false;
+    }
+    *frag = (Fragment){ e, e };
+    return true;
+}
+
+static void concat(Parser* ps, Fragment* a, Fragment b) {
+    ps->p->nfa[a->end].out = b.start;
+    a->end = b.end;
+}
+
+static bool star(Parser* ps, Fragment* a) {
+    int end = add_state(ps->p, NFA_EPS, -1, -1, -1);
+    int split = add_state(ps->p, NFA_SPLIT, a->start, end, -1);
+    if (end < 0 || split < 0) {
+        ps->err = ENOMEM;
+        return false;
+    }
+    ps->p->nfa[a->end].out = split;
+    *a = (Fragment){ split, end };
+    return true;
+}
+
+static bool plus(Parser* ps, Fragment* a) {
+    int end = add_state(ps->p, NFA_EPS, -1, -1, -1);
+    int split = add_state(ps->p, NFA_SPLIT, a->start, end, -1);
+    if (end < 0 || split < 0) {
+        ps->err = ENOMEM;
+        return false;
+    }
+    ps->p->nfa[a->end].out = split;
+    a->end = end;
+    return true;
+}
+
+static bool quest(Parser* ps, Fragment* a) {
+    int end = add_state(ps->p, NFA_EPS, -1, -1, -1);
+    int split = add_state(ps->p, NFA_SPLIT, a->start, end, -1);
+    if (end < 0 || split < 0) {
+        ps->err = ENOMEM;
+        return false;
+    }
+    ps->p->nfa[a->end].out = end;
+    *a = (Fragment){ split, end };
+    return true;
+}
+
+static bool next_codepoint(Parser* ps, uint32_t* cp) {
+    int n = utf8_decode_char(ps->src + ps->pos, ps->len - ps->pos, cp);
+    if (n < 0) {
+        ps->err = EINVAL;
+        return false;
+    }
+    ps->pos += (size_t)n;
+    return true;
+}
+
+// Shorthand classes \d \w \s; returns false if ch is not one
+static bool add_shorthand(CharClass* cls, char ch, int* rc) {
+    *rc = 0;
+    switch (ch) {
+        case 'd':
+            *rc = class_add_range(cls, '0', '9');
+            return true;
+        case 'w':
+            if ((*rc = class_add_range(cls, 'a', 'z')) != 0) return true;
+            if ((*rc = class_add_range(cls, 'A', 'Z')) != 0) return true;
+            if ((*rc = class_add_range(cls, '0', '9')) != 0) return true;
+            *rc = class_add_range(cls, '_', '_');
+            return true;
+        case 's':
+            if ((*rc = class_add_range(cls, ' ', ' ')) != 0) return true;
+            *rc = class_add_range(cls, '\t', '\r');
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Bracket expression; the opening '[' has been consumed
+static bool parse_class(Parser* ps, bool regex, Fragment* frag) {
+    CharClass cls = { NULL, 0, false };
+    if (ps->pos < ps->len && (ps->src[ps->pos] == '^' || (!regex && ps->src[ps->pos] == '!'))) {
+        cls.negate = true;
+        ps->pos++;
+    }
+
+    bool first = true;
+    while (ps->pos < ps->len && (ps->src[ps->pos] != ']' || first)) {
+        first = false;
+        uint32_t lo;
+        if (ps->src[ps->pos] == '\\' && ps->pos + 1 < ps->len) {
+            ps->pos++;
+            int rc = 0;
+            if (regex && add_shorthand(&cls, ps->src[ps->pos], &rc)) {
+                ps->pos++;
+                if (rc != 0) {
+                    ps->err = rc;
+                    free(cls.ranges);
+                    return false;
+                }
+                continue;
+            }
+        }
+        if (!next_codepoint(ps, &lo)) {
+            free(cls.ranges);
+            return false;
+        }
+
+        uint32_t hi = lo;
+        if (ps->pos + 1 < ps->len && ps->src[ps->pos] == '-' && ps->src[ps->pos + 1] != ']') {
+            ps->pos++;
+            if (ps->src[ps->pos] == '\\' && ps->pos + 1 < ps->len) ps->pos++;
+            if (!next_codepoint(ps, &hi)) {
+                free(cls.ranges);
+                return false;
+            }
+            if (hi < lo) {
+                ps->err = EINVAL;
+                free(cls.ranges);
+                return false;
+            }
+        }
+        if (class_add_range(&cls, lo, hi) != 0) {
+            ps->err = ENOMEM;
+            free(cls.ranges);
+            return false;
+        }
+    }
+
+    if (ps->pos >= ps->len) {
+        ps->err = EINVAL;  // Unterminated class
+        free(cls.ranges);
+        return false;
+    }
+    ps->pos++;
+    return class_fragment(ps, &cls, frag);
+}
+
+static bool parse_glob(Parser* ps, Fragment* frag) {
+    if (!empty_fragment(ps, frag)) return false;
+
+    while (ps->pos < ps->len) {
+        char ch = ps->src[ps->pos];
+        Fragment f;
+        bool ok;
+        if (ch == '*') {
+            ps->pos++;
+            ok = any_fragment(ps, &f) && star(ps, &f);
+        } else if (ch == '?') {
+            ps->pos++;
+            ok = any_fragment(ps, &f);
+        } else if (ch == '[') {
+            ps->pos++;
+            ok = parse_class(ps, false, &f);
+        } else {
+            if (ch == '\\' && ps->pos + 1 < ps->len) ps->pos++;
+            uint32_t cp;
+            ok = next_codepoint(ps, &cp) && literal_fragment(ps, cp, &f);
+        }
+        if (!ok) return false;
+        concat(ps, frag, f);
+    }
+    return true;
+}
+
+static bool parse_alternation(Parser* ps, Fragment* frag);
+
+static bool parse_atom(Parser* ps, Fragment* frag) {
+    char ch = ps->src[ps->pos];
+    switch (ch) {
+        case '(':
+            ps->pos++;
+            if (!parse_alternation(ps, frag)) return false;
+            if (ps->pos >= ps->len || ps->src[ps->pos] != ')') {
+                ps->err = EINVAL;
+                return false;
+            }
+            ps->pos++;
+            return true;
+        case '[':
+            ps->pos++;
+            return parse_class(ps, true, frag);
+        case '.':
+            ps->pos++;
+            return any_fragment(ps, frag);
+        case ')': case '|': case '*': case '+': case '?': case '{': case '^': case '$':
+            ps->err = EINVAL;  // Misplaced operator or unsupported anchor
+            return false;
+        case '\\': {
+            if (ps->pos + 1 >= ps->len) {
+                ps->err = EINVAL;
+                return false;
+            }
+            ps->pos++;
+            CharClass cls = { NULL, 0, false };
+            int rc = 0;
+            if (add_shorthand(&cls, ps->src[ps->pos], &rc)) {
+                ps->pos++;
+                if (rc != 0) {
+                    ps->err = rc;
+                    free(cls.ranges);
+                    return false;
+                }
+                return class_fragment(ps, &cls, frag);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    uint32_t cp;
+    return next_codepoint(ps, &cp) && literal_fragment(ps, cp, frag);
+}
+
+static bool parse_bound(Parser* ps, int* value) {
+    size_t start = ps->pos;
+    int v = 0;
+    while (ps->pos < ps->len && ps->src[ps->pos] >= '0' && ps->src[ps->pos] <= '9') {
+        v = v * 10 + (ps->src[ps->pos++] - '0');
+        if (v > PATTERN_MAX_REPEAT) return false;
+    }
+    *value = v;
+    return ps->pos > start;
+}
+
+// {m}, {m,} or {m,n}: the atom is re-parsed once per copy
+static bool parse_counted(Parser* ps, size_t atom_start, size_t atom_end, Fragment* frag) {
+    int min = 0, max = 0;
+    ps->pos++;
+    if (!parse_bound(ps, &min)) {
+        ps->err = EINVAL;
+        return false;
+    }
+    max = min;
+    bool unbounded = false;
+    if (ps->pos < ps->len && ps->src[ps->pos] == ',') {
+        ps->pos++;
+        unbounded = !parse_bound(ps, &max);
+    }
+    if (ps->pos >= ps->len || ps->src[ps->pos] != '}' || (!unbounded && max < min)) {
+        ps->err = EINVAL;
+        return false;
+    }
+    size_t resume = ps->pos + 1;
+
+    // The first copy was already parsed into frag
+    int copies = unbounded ? min : max;
+    Fragment result;
+    if (min == 0) {
+        if (!empty_fragment(ps, &result)) return false;
+    } else {
+        result = *frag;
+    }
+
+    for (int i = (min == 0 ? 0 : 1); i < copies || (unbounded && i == copies); i++) {
+        Fragment copy;
+        if (i == 0 && min == 0) {
+            copy = *frag;
+        } else {
+            ps->pos = atom_start;
+            if (!parse_atom(ps, &copy)) return false;
+            if (ps->pos != atom_end) {
+                ps->err = EINVAL;
+                return false;
+            }
+        }
+        bool optional = i >= min;
+        bool repeat = unbounded && i == copies;
+        if (repeat && !star(ps, &copy)) return false;
+        if (!repeat && optional && !quest(ps, &copy)) return false;
+        concat(ps, &result, copy);
+    }
+
+    ps->pos = resume;
+    *frag = result;
+    return true;
+}
+
+static bool parse_repeat(Parser* ps, Fragment* frag) {
+    size_t atom_start = ps->pos;
+    if (!parse_atom(ps, frag)) return false;
+    size_t atom_end = ps->pos;
+    bool quantified = false;
+
+    while (ps->pos < ps->len) {
+        char ch = ps->src[ps->pos];
+        bool ok;
+        if (ch == '{' && quantified) {
+            ps->err = EINVAL;  // Counted repeat copies the bare atom only
+            return false;
+        }
+        if (ch == '*') {
+            ps->pos++;
+            ok = star(ps, frag);
+        } else if (ch == '+') {
+            ps->pos++;
+            ok = plus(ps, frag);
+        } else if (ch == '?') {
+            ps->pos++;
+            ok = quest(ps, frag);
+        } else if (ch == '{') {
+            ok = parse_counted(ps, atom_start, atom_end, frag);
+        } else {
+            break;
+        }
+        if (!ok) return false;
+        quantified = true;
+    }
+    return true;
+}
+
+static bool parse_concat(Parser* ps, Fragment* frag) {
+    if (!empty_fragment(ps, frag)) return false;
+    while (ps->pos < ps->len && ps->src[ps->pos] != '|' && ps->src[ps->pos] != ')') {
+        Fragment f;
+        if (!parse_repeat(ps, &f)) return false;
+        concat(ps, frag, f);
+    }
+    return true;
+}
+
+static bool parse_alternation(Parser* ps, Fragment* frag) {
+    if (!parse_concat(ps, frag)) return false;
+    while (ps->pos < ps->len && ps->src[ps->pos] == '|') {
+        ps->pos++;
+        Fragment right;
+        if (!parse_concat(ps, &right)) return false;
+
+        int end = add_state(ps->p, NFA_EPS, -1, -1, -1);
+        int split = add_state(ps->p, NFA_SPLIT, frag->start, right.start, -1);
+        if (end < 0 || split < 0) {
+            ps->err = ENOMEM;
+            return false;
+        }
+        ps->p->nfa[frag->end].out = end;
+        ps->p->nfa[right.end].out = end;
+        *frag = (Fragment){ split, end };
+    }
+    return true;
+}
+
+static bool parse_regex(Parser* ps, Fragment* frag) {
+    // Unanchored ends match any surrounding text
+    bool anchored_start = ps->len > 0 && ps->src[0] == '^';
+    bool anchored_end = ps->len > 0 && ps->src[ps->len - 1] == '$' &&
+                        (ps->len < 2 || ps->src[ps->len - 2] != '\\');
+    if (anchored_start) ps->pos++;
+    if (anchored_end) ps->len--;
+
+    Fragment body;
+    if (!parse_alternation(ps, &body)) return false;
+    if (ps->pos != ps->len) {
+        ps->err = EINVAL;  // Unbalanced ')'
+        return false;
+    }
+
+    if (anchored_start) {
+        *frag = body;
+    } else {
+        if (!any_fragment(ps, frag) || !star(ps, frag)) return false;
+        concat(ps, frag, body);
+    }
+    if (!anchored_end) {
+        Fragment tail;
+        if (!any_fragment(ps, &tail) || !star(ps, &tail)) return false;
+        concat(ps, frag, tail);
+    }
+    return true;
+}
+
+Pattern* pattern_compile(const char* pattern, PatternSyntax syntax, int* err) {
+    if (!pattern || (syntax != PATTERN_GLOB && syntax != PATTERN_REGEX)) {
+        if (err) *err = EINVAL;
+        return NULL;
+    }
+
+    Pattern* p = calloc(1, sizeof(Pattern));
+    if (!p) {
+        if (err) *err = ENOMEM;
+        return NULL;
+    }
+
+    Parser ps = { p, pattern, 0, strlen(pattern), 0 };
+    Fragment frag;
+    bool ok = syntax == PATTERN_GLOB ? parse_glob(&ps, &frag) : parse_regex(&ps, &frag);
+    int match = ok ? add_state(p, NFA_MATCH, -1, -1, -1) : -1;
+    if (!ok || match < 0) {
+        if (err) *err = ps.err ? ps.err : ENOMEM;
+        DEBUG_LOG("Failed to compile pattern '%s': %s", pattern, strerror(ps.err ? ps.err : ENOMEM));
+        pattern_free(p);
+        return NULL;
+    }
+    p->nfa[frag.end].out = match;
+    p->start = frag.start;
+
+    p->marks = calloc(p->nfa_count, sizeof(unsigned));
+    p->stack = malloc(p->nfa_count * sizeof(int));
+    p->set = malloc(p->nfa_count * sizeof(int));
+    if (!p->marks || !p->stack || !p->set) {
+        if (err) *err = ENOMEM;
+        pattern_free(p);
+        return NULL;
+    }
+
+    if (err) *err = 0;
+    return p;
+}
+
+void pattern_free(Pattern* pattern) {
+    if (!pattern) return;
+
+    for (size_t i = 0; i < pattern->class_count; i++) {
+        free(pattern->classes[i].ranges);
+    }
+    for (size_t i = 0; i < pattern->dfa_count; i++) {
+        free(pattern->dfa[i].states);
+    }
+    free(pattern->classes);
+    free(pattern->nfa);
+    free(pattern->dfa);
+    free(pattern->dfa_slots);
+    free(pattern->marks);
+    free(pattern->stack);
+    free(pattern->set);
+    free(pattern);
+}
+
+// ---- Simulation ----
+
+static bool class_contains(const CharClass* cls, uint32_t cp) {
+    bool in = false;
+    for (size_t i = 0; i < cls->count && !in; i++) {
+        in = cp >= cls->ranges[2 * i] && cp <= cls->ranges[2 * i + 1];
+    }
+    return in != cls->negate;
+}
+
+// Whether some codepoint in cls lands in child slot
+static bool class_hits_slot(const CharClass* cls, int slot) {
+    if (cls->negate) return true;  // Complement of finitely many ranges
+    for (size_t i = 0; i < cls->count; i++) {
+        uint32_t lo = cls->ranges[2 * i];
+        uint32_t hi = cls->ranges[2 * i + 1];
+        uint32_t first = lo + (uint32_t)((slot - (int)(lo % ALPHABET_SIZE) + ALPHABET_SIZE) % ALPHABET_SIZE);
+        if (first <= hi) return true;
+    }
+    return false;
+}
+
+static void next_mark(Pattern* p) {
+    if (++p->mark == 0) {
+        memset(p->marks, 0, p->nfa_count * sizeof(unsigned));
+        p->mark = 1;
+    }
+}
+
+// Add the epsilon closure of state to set, keeping consuming and match states
+static void add_closure(Pattern* p, int state, int* set, size_t* count) {
+    size_t top = 0;
+    p->stack[top++] = state;
+    while (top > 0) {
+        int s = p->stack[--top];
+        if (s < 0 || p->marks[s] == p->mark) continue;
+        p->marks[s] = p->mark;
+
+        const NfaState* st = &p->nfa[s];
+        switch (st->kind) {
+            case NFA_SPLIT:
+                p->stack[top++] = st->out1;
+                p->stack[top++] = st->out;
+                break;
+            case NFA_EPS:
+                p->stack[top++] = st->out;
+                break;
+            default:
+                set[(*count)++] = s;
+                break;
+        }
+    }
+}
+
+bool pattern_match(const Pattern* pattern, const char* str) {
+    if (!pattern || !str) return false;
+
+    Pattern* p = (Pattern*)pattern;
+    int* cur = malloc(p->nfa_count * sizeof(int));
+    int* next = malloc(p->nfa_count * sizeof(int));
+    if (!cur || !next) {
+        free(cur);
+        free(next);
+        return false;
+    }
+
+    size_t cur_count = 0;
+    next_mark(p);
+    add_closure(p, p->start, cur, &cur_count);
+
+    size_t len = strlen(str);
+    size_t pos = 0;
+    while (pos < len && cur_count > 0) {
+        uint32_t cp;
+        int n = utf8_decode_char(str + pos, len - pos, &cp);
+        if (n < 0) {
+            cur_count = 0;
+            break;
+        }
+        pos += (size_t)n;
+
+        size_t next_count = 0;
+        next_mark(p);
+        for (size_t i = 0; i < cur_count; i++) {
+            const NfaState* st = &p->nfa[cur[i]];
+            if (st->kind == NFA_CLASS && class_contains(&p->classes[st->cls], cp)) {
+                add_closure(p, st->out, next, &next_count);
+            }
+        }
+        int* tmp = cur;
+        cur = next;
+        next = tmp;
+        cur_count = next_count;
+    }
+
+    bool matched = false;
+    for (size_t i = 0; i < cur_count && !matched; i++) {
+        matched = p->nfa[cur[i]].kind == NFA_MATCH;
+    }
+    free(cur);
+    free(next);
+    return matched;
+}
+
+// ---- Lazy DFA over child slots ----
+
+static int compare_ints(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t hash_set(const int* states, size_t count) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < count; i++) {
+        h ^= (uint64_t)(uint32_t)states[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h ^ (h >> 29);
+}
+
+static size_t dfa_find_slot(const Pattern* p, const int* states, size_t count) {
+    size_t mask = p->dfa_num_slots - 1;
+    size_t i = hash_set(states, count) & mask;
+    while (p->dfa_slots[i] >= 0) {
+        const DfaState* d = &p->dfa[p->dfa_slots[i]];
+        if (d->count == count && memcmp(d->states, states, count * sizeof(int)) == 0) break;
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+// DFA id for a state set (sorted in place), creating it if needed.
+// Returns DFA_DEAD for the empty set, or -3 when out of states or memory.
+static int dfa_intern(Pattern* p, int* states, size_t count) {
+    if (count == 0) return DFA_DEAD;
+    qsort(states, count, sizeof(int), compare_ints);
+
+    if (!p->dfa_slots) {
+        p->dfa_num_slots = 64;
+        p->dfa_slots = malloc(p->dfa_num_slots * sizeof(int));
+        if (!p->dfa_slots) return -3;
+        memset(p->dfa_slots, 0xFF, p->dfa_num_slots * sizeof(int));
+    }
+
+    size_t slot = dfa_find_slot(p, states, count);
+    if (p->dfa_slots[slot] >= 0) return p->dfa_slots[slot];
+    if (p->dfa_count >= DFA_MAX_STATES) return -3;
+
+    if (p->dfa_count == p->dfa_cap) {
+        size_t cap = p->dfa_cap ? p->dfa_cap * 2 : 16;
+        DfaState* grown = realloc(p->dfa, cap * sizeof(DfaState));
+        if (!grown) return -3;
+        p->dfa = grown;
+        p->dfa_cap = cap;
+    }
+
+    DfaState* d = &p->dfa[p->dfa_count];
+    d->states = malloc(count * sizeof(int));
+    if (!d->states) return -3;
+    memcpy(d->states, states, count * sizeof(int));
+    d->count = count;
+    d->accepting = false;
+    for (size_t i = 0; i < count; i++) {
+        if (p->nfa[states[i]].kind == NFA_MATCH) d->accepting = true;
+    }
+    for (int c = 0; c < ALPHABET_SIZE; c++) d->next[c] = DFA_UNKNOWN;
+
+    int id = (int)p->dfa_count++;
+    p->dfa_slots[slot] = id;
+
+    // Keep the hash at most half full
+    if (p->dfa_count * 2 > p->dfa_num_slots) {
+        size_t num_slots = p->dfa_num_slots * 2;
+        int* slots = malloc(num_slots * sizeof(int));
+        if (!slots) return -3;
+        memset(slots, 0xFF, num_slots * sizeof(int));
+        free(p->dfa_slots);
+        p->dfa_slots = slots;
+        p->dfa_num_slots = num_slots;
+        for (size_t i = 0; i < p->dfa_count; i++) {
+            p->dfa_slots[dfa_find_slot(p, p->dfa[i].states, p->dfa[i].count)] = (int)i;
+        }
+    }
+    return id;
+}
+
+static int dfa_start(Pattern* p) {
+    size_t count = 0;
+    next_mark(p);
+    add_closure(p, p->start, p->set, &count);
+    return dfa_intern(p, p->set, count);
+}
+
+// Transition on a child slot: every codepoint sharing the slot is assumed
+// possible, so the DFA over-approximates and matches are verified later
+static int dfa_step(Pattern* p, int id, int slot) {
+    int cached = p->dfa[id].next[slot];
+    if (cached != DFA_UNKNOWN) return cached;
+
+    size_t count = 0;
+    next_mark(p);
+    const DfaState* d = &p->dfa[id];
+    for (size_t i = 0; i < d->count; i++) {
+        const NfaState* st = &p->nfa[d->states[i]];
+        if (st->kind == NFA_CLASS && class_hits_slot(&p->classes[st->cls], slot)) {
+            add_closure(p, st->out, p->set, &count);
+        }
+    }
+
+    int next = dfa_intern(p, p->set, count);
+    if (next != -3) p->dfa[id].next[slot] = next;  // dfa may have moved
+    return next;
+}
+
+// ---- Trie walk ----
+
+typedef struct {
+    Pattern* pattern;
+    PatternMatch* out;
+    size_t max_matches;
+    size_t count;
+    struct timespec deadline;
+    bool has_deadline;
+    size_t visited;
+    int rc;             // Set when the walk must stop early
+} PatternWalk;
+
+static bool deadline_passed(const PatternWalk* w) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec > w->deadline.tv_sec ||
+           (now.tv_sec == w->deadline.tv_sec && now.tv_nsec >= w->deadline.tv_nsec);
+}
+
+static void pattern_walk(PatternWalk* w, const TrieNode* node, int state) {
+    if (w->has_deadline && ++w->visited % PATTERN_CLOCK_INTERVAL == 0 && deadline_passed(w)) {
+        w->rc = ETIMEDOUT;
+        return;
+    }
+
+    if (w->pattern->dfa[state].accepting && node->postings && node->postings->count > 0 &&
+        node->word && pattern_match(w->pattern, node->word)) {
+        w->out[w->count].word = node->word;
+        w->out[w->count].postings = node->postings;
+        if (++w->count == w->max_matches) {
+            w->rc = ENOSPC;  // Limit reached; reported as success
+            return;
+        }
+    }
+
+    for (int c = 0; c < ALPHABET_SIZE && !w->rc; c++) {
+        if (!node->children[c]) continue;
+        int next = dfa_step(w->pattern, state, c);
+        if (next == -3) {
+            w->rc = E2BIG;
+        } else if (next != DFA_DEAD) {
+            pattern_walk(w, node->children[c], next);
+        }
+    }
+}
+
+int gtrie_pattern_search(const GTrie* trie, Pattern* pattern, PatternMatch* out,
+                         size_t max_matches, uint64_t budget_us, size_t* count) {
+    if (count) *count = 0;
+    if (!trie || !pattern || !out || max_matches == 0) return EINVAL;
+
+    PatternWalk w = { pattern, out, max_matches, 0, { 0, 0 }, budget_us > 0, 0, 0 };
+    if (w.has_deadline) {
+        clock_gettime(CLOCK_MONOTONIC, &w.deadline);
+        uint64_t ns = (uint64_t)w.deadline.tv_nsec + (budget_us % 1000000) * 1000;
+        w.deadline.tv_sec += (time_t)(budget_us / 1000000 + ns / 1000000000);
+        w.deadline.tv_nsec = (long)(ns % 1000000000);
+    }
+
+    int start = dfa_start(pattern);
+    if (start == -3) return E2BIG;
+    if (start != DFA_DEAD) pattern_walk(&w, trie->root, start);
+
+    if (count) *count = w.count;
+    if (w.rc == ENOSPC) return 0;
+    if (w.rc) return w.rc;
+    return w.count > 0 ? 0 : ENOENT;
+}
@@ -0,0 +1,192 @@
+#include "phrase.h"
+#include "logging.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+
+// Per-term scratch for decoded positions and reachability
+typedef struct {
+    uint32_t* positions;
+    uint8_t* reach;
+    size_t count;
+    size_t cap;
+} TermPositions;
+
+typedef struct {
+    uint32_t* slots;        // Candidate index + 1, 0 when empty
+    size_t mask;
+} CandidateMap;
+
+static size_t map_slot(const CandidateMap* map, const uint32_t* docs, uint32_t doc) {
+    size_t i = (size_t)(doc * 2654435761u) & map->mask;
+    while (map->slots[i] && docs[map->slots[i] - 1] != doc) {
+        i = (i + 1) & map->mask;
+    }
+    return i;
+}
+
+static int compare_pairs(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int decode_term(const PostingEntry* entry, TermPositions* tp) {
+    if (entry->positions_size > tp->cap) {
+        size_t cap = entry->positions_size;
+        uint32_t* positions = realloc(tp->positions, cap * sizeof(uint32_t));
+        if (!positions) return ENOMEM;
+        tp->positions = positions;
+        uint8_t* reach = realloc(tp->reach, cap);
+        if (!reach) return ENOMEM;
+        tp->reach = reach;
+        tp->cap = cap;
+    }
+    // Every position takes at least one byte
+    return gtrie_decode_positions(entry->positions, entry->positions_size, tp->positions,
+                                  tp->cap, &tp->count);
+}
+
+// Whether some chain of positions, one per term, has every gap in [1, slop + 1]
+static bool positions_match(TermPositions* tps, size_t num_terms, uint32_t slop) {
+    memset(tps[0].reach, 1, tps[0].count);
+    for (size_t t = 1; t < num_terms; t++) {
+        const TermPositions* prev = &tps[t - 1];
+        TermPositions* cur = &tps[t];
+        size_t j = 0;
+        bool have_last = false;
+        bool any = false;
+        uint32_t last = 0;  // Latest reachable previous position before q
+
+        for (size_t i = 0; i < cur->count; i++) {
+            uint32_t q = cur->positions[i];
+            while (j < prev->count && prev->positions[j] < q) {
+                if (prev->reach[j]) {
+                    last = prev->positions[j];
+                    have_last = true;
+                }
+                j++;
+            }
+            cur->reach[i] = have_last && q - last <= (uint64_t)slop + 1;
+            any |= cur->reach[i];
+        }
+        if (!any) return false;
+    }
+    return true;
+}
+
+int phrase_search(const GTrie* trie, const char* const* terms, size_t num_terms, uint32_t slop,
+                  const char** doc_ids, size_t max_docs, size_t* count, PhraseStats* stats) {
+    if (count) *count = 0;
+    if (stats) memset(stats, 0, sizeof(*stats));
+    if (!trie || !terms || num_terms == 0 || num_terms > PHRASE_MAX_TERMS ||
+        !doc_ids || max_docs == 0) {
+        ERROR_LOG("Invalid arguments: trie=%p, terms=%p, num_terms=%zu, doc_ids=%p, max_docs=%zu",
+                 (void*)trie, (void*)terms, num_terms, (void*)doc_ids, max_docs);
+        return EINVAL;
+    }
+
+    const PostingList* lists[PHRASE_MAX_TERMS];
+    size_t rarest = 0;
+    for (size_t t = 0; t < num_terms; t++) {
+        if (!terms[t]) return EINVAL;
+        int err = 0;
+        lists[t] = gtrie_search(trie, terms[t], &err);
+        if (!lists[t] || lists[t]->count == 0) return err == EINVAL ? EINVAL : ENOENT;
+        if (lists[t]->count < lists[rarest]->count) rarest = t;
+    }
+
+    // Candidates start as the rarest term's documents
+    size_t n = lists[rarest]->count;
+    size_t num_slots = 16;
+    while (num_slots < 2 * n) num_slots *= 2;
+    CandidateMap map = { calloc(num_slots, sizeof(uint32_t)), num_slots - 1 };
+    uint32_t* docs = malloc(n * sizeof(uint32_t));
+    const PostingEntry** entries = calloc(n * num_terms, sizeof(PostingEntry*));
+    uint64_t* order = NULL;
+    TermPositions tps[PHRASE_MAX_TERMS];
+    memset(tps, 0, sizeof(tps));
+
+    int rc = 0;
+    if (!map.slots || !docs || !entries) {
+        rc = ENOMEM;
+        goto done;
+    }
+
+    size_t num_candidates = 0;
+    for (const PostingEntry* e = lists[rarest]->head; e && num_candidates < n; e = e->next) {
+        size_t slot = map_slot(&map, docs, e->doc);
+        if (map.slots[slot]) continue;
+        docs[num_candidates] = e->doc;
+        entries[num_candidates * num_terms + rarest] = e;
+        map.slots[slot] = (uint32_t)++num_candidates;
+    }
+    size_t scanned = num_candidates;
+
+    // Intersect: one pass over each remaining list, no positions touched
+    for (size_t t = 0; t < num_terms; t++) {
+        if (t == rarest) continue;
+        for (const PostingEntry* e = lists[t]->head; e; e = e->next) {
+            scanned++;
+            size_t slot = map_slot(&map, docs, e->doc);
+            if (map.slots[slot]) entries[(map.slots[slot] - 1) * num_terms + t] = e;
+        }
+    }
+
+    // Survivors as (ordinal, candidate) pairs, sorted by ordinal
+    size_t survivors = 0;
+    order = malloc((num_candidates ? num_candidates : 1) * sizeof(uint64_t));
+    if (!order) {
+        rc = ENOMEM;
+        goto done;
+    }
+    for (size_t c = 0; c < num_candidates; c++) {
+        bool all = true;
+        for (size_t t = 0; t < num_terms && all; t++) {
+            all = entries[c * num_terms + t] != NULL;
+        }
+        if (all) order[survivors++] = ((uint64_t)docs[c] << 32) | c;
+    }
+    qsort(order, survivors, sizeof(uint64_t), compare_pairs);
+
+    // Only now decode positions, and only for documents with every term
+    size_t decoded = 0;
+    size_t found = 0;
+    for (size_t i = 0; i < survivors && found < max_docs && rc == 0; i++) {
+        size_t c = (uint32_t)order[i];
+        bool ok = true;
+        for (size_t t = 0; t < num_terms && ok && rc == 0; t++) {
+            const PostingEntry* e = entries[c * num_terms + t];
+            if (!e->positions) {
+                ok = false;
+            } else {
+                rc = decode_term(e, &tps[t]);
+                decoded += tps[t].count;
+            }
+        }
+        if (ok && rc == 0 && positions_match(tps, num_terms, slop)) {
+            doc_ids[found++] = doc_table_id(trie->docs, docs[c]);
+        }
+    }
+
+    if (stats) {
+        stats->postings = scanned;
+        stats->candidates = survivors;
+        stats->decoded = decoded;
+    }
+    if (count) *count = found;
+    if (rc == 0 && found == 0) rc = ENOENT;
+    DEBUG_LOG("Phrase search over %zu terms: %zu postings, %zu candidates, %zu positions decoded",
+              num_terms, scanned, survivors, decoded);
+
+done:
+    for (size_t t = 0; t < num_terms; t++) {
+        free(tps[t].positions);
+        free(tps[t].reach);
+    }
+    free(map.slots);
+    free(order);
+    free(docs);
+    free(entries);
+    return rc;
+}
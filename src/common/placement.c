@@ -0,0 +1,200 @@
+#define _GNU_SOURCE
+#include "placement.h"
+#include "logging.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#define PLACEMENT_NODE_ROOT "/sys/devices/system/node"
+#define PLACEMENT_LIST_MAX 4096     // Longest sysfs cpu or node list we read
+
+static HugePageMode huge_pages = HUGE_PAGES_OFF;
+static bool hugetlb_warned = false;
+
+static pthread_once_t nodes_once = PTHREAD_ONCE_INIT;
+static int node_ids[PLACEMENT_MAX_NODES];
+static int node_count = 1;          // Node 0 only until sysfs says otherwise
+
+void placement_set_huge_pages(HugePageMode mode) {
+    __atomic_store_n(&huge_pages, mode, __ATOMIC_RELAXED);
+}
+
+HugePageMode placement_huge_pages(void) {
+    return __atomic_load_n(&huge_pages, __ATOMIC_RELAXED);
+}
+
+int placement_parse_huge_pages(const char* text, HugePageMode* mode) {
+    if (!text || !mode) return EINVAL;
+    if (strcmp(text, "off") == 0) {
+        *mode = HUGE_PAGES_OFF;
+    } else if (strcmp(text, "thp") == 0) {
+        *mode = HUGE_PAGES_TRANSPARENT;
+    } else if (strcmp(text, "hugetlb") == 0) {
+        *mode = HUGE_PAGES_EXPLICIT;
+    } else {
+        return EINVAL;
+    }
+    return 0;
+}
+
+// Anonymous mapping of size bytes (a multiple of PLACEMENT_HUGE_PAGE) aligned
+// to a huge page: over-map by one huge page and trim both ends
+static void* map_aligned(size_t size) {
+    size_t span = size + PLACEMENT_HUGE_PAGE;
+    char* base = mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return NULL;
+
+    uintptr_t start = ((uintptr_t)base + PLACEMENT_HUGE_PAGE - 1) & ~(uintptr_t)(PLACEMENT_HUGE_PAGE - 1);
+    size_t head = start - (uintptr_t)base;
+    if (head > 0) munmap(base, head);
+    size_t tail = span - head - size;
+    if (tail > 0) munmap((char*)start + size, tail);
+    return (void*)start;
+}
+
+void* placement_map(size_t size, HugePageMode mode, size_t* mapped) {
+    if (size == 0 || !mapped || size > SIZE_MAX - 2 * PLACEMENT_HUGE_PAGE) {
+        ERROR_LOG("Invalid arguments: size=%zu, mapped=%p", size, (void*)mapped);
+        return NULL;
+    }
+    size = (size + PLACEMENT_HUGE_PAGE - 1) / PLACEMENT_HUGE_PAGE * PLACEMENT_HUGE_PAGE;
+
+    void* addr = NULL;
+    if (mode == HUGE_PAGES_EXPLICIT) {
+        addr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (addr == MAP_FAILED) {
+            addr = NULL;
+            // Usually an empty vm.nr_hugepages pool; say so once, then use THP
+            if (!__atomic_exchange_n(&hugetlb_warned, true, __ATOMIC_RELAXED)) {
+                WARN_LOG("MAP_HUGETLB failed (%s), falling back to transparent huge pages",
+                         strerror(errno));
+            }
+            mode = HUGE_PAGES_TRANSPARENT;
+        }
+    }
+    if (!addr) {
+        addr = map_aligned(size);
+        if (!addr) return NULL;
+#ifdef MADV_HUGEPAGE
+        if (mode == HUGE_PAGES_TRANSPARENT) madvise(addr, size, MADV_HUGEPAGE);
+#endif
+    }
+
+    *mapped = size;
+    return addr;
+}
+
+void placement_unmap(void* addr, size_t mapped) {
+    if (addr) munmap(addr, mapped);
+}
+
+// Read a sysfs file into buf; returns false when it is missing or empty
+static bool read_list(const char* path, char* buf, size_t size) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+    size_t len = fread(buf, 1, size - 1, file);
+    fclose(file);
+    buf[len] = '\0';
+    return len > 0;
+}
+
+// Parse a kernel range list ("0-3,8,10-11"), calling fn for each id
+static bool parse_list(const char* text, void (*fn)(int id, void* arg), void* arg) {
+    const char* p = text;
+    while (*p && *p != '\n') {
+        char* end;
+        long first = strtol(p, &end, 10);
+        if (end == p || first < 0) return false;
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            if (end == p + 1 || last < first) return false;
+            p = end;
+        }
+        for (long id = first; id <= last; id++) fn((int)id, arg);
+        if (*p == ',') p++;
+    }
+    return true;
+}
+
+static void add_node(int id, void* arg) {
+    int* count = arg;
+    if (*count < PLACEMENT_MAX_NODES) node_ids[(*count)++] = id;
+}
+
+static void load_nodes(void) {
+    char buf[PLACEMENT_LIST_MAX];
+    int count = 0;
+    if (read_list(PLACEMENT_NODE_ROOT "/online", buf, sizeof(buf)) &&
+        parse_list(buf, add_node, &count) && count > 0) {
+        node_count = count;
+    } else {
+        node_ids[0] = 0;
+    }
+}
+
+int placement_node_count(void) {
+    pthread_once(&nodes_once, load_nodes);
+    return node_count;
+}
+
+static void add_cpu(int id, void* arg) {
+    if (id < CPU_SETSIZE) CPU_SET(id, (cpu_set_t*)arg);
+}
+
+int placement_bind_node(int node) {
+    if (node < 0 || node >= placement_node_count()) {
+        ERROR_LOG("Invalid arguments: node=%d", node);
+        return EINVAL;
+    }
+
+    char path[128];
+    char buf[PLACEMENT_LIST_MAX];
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    snprintf(path, sizeof(path), PLACEMENT_NODE_ROOT "/node%d/cpulist", node_ids[node]);
+    if (!read_list(path, buf, sizeof(buf))) {
+        // No sysfs topology: a single node holding every CPU we may use
+        if (node_count == 1) return 0;
+        return ENOENT;
+    }
+    if (!parse_list(buf, add_cpu, &cpus)) return EINVAL;
+    if (CPU_COUNT(&cpus) == 0) return ENOENT;  // Memory-only node
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+}
+
+typedef struct {
+    int node;
+    void* (*fn)(void*);
+    void* arg;
+    int rc;
+} NodeTask;
+
+static void* node_task_main(void* arg) {
+    NodeTask* task = arg;
+    task->rc = placement_bind_node(task->node);
+    if (task->rc == 0) task->fn(task->arg);
+    return NULL;
+}
+
+int placement_run_on_node(int node, void* (*fn)(void*), void* arg) {
+    if (!fn) {
+        ERROR_LOG("Invalid arguments: fn=NULL");
+        return EINVAL;
+    }
+
+    NodeTask task = { node, fn, arg, 0 };
+    pthread_t thread;
+    int rc = pthread_create(&thread, NULL, node_task_main, &task);
+    if (rc != 0) return rc;
+    pthread_join(thread, NULL);
+    return task.rc;
+}
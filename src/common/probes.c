@@ -0,0 +1,10 @@
+#include "probes.h"
+
+#ifdef SEARCH_ENGINE_PROBES
+// One semaphore per probe in the .probes section, where tracers look for them
+#define PROBE_DEFINE_SEMAPHORE(name) \
+    __attribute__((section(".probes"), used)) unsigned short PROBE_SEMAPHORE(name) = 0;
+PROBE_LIST(PROBE_DEFINE_SEMAPHORE)
+#else
+typedef int probes_disabled;  // Keep the translation unit non-empty
+#endif
@@ -0,0 +1,427 @@
+#include "query_cache.h"
+#include "logging.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <pthread.h>
+
+#define CACHE_MAX_SHARDS 64
+#define CACHE_MIN_SHARD_BYTES (64 * 1024)  // Small caches use fewer shards
+#define CACHE_INITIAL_BUCKETS 64
+#define CACHE_SKETCH_DEPTH 4
+#define CACHE_COUNTER_MAX 15               // 4-bit saturating frequency counters
+#define CACHE_SKETCH_RESET_FACTOR 10       // Halve counters after width * factor samples
+
+typedef struct CacheEntry {
+    struct CacheEntry* next;    // Hash chain
+    uint64_t hash;
+    uint64_t generation;
+    uint32_t key_len;
+    uint32_t value_len;
+    uint32_t clock_slot;        // Position in the CLOCK ring
+    uint8_t referenced;         // CLOCK reference bit
+    char data[];                // Key bytes followed by value bytes
+} CacheEntry;
+
+typedef struct {
+    pthread_mutex_t lock;
+    CacheEntry** buckets;
+    size_t bucket_count;        // Power of two
+    CacheEntry** clock;         // CLOCK ring; NULL slots are free
+    size_t clock_size;          // Slots in use or free-listed
+    size_t clock_cap;
+    size_t clock_hand;
+    uint32_t* free_slots;       // Stack of NULL ring positions
+    size_t free_count;
+    size_t entries;
+    size_t bytes;
+    size_t max_bytes;
+    uint8_t* sketch;            // Count-min sketch, CACHE_SKETCH_DEPTH rows
+    size_t sketch_width;        // Power of two
+    size_t sketch_samples;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t insertions;
+    uint64_t evictions;
+    uint64_t rejections;
+} __attribute__((aligned(64))) CacheShard;
+
+struct QueryCache {
+    CacheShard* shards;
+    size_t shard_count;         // Power of two
+    size_t max_bytes;
+};
+
+static uint64_t hash_key(const char* key, size_t len) {
+    // FNV-1a followed by a murmur finalizer for better high bits
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)key[i];
+        h *= 0x100000001b3ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static size_t next_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+static inline size_t sketch_index(const CacheShard* shard, uint64_t hash, int row) {
+    uint64_t h1 = hash;
+    uint64_t h2 = (hash >> 32) | 1;
+    return (size_t)row * shard->sketch_width + ((h1 + (uint64_t)row * h2) & (shard->sketch_width - 1));
+}
+
+static uint8_t sketch_frequency(const CacheShard* shard, uint64_t hash) {
+    uint8_t freq = CACHE_COUNTER_MAX;
+    for (int row = 0; row < CACHE_SKETCH_DEPTH; row++) {
+        uint8_t c = shard->sketch[sketch_index(shard, hash, row)];
+        if (c < freq) freq = c;
+    }
+    return freq;
+}
+
+static void sketch_increment(CacheShard* shard, uint64_t hash) {
+    for (int row = 0; row < CACHE_SKETCH_DEPTH; row++) {
+        uint8_t* c = &shard->sketch[sketch_index(shard, hash, row)];
+        if (*c < CACHE_COUNTER_MAX) (*c)++;
+    }
+
+    // Periodic aging keeps the filter responsive to shifts in popularity
+    if (++shard->sketch_samples >= shard->sketch_width * CACHE_SKETCH_RESET_FACTOR) {
+        size_t total = shard->sketch_width * CACHE_SKETCH_DEPTH;
+        for (size_t i = 0; i < total; i++) {
+            shard->sketch[i] >>= 1;
+        }
+        shard->sketch_samples /= 2;
+    }
+}
+
+static CacheEntry* find_entry(const CacheShard* shard, uint64_t hash, const char* key, size_t key_len) {
+    CacheEntry* e = shard->buckets[hash & (shard->bucket_count - 1)];
+    while (e) {
+        if (e->hash == hash && e->key_len == key_len && memcmp(e->data, key, key_len) == 0) {
+            return e;
+        }
+        e = e->next;
+    }
+    return NULL;
+}
+
+static void remove_entry(CacheShard* shard, CacheEntry* entry) {
+    CacheEntry** link = &shard->buckets[entry->hash & (shard->bucket_count - 1)];
+    while (*link != entry) {
+        link = &(*link)->next;
+    }
+    *link = entry->next;
+
+    shard->clock[entry->clock_slot] = NULL;
+    shard->free_slots[shard->free_count++] = entry->clock_slot;
+
+    shard->bytes -= sizeof(CacheEntry) + entry->key_len + entry->value_len;
+    shard->entries--;
+    free(entry);
+}
+
+static int grow_buckets(CacheShard* shard) {
+    size_t new_count = shard->bucket_count * 2;
+    CacheEntry** buckets = calloc(new_count, sizeof(CacheEntry*));
+    if (!buckets) return ENOMEM;
+
+    for (size_t i = 0; i < shard->bucket_count; i++) {
+        CacheEntry* e = shard->buckets[i];
+        while (e) {
+            CacheEntry* next = e->next;
+            size_t b = e->hash & (new_count - 1);
+            e->next = buckets[b];
+            buckets[b] = e;
+            e = next;
+        }
+    }
+
+    free(shard->buckets);
+    shard->buckets = buckets;
+    shard->bucket_count = new_count;
+    return 0;
+}
+
+static int reserve_clock_slot(CacheShard* shard, uint32_t* slot) {
+    if (shard->free_count > 0) {
+        *slot = shard->free_slots[--shard->free_count];
+        return 0;
+    }
+
+    if (shard->clock_size == shard->clock_cap) {
+        size_t cap = shard->clock_cap ? shard->clock_cap * 2 : CACHE_INITIAL_BUCKETS;
+        CacheEntry** clock = realloc(shard->clock, cap * sizeof(CacheEntry*));
+        if (!clock) return ENOMEM;
+        shard->clock = clock;
+
+        uint32_t* free_slots = realloc(shard->free_slots, cap * sizeof(uint32_t));
+        if (!free_slots) return ENOMEM;
+        shard->free_slots = free_slots;
+        shard->clock_cap = cap;
+    }
+
+    *slot = (uint32_t)shard->clock_size++;
+    return 0;
+}
+
+// Advance the CLOCK hand to the first entry whose reference bit is clear
+static CacheEntry* clock_victim(CacheShard* shard) {
+    if (shard->entries == 0) return NULL;
+
+    for (;;) {
+        if (shard->clock_hand >= shard->clock_size) shard->clock_hand = 0;
+        CacheEntry* e = shard->clock[shard->clock_hand];
+        if (e) {
+            if (!e->referenced) return e;
+            e->referenced = 0;
+        }
+        shard->clock_hand++;
+    }
+}
+
+static void shard_clear(CacheShard* shard) {
+    for (size_t i = 0; i < shard->clock_size; i++) {
+        free(shard->clock[i]);
+    }
+    memset(shard->buckets, 0, shard->bucket_count * sizeof(CacheEntry*));
+    shard->clock_size = 0;
+    shard->clock_hand = 0;
+    shard->free_count = 0;
+    shard->entries = 0;
+    shard->bytes = 0;
+}
+
+static void shard_cleanup(CacheShard* shard) {
+    if (shard->clock) shard_clear(shard);
+    free(shard->buckets);
+    free(shard->clock);
+    free(shard->free_slots);
+    free(shard->sketch);
+    pthread_mutex_destroy(&shard->lock);
+}
+
+static int shard_init(CacheShard* shard, size_t max_bytes) {
+    memset(shard, 0, sizeof(*shard));
+    int rc = pthread_mutex_init(&shard->lock, NULL);
+    if (rc != 0) return rc;
+
+    shard->max_bytes = max_bytes;
+    shard->bucket_count = CACHE_INITIAL_BUCKETS;
+    shard->buckets = calloc(shard->bucket_count, sizeof(CacheEntry*));
+
+    // Size the sketch for roughly one counter per expected 64-byte entry
+    shard->sketch_width = next_pow2(max_bytes / 64 > 64 ? max_bytes / 64 : 64);
+    shard->sketch = calloc(shard->sketch_width * CACHE_SKETCH_DEPTH, 1);
+
+    if (!shard->buckets || !shard->sketch) {
+        shard_cleanup(shard);
+        return ENOMEM;
+    }
+    return 0;
+}
+
+static inline CacheShard* pick_shard(QueryCache* cache, uint64_t hash) {
+    return &cache->shards[(hash >> 56) & (cache->shard_count - 1)];
+}
+
+QueryCache* query_cache_create(size_t max_bytes, int* err) {
+    if (max_bytes == 0) {
+        ERROR_LOG("Invalid cache size: %zu", max_bytes);
+        if (err) *err = EINVAL;
+        return NULL;
+    }
+
+    QueryCache* cache = calloc(1, sizeof(QueryCache));
+    if (!cache) {
+        if (err) *err = ENOMEM;
+        return NULL;
+    }
+
+    size_t shards = 1;
+    while (shards < CACHE_MAX_SHARDS && max_bytes / (shards * 2) >= CACHE_MIN_SHARD_BYTES) {
+        shards *= 2;
+    }
+
+    cache->shard_count = shards;
+    cache->max_bytes = max_bytes;
+    cache->shards = aligned_alloc(64, shards * sizeof(CacheShard));
+    if (!cache->shards) {
+        free(cache);
+        if (err) *err = ENOMEM;
+        return NULL;
+    }
+
+    for (size_t i = 0; i < shards; i++) {
+        int rc = shard_init(&cache->shards[i], max_bytes / shards);
+        if (rc != 0) {
+            for (size_t j = 0; j < i; j++) {
+                shard_cleanup(&cache->shards[j]);
+            }
+            free(cache->shards);
+            free(cache);
+            if (err) *err = rc;
+            return NULL;
+        }
+    }
+
+    DEBUG_LOG("Created query cache: %zu bytes in %zu shards", max_bytes, shards);
+    if (err) *err = 0;
+    return cache;
+}
+
+void query_cache_destroy(QueryCache* cache) {
+    if (!cache) return;
+
+    for (size_t i = 0; i < cache->shard_count; i++) {
+        shard_cleanup(&cache->shards[i]);
+    }
+    free(cache->shards);
+    free(cache);
+}
+
+int query_cache_lookup(QueryCache* cache, const char* key, size_t key_len, uint64_t generation,
+                       void* out, size_t out_size, size_t* value_len) {
+    if (!cache || !key) return EINVAL;
+
+    uint64_t hash = hash_key(key, key_len);
+    CacheShard* shard = pick_shard(cache, hash);
+
+    pthread_mutex_lock(&shard->lock);
+    sketch_increment(shard, hash);
+
+    CacheEntry* e = find_entry(shard, hash, key, key_len);
+    if (e && e->generation != generation) {
+        // Computed against an older index; drop it now
+        remove_entry(shard, e);
+        e = NULL;
+    }
+    if (!e) {
+        shard->misses++;
+        pthread_mutex_unlock(&shard->lock);
+        return ENOENT;
+    }
+
+    if (value_len) *value_len = e->value_len;
+    if (e->value_len > out_size) {
+        pthread_mutex_unlock(&shard->lock);
+        return ENOSPC;
+    }
+
+    memcpy(out, e->data + e->key_len, e->value_len);
+    e->referenced = 1;
+    shard->hits++;
+    pthread_mutex_unlock(&shard->lock);
+    return 0;
+}
+
+int query_cache_insert(QueryCache* cache, const char* key, size_t key_len, uint64_t generation,
+                       const void* value, size_t value_len) {
+    if (!cache || !key || (!value && value_len > 0)) return EINVAL;
+
+    uint64_t hash = hash_key(key, key_len);
+    CacheShard* shard = pick_shard(cache, hash);
+    size_t size = sizeof(CacheEntry) + key_len + value_len;
+
+    pthread_mutex_lock(&shard->lock);
+
+    if (size > shard->max_bytes || key_len > UINT32_MAX || value_len > UINT32_MAX) {
+        shard->rejections++;
+        pthread_mutex_unlock(&shard->lock);
+        return 0;
+    }
+
+    CacheEntry* existing = find_entry(shard, hash, key, key_len);
+    if (existing) {
+        remove_entry(shard, existing);
+    }
+
+    // TinyLFU admission: the candidate must be more popular than the CLOCK victim
+    if (shard->bytes + size > shard->max_bytes) {
+        CacheEntry* victim = clock_victim(shard);
+        if (victim && victim->generation == generation &&
+            sketch_frequency(shard, hash) <= sketch_frequency(shard, victim->hash)) {
+            shard->rejections++;
+            pthread_mutex_unlock(&shard->lock);
+            return 0;
+        }
+    }
+    while (shard->bytes + size > shard->max_bytes) {
+        CacheEntry* victim = clock_victim(shard);
+        if (!victim) break;
+        remove_entry(shard, victim);
+        shard->evictions++;
+    }
+
+    if (shard->entries >= shard->bucket_count && grow_buckets(shard) != 0) {
+        pthread_mutex_unlock(&shard->lock);
+        return ENOMEM;
+    }
+
+    CacheEntry* e = malloc(size);
+    uint32_t slot;
+    if (!e || reserve_clock_slot(shard, &slot) != 0) {
+        free(e);
+        pthread_mutex_unlock(&shard->lock);
+        return ENOMEM;
+    }
+
+    e->hash = hash;
+    e->generation = generation;
+    e->key_len = (uint32_t)key_len;
+    e->value_len = (uint32_t)value_len;
+    e->clock_slot = slot;
+    e->referenced = 0;
+    memcpy(e->data, key, key_len);
+    if (value_len > 0) memcpy(e->data + key_len, value, value_len);
+
+    size_t b = hash & (shard->bucket_count - 1);
+    e->next = shard->buckets[b];
+    shard->buckets[b] = e;
+    shard->clock[slot] = e;
+    shard->entries++;
+    shard->bytes += size;
+    shard->insertions++;
+
+    pthread_mutex_unlock(&shard->lock);
+    return 0;
+}
+
+void query_cache_clear(QueryCache* cache) {
+    if (!cache) return;
+
+    for (size_t i = 0; i < cache->shard_count; i++) {
+        CacheShard* shard = &cache->shards[i];
+        pthread_mutex_lock(&shard->lock);
+        shard_clear(shard);
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
+
+void query_cache_get_stats(QueryCache* cache, QueryCacheStats* stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!cache) return;
+
+    stats->max_bytes = cache->max_bytes;
+    for (size_t i = 0; i < cache->shard_count; i++) {
+        CacheShard* shard = &cache->shards[i];
+        pthread_mutex_lock(&shard->lock);
+        stats->hits += shard->hits;
+        stats->misses += shard->misses;
+        stats->insertions += shard->insertions;
+        stats->evictions += shard->evictions;
+        stats->rejections += shard->rejections;
+        stats->entries += shard->entries;
+        stats->bytes += shard->bytes;
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
@@ -0,0 +1,400 @@
+#include "query_replay.h"
+#include "logging.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define REPLAY_LATE_NS 1000000ULL       // Start lag that counts a query as late
+#define REPLAY_DEFAULT_COMPLETIONS 10   // search_server defaults
+#define REPLAY_DEFAULT_RANKED 10
+
+typedef struct {
+    Indexer* idx;
+    const QueryLog* log;
+    const ReplayConfig* cfg;
+    const uint64_t* schedule;   // Open loop: arrival of query i, ns after start
+    uint64_t* latencies;        // One slot per query
+    uint64_t start_ns;
+    size_t total;
+    size_t next;                // Next query to claim (atomic)
+    uint64_t errors;            // Atomic
+    uint64_t late;              // Atomic
+} ReplayRun;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int hex_value(char ch) {
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+    return -1;
+}
+
+// Percent-decode src[0..len) into a new string, '+' as space
+static char* url_decode(const char* src, size_t len) {
+    char* out = malloc(len + 1);
+    if (!out) return NULL;
+    size_t o = 0;
+    for (size_t i = 0; i < len; i++) {
+        char ch = src[i];
+        if (ch == '+') {
+            ch = ' ';
+        } else if (ch == '%' && i + 2 < len) {
+            int hi = hex_value(src[i + 1]);
+            int lo = hex_value(src[i + 2]);
+            if (hi >= 0 && lo >= 0) {
+                ch = (char)((hi << 4) | lo);
+                i += 2;
+            }
+        }
+        out[o++] = ch;
+    }
+    out[o] = '\0';
+    return out;
+}
+
+// Raw value of a query parameter in "a=1&b=2", or NULL
+static const char* query_param(const char* query, size_t query_len, const char* name,
+                               size_t* value_len) {
+    size_t name_len = strlen(name);
+    const char* p = query;
+    const char* end = query + query_len;
+    while (p < end) {
+        const char* amp = memchr(p, '&', (size_t)(end - p));
+        const char* field_end = amp ? amp : end;
+        const char* eq = memchr(p, '=', (size_t)(field_end - p));
+        if (eq && (size_t)(eq - p) == name_len && memcmp(p, name, name_len) == 0) {
+            *value_len = (size_t)(field_end - eq - 1);
+            return eq + 1;
+        }
+        p = field_end + 1;
+    }
+    return NULL;
+}
+
+// Optional numeric parameter; false if present but not a number
+static bool size_param(const char* query, size_t query_len, const char* name, size_t* value) {
+    size_t len = 0;
+    const char* raw = query_param(query, query_len, name, &len);
+    if (!raw) return true;
+    if (len == 0 || len > 19) return false;
+    size_t v = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (raw[i] < '0' || raw[i] > '9') return false;
+        v = v * 10 + (size_t)(raw[i] - '0');
+    }
+    *value = v;
+    return true;
+}
+
+// Parse one log line; returns 0, EINVAL for lines to skip or ENOMEM
+static int parse_line(const char* line, size_t len, ReplayQuery* q) {
+    if (len >= 4 && memcmp(line, "GET ", 4) == 0) {
+        line += 4;
+        len -= 4;
+        const char* space = memchr(line, ' ', len);
+        if (space) len = (size_t)(space - line);
+    }
+    if (len == 0) return EINVAL;
+
+    q->offset = 0;
+    q->limit = SIZE_MAX;
+    if (line[0] != '/') {
+        q->type = REPLAY_SEARCH;
+        q->text = strndup(line, len);
+        return q->text ? 0 : ENOMEM;
+    }
+
+    const char* mark = memchr(line, '?', len);
+    if (!mark) return EINVAL;
+    size_t path_len = (size_t)(mark - line);
+    const char* query = mark + 1;
+    size_t query_len = len - path_len - 1;
+
+    if (path_len == 7 && memcmp(line, "/search", 7) == 0) {
+        q->type = REPLAY_SEARCH;
+        if (!size_param(query, query_len, "offset", &q->offset)) return EINVAL;
+    } else if (path_len == 9 && memcmp(line, "/complete", 9) == 0) {
+        q->type = REPLAY_COMPLETE;
+        q->limit = REPLAY_DEFAULT_COMPLETIONS;
+    } else if (path_len == 5 && memcmp(line, "/rank", 5) == 0) {
+        q->type = REPLAY_RANK;
+        q->limit = REPLAY_DEFAULT_RANKED;
+    } else {
+        return EINVAL;
+    }
+    if (!size_param(query, query_len, "limit", &q->limit)) return EINVAL;
+    if (q->type != REPLAY_SEARCH) {
+        if (q->limit == 0) return EINVAL;
+        if (q->limit > REPLAY_MAX_RESULTS) q->limit = REPLAY_MAX_RESULTS;
+    }
+
+    size_t raw_len = 0;
+    const char* raw = query_param(query, query_len, "q", &raw_len);
+    if (!raw) return EINVAL;
+    q->text = url_decode(raw, raw_len);
+    return q->text ? 0 : ENOMEM;
+}
+
+QueryLog* query_log_read(FILE* fp, int* err) {
+    if (!fp) {
+        ERROR_LOG("Invalid arguments: fp=%p", (void*)fp);
+        if (err) *err = EINVAL;
+        return NULL;
+    }
+
+    QueryLog* log = calloc(1, sizeof(QueryLog));
+    if (!log) {
+        if (err) *err = ENOMEM;
+        return NULL;
+    }
+
+    size_t capacity = 0;
+    char* line = NULL;
+    size_t line_cap = 0;
+    ssize_t n;
+    int rc = 0;
+    while (rc == 0 && (n = getline(&line, &line_cap, fp)) >= 0) {
+        size_t len = (size_t)n;
+        while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) len--;
+
+        if (log->count == capacity) {
+            size_t new_capacity = capacity ? capacity * 2 : 1024;
+            ReplayQuery* grown = realloc(log->queries, new_capacity * sizeof(ReplayQuery));
+            if (!grown) {
+                rc = ENOMEM;
+                break;
+            }
+            log->queries = grown;
+            capacity = new_capacity;
+        }
+
+        int line_rc = parse_line(line, len, &log->queries[log->count]);
+        if (line_rc == 0) {
+            log->count++;
+        } else if (line_rc == EINVAL) {
+            log->skipped++;
+        } else {
+            rc = line_rc;
+        }
+    }
+    free(line);
+
+    if (rc != 0) {
+        query_log_destroy(log);
+        if (err) *err = rc;
+        return NULL;
+    }
+    if (err) *err = 0;
+    return log;
+}
+
+void query_log_destroy(QueryLog* log) {
+    if (!log) return;
+    for (size_t i = 0; i < log->count; i++) free(log->queries[i].text);
+    free(log->queries);
+    free(log);
+}
+
+void replay_config_init(ReplayConfig* cfg) {
+    if (!cfg) return;
+    cfg->mode = REPLAY_CLOSED_LOOP;
+    cfg->num_threads = 0;
+    cfg->target_qps = 1000;
+    cfg->num_queries = 0;
+    cfg->seed = 42;
+}
+
+// Run one query the way search_server answers it; returns 0 or an errno
+static int run_query(Indexer* idx, const ReplayQuery* q) {
+    if (q->type == REPLAY_SEARCH) {
+        SearchCursor cursor;
+        int rc = indexer_cursor_open(idx, q->text, &cursor);
+        if (rc == 0) {
+            indexer_cursor_skip(&cursor, q->offset);
+            size_t count = 0;
+            while (count < q->limit && indexer_cursor_next(&cursor) != NULL) count++;
+        }
+        indexer_cursor_close(&cursor);
+        return rc == ENOENT ? 0 : rc;
+    }
+
+    if (q->type == REPLAY_COMPLETE) {
+        CompletionResult results[REPLAY_MAX_RESULTS];
+        size_t count = 0;
+        int rc = indexer_complete(idx, q->text, results, q->limit, &count);
+        for (size_t i = 0; i < count; i++) indexer_cursor_close(&results[i].cursor);
+        return rc == ENOENT ? 0 : rc;
+    }
+
+    // Ranked: split the terms on spaces as search_server does
+    char text[1024];
+    size_t len = strlen(q->text);
+    if (len >= sizeof(text)) return E2BIG;
+    memcpy(text, q->text, len + 1);
+    const char* terms[REPLAY_MAX_TERMS];
+    size_t n = 0;
+    char* save = NULL;
+    for (char* t = strtok_r(text, " ", &save); t; t = strtok_r(NULL, " ", &save)) {
+        if (n == REPLAY_MAX_TERMS) return E2BIG;
+        terms[n++] = t;
+    }
+    if (n == 0) return EINVAL;
+
+    RankedDoc ranked[REPLAY_MAX_RESULTS];
+    size_t count = 0;
+    int rc = indexer_search_ranked(idx, terms, n, q->limit, ranked, &count, NULL);
+    return rc == ENOENT ? 0 : rc;
+}
+
+static void* replay_thread(void* arg) {
+    ReplayRun* run = arg;
+    const QueryLog* log = run->log;
+    bool open_loop = run->cfg->mode == REPLAY_OPEN_LOOP;
+
+    for (;;) {
+        size_t i = __atomic_fetch_add(&run->next, 1, __ATOMIC_RELAXED);
+        if (i >= run->total) break;
+
+        uint64_t start;
+        if (open_loop) {
+            // Wait for the arrival; latency counts from it even when we are late
+            start = run->start_ns + run->schedule[i];
+            uint64_t now = now_ns();
+            if (now < start) {
+                struct timespec ts = {
+                    .tv_sec = (time_t)(start / 1000000000ULL),
+                    .tv_nsec = (long)(start % 1000000000ULL)
+                };
+                while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+                }
+            } else if (now - start > REPLAY_LATE_NS) {
+                __atomic_fetch_add(&run->late, 1, __ATOMIC_RELAXED);
+            }
+        } else {
+            start = now_ns();
+        }
+
+        if (run_query(run->idx, &log->queries[i % log->count]) != 0) {
+            __atomic_fetch_add(&run->errors, 1, __ATOMIC_RELAXED);
+        }
+        run->latencies[i] = now_ns() - start;
+    }
+    return NULL;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+// Nearest-rank percentile of sorted samples
+static uint64_t percentile(const uint64_t* sorted, size_t count, double p) {
+    size_t rank = (size_t)ceil(p / 100.0 * (double)count);
+    return sorted[rank == 0 ? 0 : rank - 1];
+}
+
+int query_replay_run(Indexer* idx, const QueryLog* log, const ReplayConfig* cfg,
+                     ReplayReport* report) {
+    if (!idx || !log || log->count == 0 || !cfg || !report || cfg->num_threads < 0 ||
+        (cfg->mode == REPLAY_OPEN_LOOP && !(cfg->target_qps > 0))) {
+        ERROR_LOG("Invalid arguments: idx=%p, log=%p, cfg=%p, report=%p",
+                  (void*)idx, (const void*)log, (const void*)cfg, (void*)report);
+        return EINVAL;
+    }
+
+    int num_threads = cfg->num_threads;
+    if (num_threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = cpus > 0 ? (int)cpus : 1;
+    }
+
+    ReplayRun run = {
+        .idx = idx,
+        .log = log,
+        .cfg = cfg,
+        .total = cfg->num_queries ? cfg->num_queries : log->count
+    };
+    run.latencies = malloc(run.total * sizeof(uint64_t));
+    pthread_t* threads = malloc((size_t)num_threads * sizeof(pthread_t));
+    uint64_t* schedule = NULL;
+    if (cfg->mode == REPLAY_OPEN_LOOP) {
+        schedule = malloc(run.total * sizeof(uint64_t));
+        // Exponential gaps give Poisson arrivals at target_qps
+        uint64_t state = cfg->seed;
+        double t = 0;
+        for (size_t i = 0; schedule && i < run.total; i++) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            double u = (double)(state >> 11) * (1.0 / 9007199254740992.0);
+            t += -log1p(-u) / cfg->target_qps * 1e9;
+            schedule[i] = (uint64_t)t;
+        }
+    }
+    run.schedule = schedule;
+    if (!run.latencies || !threads || (cfg->mode == REPLAY_OPEN_LOOP && !schedule)) {
+        free(run.latencies);
+        free(threads);
+        free(schedule);
+        return ENOMEM;
+    }
+
+    int rc = 0;
+    int started = 0;
+    run.start_ns = now_ns();
+    for (; started < num_threads; started++) {
+        rc = pthread_create(&threads[started], NULL, replay_thread, &run);
+        if (rc != 0) break;
+    }
+    if (rc != 0) {
+        // Stop the threads that did start
+        __atomic_store_n(&run.next, run.total, __ATOMIC_RELAXED);
+    }
+    for (int t = 0; t < started; t++) pthread_join(threads[t], NULL);
+    uint64_t elapsed = now_ns() - run.start_ns;
+
+    if (rc == 0) {
+        qsort(run.latencies, run.total, sizeof(uint64_t), compare_u64);
+        memset(report, 0, sizeof(*report));
+        report->threads = num_threads;
+        report->queries = run.total;
+        report->errors = run.errors;
+        report->late = run.late;
+        report->elapsed_ns = elapsed;
+        report->qps = (double)run.total * 1e9 / (double)(elapsed ? elapsed : 1);
+        report->p50_ns = percentile(run.latencies, run.total, 50);
+        report->p90_ns = percentile(run.latencies, run.total, 90);
+        report->p99_ns = percentile(run.latencies, run.total, 99);
+        report->p999_ns = percentile(run.latencies, run.total, 99.9);
+        report->max_ns = run.latencies[run.total - 1];
+    }
+
+    free(run.latencies);
+    free(threads);
+    free(schedule);
+    return rc;
+}
+
+void replay_report_write(const ReplayReport* report, const ReplayConfig* cfg, FILE* fp) {
+    if (!report || !cfg || !fp) return;
+    bool open_loop = cfg->mode == REPLAY_OPEN_LOOP;
+    fprintf(fp, "{\"mode\":\"%s\",\"threads\":%d", open_loop ? "open" : "closed", report->threads);
+    if (open_loop) fprintf(fp, ",\"target_qps\":%.1f", cfg->target_qps);
+    fprintf(fp, ",\"queries\":%llu,\"errors\":%llu", (unsigned long long)report->queries,
+            (unsigned long long)report->errors);
+    if (open_loop) fprintf(fp, ",\"late\":%llu", (unsigned long long)report->late);
+    fprintf(fp, ",\"elapsed_s\":%.3f,\"qps\":%.1f", (double)report->elapsed_ns / 1e9, report->qps);
+    fprintf(fp, ",\"p50_ns\":%llu,\"p90_ns\":%llu,\"p99_ns\":%llu,\"p999_ns\":%llu,\"max_ns\":%llu}\n",
+            (unsigned long long)report->p50_ns, (unsigned long long)report->p90_ns,
+            (unsigned long long)report->p99_ns, (unsigned long long)report->p999_ns,
+            (unsigned long long)report->max_ns);
+}
@@ -0,0 +1,358 @@
+#include "ranking.h"
+#include "logging.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <math.h>
+
+#define RANK_BLOCK_SIZE 64
+#define RANK_END UINT32_MAX
+
+// Bounds for one block of a doc-ordered posting view
+typedef struct {
+    uint32_t last_doc;      // Largest ordinal in the block
+    uint32_t max_tf;
+    uint32_t min_len;       // Shortest document length when the view was built
+} PostingBlock;
+
+// Doc-ordered copy of a PostingList. Document lengths only grow, so the
+// recorded minimum lengths keep the score bounds valid as the index changes.
+struct PostingView {
+    uint32_t count;
+    uint32_t num_blocks;
+    uint32_t max_tf;
+    uint32_t min_len;
+    uint32_t* docs;         // Sorted ordinals
+    uint32_t* tfs;
+    PostingBlock* blocks;
+};
+
+typedef struct {
+    const struct PostingView* view;
+    size_t pos;             // Current posting
+    size_t block;           // Block hint; only moves forward
+    double idf;
+    double max_score;       // Upper bound over the whole list
+} TermCursor;
+
+typedef struct {
+    double score;
+    uint32_t doc;
+} HeapEntry;
+
+double rank_bm25_idf(size_t df, size_t num_docs) {
+    double n = (double)num_docs;
+    double d = (double)df;
+    return log(1.0 + (n - d + 0.5) / (d + 0.5));
+}
+
+double rank_bm25_term_score(double idf, uint32_t tf, uint32_t doc_len, double avg_doc_len) {
+    double norm = BM25_K1 * (1.0 - BM25_B + BM25_B * (double)doc_len / avg_doc_len);
+    return idf * (double)tf * (BM25_K1 + 1.0) / ((double)tf + norm);
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static struct PostingView* build_view(const GTrie* trie, const PostingList* list) {
+    size_t n = list->count;
+    size_t num_blocks = (n + RANK_BLOCK_SIZE - 1) / RANK_BLOCK_SIZE;
+
+    // Header, ordinals, frequencies and blocks share one allocation
+    size_t size = sizeof(struct PostingView) + 2 * n * sizeof(uint32_t) +
+                  num_blocks * sizeof(PostingBlock);
+    struct PostingView* view = malloc(size);
+    uint64_t* pairs = malloc((n ? n : 1) * sizeof(uint64_t));
+    if (!view || !pairs) {
+        free(view);
+        free(pairs);
+        return NULL;
+    }
+
+    size_t i = 0;
+    for (const PostingEntry* e = list->head; e && i < n; e = e->next) {
+        pairs[i++] = ((uint64_t)e->doc << 32) | e->tf;
+    }
+    n = i;
+    qsort(pairs, n, sizeof(uint64_t), compare_u64);
+
+    view->count = (uint32_t)n;
+    view->num_blocks = (uint32_t)((n + RANK_BLOCK_SIZE - 1) / RANK_BLOCK_SIZE);
+    view->docs = (uint32_t*)(view + 1);
+    view->tfs = view->docs + n;
+    view->blocks = (PostingBlock*)(view->tfs + n);
+    view->max_tf = 0;
+    view->min_len = UINT32_MAX;
+
+    for (i = 0; i < n; i++) {
+        uint32_t doc = (uint32_t)(pairs[i] >> 32);
+        uint32_t tf = (uint32_t)pairs[i];
+        uint32_t len = doc_table_length(trie->docs, doc);
+        view->docs[i] = doc;
+        view->tfs[i] = tf;
+
+        PostingBlock* block = &view->blocks[i / RANK_BLOCK_SIZE];
+        if (i % RANK_BLOCK_SIZE == 0) {
+            block->max_tf = 0;
+            block->min_len = UINT32_MAX;
+        }
+        block->last_doc = doc;
+        if (tf > block->max_tf) block->max_tf = tf;
+        if (len < block->min_len) block->min_len = len;
+        if (tf > view->max_tf) view->max_tf = tf;
+        if (len < view->min_len) view->min_len = len;
+    }
+
+    free(pairs);
+    return view;
+}
+
+// Doc-ordered view of list, built on first use. Concurrent readers may race
+// to build it; the loser frees its copy.
+static const struct PostingView* get_view(const GTrie* trie, PostingList* list) {
+    struct PostingView* view = __atomic_load_n(&list->view, __ATOMIC_ACQUIRE);
+    if (view) return view;
+
+    struct PostingView* built = build_view(trie, list);
+    if (!built) return NULL;
+
+    struct PostingView* expected = NULL;
+    if (__atomic_compare_exchange_n(&list->view, &expected, built, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return built;
+    }
+    free(built);
+    return expected;
+}
+
+size_t rank_view_bytes(const PostingList* list) {
+    if (!list) return 0;
+    const struct PostingView* view = __atomic_load_n(&list->view, __ATOMIC_ACQUIRE);
+    if (!view) return 0;
+    return sizeof(struct PostingView) + 2 * (size_t)view->count * sizeof(uint32_t) +
+           view->num_blocks * sizeof(PostingBlock);
+}
+
+static inline uint32_t cursor_doc(const TermCursor* c) {
+    return c->pos < c->view->count ? c->view->docs[c->pos] : RANK_END;
+}
+
+// Block containing target (or the last block); moves the hint forward
+static size_t cursor_block(TermCursor* c, uint32_t target) {
+    const struct PostingView* v = c->view;
+    while (c->block + 1 < v->num_blocks && v->blocks[c->block].last_doc < target) {
+        c->block++;
+    }
+    return c->block;
+}
+
+// Move to the first posting with ordinal >= target, skipping whole blocks
+static void cursor_advance(TermCursor* c, uint32_t target) {
+    const struct PostingView* v = c->view;
+    if (cursor_doc(c) >= target) return;
+
+    size_t block = cursor_block(c, target);
+    if (v->blocks[block].last_doc < target) {
+        c->pos = v->count;
+        return;
+    }
+    if (c->pos < block * RANK_BLOCK_SIZE) c->pos = block * RANK_BLOCK_SIZE;
+    while (c->pos < v->count && v->docs[c->pos] < target) c->pos++;
+}
+
+static void sort_cursors(TermCursor** cursors, size_t n) {
+    for (size_t i = 1; i < n; i++) {
+        TermCursor* c = cursors[i];
+        uint32_t doc = cursor_doc(c);
+        size_t j = i;
+        while (j > 0 && cursor_doc(cursors[j - 1]) > doc) {
+            cursors[j] = cursors[j - 1];
+            j--;
+        }
+        cursors[j] = c;
+    }
+}
+
+// Min-heap ordered by score; on ties the later document ranks lower
+static inline bool heap_less(const HeapEntry* a, const HeapEntry* b) {
+    if (a->score != b->score) return a->score < b->score;
+    return a->doc > b->doc;
+}
+
+static void heap_sift_down(HeapEntry* heap, size_t size, size_t i) {
+    for (;;) {
+        size_t smallest = i;
+        size_t l = 2 * i + 1, r = l + 1;
+        if (l < size && heap_less(&heap[l], &heap[smallest])) smallest = l;
+        if (r < size && heap_less(&heap[r], &heap[smallest])) smallest = r;
+        if (smallest == i) return;
+        HeapEntry tmp = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+static void heap_push(HeapEntry* heap, size_t* size, size_t k, HeapEntry entry) {
+    if (*size < k) {
+        size_t i = (*size)++;
+        heap[i] = entry;
+        while (i > 0 && heap_less(&heap[i], &heap[(i - 1) / 2])) {
+            HeapEntry tmp = heap[i];
+            heap[i] = heap[(i - 1) / 2];
+            heap[(i - 1) / 2] = tmp;
+            i = (i - 1) / 2;
+        }
+    } else if (heap_less(&heap[0], &entry)) {
+        heap[0] = entry;
+        heap_sift_down(heap, *size, 0);
+    }
+}
+
+static int compare_heap_desc(const void* a, const void* b) {
+    const HeapEntry* x = a;
+    const HeapEntry* y = b;
+    if (heap_less(x, y)) return 1;
+    if (heap_less(y, x)) return -1;
+    return 0;
+}
+
+int rank_bm25_top_k(const GTrie* trie, const char* const* terms, size_t num_terms, size_t k,
+                    RankedDoc* out, size_t* count, RankStats* stats) {
+    if (count) *count = 0;
+    if (stats) memset(stats, 0, sizeof(*stats));
+    if (!trie || !terms || !out || k == 0) return EINVAL;
+
+    size_t num_docs = doc_table_count(trie->docs);
+    double avg_len = num_docs ? (double)doc_table_total_length(trie->docs) / (double)num_docs : 1.0;
+
+    TermCursor* storage = calloc(num_terms ? num_terms : 1, sizeof(TermCursor));
+    TermCursor** cursors = malloc((num_terms ? num_terms : 1) * sizeof(TermCursor*));
+    HeapEntry* heap = malloc(k * sizeof(HeapEntry));
+    if (!storage || !cursors || !heap) {
+        free(storage);
+        free(cursors);
+        free(heap);
+        return ENOMEM;
+    }
+
+    int rc = 0;
+    size_t n = 0;
+    size_t total_postings = 0;
+    for (size_t t = 0; t < num_terms; t++) {
+        if (!terms[t]) {
+            rc = EINVAL;
+            break;
+        }
+        int err = 0;
+        PostingList* list = gtrie_search(trie, terms[t], &err);
+        if (err == EINVAL) {
+            rc = EINVAL;
+            break;
+        }
+        if (!list || list->count == 0) continue;
+
+        const struct PostingView* view = get_view(trie, list);
+        if (!view) {
+            rc = ENOMEM;
+            break;
+        }
+
+        TermCursor* c = &storage[n];
+        c->view = view;
+        c->idf = rank_bm25_idf(view->count, num_docs);
+        c->max_score = rank_bm25_term_score(c->idf, view->max_tf, view->min_len, avg_len);
+        cursors[n++] = c;
+        total_postings += view->count;
+    }
+
+    size_t heap_size = 0;
+    size_t scored = 0;
+    double threshold = 0.0;
+
+    while (rc == 0 && n > 0) {
+        sort_cursors(cursors, n);
+
+        // Pivot: first cursor at which the summed upper bounds beat the threshold
+        double bound = 0.0;
+        size_t p = 0;
+        bool found = false;
+        for (; p < n && cursor_doc(cursors[p]) != RANK_END; p++) {
+            bound += cursors[p]->max_score;
+            if (bound > threshold) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) break;
+
+        uint32_t pivot = cursor_doc(cursors[p]);
+        while (p + 1 < n && cursor_doc(cursors[p + 1]) == pivot) p++;
+
+        // Refine with the block maxima around the pivot
+        double block_bound = 0.0;
+        for (size_t i = 0; i <= p; i++) {
+            TermCursor* c = cursors[i];
+            const PostingBlock* b = &c->view->blocks[cursor_block(c, pivot)];
+            block_bound += rank_bm25_term_score(c->idf, b->max_tf, b->min_len, avg_len);
+        }
+
+        if (heap_size == k && block_bound <= threshold) {
+            // No document before the end of these blocks can qualify
+            uint32_t next = RANK_END;
+            for (size_t i = 0; i <= p; i++) {
+                uint32_t last = cursors[i]->view->blocks[cursors[i]->block].last_doc;
+                if (last != RANK_END && last + 1 < next) next = last + 1;
+            }
+            if (p + 1 < n && cursor_doc(cursors[p + 1]) < next) next = cursor_doc(cursors[p + 1]);
+            for (size_t i = 0; i <= p; i++) {
+                cursor_advance(cursors[i], next);
+            }
+            continue;
+        }
+
+        if (cursor_doc(cursors[0]) == pivot) {
+            // Every cursor up to the pivot sits on it: score the document
+            uint32_t len = doc_table_length(trie->docs, pivot);
+            double score = 0.0;
+            for (size_t i = 0; i <= p; i++) {
+                TermCursor* c = cursors[i];
+                score += rank_bm25_term_score(c->idf, c->view->tfs[c->pos], len, avg_len);
+                c->pos++;
+            }
+            scored++;
+
+            heap_push(heap, &heap_size, k, (HeapEntry){ score, pivot });
+            if (heap_size == k) threshold = heap[0].score;
+        } else {
+            for (size_t i = 0; i < p; i++) {
+                cursor_advance(cursors[i], pivot);
+            }
+        }
+    }
+
+    if (rc == 0) {
+        qsort(heap, heap_size, sizeof(HeapEntry), compare_heap_desc);
+        for (size_t i = 0; i < heap_size; i++) {
+            out[i].doc_id = doc_table_id(trie->docs, heap[i].doc);
+            out[i].score = heap[i].score;
+        }
+        if (count) *count = heap_size;
+        if (stats) {
+            stats->postings = total_postings;
+            stats->scored = scored;
+        }
+        if (n == 0) rc = ENOENT;
+    }
+
+    TRACE_LOG("Ranked %zu terms: %zu of %zu postings scored", num_terms, scored, total_postings);
+    free(storage);
+    free(cursors);
+    free(heap);
+    return rc;
+}
@@ -0,0 +1,1499 @@
+#define _GNU_SOURCE
+#include "search_server.h"
+#include "logging.h"
+#include "metrics.h"
+#include "placement.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define SERVER_DEFAULT_BACKLOG 1024
+#define SERVER_DEFAULT_MAX_REQUEST 8192
+#define SERVER_MAX_EVENTS 256
+#define SERVER_READ_CHUNK 16384
+#define SERVER_BUFFER_KEEP (64 * 1024)   // Larger buffers are released on close
+#define SERVER_MAX_KEY_LENGTH 1024
+#define SERVER_CACHE_KEY_LENGTH (SERVER_MAX_KEY_LENGTH + 48)
+#define SERVER_DEFAULT_COMPLETIONS 10
+#define SERVER_MAX_COMPLETIONS 100
+#define SERVER_DEFAULT_RANKED 10
+#define SERVER_MAX_RANKED 100
+#define SERVER_MAX_TERMS COORDINATOR_MAX_TERMS
+#define SERVER_FANOUT_PER_WORKER 4
+
+// Growable byte buffer, reused across requests
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+} Buffer;
+
+typedef struct Connection {
+    int fd;
+    Buffer in;
+    Buffer out;
+    size_t out_sent;
+    bool close_after_write;
+    bool want_write;
+    bool peer_closed;       // Read EOF; close once buffered requests are answered
+    bool parked;            // Out of the epoll set while a fan-out runs
+    struct Connection* prev;
+    struct Connection* next;
+} Connection;
+
+typedef struct FanoutJob FanoutJob;
+
+typedef struct {
+    struct SearchServer* srv;
+    Indexer* idx;           // The server's index, or the replica of this worker's node
+    int node;               // NUMA node the worker is bound to, -1 when unbound
+    pthread_t thread;
+    int epoll_fd;
+    int wake_fd;            // eventfd used to stop the loop
+    int done_fd;            // eventfd signalled when a fan-out finishes
+    pthread_mutex_t done_lock;
+    FanoutJob* done;        // Finished fan-outs, guarded by done_lock
+    Buffer body;            // Response body scratch, reused for every request
+    Connection* active;     // Open connections
+    Connection* free_list;  // Closed connections kept for their buffers
+} Worker;
+
+typedef enum {
+    FANOUT_SEARCH,
+    FANOUT_BOOL,
+    FANOUT_RANK
+} FanoutKind;
+
+// A coordinated query. Shard round trips take up to the coordinator timeout,
+// so they run on the fan-out pool while the worker serves other connections.
+struct FanoutJob {
+    Worker* worker;
+    Connection* conn;
+    FanoutKind kind;
+    char text[SERVER_MAX_KEY_LENGTH];   // Decoded key, or the terms split in place
+    const char* terms[SERVER_MAX_TERMS];
+    size_t num_terms;
+    size_t limit;
+    bool intersect;
+    int rc;
+    CoordinatorResult result;
+    FanoutJob* next;
+};
+
+struct SearchServer {
+    Indexer* idx;
+    QueryCache* cache;          // Serialized /search bodies, NULL when disabled
+    SearchServerConfig cfg;
+    int listen_fd;
+    uint16_t port;
+    Worker* workers;
+    int num_workers;
+    pthread_t* fanout_threads;  // Coordinator mode only
+    int num_fanout;
+    pthread_mutex_t fanout_lock;
+    pthread_cond_t fanout_wake;
+    FanoutJob* fanout_head;     // Queued jobs, guarded by fanout_lock
+    FanoutJob* fanout_tail;
+    bool fanout_stopping;
+    bool running;
+};
+
+// Parsed request head; all pointers reference the connection input buffer
+typedef struct {
+    const char* method;
+    size_t method_len;
+    const char* target;
+    size_t target_len;
+    size_t content_length;
+    bool keep_alive;
+} HttpRequest;
+
+static int buffer_reserve(Buffer* buf, size_t extra) {
+    if (buf->len + extra <= buf->cap) return 0;
+
+    size_t cap = buf->cap ? buf->cap : 1024;
+    while (cap < buf->len + extra) cap *= 2;
+
+    char* data = realloc(buf->data, cap);
+    if (!data) return ENOMEM;
+    buf->data = data;
+    buf->cap = cap;
+    return 0;
+}
+
+static int buffer_append(Buffer* buf, const char* data, size_t len) {
+    int rc = buffer_reserve(buf, len);
+    if (rc != 0) return rc;
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+    return 0;
+}
+
+static int buffer_append_str(Buffer* buf, const char* str) {
+    return buffer_append(buf, str, strlen(str));
+}
+
+static int buffer_append_size(Buffer* buf, size_t value) {
+    char tmp[32];
+    int len = snprintf(tmp, sizeof(tmp), "%zu", value);
+    return buffer_append(buf, tmp, (size_t)len);
+}
+
+static int buffer_append_double(Buffer* buf, double value) {
+    char tmp[32];
+    int len = snprintf(tmp, sizeof(tmp), "%.17g", value);
+    return buffer_append(buf, tmp, (size_t)len);
+}
+
+static void buffer_shrink(Buffer* buf) {
+    buf->len = 0;
+    if (buf->cap > SERVER_BUFFER_KEEP) {
+        free(buf->data);
+        buf->data = NULL;
+        buf->cap = 0;
+    }
+}
+
+static void buffer_free(Buffer* buf) {
+    free(buf->data);
+    buf->data = NULL;
+    buf->len = buf->cap = 0;
+}
+
+// Append a JSON string literal, escaping quotes, backslashes and control bytes
+static int json_append_string(Buffer* buf, const char* str, size_t len) {
+    static const char hex[] = "0123456789abcdef";
+
+    if (buffer_reserve(buf, len + 2) != 0) return ENOMEM;
+    buf->data[buf->len++] = '"';
+
+    for (size_t i = 0; i < len; i++) {
+        unsigned char ch = (unsigned char)str[i];
+        if (ch == '"' || ch == '\\') {
+            char esc[2] = {'\\', (char)ch};
+            if (buffer_append(buf, esc, 2) != 0) return ENOMEM;
+        } else if (ch < 0x20) {
+            char esc[6] = {'\\', 'u', '0', '0', hex[ch >> 4], hex[ch & 0xF]};
+            if (buffer_append(buf, esc, 6) != 0) return ENOMEM;
+        } else {
+            if (buffer_append(buf, (const char*)&ch, 1) != 0) return ENOMEM;
+        }
+    }
+
+    return buffer_append(buf, "\"", 1);
+}
+
+static int hex_value(char ch) {
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+    return -1;
+}
+
+// Decode a percent-encoded query value into out; returns false if it does not fit
+static bool url_decode(const char* src, size_t len, char* out, size_t out_size) {
+    size_t o = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (o + 1 >= out_size) return false;
+
+        char ch = src[i];
+        if (ch == '+') {
+            ch = ' ';
+        } else if (ch == '%' && i + 2 < len) {
+            int hi = hex_value(src[i + 1]);
+            int lo = hex_value(src[i + 2]);
+            if (hi >= 0 && lo >= 0) {
+                ch = (char)((hi << 4) | lo);
+                i += 2;
+            }
+        }
+        out[o++] = ch;
+    }
+    out[o] = '\0';
+    return true;
+}
+
+// Find a query parameter in "a=1&b=2"; returns a pointer to its raw value
+static const char* query_param(const char* query, size_t query_len, const char* name,
+                               size_t* value_len) {
+    size_t name_len = strlen(name);
+    const char* p = query;
+    const char* end = query + query_len;
+
+    while (p < end) {
+        const char* amp = memchr(p, '&', (size_t)(end - p));
+        const char* field_end = amp ? amp : end;
+        const char* eq = memchr(p, '=', (size_t)(field_end - p));
+
+        if (eq && (size_t)(eq - p) == name_len && memcmp(p, name, name_len) == 0) {
+            *value_len = (size_t)(field_end - eq - 1);
+            return eq + 1;
+        }
+        p = field_end + 1;
+    }
+    return NULL;
+}
+
+static const char* status_text(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 504: return "Gateway Timeout";
+        default:  return "Unknown";
+    }
+}
+
+// Queue a complete response (head + worker body scratch) on the connection
+static int queue_typed_response(Worker* w, Connection* conn, int status, const char* content_type) {
+    char head[256];
+    int head_len = snprintf(head, sizeof(head),
+                            "HTTP/1.1 %d %s\r\n"
+                            "Content-Type: %s\r\n"
+                            "Content-Length: %zu\r\n"
+                            "Connection: %s\r\n\r\n",
+                            status, status_text(status), content_type, w->body.len,
+                            conn->close_after_write ? "close" : "keep-alive");
+
+    if (buffer_reserve(&conn->out, (size_t)head_len + w->body.len) != 0) return ENOMEM;
+    buffer_append(&conn->out, head, (size_t)head_len);
+    buffer_append(&conn->out, w->body.data, w->body.len);
+    return 0;
+}
+
+static int queue_response(Worker* w, Connection* conn, int status) {
+    return queue_typed_response(w, conn, status, "application/json");
+}
+
+static int queue_error(Worker* w, Connection* conn, int status, const char* message) {
+    w->body.len = 0;
+    buffer_append_str(&w->body, "{\"error\":");
+    json_append_string(&w->body, message, strlen(message));
+    buffer_append_str(&w->body, "}");
+    return queue_response(w, conn, status);
+}
+
+// Parse an optional non-negative integer query parameter
+static bool size_param(const char* query, size_t query_len, const char* name, size_t* value) {
+    size_t raw_len = 0;
+    const char* raw = query ? query_param(query, query_len, name, &raw_len) : NULL;
+    if (!raw) return true;
+
+    size_t v = 0;
+    if (raw_len == 0 || raw_len > 18) return false;
+    for (size_t i = 0; i < raw_len; i++) {
+        if (raw[i] < '0' || raw[i] > '9') return false;
+        v = v * 10 + (size_t)(raw[i] - '0');
+    }
+    *value = v;
+    return true;
+}
+
+// Serve a cached body into the worker scratch buffer; returns true on a hit
+static bool lookup_cached_body(Worker* w, const char* cache_key, size_t cache_key_len,
+                               uint64_t generation) {
+    size_t len = 0;
+    int rc = query_cache_lookup(w->srv->cache, cache_key, cache_key_len, generation,
+                                w->body.data, w->body.cap, &len);
+    if (rc == ENOSPC && buffer_reserve(&w->body, len) == 0) {
+        rc = query_cache_lookup(w->srv->cache, cache_key, cache_key_len, generation,
+                                w->body.data, w->body.cap, &len);
+    }
+    if (rc != 0) return false;
+
+    w->body.len = len;
+    return true;
+}
+
+// Split a decoded query value on spaces; returns SERVER_MAX_TERMS + 1 when
+// there are too many terms
+static size_t split_terms(char* text, const char** terms) {
+    size_t n = 0;
+    char* save = NULL;
+    for (char* t = strtok_r(text, " ", &save); t; t = strtok_r(NULL, " ", &save)) {
+        if (n == SERVER_MAX_TERMS) return n + 1;
+        terms[n++] = t;
+    }
+    return n;
+}
+
+// 400 for a multi-term query with no terms or more than SERVER_MAX_TERMS
+static int queue_terms_error(Worker* w, Connection* conn) {
+    char message[64];
+    snprintf(message, sizeof(message), "between 1 and %d terms required", SERVER_MAX_TERMS);
+    return queue_error(w, conn, 400, message);
+}
+
+// Write a merged coordinator answer: docs, or {"doc","score"} objects when
+// ranked. field/value (optional) echo the query as the local handlers do.
+static int queue_coordinated(Worker* w, Connection* conn, int rc, const char* field,
+                             const char* value, CoordinatorResult* result, bool ranked) {
+    if (rc == ETIMEDOUT) return queue_error(w, conn, 504, "no shard answered in time");
+    if (rc != 0) return queue_error(w, conn, rc == EINVAL ? 400 : 500, strerror(rc));
+
+    Buffer* body = &w->body;
+    body->len = 0;
+    buffer_append_str(body, "{");
+    if (field) {
+        buffer_append_str(body, "\"");
+        buffer_append_str(body, field);
+        buffer_append_str(body, "\":");
+        json_append_string(body, value, strlen(value));
+        buffer_append_str(body, ",");
+    }
+    buffer_append_str(body, "\"results\":[");
+    for (size_t i = 0; i < result->count; i++) {
+        if (i > 0) buffer_append(body, ",", 1);
+        if (ranked) buffer_append_str(body, "{\"doc\":");
+        json_append_string(body, result->hits[i].doc_id, strlen(result->hits[i].doc_id));
+        if (ranked) {
+            buffer_append_str(body, ",\"score\":");
+            buffer_append_double(body, result->hits[i].score);
+            buffer_append_str(body, "}");
+        }
+    }
+    buffer_append_str(body, "],\"count\":");
+    buffer_append_size(body, result->count);
+    if (field && strcmp(field, "key") == 0) {
+        buffer_append_str(body, ",\"total\":");
+        buffer_append_size(body, result->total);
+    }
+    buffer_append_str(body, ",\"shards_failed\":");
+    buffer_append_size(body, result->shards_failed);
+    coordinator_result_free(result);
+    if (buffer_append(body, "}", 1) != 0) {
+        return queue_error(w, conn, 500, "out of memory");
+    }
+    return queue_response(w, conn, 200);
+}
+
+// Hand a coordinated query to the fan-out pool. The connection leaves the
+// epoll set until the answer is queued, so requests pipelined behind it keep
+// their order. terms, if any, point into text as left by split_terms.
+static int park_coordinated(Worker* w, Connection* conn, FanoutKind kind, const char* text,
+                            const char* const* terms, size_t num_terms, size_t limit,
+                            bool intersect) {
+    FanoutJob* job = calloc(1, sizeof(FanoutJob));
+    if (!job) return queue_error(w, conn, 500, "out of memory");
+
+    job->worker = w;
+    job->conn = conn;
+    job->kind = kind;
+    const char* last = num_terms > 0 ? terms[num_terms - 1] : text;
+    memcpy(job->text, text, (size_t)(last - text) + strlen(last) + 1);
+    for (size_t i = 0; i < num_terms; i++) job->terms[i] = job->text + (terms[i] - text);
+    job->num_terms = num_terms;
+    job->limit = limit;
+    job->intersect = intersect;
+
+    epoll_ctl(w->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    conn->want_write = false;
+    conn->parked = true;
+
+    SearchServer* srv = w->srv;
+    pthread_mutex_lock(&srv->fanout_lock);
+    if (srv->fanout_tail) {
+        srv->fanout_tail->next = job;
+    } else {
+        srv->fanout_head = job;
+    }
+    srv->fanout_tail = job;
+    pthread_cond_signal(&srv->fanout_wake);
+    pthread_mutex_unlock(&srv->fanout_lock);
+    return 0;
+}
+
+static void* fanout_main(void* arg) {
+    SearchServer* srv = arg;
+    Coordinator* c = srv->cfg.coordinator;
+
+    pthread_mutex_lock(&srv->fanout_lock);
+    for (;;) {
+        while (!srv->fanout_stopping && !srv->fanout_head) {
+            pthread_cond_wait(&srv->fanout_wake, &srv->fanout_lock);
+        }
+        if (srv->fanout_stopping) break;
+        FanoutJob* job = srv->fanout_head;
+        srv->fanout_head = job->next;
+        if (!srv->fanout_head) srv->fanout_tail = NULL;
+        pthread_mutex_unlock(&srv->fanout_lock);
+
+        switch (job->kind) {
+            case FANOUT_SEARCH:
+                job->rc = coordinator_search(c, job->text, job->limit, &job->result);
+                break;
+            case FANOUT_BOOL:
+                job->rc = coordinator_search_bool(c, job->terms, job->num_terms,
+                                                  job->intersect ? SHARD_QUERY_AND : SHARD_QUERY_OR,
+                                                  job->limit, &job->result);
+                break;
+            case FANOUT_RANK:
+                job->rc = coordinator_search_ranked(c, job->terms, job->num_terms, job->limit,
+                                                    &job->result);
+                break;
+        }
+
+        Worker* w = job->worker;
+        pthread_mutex_lock(&w->done_lock);
+        job->next = w->done;
+        w->done = job;
+        pthread_mutex_unlock(&w->done_lock);
+        uint64_t one = 1;
+        ssize_t n = write(w->done_fd, &one, sizeof(one));
+        (void)n;
+
+        pthread_mutex_lock(&srv->fanout_lock);
+    }
+    pthread_mutex_unlock(&srv->fanout_lock);
+    return NULL;
+}
+
+static void free_fanout_jobs(FanoutJob* job) {
+    while (job) {
+        FanoutJob* next = job->next;
+        coordinator_result_free(&job->result);
+        free(job);
+        job = next;
+    }
+}
+
+static int compare_doc_ids(const void* a, const void* b) {
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+// Combine two sorted doc id arrays into out (room for na + nb); returns its length
+static size_t merge_doc_ids(const char** a, size_t na, const char** b, size_t nb,
+                            bool intersect, const char** out) {
+    size_t i = 0, j = 0, n = 0;
+    while (i < na || j < nb) {
+        int c = i == na ? 1 : j == nb ? -1 : strcmp(a[i], b[j]);
+        if (c == 0) {
+            out[n++] = a[i++];
+            j++;
+        } else if (c < 0) {
+            if (!intersect) out[n++] = a[i];
+            i++;
+        } else {
+            if (!intersect) out[n++] = b[j];
+            j++;
+        }
+    }
+    return n;
+}
+
+// Boolean query over the local index; doc ids stay pinned by the open cursors
+static int local_bool(Worker* w, const char** terms, size_t n, bool intersect,
+                      SearchCursor* cursors, const char*** docs, size_t* count) {
+    *docs = NULL;
+    *count = 0;
+
+    size_t sum = 0;
+    for (size_t t = 0; t < n; t++) {
+        if (indexer_cursor_open(w->idx, terms[t], &cursors[t]) != 0 && intersect) return 0;
+        sum += cursors[t].total;
+    }
+
+    const char** acc = malloc((sum + 1) * sizeof(char*));
+    const char** term = malloc((sum + 1) * sizeof(char*));
+    const char** merged = malloc((sum + 1) * sizeof(char*));
+    if (!acc || !term || !merged) {
+        free(acc);
+        free(term);
+        free(merged);
+        return ENOMEM;
+    }
+
+    size_t acc_len = 0;
+    for (size_t t = 0; t < n; t++) {
+        size_t term_len = 0;
+        const char* doc_id;
+        while ((doc_id = indexer_cursor_next(&cursors[t])) != NULL) term[term_len++] = doc_id;
+        qsort(term, term_len, sizeof(char*), compare_doc_ids);
+
+        if (t == 0) {
+            memcpy(acc, term, term_len * sizeof(char*));
+            acc_len = term_len;
+        } else {
+            acc_len = merge_doc_ids(acc, acc_len, term, term_len, intersect, merged);
+            const char** tmp = acc;
+            acc = merged;
+            merged = tmp;
+        }
+        if (intersect && acc_len == 0) break;
+    }
+
+    free(term);
+    free(merged);
+    *docs = acc;
+    *count = acc_len;
+    return 0;
+}
+
+static int handle_bool(Worker* w, Connection* conn, const char* query, size_t query_len) {
+    size_t raw_len = 0;
+    const char* raw = query ? query_param(query, query_len, "q", &raw_len) : NULL;
+    if (!raw) {
+        return queue_error(w, conn, 400, "missing query parameter 'q'");
+    }
+
+    char text[SERVER_MAX_KEY_LENGTH];
+    if (!url_decode(raw, raw_len, text, sizeof(text))) {
+        return queue_error(w, conn, 400, "query too long");
+    }
+
+    size_t op_len = 0;
+    const char* op = query_param(query, query_len, "op", &op_len);
+    bool intersect = true;
+    if (op && op_len == 2 && memcmp(op, "or", 2) == 0) {
+        intersect = false;
+    } else if (op && !(op_len == 3 && memcmp(op, "and", 3) == 0)) {
+        return queue_error(w, conn, 400, "op must be 'and' or 'or'");
+    }
+
+    size_t limit = SIZE_MAX;
+    if (!size_param(query, query_len, "limit", &limit)) {
+        return queue_error(w, conn, 400, "invalid limit");
+    }
+
+    const char* terms[SERVER_MAX_TERMS];
+    size_t n = split_terms(text, terms);
+    if (n == 0 || n > SERVER_MAX_TERMS) return queue_terms_error(w, conn);
+
+    if (w->srv->cfg.coordinator) {
+        return park_coordinated(w, conn, FANOUT_BOOL, text, terms, n, limit, intersect);
+    }
+
+    const char* op_name = intersect ? "and" : "or";
+
+    SearchCursor cursors[SERVER_MAX_TERMS];
+    memset(cursors, 0, sizeof(cursors));
+    const char** docs = NULL;
+    size_t count = 0;
+    int rc = local_bool(w, terms, n, intersect, cursors, &docs, &count);
+    if (count > limit) count = limit;
+
+    Buffer* body = &w->body;
+    body->len = 0;
+    buffer_append_str(body, "{\"op\":");
+    json_append_string(body, op_name, strlen(op_name));
+    buffer_append_str(body, ",\"results\":[");
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) buffer_append(body, ",", 1);
+        json_append_string(body, docs[i], strlen(docs[i]));
+    }
+    buffer_append_str(body, "],\"count\":");
+    buffer_append_size(body, count);
+    free(docs);
+    for (size_t t = 0; t < n; t++) indexer_cursor_close(&cursors[t]);
+    if (rc != 0 || buffer_append(body, "}", 1) != 0) {
+        return queue_error(w, conn, 500, "out of memory");
+    }
+    return queue_response(w, conn, 200);
+}
+
+static int handle_rank(Worker* w, Connection* conn, const char* query, size_t query_len) {
+    size_t raw_len = 0;
+    const char* raw = query ? query_param(query, query_len, "q", &raw_len) : NULL;
+    if (!raw) {
+        return queue_error(w, conn, 400, "missing query parameter 'q'");
+    }
+
+    char text[SERVER_MAX_KEY_LENGTH];
+    if (!url_decode(raw, raw_len, text, sizeof(text))) {
+        return queue_error(w, conn, 400, "query too long");
+    }
+
+    size_t limit = SERVER_DEFAULT_RANKED;
+    if (!size_param(query, query_len, "limit", &limit) || limit == 0) {
+        return queue_error(w, conn, 400, "invalid limit");
+    }
+    if (limit > SERVER_MAX_RANKED) limit = SERVER_MAX_RANKED;
+
+    const char* terms[SERVER_MAX_TERMS];
+    size_t n = split_terms(text, terms);
+    if (n == 0 || n > SERVER_MAX_TERMS) return queue_terms_error(w, conn);
+
+    if (w->srv->cfg.coordinator) {
+        return park_coordinated(w, conn, FANOUT_RANK, text, terms, n, limit, false);
+    }
+
+    // The pin keeps the doc ids alive until they are serialized, even if a
+    // reload swaps the index meanwhile
+    RankedDoc ranked[SERVER_MAX_RANKED];
+    size_t count = 0;
+    IndexPin pin;
+    indexer_search_ranked(w->idx, terms, n, limit, ranked, &count, &pin);
+
+    Buffer* body = &w->body;
+    body->len = 0;
+    buffer_append_str(body, "{\"results\":[");
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) buffer_append(body, ",", 1);
+        buffer_append_str(body, "{\"doc\":");
+        json_append_string(body, ranked[i].doc_id, strlen(ranked[i].doc_id));
+        buffer_append_str(body, ",\"score\":");
+        buffer_append_double(body, ranked[i].score);
+        buffer_append_str(body, "}");
+    }
+    indexer_unpin(&pin);
+    buffer_append_str(body, "],\"count\":");
+    buffer_append_size(body, count);
+    if (buffer_append(body, "}", 1) != 0) {
+        return queue_error(w, conn, 500, "out of memory");
+    }
+    return queue_response(w, conn, 200);
+}
+
+static int handle_search(Worker* w, Connection* conn, const char* query, size_t query_len) {
+    size_t raw_len = 0;
+    const char* raw = query ? query_param(query, query_len, "q", &raw_len) : NULL;
+    if (!raw) {
+        return queue_error(w, conn, 400, "missing query parameter 'q'");
+    }
+
+    char key[SERVER_MAX_KEY_LENGTH];
+    if (!url_decode(raw, raw_len, key, sizeof(key))) {
+        return queue_error(w, conn, 400, "query too long");
+    }
+
+    size_t offset = 0;
+    size_t limit = SIZE_MAX;
+    if (!size_param(query, query_len, "offset", &offset) ||
+        !size_param(query, query_len, "limit", &limit)) {
+        return queue_error(w, conn, 400, "invalid offset or limit");
+    }
+
+    if (w->srv->cfg.coordinator) {
+        if (offset > 0) return queue_error(w, conn, 400, "offset is not supported by the coordinator");
+        return park_coordinated(w, conn, FANOUT_SEARCH, key, NULL, 0, limit, false);
+    }
+
+    // Cache key is the decoded query plus the requested page, and the replica
+    // node, since replicas reloaded one after another may briefly disagree
+    char cache_key[SERVER_CACHE_KEY_LENGTH];
+    int cache_key_len = 0;
+    uint64_t generation = indexer_get_generation(w->idx);
+    if (w->srv->cache) {
+        cache_key_len = snprintf(cache_key, sizeof(cache_key), "%s%c%zu%c%zu%c%d",
+                                 key, '\0', offset, '\0', limit, '\0', w->node);
+        if (lookup_cached_body(w, cache_key, (size_t)cache_key_len, generation)) {
+            return queue_response(w, conn, 200);
+        }
+    }
+
+    Buffer* body = &w->body;
+    body->len = 0;
+    buffer_append_str(body, "{\"key\":");
+    json_append_string(body, key, strlen(key));
+    buffer_append_str(body, ",\"results\":[");
+
+    // Walk the postings in place; nothing is allocated per result
+    SearchCursor cursor;
+    size_t count = 0;
+    if (indexer_cursor_open(w->idx, key, &cursor) == 0) {
+        indexer_cursor_skip(&cursor, offset);
+
+        const char* doc_id;
+        while (count < limit && (doc_id = indexer_cursor_next(&cursor)) != NULL) {
+            if (count++ > 0) buffer_append(body, ",", 1);
+            json_append_string(body, doc_id, strlen(doc_id));
+        }
+    }
+
+    buffer_append_str(body, "],\"count\":");
+    buffer_append_size(body, count);
+    buffer_append_str(body, ",\"total\":");
+    buffer_append_size(body, cursor.total);
+    indexer_cursor_close(&cursor);
+    if (buffer_append(body, "}", 1) != 0) {
+        return queue_error(w, conn, 500, "out of memory");
+    }
+
+    if (w->srv->cache) {
+        query_cache_insert(w->srv->cache, cache_key, (size_t)cache_key_len, generation,
+                           body->data, body->len);
+    }
+    return queue_response(w, conn, 200);
+}
+
+static int handle_complete(Worker* w, Connection* conn, const char* query, size_t query_len) {
+    size_t raw_len = 0;
+    const char* raw = query ? query_param(query, query_len, "q", &raw_len) : NULL;
+    if (!raw) {
+        return queue_error(w, conn, 400, "missing query parameter 'q'");
+    }
+
+    char prefix[SERVER_MAX_KEY_LENGTH];
+    if (!url_decode(raw, raw_len, prefix, sizeof(prefix))) {
+        return queue_error(w, conn, 400, "query too long");
+    }
+
+    size_t limit = SERVER_DEFAULT_COMPLETIONS;
+    if (!size_param(query, query_len, "limit", &limit) || limit == 0) {
+        return queue_error(w, conn, 400, "invalid limit");
+    }
+    if (limit > SERVER_MAX_COMPLETIONS) limit = SERVER_MAX_COMPLETIONS;
+
+    CompletionResult completions[SERVER_MAX_COMPLETIONS];
+    size_t count = 0;
+    indexer_complete(w->idx, prefix, completions, limit, &count);
+
+    Buffer* body = &w->body;
+    body->len = 0;
+    buffer_append_str(body, "{\"prefix\":");
+    json_append_string(body, prefix, strlen(prefix));
+    buffer_append_str(body, ",\"completions\":[");
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) buffer_append(body, ",", 1);
+        buffer_append_str(body, "{\"key\":");
+        json_append_string(body, completions[i].key, strlen(completions[i].key));
+        buffer_append_str(body, ",\"weight\":");
+        buffer_append_size(body, completions[i].weight);
+        buffer_append_str(body, ",\"total\":");
+        buffer_append_size(body, completions[i].cursor.total);
+        buffer_append_str(body, "}");
+        indexer_cursor_close(&completions[i].cursor);
+    }
+    if (buffer_append_str(body, "]}") != 0) {
+        return queue_error(w, conn, 500, "out of memory");
+    }
+    return queue_response(w, conn, 200);
+}
+
+static int handle_health(Worker* w, Connection* conn) {
+    Buffer* body = &w->body;
+    body->len = 0;
+    if (w->srv->cfg.coordinator) {
+        buffer_append_str(body, "{\"status\":\"ok\",\"shards\":");
+        buffer_append_size(body, coordinator_shard_count(w->srv->cfg.coordinator));
+        buffer_append_str(body, "}");
+        return queue_response(w, conn, 200);
+    }
+
+    buffer_append_str(body, "{\"status\":\"ok\",\"keys\":");
+    buffer_append_size(body, indexer_get_key_count(w->idx));
+    buffer_append_str(body, ",\"docs\":");
+    buffer_append_size(body, indexer_get_doc_count(w->idx));
+
+    QueryCacheStats stats;
+    if (search_server_cache_stats(w->srv, &stats) == 0) {
+        buffer_append_str(body, ",\"cache_hits\":");
+        buffer_append_size(body, (size_t)stats.hits);
+        buffer_append_str(body, ",\"cache_misses\":");
+        buffer_append_size(body, (size_t)stats.misses);
+    }
+    buffer_append_str(body, "}");
+    return queue_response(w, conn, 200);
+}
+
+// Operation latency snapshot: JSON, or Prometheus text with format=prometheus
+static int handle_metrics(Worker* w, Connection* conn, const char* query, size_t query_len) {
+    size_t format_len = 0;
+    const char* format = query ? query_param(query, query_len, "format", &format_len) : NULL;
+    bool prometheus = format && format_len == 10 && memcmp(format, "prometheus", 10) == 0;
+
+    char* text = NULL;
+    size_t len = 0;
+    FILE* fp = open_memstream(&text, &len);
+    if (!fp) return queue_error(w, conn, 500, "out of memory");
+    int rc = metrics_write(fp, prometheus ? METRICS_FORMAT_PROMETHEUS : METRICS_FORMAT_JSON);
+    fclose(fp);
+    if (rc != 0) {
+        free(text);
+        return queue_error(w, conn, 500, strerror(rc));
+    }
+
+    w->body.len = 0;
+    rc = buffer_append(&w->body, text, len);
+    free(text);
+    if (rc != 0) return rc;
+    return queue_typed_response(w, conn, 200,
+                                prometheus ? "text/plain; version=0.0.4" : "application/json");
+}
+
+static int handle_request(Worker* w, Connection* conn, const HttpRequest* req) {
+    if (req->method_len != 3 || memcmp(req->method, "GET", 3) != 0) {
+        return queue_error(w, conn, 405, "only GET is supported");
+    }
+
+    const char* query = memchr(req->target, '?', req->target_len);
+    size_t path_len = query ? (size_t)(query - req->target) : req->target_len;
+    size_t query_len = query ? req->target_len - path_len - 1 : 0;
+    if (query) query++;
+
+    if (path_len == 7 && memcmp(req->target, "/search", 7) == 0) {
+        return handle_search(w, conn, query, query_len);
+    }
+    if (path_len == 5 && memcmp(req->target, "/bool", 5) == 0) {
+        return handle_bool(w, conn, query, query_len);
+    }
+    if (path_len == 5 && memcmp(req->target, "/rank", 5) == 0) {
+        return handle_rank(w, conn, query, query_len);
+    }
+    if (path_len == 9 && memcmp(req->target, "/complete", 9) == 0) {
+        if (w->srv->cfg.coordinator) {
+            return queue_error(w, conn, 404, "not available in coordinator mode");
+        }
+        return handle_complete(w, conn, query, query_len);
+    }
+    if (path_len == 7 && memcmp(req->target, "/health", 7) == 0) {
+        return handle_health(w, conn);
+    }
+    if (path_len == 8 && memcmp(req->target, "/metrics", 8) == 0) {
+        return handle_metrics(w, conn, query, query_len);
+    }
+
+    return queue_error(w, conn, 404, "not found");
+}
+
+static bool header_is(const char* line, size_t len, const char* name, const char** value,
+                      size_t* value_len) {
+    size_t name_len = strlen(name);
+    if (len <= name_len || line[name_len] != ':' || strncasecmp(line, name, name_len) != 0) {
+        return false;
+    }
+
+    const char* v = line + name_len + 1;
+    const char* end = line + len;
+    while (v < end && (*v == ' ' || *v == '\t')) v++;
+    *value = v;
+    *value_len = (size_t)(end - v);
+    return true;
+}
+
+static bool contains_token(const char* value, size_t len, const char* token) {
+    size_t token_len = strlen(token);
+    for (size_t i = 0; i + token_len <= len; i++) {
+        if (strncasecmp(value + i, token, token_len) == 0) return true;
+    }
+    return false;
+}
+
+// Parse a request head terminated by CRLFCRLF; returns 0 or an HTTP status code
+static int parse_request(const char* head, size_t head_len, HttpRequest* req) {
+    memset(req, 0, sizeof(*req));
+
+    const char* end = head + head_len;
+    const char* line_end = memmem(head, head_len, "\r\n", 2);
+    if (!line_end) return 400;
+
+    // Request line: METHOD SP target SP HTTP/1.x
+    const char* sp1 = memchr(head, ' ', (size_t)(line_end - head));
+    if (!sp1) return 400;
+    const char* sp2 = memchr(sp1 + 1, ' ', (size_t)(line_end - sp1 - 1));
+    if (!sp2) return 400;
+
+    req->method = head;
+    req->method_len = (size_t)(sp1 - head);
+    req->target = sp1 + 1;
+    req->target_len = (size_t)(sp2 - sp1 - 1);
+
+    const char* version = sp2 + 1;
+    size_t version_len = (size_t)(line_end - version);
+    if (version_len != 8 || memcmp(version, "HTTP/1.", 7) != 0) return 400;
+    bool http11 = version[7] == '1';
+    bool saw_close = false;
+    bool saw_keep_alive = false;
+
+    // Headers
+    const char* line = line_end + 2;
+    while (line < end) {
+        const char* next = memmem(line, (size_t)(end - line), "\r\n", 2);
+        if (!next || next == line) break;
+
+        const char* value;
+        size_t value_len;
+        size_t len = (size_t)(next - line);
+        if (header_is(line, len, "Connection", &value, &value_len)) {
+            saw_close = contains_token(value, value_len, "close");
+            saw_keep_alive = contains_token(value, value_len, "keep-alive");
+        } else if (header_is(line, len, "Content-Length", &value, &value_len)) {
+            char tmp[32];
+            if (value_len >= sizeof(tmp)) return 400;
+            memcpy(tmp, value, value_len);
+            tmp[value_len] = '\0';
+            char* num_end;
+            unsigned long long n = strtoull(tmp, &num_end, 10);
+            if (num_end == tmp) return 400;
+            req->content_length = (size_t)n;
+        }
+        line = next + 2;
+    }
+
+    req->keep_alive = http11 ? !saw_close : saw_keep_alive;
+    return 0;
+}
+
+static void set_write_interest(Worker* w, Connection* conn, bool want) {
+    if (conn->want_write == want) return;
+
+    struct epoll_event ev = {
+        .events = EPOLLIN | EPOLLRDHUP | (want ? EPOLLOUT : 0),
+        .data.ptr = conn
+    };
+    epoll_ctl(w->epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev);
+    conn->want_write = want;
+}
+
+static void close_connection(Worker* w, Connection* conn) {
+    epoll_ctl(w->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    conn->fd = -1;
+
+    if (conn->prev) conn->prev->next = conn->next;
+    else w->active = conn->next;
+    if (conn->next) conn->next->prev = conn->prev;
+
+    buffer_shrink(&conn->in);
+    buffer_shrink(&conn->out);
+    conn->out_sent = 0;
+    conn->close_after_write = false;
+    conn->want_write = false;
+    conn->peer_closed = false;
+    conn->parked = false;
+
+    conn->prev = NULL;
+    conn->next = w->free_list;
+    w->free_list = conn;
+}
+
+// Send pending output; returns false if the connection was closed
+static bool flush_connection(Worker* w, Connection* conn) {
+    while (conn->out_sent < conn->out.len) {
+        ssize_t n = send(conn->fd, conn->out.data + conn->out_sent,
+                         conn->out.len - conn->out_sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            conn->out_sent += (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            set_write_interest(w, conn, true);
+            return true;
+        } else {
+            close_connection(w, conn);
+            return false;
+        }
+    }
+
+    conn->out.len = 0;
+    conn->out_sent = 0;
+    set_write_interest(w, conn, false);
+
+    if (conn->close_after_write) {
+        close_connection(w, conn);
+        return false;
+    }
+    return true;
+}
+
+// Answer every complete request in the input buffer (supports pipelining)
+static void process_input(Worker* w, Connection* conn) {
+    size_t max_request = w->srv->cfg.max_request_size;
+    size_t consumed = 0;
+
+    while (!conn->close_after_write && !conn->parked) {
+        char* start = conn->in.data + consumed;
+        size_t avail = conn->in.len - consumed;
+
+        char* head_end = avail ? memmem(start, avail, "\r\n\r\n", 4) : NULL;
+        if (!head_end) {
+            if (avail > max_request) {
+                conn->close_after_write = true;
+                queue_error(w, conn, 431, "request head too large");
+            }
+            break;
+        }
+
+        size_t head_len = (size_t)(head_end - start) + 4;
+        HttpRequest req;
+        int status = parse_request(start, head_len, &req);
+        if (status != 0) {
+            conn->close_after_write = true;
+            queue_error(w, conn, status, "malformed request");
+            break;
+        }
+
+        if (req.content_length > max_request) {
+            conn->close_after_write = true;
+            queue_error(w, conn, 413, "request body too large");
+            break;
+        }
+        if (head_len + req.content_length > avail) break;  // Wait for the body
+
+        conn->close_after_write = !req.keep_alive;
+        if (handle_request(w, conn, &req) != 0) {
+            conn->close_after_write = true;
+        }
+        consumed += head_len + req.content_length;
+    }
+
+    if (consumed > 0) {
+        memmove(conn->in.data, conn->in.data + consumed, conn->in.len - consumed);
+        conn->in.len -= consumed;
+    }
+}
+
+static void handle_readable(Worker* w, Connection* conn) {
+    bool peer_closed = false;
+
+    for (;;) {
+        if (buffer_reserve(&conn->in, SERVER_READ_CHUNK) != 0) {
+            close_connection(w, conn);
+            return;
+        }
+
+        size_t room = conn->in.cap - conn->in.len;
+        ssize_t n = recv(conn->fd, conn->in.data + conn->in.len, room, 0);
+        if (n > 0) {
+            conn->in.len += (size_t)n;
+            if ((size_t)n < room) break;
+        } else if (n == 0) {
+            peer_closed = true;
+            break;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else {
+            close_connection(w, conn);
+            return;
+        }
+    }
+
+    process_input(w, conn);
+    if (peer_closed) conn->peer_closed = true;
+    if (conn->parked) return;   // Flushed when the fan-out finishes
+    if (conn->peer_closed) conn->close_after_write = true;
+
+    if (conn->out.len > 0 || conn->close_after_write) {
+        flush_connection(w, conn);
+    }
+}
+
+// Answer the parked request of a finished fan-out, then carry on with the
+// requests pipelined behind it
+static void resume_connection(Worker* w, FanoutJob* job) {
+    Connection* conn = job->conn;
+    int rc;
+    if (job->kind == FANOUT_SEARCH) {
+        rc = queue_coordinated(w, conn, job->rc, "key", job->text, &job->result, false);
+    } else if (job->kind == FANOUT_BOOL) {
+        rc = queue_coordinated(w, conn, job->rc, "op", job->intersect ? "and" : "or",
+                               &job->result, false);
+    } else {
+        rc = queue_coordinated(w, conn, job->rc, NULL, NULL, &job->result, true);
+    }
+    if (rc != 0) conn->close_after_write = true;
+    conn->parked = false;
+
+    struct epoll_event ev = { .events = EPOLLIN | EPOLLRDHUP, .data.ptr = conn };
+    if (epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, conn->fd, &ev) != 0) {
+        close_connection(w, conn);
+        return;
+    }
+
+    process_input(w, conn);
+    if (conn->parked) return;
+    if (conn->peer_closed) conn->close_after_write = true;
+    if (conn->out.len > 0 || conn->close_after_write) {
+        flush_connection(w, conn);
+    }
+}
+
+static void finish_fanouts(Worker* w) {
+    uint64_t ready;
+    ssize_t n = read(w->done_fd, &ready, sizeof(ready));
+    (void)n;
+
+    pthread_mutex_lock(&w->done_lock);
+    FanoutJob* job = w->done;
+    w->done = NULL;
+    pthread_mutex_unlock(&w->done_lock);
+
+    while (job) {
+        FanoutJob* next = job->next;
+        resume_connection(w, job);
+        coordinator_result_free(&job->result);
+        free(job);
+        job = next;
+    }
+}
+
+static void accept_connections(Worker* w) {
+    for (;;) {
+        int fd = accept4(w->srv->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                WARN_LOG("accept failed: %s", strerror(errno));
+            }
+            return;
+        }
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        Connection* conn = w->free_list;
+        if (conn) {
+            w->free_list = conn->next;
+        } else {
+            conn = calloc(1, sizeof(Connection));
+            if (!conn) {
+                ERROR_LOG("Failed to allocate connection");
+                close(fd);
+                continue;
+            }
+        }
+
+        conn->fd = fd;
+        conn->prev = NULL;
+        conn->next = w->active;
+        if (w->active) w->active->prev = conn;
+        w->active = conn;
+
+        struct epoll_event ev = { .events = EPOLLIN | EPOLLRDHUP, .data.ptr = conn };
+        if (epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            ERROR_LOG("epoll_ctl failed: %s", strerror(errno));
+            close_connection(w, conn);
+        }
+    }
+}
+
+static void* worker_main(void* arg) {
+    Worker* w = arg;
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    bool stopping = false;
+
+    // Stay next to the replica; a failed bind only costs remote accesses
+    if (w->node >= 0) {
+        int rc = placement_bind_node(w->node);
+        if (rc != 0) WARN_LOG("Failed to bind worker to node %d: %s", w->node, strerror(rc));
+    }
+
+    while (!stopping) {
+        int n = epoll_wait(w->epoll_fd, events, SERVER_MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ERROR_LOG("epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            void* ptr = events[i].data.ptr;
+            uint32_t mask = events[i].events;
+
+            if (ptr == &w->wake_fd) {
+                stopping = true;
+            } else if (ptr == &w->done_fd) {
+                finish_fanouts(w);
+            } else if (ptr == w->srv) {
+                accept_connections(w);
+            } else {
+                Connection* conn = ptr;
+                if (mask & EPOLLIN) {
+                    handle_readable(w, conn);
+                } else if (mask & (EPOLLERR | EPOLLHUP)) {
+                    close_connection(w, conn);
+                } else if (mask & EPOLLOUT) {
+                    flush_connection(w, conn);
+                }
+            }
+        }
+    }
+
+    while (w->active) {
+        close_connection(w, w->active);
+    }
+    return NULL;
+}
+
+void search_server_config_init(SearchServerConfig* cfg) {
+    if (!cfg) return;
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->bind_addr = NULL;
+    cfg->port = 8080;
+    cfg->num_workers = 0;
+    cfg->backlog = SERVER_DEFAULT_BACKLOG;
+    cfg->max_request_size = SERVER_DEFAULT_MAX_REQUEST;
+    cfg->cache_bytes = 0;
+}
+
+static int open_listener(SearchServer* srv) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return errno;
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(srv->cfg.port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (srv->cfg.bind_addr && inet_pton(AF_INET, srv->cfg.bind_addr, &addr.sin_addr) != 1) {
+        close(fd);
+        return EINVAL;
+    }
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(fd, srv->cfg.backlog) != 0) {
+        int err = errno;
+        close(fd);
+        return err;
+    }
+
+    socklen_t addr_len = sizeof(addr);
+    getsockname(fd, (struct sockaddr*)&addr, &addr_len);
+    srv->port = ntohs(addr.sin_port);
+    srv->listen_fd = fd;
+    return 0;
+}
+
+static int worker_init(SearchServer* srv, Worker* w, int index) {
+    w->srv = srv;
+    w->idx = srv->idx;
+    w->node = -1;
+    if (srv->cfg.num_replicas > 0) {
+        // Spread workers round-robin so every node serves from its own replica
+        w->node = index % srv->cfg.num_replicas;
+        w->idx = srv->cfg.replicas[w->node];
+    }
+    w->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (w->epoll_fd < 0) return errno;
+
+    w->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (w->wake_fd < 0) return errno;
+
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = &w->wake_fd };
+    if (epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, w->wake_fd, &ev) != 0) return errno;
+
+    w->done_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (w->done_fd < 0) return errno;
+    ev.data.ptr = &w->done_fd;
+    if (epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, w->done_fd, &ev) != 0) return errno;
+
+    // EPOLLEXCLUSIVE wakes a single worker per incoming connection
+    ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+    ev.data.ptr = srv;
+    if (epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, srv->listen_fd, &ev) != 0) return errno;
+
+    return 0;
+}
+
+static void worker_cleanup(Worker* w) {
+    while (w->free_list) {
+        Connection* next = w->free_list->next;
+        buffer_free(&w->free_list->in);
+        buffer_free(&w->free_list->out);
+        free(w->free_list);
+        w->free_list = next;
+    }
+    buffer_free(&w->body);
+    free_fanout_jobs(w->done);
+    pthread_mutex_destroy(&w->done_lock);
+    if (w->wake_fd >= 0) close(w->wake_fd);
+    if (w->done_fd >= 0) close(w->done_fd);
+    if (w->epoll_fd >= 0) close(w->epoll_fd);
+}
+
+SearchServer* search_server_create(Indexer* idx, const SearchServerConfig* cfg, int* err) {
+    bool replicated = cfg && cfg->num_replicas > 0;
+    if ((!idx && !(cfg && cfg->coordinator) && !replicated) ||
+        (replicated && (!cfg->replicas || cfg->num_replicas > placement_node_count() ||
+                        cfg->coordinator))) {
+        ERROR_LOG("Invalid arguments: idx=%p, num_replicas=%d", (void*)idx,
+                  cfg ? cfg->num_replicas : 0);
+        if (err) *err = EINVAL;
+        return NULL;
+    }
+
+    SearchServer* srv = calloc(1, sizeof(SearchServer));
+    if (!srv) {
+        if (err) *err = ENOMEM;
+        return NULL;
+    }
+
+    srv->idx = idx ? idx : (replicated ? cfg->replicas[0] : NULL);
+    srv->listen_fd = -1;
+    if (cfg) {
+        srv->cfg = *cfg;
+    } else {
+        search_server_config_init(&srv->cfg);
+    }
+    if (srv->cfg.backlog <= 0) srv->cfg.backlog = SERVER_DEFAULT_BACKLOG;
+    if (srv->cfg.max_request_size == 0) srv->cfg.max_request_size = SERVER_DEFAULT_MAX_REQUEST;
+
+    srv->num_workers = srv->cfg.num_workers;
+    if (srv->num_workers <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        srv->num_workers = cpus > 0 ? (int)cpus : 1;
+    }
+    if (srv->cfg.coordinator) {
+        srv->num_fanout = srv->cfg.fanout_threads;
+        if (srv->num_fanout <= 0) srv->num_fanout = srv->num_workers * SERVER_FANOUT_PER_WORKER;
+    }
+
+    int rc = 0;
+    if (srv->cfg.cache_bytes > 0) {
+        srv->cache = query_cache_create(srv->cfg.cache_bytes, &rc);
+        if (!srv->cache) {
+            ERROR_LOG("Failed to create response cache: %s", strerror(rc));
+            free(srv);
+            if (err) *err = rc;
+            return NULL;
+        }
+    }
+
+    rc = open_listener(srv);
+    if (rc != 0) {
+        ERROR_LOG("Failed to listen on port %u: %s", srv->cfg.port, strerror(rc));
+        query_cache_destroy(srv->cache);
+        free(srv);
+        if (err) *err = rc;
+        return NULL;
+    }
+
+    pthread_mutex_init(&srv->fanout_lock, NULL);
+    pthread_cond_init(&srv->fanout_wake, NULL);
+    srv->workers = calloc((size_t)srv->num_workers, sizeof(Worker));
+    if (srv->num_fanout > 0) srv->fanout_threads = calloc((size_t)srv->num_fanout, sizeof(pthread_t));
+    if (!srv->workers || (srv->num_fanout > 0 && !srv->fanout_threads)) {
+        free(srv->workers);
+        free(srv->fanout_threads);
+        close(srv->listen_fd);
+        query_cache_destroy(srv->cache);
+        pthread_mutex_destroy(&srv->fanout_lock);
+        pthread_cond_destroy(&srv->fanout_wake);
+        free(srv);
+        if (err) *err = ENOMEM;
+        return NULL;
+    }
+
+    for (int i = 0; i < srv->num_workers; i++) {
+        srv->workers[i].epoll_fd = -1;
+        srv->workers[i].wake_fd = -1;
+        srv->workers[i].done_fd = -1;
+        pthread_mutex_init(&srv->workers[i].done_lock, NULL);
+    }
+    for (int i = 0; i < srv->num_workers; i++) {
+        rc = worker_init(srv, &srv->workers[i], i);
+        if (rc != 0) {
+            ERROR_LOG("Failed to initialize worker %d: %s", i, strerror(rc));
+            search_server_destroy(srv);
+            if (err) *err = rc;
+            return NULL;
+        }
+    }
+
+    if (err) *err = 0;
+    return srv;
+}
+
+// Join the first count fan-out threads and drop the jobs nobody will answer;
+// the workers must already be stopped
+static void stop_fanout(SearchServer* srv, int count) {
+    pthread_mutex_lock(&srv->fanout_lock);
+    srv->fanout_stopping = true;
+    pthread_cond_broadcast(&srv->fanout_wake);
+    pthread_mutex_unlock(&srv->fanout_lock);
+    for (int i = 0; i < count; i++) {
+        pthread_join(srv->fanout_threads[i], NULL);
+    }
+
+    free_fanout_jobs(srv->fanout_head);
+    srv->fanout_head = srv->fanout_tail = NULL;
+    srv->fanout_stopping = false;
+    for (int i = 0; i < srv->num_workers; i++) {
+        free_fanout_jobs(srv->workers[i].done);
+        srv->workers[i].done = NULL;
+    }
+}
+
+int search_server_start(SearchServer* srv) {
+    if (!srv) return EINVAL;
+    if (srv->running) return 0;
+
+    for (int i = 0; i < srv->num_fanout; i++) {
+        int rc = pthread_create(&srv->fanout_threads[i], NULL, fanout_main, srv);
+        if (rc != 0) {
+            ERROR_LOG("Failed to start fan-out thread %d: %s", i, strerror(rc));
+            stop_fanout(srv, i);
+            return rc;
+        }
+    }
+
+    for (int i = 0; i < srv->num_workers; i++) {
+        int rc = pthread_create(&srv->workers[i].thread, NULL, worker_main, &srv->workers[i]);
+        if (rc != 0) {
+            ERROR_LOG("Failed to start worker %d: %s", i, strerror(rc));
+            srv->num_workers = i;
+            srv->running = true;
+            search_server_stop(srv);
+            return rc;
+        }
+    }
+
+    srv->running = true;
+    INFO_LOG("Search server listening on port %u with %d workers", srv->port, srv->num_workers);
+    return 0;
+}
+
+uint16_t search_server_port(const SearchServer* srv) {
+    return srv ? srv->port : 0;
+}
+
+int search_server_cache_stats(const SearchServer* srv, QueryCacheStats* stats) {
+    if (!srv || !stats) return EINVAL;
+    query_cache_get_stats(srv->cache, stats);
+    return srv->cache ? 0 : ENOENT;
+}
+
+void search_server_stop(SearchServer* srv) {
+    if (!srv || !srv->running) return;
+
+    for (int i = 0; i < srv->num_workers; i++) {
+        uint64_t one = 1;
+        ssize_t n = write(srv->workers[i].wake_fd, &one, sizeof(one));
+        (void)n;
+    }
+    for (int i = 0; i < srv->num_workers; i++) {
+        pthread_join(srv->workers[i].thread, NULL);
+    }
+    stop_fanout(srv, srv->num_fanout);
+
+    srv->running = false;
+    INFO_LOG("Search server on port %u stopped", srv->port);
+}
+
+void search_server_destroy(SearchServer* srv) {
+    if (!srv) return;
+
+    search_server_stop(srv);
+    if (srv->workers) {
+        for (int i = 0; i < srv->num_workers; i++) {
+            worker_cleanup(&srv->workers[i]);
+        }
+        free(srv->workers);
+    }
+    if (srv->listen_fd >= 0) close(srv->listen_fd);
+    query_cache_destroy(srv->cache);
+    free(srv->fanout_threads);
+    pthread_mutex_destroy(&srv->fanout_lock);
+    pthread_cond_destroy(&srv->fanout_wake);
+    free(srv);
+}
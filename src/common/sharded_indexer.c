@@ -0,0 +1,727 @@
+#include "sharded_indexer.h"
+#include "logging.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define SHARD_MANIFEST_MAGIC "gtrie-shards"
+#define SHARD_MANIFEST_VERSION 1
+
+typedef struct {
+    Indexer* idx;
+    pthread_rwlock_t lock;          // Writers exclusive, queries shared
+} Shard;
+
+// One call of fn per shard; the caller waits for remaining to reach 0
+typedef struct FanOut {
+    void (*fn)(ShardedIndexer* si, size_t shard, void* arg);
+    void* arg;
+    size_t remaining;
+} FanOut;
+
+typedef struct ShardTask {
+    FanOut* fan;
+    size_t shard;
+    struct ShardTask* next;
+} ShardTask;
+
+struct ShardedIndexer {
+    Shard* shards;
+    size_t num_shards;
+
+    // Worker pool shared by every fan-out
+    pthread_t* workers;
+    size_t num_workers;
+    pthread_mutex_t pool_lock;
+    pthread_cond_t work;            // Tasks queued or stopping
+    pthread_cond_t done;            // Some fan-out finished
+    ShardTask* head;
+    ShardTask* tail;
+    bool stopping;
+};
+
+static uint64_t hash_key(const char* key) {
+    uint64_t h = 0xcbf29ce484222325ULL;  // FNV-1a; part of the file format
+    for (const unsigned char* p = (const unsigned char*)key; *p; p++) {
+        h ^= *p;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+size_t sharded_indexer_shard_of(const ShardedIndexer* si, const char* key) {
+    if (!si || !key) return 0;
+    return (size_t)(hash_key(key) % si->num_shards);
+}
+
+size_t sharded_indexer_shard_count(const ShardedIndexer* si) {
+    return si ? si->num_shards : 0;
+}
+
+// ---- Worker pool ----
+
+static void run_task(ShardedIndexer* si, ShardTask* task) {
+    FanOut* fan = task->fan;
+    fan->fn(si, task->shard, fan->arg);
+
+    pthread_mutex_lock(&si->pool_lock);
+    if (--fan->remaining == 0) pthread_cond_broadcast(&si->done);
+    pthread_mutex_unlock(&si->pool_lock);
+}
+
+// Pop a task; call with pool_lock held
+static ShardTask* pop_task(ShardedIndexer* si) {
+    ShardTask* task = si->head;
+    if (task) {
+        si->head = task->next;
+        if (!si->head) si->tail = NULL;
+    }
+    return task;
+}
+
+static void* worker_main(void* arg) {
+    ShardedIndexer* si = arg;
+
+    pthread_mutex_lock(&si->pool_lock);
+    for (;;) {
+        while (!si->stopping && !si->head) {
+            pthread_cond_wait(&si->work, &si->pool_lock);
+        }
+        ShardTask* task = pop_task(si);
+        if (!task) break;  // Stopping with an empty queue
+        pthread_mutex_unlock(&si->pool_lock);
+        run_task(si, task);
+        pthread_mutex_lock(&si->pool_lock);
+    }
+    pthread_mutex_unlock(&si->pool_lock);
+    return NULL;
+}
+
+// Run fn once per shard on the pool. The caller works through queued tasks
+// too, so nested or concurrent fan-outs cannot starve each other.
+static int fan_out(ShardedIndexer* si, void (*fn)(ShardedIndexer*, size_t, void*), void* arg) {
+    FanOut fan = { fn, arg, si->num_shards };
+
+    ShardTask* tasks = si->num_workers ? malloc(si->num_shards * sizeof(ShardTask)) : NULL;
+    if (!tasks) {
+        for (size_t s = 0; s < si->num_shards; s++) fn(si, s, arg);
+        return 0;
+    }
+
+    pthread_mutex_lock(&si->pool_lock);
+    for (size_t s = 0; s < si->num_shards; s++) {
+        tasks[s] = (ShardTask){ &fan, s, NULL };
+        if (si->tail) si->tail->next = &tasks[s];
+        else si->head = &tasks[s];
+        si->tail = &tasks[s];
+    }
+    pthread_cond_broadcast(&si->work);
+
+    while (fan.remaining > 0) {
+        ShardTask* task = pop_task(si);
+        if (task) {
+            pthread_mutex_unlock(&si->pool_lock);
+            run_task(si, task);
+            pthread_mutex_lock(&si->pool_lock);
+        } else {
+            pthread_cond_wait(&si->done, &si->pool_lock);
+        }
+    }
+    pthread_mutex_unlock(&si->pool_lock);
+
+    free(tasks);
+    return 0;
+}
+
+// ---- Lifecycle ----
+
+static size_t online_cpus(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (size_t)n : 1;
+}
+
+ShardedIndexer* sharded_indexer_create(size_t num_shards) {
+    if (num_shards == 0) num_shards = online_cpus();
+    if (num_shards > SHARDED_MAX_SHARDS) {
+        ERROR_LOG("Invalid arguments: num_shards=%zu (max %d)", num_shards, SHARDED_MAX_SHARDS);
+        return NULL;
+    }
+
+    ShardedIndexer* si = calloc(1, sizeof(ShardedIndexer));
+    if (!si) {
+        ERROR_LOG("Failed to allocate ShardedIndexer");
+        return NULL;
+    }
+    pthread_mutex_init(&si->pool_lock, NULL);
+    pthread_cond_init(&si->work, NULL);
+    pthread_cond_init(&si->done, NULL);
+    si->num_shards = num_shards;
+    si->shards = calloc(num_shards, sizeof(Shard));
+    if (!si->shards) {
+        sharded_indexer_destroy(si);
+        return NULL;
+    }
+
+    for (size_t s = 0; s < num_shards; s++) {
+        si->shards[s].idx = indexer_create();
+        if (!si->shards[s].idx) {
+            sharded_indexer_destroy(si);
+            return NULL;
+        }
+        pthread_rwlock_init(&si->shards[s].lock, NULL);
+    }
+
+    // The calling thread takes part in every fan-out
+    size_t want = num_shards < online_cpus() ? num_shards : online_cpus();
+    si->workers = want > 1 ? malloc((want - 1) * sizeof(pthread_t)) : NULL;
+    for (size_t i = 0; si->workers && i + 1 < want; i++) {
+        if (pthread_create(&si->workers[i], NULL, worker_main, si) != 0) {
+            ERROR_LOG("Failed to start shard worker %zu; continuing with %zu", i, si->num_workers);
+            break;
+        }
+        si->num_workers++;
+    }
+
+    DEBUG_LOG("Created sharded indexer: %zu shards, %zu workers", num_shards, si->num_workers);
+    return si;
+}
+
+void sharded_indexer_destroy(ShardedIndexer* si) {
+    if (!si) return;
+
+    if (si->num_workers > 0) {
+        pthread_mutex_lock(&si->pool_lock);
+        si->stopping = true;
+        pthread_cond_broadcast(&si->work);
+        pthread_mutex_unlock(&si->pool_lock);
+        for (size_t i = 0; i < si->num_workers; i++) {
+            pthread_join(si->workers[i], NULL);
+        }
+    }
+    free(si->workers);
+
+    for (size_t s = 0; si->shards && s < si->num_shards; s++) {
+        if (!si->shards[s].idx) break;
+        indexer_destroy(si->shards[s].idx);
+        pthread_rwlock_destroy(&si->shards[s].lock);
+    }
+    free(si->shards);
+    pthread_cond_destroy(&si->done);
+    pthread_cond_destroy(&si->work);
+    pthread_mutex_destroy(&si->pool_lock);
+    free(si);
+}
+
+// ---- Writes ----
+
+int sharded_indexer_add_document(ShardedIndexer* si, const char* key, const char* doc_id) {
+    if (!si || !key || !doc_id) {
+        ERROR_LOG("Invalid arguments: si=%p, key=%p, doc_id=%p",
+                 (void*)si, (void*)key, (void*)doc_id);
+        return EINVAL;
+    }
+
+    Shard* shard = &si->shards[sharded_indexer_shard_of(si, key)];
+    pthread_rwlock_wrlock(&shard->lock);
+    int rc = indexer_add_document(shard->idx, key, doc_id);
+    pthread_rwlock_unlock(&shard->lock);
+    return rc;
+}
+
+typedef struct {
+    const char* const* keys;
+    const char* const* doc_ids;
+    size_t* order;              // Pair indexes grouped by shard
+    size_t* offsets;            // Shard s owns order[offsets[s] .. offsets[s + 1])
+    size_t* failed;             // Per shard
+} BatchJob;
+
+static void batch_shard(ShardedIndexer* si, size_t s, void* arg) {
+    BatchJob* job = arg;
+    Shard* shard = &si->shards[s];
+
+    pthread_rwlock_wrlock(&shard->lock);
+    for (size_t i = job->offsets[s]; i < job->offsets[s + 1]; i++) {
+        size_t pair = job->order[i];
+        if (indexer_add_document(shard->idx, job->keys[pair], job->doc_ids[pair]) != 0) {
+            job->failed[s]++;
+        }
+    }
+    pthread_rwlock_unlock(&shard->lock);
+}
+
+// Group item indexes by the shard of their key (counting sort)
+static int partition_keys(ShardedIndexer* si, const char* const* keys, size_t count,
+                          size_t** order, size_t** offsets) {
+    *order = malloc((count ? count : 1) * sizeof(size_t));
+    *offsets = calloc(si->num_shards + 1, sizeof(size_t));
+    size_t* shard_of = malloc((count ? count : 1) * sizeof(size_t));
+    if (!*order || !*offsets || !shard_of) {
+        free(*order);
+        free(*offsets);
+        free(shard_of);
+        return ENOMEM;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        shard_of[i] = keys[i] ? sharded_indexer_shard_of(si, keys[i]) : 0;
+        (*offsets)[shard_of[i] + 1]++;
+    }
+    for (size_t s = 0; s < si->num_shards; s++) {
+        (*offsets)[s + 1] += (*offsets)[s];
+    }
+    size_t* next = malloc(si->num_shards * sizeof(size_t));
+    if (!next) {
+        free(*order);
+        free(*offsets);
+        free(shard_of);
+        return ENOMEM;
+    }
+    memcpy(next, *offsets, si->num_shards * sizeof(size_t));
+    for (size_t i = 0; i < count; i++) {
+        (*order)[next[shard_of[i]]++] = i;
+    }
+    free(next);
+    free(shard_of);
+    return 0;
+}
+
+int sharded_indexer_add_batch(ShardedIndexer* si, const char* const* keys,
+                              const char* const* doc_ids, size_t count, size_t* failed) {
+    if (failed) *failed = 0;
+    if (!si || !keys || !doc_ids) {
+        ERROR_LOG("Invalid arguments: si=%p, keys=%p, doc_ids=%p",
+                 (void*)si, (void*)keys, (void*)doc_ids);
+        return EINVAL;
+    }
+
+    BatchJob job = { keys, doc_ids, NULL, NULL, calloc(si->num_shards, sizeof(size_t)) };
+    if (!job.failed || partition_keys(si, keys, count, &job.order, &job.offsets) != 0) {
+        free(job.failed);
+        return ENOMEM;
+    }
+
+    fan_out(si, batch_shard, &job);
+
+    size_t total = 0;
+    for (size_t s = 0; s < si->num_shards; s++) total += job.failed[s];
+    if (failed) *failed = total;
+    DEBUG_LOG("Batch insert of %zu pairs across %zu shards: %zu failed", count, si->num_shards, total);
+
+    free(job.order);
+    free(job.offsets);
+    free(job.failed);
+    return 0;
+}
+
+// ---- Queries ----
+
+int sharded_indexer_cursor_open(ShardedIndexer* si, const char* key, SearchCursor* cursor) {
+    if (!si || !key || !cursor) {
+        ERROR_LOG("Invalid arguments: si=%p, key=%p, cursor=%p",
+                 (void*)si, (void*)key, (void*)cursor);
+        return EINVAL;
+    }
+
+    Shard* shard = &si->shards[sharded_indexer_shard_of(si, key)];
+    pthread_rwlock_rdlock(&shard->lock);
+    int rc = indexer_cursor_open(shard->idx, key, cursor);
+    pthread_rwlock_unlock(&shard->lock);
+    return rc;
+}
+
+typedef struct {
+    const char* const* keys;
+    SearchManyResult* results;
+    size_t* order;
+    size_t* offsets;
+    int* errs;                  // Per shard
+} ManyJob;
+
+static void many_shard(ShardedIndexer* si, size_t s, void* arg) {
+    ManyJob* job = arg;
+    size_t n = job->offsets[s + 1] - job->offsets[s];
+    if (n == 0) return;
+
+    const char** keys = malloc(n * sizeof(char*));
+    SearchManyResult* results = malloc(n * sizeof(SearchManyResult));
+    if (!keys || !results) {
+        job->errs[s] = ENOMEM;
+    } else {
+        for (size_t i = 0; i < n; i++) keys[i] = job->keys[job->order[job->offsets[s] + i]];
+
+        pthread_rwlock_rdlock(&si->shards[s].lock);
+        job->errs[s] = indexer_search_many(si->shards[s].idx, keys, n, results);
+        pthread_rwlock_unlock(&si->shards[s].lock);
+
+        if (job->errs[s] == 0) {
+            for (size_t i = 0; i < n; i++) job->results[job->order[job->offsets[s] + i]] = results[i];
+        }
+    }
+    free(keys);
+    free(results);
+}
+
+int sharded_indexer_search_many(ShardedIndexer* si, const char* const* keys, size_t count,
+                                SearchManyResult* results) {
+    if (!si || !keys || !results) {
+        ERROR_LOG("Invalid arguments: si=%p, keys=%p, results=%p",
+                 (void*)si, (void*)keys, (void*)results);
+        return EINVAL;
+    }
+
+    ManyJob job = { keys, results, NULL, NULL, calloc(si->num_shards, sizeof(int)) };
+    if (!job.errs || partition_keys(si, keys, count, &job.order, &job.offsets) != 0) {
+        free(job.errs);
+        return ENOMEM;
+    }
+    memset(results, 0, count * sizeof(SearchManyResult));
+    for (size_t i = 0; i < count; i++) results[i].err = EINVAL;
+
+    fan_out(si, many_shard, &job);
+
+    int rc = 0;
+    for (size_t s = 0; s < si->num_shards && rc == 0; s++) rc = job.errs[s];
+    if (rc != 0) {
+        for (size_t i = 0; i < count; i++) indexer_cursor_close(&results[i].cursor);
+    }
+
+    free(job.order);
+    free(job.offsets);
+    free(job.errs);
+    return rc;
+}
+
+// Sorted, distinct doc ids owned by one shard's partial answer
+typedef struct {
+    char** ids;
+    size_t count;
+    bool used;                  // The shard held at least one of the keys
+} DocSet;
+
+typedef struct {
+    const char* const* keys;
+    size_t* order;
+    size_t* offsets;
+    ShardBoolOp op;
+    DocSet* sets;               // Per shard
+    int* errs;
+} BoolJob;
+
+static int compare_ids(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+static void doc_set_free(DocSet* set) {
+    for (size_t i = 0; i < set->count; i++) free(set->ids[i]);
+    free(set->ids);
+    set->ids = NULL;
+    set->count = 0;
+}
+
+// Combine two sorted sets into out, taking ownership of both
+static int doc_set_merge(DocSet* a, DocSet* b, ShardBoolOp op, DocSet* out) {
+    DocSet result = { malloc((a->count + b->count + 1) * sizeof(char*)), 0, true };
+    if (!result.ids) return ENOMEM;
+
+    size_t i = 0, j = 0;
+    while (i < a->count || j < b->count) {
+        int c = i == a->count ? 1 : j == b->count ? -1 : strcmp(a->ids[i], b->ids[j]);
+        if (c == 0) {
+            result.ids[result.count++] = a->ids[i++];
+            free(b->ids[j++]);
+        } else if (c < 0) {
+            if (op == SHARD_QUERY_OR) result.ids[result.count++] = a->ids[i];
+            else free(a->ids[i]);
+            i++;
+        } else {
+            if (op == SHARD_QUERY_OR) result.ids[result.count++] = b->ids[j];
+            else free(b->ids[j]);
+            j++;
+        }
+    }
+    free(a->ids);
+    free(b->ids);
+    a->ids = b->ids = NULL;
+    a->count = b->count = 0;
+    *out = result;
+    return 0;
+}
+
+// Copy a key's postings into a sorted set
+static int postings_set(Indexer* idx, const char* key, DocSet* set) {
+    SearchCursor cursor;
+    int rc = indexer_cursor_open(idx, key, &cursor);
+    if (rc != 0) return rc;
+
+    set->ids = malloc((cursor.total + 1) * sizeof(char*));
+    set->count = 0;
+    set->used = true;
+    const char* doc;
+    while (set->ids && (doc = indexer_cursor_next(&cursor))) {
+        char* copy = strdup(doc);
+        if (!copy) {
+            rc = ENOMEM;
+            break;
+        }
+        set->ids[set->count++] = copy;
+    }
+    indexer_cursor_close(&cursor);
+    if (!set->ids) return ENOMEM;
+    if (rc != 0) {
+        doc_set_free(set);
+        return rc;
+    }
+    qsort(set->ids, set->count, sizeof(char*), compare_ids);
+    return 0;
+}
+
+static void bool_shard(ShardedIndexer* si, size_t s, void* arg) {
+    BoolJob* job = arg;
+    DocSet* acc = &job->sets[s];
+    Shard* shard = &si->shards[s];
+
+    pthread_rwlock_rdlock(&shard->lock);
+    for (size_t i = job->offsets[s]; i < job->offsets[s + 1]; i++) {
+        DocSet set = { NULL, 0, false };
+        int rc = postings_set(shard->idx, job->keys[job->order[i]], &set);
+        if (rc == ENOENT) {
+            set.used = true;  // Missing key: empty set
+            rc = 0;
+        }
+        if (rc == 0) {
+            if (acc->used) {
+                rc = doc_set_merge(acc, &set, job->op, acc);
+            } else {
+                *acc = set;
+                acc->used = true;
+            }
+        }
+        if (rc != 0) {
+            doc_set_free(&set);
+            job->errs[s] = rc;
+            break;
+        }
+        if (job->op == SHARD_QUERY_AND && acc->count == 0) break;
+    }
+    pthread_rwlock_unlock(&shard->lock);
+}
+
+SearchResult* sharded_indexer_search_bool(ShardedIndexer* si, const char* const* keys, size_t count,
+                                          ShardBoolOp op, int* err) {
+    if (!si || !keys || count == 0 || (op != SHARD_QUERY_AND && op != SHARD_QUERY_OR)) {
+        ERROR_LOG("Invalid arguments: si=%p, keys=%p, count=%zu, op=%d",
+                 (void*)si, (void*)keys, count, (int)op);
+        if (err) *err = EINVAL;
+        return NULL;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!keys[i]) {
+            if (err) *err = EINVAL;
+            return NULL;
+        }
+    }
+
+    BoolJob job = { keys, NULL, NULL, op, calloc(si->num_shards, sizeof(DocSet)),
+                    calloc(si->num_shards, sizeof(int)) };
+    int rc = (job.sets && job.errs) ? partition_keys(si, keys, count, &job.order, &job.offsets)
+                                    : ENOMEM;
+    if (rc == 0) fan_out(si, bool_shard, &job);
+
+    // Merge the per-shard answers
+    DocSet total = { NULL, 0, false };
+    for (size_t s = 0; s < si->num_shards && job.sets && job.errs; s++) {
+        if (rc == 0) rc = job.errs[s];
+        if (rc == 0 && job.sets[s].used) {
+            if (total.used) {
+                rc = doc_set_merge(&total, &job.sets[s], op, &total);
+            } else {
+                total = job.sets[s];
+                job.sets[s].ids = NULL;
+                job.sets[s].count = 0;
+            }
+        }
+        doc_set_free(&job.sets[s]);
+    }
+
+    // Build the result list back to front so it comes out sorted
+    SearchResult* head = NULL;
+    for (size_t i = total.count; i > 0 && rc == 0; i--) {
+        SearchResult* node = malloc(sizeof(SearchResult));
+        if (!node) {
+            rc = ENOMEM;
+            break;
+        }
+        node->doc_id = total.ids[i - 1];
+        total.ids[i - 1] = NULL;
+        node->next = head;
+        head = node;
+    }
+    doc_set_free(&total);
+    if (rc != 0) {
+        search_results_free(head);
+        head = NULL;
+    } else if (!head) {
+        rc = ENOENT;
+    }
+
+    free(job.order);
+    free(job.offsets);
+    free(job.sets);
+    free(job.errs);
+    if (err) *err = rc;
+    return head;
+}
+
+// ---- Persistence ----
+
+typedef struct {
+    const char* path;
+    int* errs;
+} FileJob;
+
+static char* shard_path(const char* path, size_t shard) {
+    size_t len = strlen(path) + sizeof(SHARD_FILE_SUFFIX) + 20;
+    char* out = malloc(len);
+    if (out) snprintf(out, len, "%s%s%zu", path, SHARD_FILE_SUFFIX, shard);
+    return out;
+}
+
+static void save_shard(ShardedIndexer* si, size_t s, void* arg) {
+    FileJob* job = arg;
+    char* path = shard_path(job->path, s);
+    if (!path) {
+        job->errs[s] = ENOMEM;
+        return;
+    }
+    pthread_rwlock_rdlock(&si->shards[s].lock);
+    job->errs[s] = indexer_save(si->shards[s].idx, path);
+    pthread_rwlock_unlock(&si->shards[s].lock);
+    free(path);
+}
+
+static void load_shard(ShardedIndexer* si, size_t s, void* arg) {
+    FileJob* job = arg;
+    char* path = shard_path(job->path, s);
+    if (!path) {
+        job->errs[s] = ENOMEM;
+        return;
+    }
+    pthread_rwlock_wrlock(&si->shards[s].lock);
+    job->errs[s] = indexer_load(si->shards[s].idx, path);
+    pthread_rwlock_unlock(&si->shards[s].lock);
+    free(path);
+}
+
+static int first_error(const int* errs, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (errs[i] != 0) return errs[i];
+    }
+    return 0;
+}
+
+int sharded_indexer_save(ShardedIndexer* si, const char* path) {
+    if (!si || !path) {
+        ERROR_LOG("Invalid arguments: si=%p, path=%p", (void*)si, (void*)path);
+        return EINVAL;
+    }
+
+    FileJob job = { path, calloc(si->num_shards, sizeof(int)) };
+    if (!job.errs) return ENOMEM;
+    fan_out(si, save_shard, &job);
+    int rc = first_error(job.errs, si->num_shards);
+    free(job.errs);
+    if (rc != 0) {
+        ERROR_LOG("Failed to save shards of %s: %s", path, strerror(rc));
+        return rc;
+    }
+
+    // The manifest goes last, so a complete one implies complete shards
+    FILE* fp = fopen(path, "w");
+    if (!fp) {
+        rc = errno;
+        ERROR_LOG("Failed to open manifest %s: %s", path, strerror(rc));
+        return rc;
+    }
+    if (fprintf(fp, "%s %d\nshards %zu\n", SHARD_MANIFEST_MAGIC, SHARD_MANIFEST_VERSION,
+                si->num_shards) < 0) {
+        rc = EIO;
+    }
+    if (fclose(fp) != 0 && rc == 0) rc = EIO;
+
+    if (rc == 0) INFO_LOG("Saved %zu shards to %s", si->num_shards, path);
+    return rc;
+}
+
+ShardedIndexer* sharded_indexer_load(const char* path, int* err) {
+    if (!path) {
+        ERROR_LOG("Invalid arguments: path=%p", (void*)path);
+        if (err) *err = EINVAL;
+        return NULL;
+    }
+
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        if (err) *err = errno;
+        ERROR_LOG("Failed to open manifest %s: %s", path, strerror(errno));
+        return NULL;
+    }
+    char magic[32];
+    int version = 0;
+    size_t num_shards = 0;
+    int fields = fscanf(fp, "%31s %d shards %zu", magic, &version, &num_shards);
+    fclose(fp);
+    if (fields != 3 || strcmp(magic, SHARD_MANIFEST_MAGIC) != 0 ||
+        version != SHARD_MANIFEST_VERSION || num_shards == 0 || num_shards > SHARDED_MAX_SHARDS) {
+        ERROR_LOG("Invalid shard manifest %s", path);
+        if (err) *err = EINVAL;
+        return NULL;
+    }
+
+    ShardedIndexer* si = sharded_indexer_create(num_shards);
+    FileJob job = { path, calloc(num_shards, sizeof(int)) };
+    if (!si || !job.errs) {
+        sharded_indexer_destroy(si);
+        free(job.errs);
+        if (err) *err = ENOMEM;
+        return NULL;
+    }
+
+    fan_out(si, load_shard, &job);
+    int rc = first_error(job.errs, num_shards);
+    free(job.errs);
+    if (rc != 0) {
+        ERROR_LOG("Failed to load shards of %s: %s", path, strerror(rc));
+        sharded_indexer_destroy(si);
+        if (err) *err = rc;
+        return NULL;
+    }
+
+    INFO_LOG("Loaded %zu shards from %s", num_shards, path);
+    if (err) *err = 0;
+    return si;
+}
+
+size_t sharded_indexer_get_key_count(ShardedIndexer* si) {
+    size_t total = 0;
+    for (size_t s = 0; si && s < si->num_shards; s++) {
+        pthread_rwlock_rdlock(&si->shards[s].lock);
+        total += indexer_get_key_count(si->shards[s].idx);
+        pthread_rwlock_unlock(&si->shards[s].lock);
+    }
+    return total;
+}
+
+size_t sharded_indexer_get_doc_count(ShardedIndexer* si) {
+    size_t total = 0;
+    for (size_t s = 0; si && s < si->num_shards; s++) {
+        pthread_rwlock_rdlock(&si->shards[s].lock);
+        total += indexer_get_doc_count(si->shards[s].idx);
+        pthread_rwlock_unlock(&si->shards[s].lock);
+    }
+    return total;
+}
@@ -0,0 +1,152 @@
+#include "utf8.h"
+#include <string.h>
+#include <limits.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#define UTF8_BLOCK 16
+#endif
+
+int utf8_decode_char(const char* s, size_t len, uint32_t* cp) {
+    const uint8_t* b = (const uint8_t*)s;
+    if (len == 0) return -1;
+    if (b[0] < 0x80) {
+        *cp = b[0];
+        return 1;
+    }
+
+    // Lead bytes C0, C1 and F5..FF can only start overlong or out-of-range forms
+    int n;
+    uint32_t c, min;
+    if (b[0] >= 0xC2 && b[0] <= 0xDF) {
+        n = 2;
+        c = b[0] & 0x1F;
+        min = 0x80;
+    } else if ((b[0] & 0xF0) == 0xE0) {
+        n = 3;
+        c = b[0] & 0x0F;
+        min = 0x800;
+    } else if (b[0] >= 0xF0 && b[0] <= 0xF4) {
+        n = 4;
+        c = b[0] & 0x07;
+        min = 0x10000;
+    } else {
+        return -1;
+    }
+
+    if ((size_t)n > len) return -1;
+    for (int i = 1; i < n; i++) {
+        if ((b[i] & 0xC0) != 0x80) return -1;
+        c = (c << 6) | (b[i] & 0x3F);
+    }
+    if (c < min || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) return -1;
+    *cp = c;
+    return n;
+}
+
+#ifdef UTF8_BLOCK
+static inline bool block_is_ascii(__m128i v) {
+    return _mm_movemask_epi8(v) == 0;
+}
+
+// v % modulus for 16 ASCII bytes: a 16-bit multiply by ceil(2^16 / modulus)
+// gives the exact quotient for every byte below 128 when 2 <= modulus <= 256
+static inline __m128i ascii_slots(__m128i v, __m128i magic, __m128i modulus) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_unpacklo_epi8(v, zero);
+    __m128i hi = _mm_unpackhi_epi8(v, zero);
+    lo = _mm_sub_epi16(lo, _mm_mullo_epi16(_mm_mulhi_epu16(lo, magic), modulus));
+    hi = _mm_sub_epi16(hi, _mm_mullo_epi16(_mm_mulhi_epu16(hi, magic), modulus));
+    return _mm_packus_epi16(lo, hi);
+}
+
+// Load s[0..n), n <= 16, zero padded, without reading past s[n - 1]
+static inline __m128i load_partial(const char* s, size_t n) {
+    uint8_t block[UTF8_BLOCK] = { 0 };
+    memcpy(block, s, n);
+    return _mm_loadu_si128((const __m128i*)block);
+}
+#endif
+
+bool utf8_validate(const char* s, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+#ifdef UTF8_BLOCK
+        if (len - i >= UTF8_BLOCK && block_is_ascii(_mm_loadu_si128((const __m128i*)(s + i)))) {
+            i += UTF8_BLOCK;
+            continue;
+        }
+#endif
+        uint32_t cp;
+        int n = utf8_decode_char(s + i, len - i, &cp);
+        if (n < 0) return false;
+        i += (size_t)n;
+    }
+    return true;
+}
+
+int utf8_decode(const char* s, size_t len, uint32_t* out, size_t max) {
+    if (len > INT_MAX) return -1;
+    size_t i = 0, count = 0;
+    while (i < len) {
+        if (count == max) return -1;
+        uint8_t b = (uint8_t)s[i];
+        if (b < 0x80) {
+            out[count++] = b;
+            i++;
+            continue;
+        }
+        int n = utf8_decode_char(s + i, len - i, &out[count]);
+        if (n < 0) return -1;
+        count++;
+        i += (size_t)n;
+    }
+    return (int)count;
+}
+
+int utf8_slots(const char* s, size_t len, uint8_t* out, size_t max, unsigned modulus) {
+    if (len > INT_MAX || modulus < 2 || modulus > 256) return -1;
+    size_t i = 0, count = 0;
+
+#ifdef UTF8_BLOCK
+    __m128i magic = _mm_set1_epi16((short)(uint16_t)((65536 + modulus - 1) / modulus));
+    __m128i mod = _mm_set1_epi16((short)modulus);
+#endif
+    while (i < len) {
+#ifdef UTF8_BLOCK
+        // Whole ASCII blocks, then an ASCII tail, take one vector step each
+        size_t rest = len - i;
+        size_t take = rest < UTF8_BLOCK ? rest : UTF8_BLOCK;
+        if (count + take <= max) {
+            __m128i v = rest >= UTF8_BLOCK ? _mm_loadu_si128((const __m128i*)(s + i))
+                                           : load_partial(s + i, rest);
+            if (block_is_ascii(v)) {
+                __m128i slots = ascii_slots(v, magic, mod);
+                if (take == UTF8_BLOCK) {
+                    _mm_storeu_si128((__m128i*)(out + count), slots);
+                } else {
+                    uint8_t block[UTF8_BLOCK];
+                    _mm_storeu_si128((__m128i*)block, slots);
+                    memcpy(out + count, block, take);
+                }
+                i += take;
+                count += take;
+                continue;
+            }
+        }
+        // Mixed block: decode it one codepoint at a time
+        size_t block_end = i + take;
+#else
+        size_t block_end = len;
+#endif
+        while (i < block_end) {
+            if (count == max) return -1;
+            uint32_t cp = (uint8_t)s[i];
+            int n = 1;
+            if (cp >= 0x80 && (n = utf8_decode_char(s + i, len - i, &cp)) < 0) return -1;
+            out[count++] = (uint8_t)(cp % modulus);
+            i += (size_t)n;
+        }
+    }
+    return (int)count;
+}
@@ -1,30 +1,46 @@
 #include "indexer.h"
 #include "index_writer.h"
+#include "affix_index.h"
 #include "logging.h"
+#include "metrics.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <stdbool.h>
+#include <signal.h>
 
 static void print_usage(const char* program) {
-    fprintf(stderr, "Usage: %s -i input_file -o output_file\n", program);
+    fprintf(stderr, "Usage: %s [-w | -p] [-x | -d] -i input_file -o output_file\n", program);
     fprintf(stderr, "Options:\n");
     fprintf(stderr, "  -i input_file   Input file containing key:value pairs (one per line)\n");
     fprintf(stderr, "  -o output_file  Output file for the generated index\n");
+    fprintf(stderr, "  -w              Lines are key:value:weight; weight ranks completions\n");
+    fprintf(stderr, "  -p              Lines are doc_id:text; tokens are indexed with positions\n");
+    fprintf(stderr, "  -x              Also write suffix/infix sidecars (.rev and .sa)\n");
+    fprintf(stderr, "  -d              Write a read-only double-array index for exact lookups\n");
     fprintf(stderr, "  -h             Show this help message\n");
+    fprintf(stderr, "SIGUSR1 writes insert and save latencies to stderr while the build runs\n");
 }
 
 int main(int argc, char* argv[]) {
     const char* input_file = NULL;
     const char* output_file = NULL;
+    bool weighted = false;
+    bool affix = false;
+    bool documents = false;
+    bool double_array = false;
     int opt;
 
     // Initialize logging
     log_init("index_writer", LOG_LEVEL_INFO, LOG_DEST_STDERR);
+    // Bad input lines must not stall ingest; a batch build waits rather than lose them
+    log_start_async(1 << 20, LOG_OVERFLOW_BLOCK);
+    metrics_dump_on_signal(SIGUSR1, METRICS_FORMAT_JSON, stderr);
 
     // Parse command line arguments
-    while ((opt = getopt(argc, argv, "i:o:h")) != -1) {
+    while ((opt = getopt(argc, argv, "i:o:wpxdh")) != -1) {
         switch (opt) {
             case 'i':
                 input_file = optarg;
@@ -32,6 +48,18 @@ int main(int argc, char* argv[]) {
             case 'o':
                 output_file = optarg;
                 break;
+            case 'w':
+                weighted = true;
+                break;
+            case 'p':
+                documents = true;
+                break;
+            case 'x':
+                affix = true;
+                break;
+            case 'd':
+                double_array = true;
+                break;
             case 'h':
                 print_usage(argv[0]);
                 return 0;
@@ -46,6 +74,14 @@ int main(int argc, char* argv[]) {
         print_usage(argv[0]);
         return 1;
     }
+    if (weighted && documents) {
+        ERROR_LOG("Weighted lines (-w) cannot be combined with document lines (-p)");
+        return 1;
+    }
+    if (affix && double_array) {
+        ERROR_LOG("Affix sidecars (-x) cannot be used with a double-array index (-d)");
+        return 1;
+    }
 
     // Open input file
     FILE* fp = fopen(input_file, "r");
@@ -66,7 +102,14 @@ int main(int argc, char* argv[]) {
     // Process input file
     size_t processed = 0;
     size_t failed = 0;
-    int rc = process_file(idx, fp, &processed, &failed);
+    int rc;
+    if (documents) {
+        rc = process_document_file(idx, fp, &processed, &failed);
+    } else if (weighted) {
+        rc = process_weighted_file(idx, fp, &processed, &failed);
+    } else {
+        rc = process_file(idx, fp, &processed, &failed);
+    }
 
     if (rc != 0) {
         ERROR_LOG("Failed to process input file: %s", strerror(rc));
@@ -79,12 +122,27 @@ int main(int argc, char* argv[]) {
 
     // Save index
     INFO_LOG("Saving index to %s", output_file);
-    rc = indexer_save(idx, output_file);
+    rc = double_array ? indexer_save_double_array(idx, output_file)
+                      : indexer_save(idx, output_file);
     if (rc != 0) {
         ERROR_LOG("Failed to save index: %s", strerror(rc));
     } else {
-        INFO_LOG("Successfully saved index with %zu keys and %zu documents",
+        INFO_LOG("Successfully saved index with %zu keys and %zu postings",
                 indexer_get_key_count(idx), indexer_get_doc_count(idx));
+        GTrieStats stats;
+        if (indexer_get_trie_stats(idx, &stats) == 0) {
+            gtrie_stats_print(&stats, stderr);
+        }
+    }
+
+    if (rc == 0 && affix) {
+        rc = indexer_save_affix(idx, output_file);
+        if (rc != 0) {
+            ERROR_LOG("Failed to save affix sidecars: %s", strerror(rc));
+        }
+    } else if (rc == 0) {
+        // Sidecars from an earlier -x build describe keys this index may not have
+        rc = affix_index_remove(output_file);
     }
 
     // Cleanup
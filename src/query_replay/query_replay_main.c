@@ -0,0 +1,113 @@
+#include "indexer.h"
+#include "query_replay.h"
+#include "logging.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+static void print_usage(const char* program) {
+    fprintf(stderr, "Usage: %s [-t threads] [-r qps] [-n queries] [-S seed] [-F] index_file query_log\n", program);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -t threads   Number of replay threads (default: one per CPU)\n");
+    fprintf(stderr, "  -r qps       Open loop: Poisson arrivals at this rate (default: closed loop)\n");
+    fprintf(stderr, "  -n queries   Queries to send, cycling through the log (default: one pass)\n");
+    fprintf(stderr, "  -S seed      Seed of the open-loop arrival schedule (default: 42)\n");
+    fprintf(stderr, "  -F           Freeze the index after loading, as search_server -F does\n");
+    fprintf(stderr, "  -h           Show this help message\n");
+    fprintf(stderr, "Log lines are search_server targets (/search?q=..., /complete?q=..., /rank?q=...),\n");
+    fprintf(stderr, "optionally as \"GET <target> HTTP/1.1\", or bare keys. '-' reads the log from stdin.\n");
+}
+
+int main(int argc, char* argv[]) {
+    ReplayConfig cfg;
+    replay_config_init(&cfg);
+    bool freeze = false;
+    int opt;
+
+    log_init("query_replay", LOG_LEVEL_INFO, LOG_DEST_STDERR);
+
+    while ((opt = getopt(argc, argv, "t:r:n:S:Fh")) != -1) {
+        switch (opt) {
+            case 't':
+                cfg.num_threads = atoi(optarg);
+                break;
+            case 'r':
+                cfg.mode = REPLAY_OPEN_LOOP;
+                cfg.target_qps = atof(optarg);
+                break;
+            case 'n':
+                cfg.num_queries = strtoul(optarg, NULL, 10);
+                break;
+            case 'S':
+                cfg.seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'F':
+                freeze = true;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (argc - optind != 2 || cfg.num_threads < 0 ||
+        (cfg.mode == REPLAY_OPEN_LOOP && !(cfg.target_qps > 0))) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    const char* index_file = argv[optind];
+    const char* log_file = argv[optind + 1];
+
+    // Read the whole log first so that parsing stays out of the measurement
+    FILE* fp = strcmp(log_file, "-") == 0 ? stdin : fopen(log_file, "r");
+    if (!fp) {
+        ERROR_LOG("Failed to open query log %s: %s", log_file, strerror(errno));
+        return 1;
+    }
+    int err = 0;
+    QueryLog* log = query_log_read(fp, &err);
+    if (fp != stdin) fclose(fp);
+    if (!log) {
+        ERROR_LOG("Failed to read query log %s: %s", log_file, strerror(err));
+        return 1;
+    }
+    if (log->count == 0) {
+        ERROR_LOG("No replayable queries in %s (%zu lines skipped)", log_file, log->skipped);
+        query_log_destroy(log);
+        return 1;
+    }
+    INFO_LOG("Read %zu queries from %s, skipped %zu lines", log->count, log_file, log->skipped);
+
+    Indexer* idx = indexer_create();
+    if (!idx) {
+        ERROR_LOG("Failed to create indexer");
+        query_log_destroy(log);
+        return 1;
+    }
+    indexer_enable_freeze(idx, freeze);
+    int rc = indexer_load(idx, index_file);
+    if (rc != 0) {
+        ERROR_LOG("Failed to load index %s: %s", index_file, strerror(rc));
+        indexer_destroy(idx);
+        query_log_destroy(log);
+        return 1;
+    }
+
+    ReplayReport report;
+    rc = query_replay_run(idx, log, &cfg, &report);
+    if (rc != 0) {
+        ERROR_LOG("Replay failed: %s", strerror(rc));
+    } else {
+        replay_report_write(&report, &cfg, stdout);
+    }
+
+    indexer_destroy(idx);
+    query_log_destroy(log);
+    log_cleanup();
+    return rc == 0 ? 0 : 1;
+}
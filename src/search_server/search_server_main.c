@@ -0,0 +1,225 @@
+#include "indexer.h"
+#include "search_server.h"
+#include "logging.h"
+#include "metrics.h"
+#include "placement.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <errno.h>
+
+static void print_usage(const char* program) {
+    fprintf(stderr, "Usage: %s [-t threads] [-b address] [-c cache_mb] [-P pages] [-N] [-F] index_file port\n", program);
+    fprintf(stderr, "       %s [-t threads] [-b address] [-T timeout_ms] [-H hedge_ms] -s shard [-s shard...] port\n", program);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -t threads   Number of worker threads (default: one per CPU)\n");
+    fprintf(stderr, "  -b address   IPv4 address to bind (default: all interfaces)\n");
+    fprintf(stderr, "  -c cache_mb  Size of the response cache in MiB (default: 0, disabled)\n");
+    fprintf(stderr, "  -P pages     Back trie nodes with huge pages: off, thp or hugetlb (default: off)\n");
+    fprintf(stderr, "  -N           Load one replica of the index per NUMA node and bind workers to them\n");
+    fprintf(stderr, "  -F           Freeze the index on load: a read-only, cache-friendly node layout\n");
+    fprintf(stderr, "  -s shard     Coordinate shard servers instead of loading an index;\n");
+    fprintf(stderr, "               shard is host:port with optional ,host:port replicas\n");
+    fprintf(stderr, "  -T ms        Per-query deadline for shard answers (default: 1000)\n");
+    fprintf(stderr, "  -H ms        Delay before a hedged request to a replica (default: 50, 0 = off)\n");
+    fprintf(stderr, "  -h           Show this help message\n");
+    fprintf(stderr, "Signals: SIGHUP reloads the index, SIGUSR1 writes operation latencies to stderr\n");
+}
+
+// Load or reload one index replica on a thread bound to its NUMA node, so
+// first-touch places its nodes and postings in that node's memory
+typedef struct {
+    Indexer* idx;
+    const char* path;
+    int rc;
+} ReplicaLoad;
+
+static void* load_replica(void* arg) {
+    ReplicaLoad* load = arg;
+    load->rc = indexer_load(load->idx, load->path);
+    return NULL;
+}
+
+static int load_indexes(Indexer* const* indexes, int count, bool numa, const char* path) {
+    int rc = 0;
+    for (int n = 0; n < count; n++) {
+        ReplicaLoad load = { indexes[n], path, 0 };
+        int node_rc = 0;
+        if (numa) {
+            node_rc = placement_run_on_node(n, load_replica, &load);
+        } else {
+            load_replica(&load);
+        }
+        if (node_rc == 0) node_rc = load.rc;
+        if (node_rc != 0 && rc == 0) rc = node_rc;
+    }
+    return rc;
+}
+
+int main(int argc, char* argv[]) {
+    SearchServerConfig cfg;
+    search_server_config_init(&cfg);
+    CoordinatorConfig coord_cfg;
+    coordinator_config_init(&coord_cfg);
+    const char* shards[COORDINATOR_MAX_SHARDS];
+    size_t num_shards = 0;
+    bool numa = false;
+    bool freeze = false;
+    HugePageMode huge_pages = HUGE_PAGES_OFF;
+    int opt;
+
+    // Initialize logging
+    log_init("search_server", LOG_LEVEL_INFO, LOG_DEST_STDERR);
+    // Workers never wait on log output; overflow is dropped and counted
+    log_start_async(1 << 20, LOG_OVERFLOW_DROP);
+
+    // Parse command line arguments
+    while ((opt = getopt(argc, argv, "t:b:c:P:NFs:T:H:h")) != -1) {
+        switch (opt) {
+            case 't':
+                cfg.num_workers = atoi(optarg);
+                break;
+            case 'b':
+                cfg.bind_addr = optarg;
+                break;
+            case 'c':
+                cfg.cache_bytes = strtoul(optarg, NULL, 10) * 1024 * 1024;
+                break;
+            case 'P':
+                if (placement_parse_huge_pages(optarg, &huge_pages) != 0) {
+                    ERROR_LOG("Invalid huge page mode: %s", optarg);
+                    return 1;
+                }
+                break;
+            case 'N':
+                numa = true;
+                break;
+            case 'F':
+                freeze = true;
+                break;
+            case 's':
+                if (num_shards == COORDINATOR_MAX_SHARDS) {
+                    ERROR_LOG("At most %d shards are supported", COORDINATOR_MAX_SHARDS);
+                    return 1;
+                }
+                shards[num_shards++] = optarg;
+                break;
+            case 'T':
+                coord_cfg.timeout_ms = atoi(optarg);
+                break;
+            case 'H':
+                coord_cfg.hedge_ms = atoi(optarg);
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    // A coordinator takes only a port; a shard server also takes its index file
+    int positional = num_shards > 0 ? 1 : 2;
+    if (argc - optind != positional) {
+        ERROR_LOG(num_shards > 0 ? "Port must be specified" : "Both index file and port must be specified");
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const char* index_file = num_shards > 0 ? NULL : argv[optind];
+    const char* port_arg = argv[optind + positional - 1];
+    int port = atoi(port_arg);
+    if (port <= 0 || port > 65535) {
+        ERROR_LOG("Invalid port: %s", port_arg);
+        return 1;
+    }
+    cfg.port = (uint16_t)port;
+
+    // Block termination, reload and metrics signals in every thread; main waits for them below
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGHUP);
+    sigaddset(&signals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    // Load the index (one replica per NUMA node with -N), or connect the
+    // coordinator to its shards
+    int err = 0;
+    int rc = 0;
+    Indexer* indexes[PLACEMENT_MAX_NODES] = { NULL };
+    int num_indexes = 0;
+    placement_set_huge_pages(huge_pages);
+    if (num_shards > 0) {
+        cfg.coordinator = coordinator_create(shards, num_shards, &coord_cfg, &err);
+        if (!cfg.coordinator) {
+            ERROR_LOG("Failed to create coordinator: %s", strerror(err));
+            return 1;
+        }
+    } else {
+        num_indexes = numa ? placement_node_count() : 1;
+        for (int n = 0; n < num_indexes; n++) {
+            indexes[n] = indexer_create();
+            if (!indexes[n]) {
+                rc = ENOMEM;
+            } else {
+                indexer_enable_freeze(indexes[n], freeze);
+            }
+        }
+        if (rc == 0) rc = load_indexes(indexes, num_indexes, numa, index_file);
+        if (rc != 0) {
+            ERROR_LOG("Failed to load index %s: %s", index_file, strerror(rc));
+            for (int n = 0; n < num_indexes; n++) indexer_destroy(indexes[n]);
+            return 1;
+        }
+        if (numa) {
+            cfg.replicas = indexes;
+            cfg.num_replicas = num_indexes;
+            INFO_LOG("Loaded %d NUMA replicas of %s", num_indexes, index_file);
+        }
+    }
+    Indexer* idx = numa ? NULL : indexes[0];
+
+    // Start serving
+    SearchServer* srv = search_server_create(idx, &cfg, &err);
+    if (!srv) {
+        ERROR_LOG("Failed to create server: %s", strerror(err));
+        for (int n = 0; n < num_indexes; n++) indexer_destroy(indexes[n]);
+        coordinator_destroy(cfg.coordinator);
+        return 1;
+    }
+
+    rc = search_server_start(srv);
+    if (rc != 0) {
+        ERROR_LOG("Failed to start server: %s", strerror(rc));
+    } else {
+        // SIGHUP swaps in a fresh copy of the index file without dropping queries
+        int sig = 0;
+        while (sigwait(&signals, &sig) == 0 && (sig == SIGHUP || sig == SIGUSR1)) {
+            if (sig == SIGUSR1) {
+                metrics_write(stderr, METRICS_FORMAT_JSON);
+                continue;
+            }
+            if (num_indexes == 0) continue;  // Coordinators have nothing to reload
+            INFO_LOG("Received SIGHUP, reloading %s", index_file);
+            int reload_rc = load_indexes(indexes, num_indexes, numa, index_file);
+            if (reload_rc != 0) {
+                ERROR_LOG("Reload failed, still serving the previous index: %s", strerror(reload_rc));
+            }
+        }
+        INFO_LOG("Received signal %d, shutting down", sig);
+    }
+
+    // Cleanup
+    search_server_destroy(srv);
+    for (int n = 0; n < num_indexes; n++) indexer_destroy(indexes[n]);
+    coordinator_destroy(cfg.coordinator);
+    log_cleanup();
+
+    return rc == 0 ? 0 : 1;
+}
@@ -0,0 +1,461 @@
+#include "bench.h"
+#include "gtrie.h"
+#include "gtrie_io.h"
+#include "indexer.h"
+#include "index_writer.h"
+#include "logging.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>
+
+// Performance regression gate. Each workload runs on a fixed-seed corpus N
+// times; its median throughput is divided by the median of a calibration
+// loop so that baselines carry over between machines of similar shape, and
+// compared with the checked-in baseline. A workload fails when even the
+// upper end of the 95% confidence interval of its median falls more than
+// the tolerance below the baseline, or when it allocates more per op.
+
+#define PERF_DEFAULT_REPEATS 7
+#define PERF_DEFAULT_TOLERANCE 0.35
+#define PERF_DEFAULT_ALLOC_TOLERANCE 0.05
+#define PERF_CALIBRATION_SLOTS (1u << 21)   // 16 MiB pointer chase
+#define PERF_MAX_WORKLOADS 16
+
+// Count allocations by interposing the allocator; sanitizers own it already
+#if !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define PERF_COUNT_ALLOCS 1
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void* __libc_memalign(size_t alignment, size_t size);
+
+static int counting;
+static uint64_t allocations;
+
+static inline void count_allocation(void) {
+    if (__atomic_load_n(&counting, __ATOMIC_RELAXED)) {
+        __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void* malloc(size_t size) {
+    count_allocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    count_allocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    count_allocation();
+    return __libc_realloc(ptr, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    count_allocation();
+    void* ptr = __libc_memalign(alignment, size);
+    if (!ptr) return ENOMEM;
+    *out = ptr;
+    return 0;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    count_allocation();
+    return __libc_memalign(alignment, size);
+}
+
+static void count_begin(void) {
+    __atomic_store_n(&allocations, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&counting, 1, __ATOMIC_RELAXED);
+}
+
+static uint64_t count_end(void) {
+    __atomic_store_n(&counting, 0, __ATOMIC_RELAXED);
+    return __atomic_load_n(&allocations, __ATOMIC_RELAXED);
+}
+#else
+static void count_begin(void) {
+}
+
+static uint64_t count_end(void) {
+    return 0;
+}
+#endif
+
+typedef struct {
+    Corpus* corpus;
+    GTrie* trie;            // Built once for the read-only workloads
+    char path[4096];        // Saved copy of trie
+    FILE* input;            // Corpus as key:doc_id lines
+    char** queries;         // Half hits, half misses
+    size_t num_queries;
+} PerfContext;
+
+typedef struct {
+    const char* name;
+    // Run once; returns 0 and the ops done in the timed region
+    int (*run)(PerfContext* ctx, uint64_t* ns, size_t* ops, uint64_t* allocs);
+} Workload;
+
+typedef struct {
+    char name[64];
+    double throughput;      // Median ops/sec over calibration ops/sec
+    double allocs_per_op;
+} BaselineEntry;
+
+static int run_insert(PerfContext* ctx, uint64_t* ns, size_t* ops, uint64_t* allocs) {
+    const Corpus* c = ctx->corpus;
+    int err = 0;
+    count_begin();
+    uint64_t start = bench_now_ns();
+    GTrie* trie = gtrie_create(&err);
+    for (size_t p = 0; trie && p < c->num_postings; p++) {
+        gtrie_insert(trie, c->keys[c->key_of[p]], c->docs[c->doc_of[p]]);
+    }
+    *ns = bench_now_ns() - start;
+    *allocs = count_end();
+    *ops = c->num_postings;
+    gtrie_destroy(trie);
+    return trie ? 0 : err;
+}
+
+static int run_search(PerfContext* ctx, uint64_t* ns, size_t* ops, uint64_t* allocs) {
+    size_t found = 0;
+    count_begin();
+    uint64_t start = bench_now_ns();
+    for (size_t q = 0; q < ctx->num_queries; q++) {
+        int err;
+        found += gtrie_search(ctx->trie, ctx->queries[q], &err) != NULL;
+    }
+    *ns = bench_now_ns() - start;
+    *allocs = count_end();
+    *ops = ctx->num_queries;
+    return found > 0 ? 0 : ENOENT;
+}
+
+static int run_save(PerfContext* ctx, uint64_t* ns, size_t* ops, uint64_t* allocs) {
+    count_begin();
+    uint64_t start = bench_now_ns();
+    int rc = gtrie_save(ctx->trie, ctx->path, NULL, NULL);
+    *ns = bench_now_ns() - start;
+    *allocs = count_end();
+    *ops = ctx->trie->node_count;
+    return rc;
+}
+
+static int run_load(PerfContext* ctx, uint64_t* ns, size_t* ops, uint64_t* allocs) {
+    int err = 0;
+    count_begin();
+    uint64_t start = bench_now_ns();
+    GTrie* trie = gtrie_load(ctx->path, &err, NULL, NULL);
+    *ns = bench_now_ns() - start;
+    *allocs = count_end();
+    *ops = ctx->trie->node_count;
+    gtrie_destroy(trie);
+    return trie ? 0 : err;
+}
+
+static int run_process_file(PerfContext* ctx, uint64_t* ns, size_t* ops, uint64_t* allocs) {
+    size_t processed = 0, failed = 0;
+    rewind(ctx->input);
+    count_begin();
+    uint64_t start = bench_now_ns();
+    Indexer* idx = indexer_create();
+    int rc = idx ? process_file(idx, ctx->input, &processed, &failed) : ENOMEM;
+    *ns = bench_now_ns() - start;
+    *allocs = count_end();
+    *ops = processed;
+    indexer_destroy(idx);
+    return rc;
+}
+
+static const Workload workloads[] = {
+    { "insert", run_insert },
+    { "search", run_search },
+    { "save", run_save },
+    { "load", run_load },
+    { "process_file", run_process_file },
+};
+
+#define NUM_WORKLOADS (sizeof(workloads) / sizeof(workloads[0]))
+
+// Dependent loads over a random cycle: a stand-in for trie walks that
+// measures this machine's memory latency and clock
+static double calibrate(int repeats) {
+    uint32_t* next = malloc(PERF_CALIBRATION_SLOTS * sizeof(uint32_t));
+    uint32_t* order = malloc(PERF_CALIBRATION_SLOTS * sizeof(uint32_t));
+    if (!next || !order) {
+        free(next);
+        free(order);
+        return 0;
+    }
+    uint64_t state = 42;
+    for (uint32_t i = 0; i < PERF_CALIBRATION_SLOTS; i++) order[i] = i;
+    for (uint32_t i = PERF_CALIBRATION_SLOTS - 1; i > 0; i--) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint32_t j = (uint32_t)((state >> 33) % (i + 1));
+        uint32_t t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+    for (uint32_t i = 0; i < PERF_CALIBRATION_SLOTS; i++) {
+        next[order[i]] = order[(i + 1) % PERF_CALIBRATION_SLOTS];
+    }
+    free(order);
+
+    uint64_t* samples = malloc((size_t)repeats * sizeof(uint64_t));
+    uint32_t pos = 0;
+    for (int r = 0; samples && r < repeats; r++) {
+        uint64_t start = bench_now_ns();
+        for (uint32_t i = 0; i < PERF_CALIBRATION_SLOTS; i++) pos = next[pos];
+        samples[r] = bench_now_ns() - start + (pos == UINT32_MAX);  // Keep the chase live
+    }
+    double ops_per_sec = samples ? 1e9 * PERF_CALIBRATION_SLOTS / (double)bench_percentile(samples, (size_t)repeats, 50) : 0;
+    free(samples);
+    free(next);
+    return ops_per_sec;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+// Median of sorted samples with a distribution-free 95% confidence interval
+// from order statistics
+static double median_ci(double* samples, size_t n, double* lo, double* hi) {
+    qsort(samples, n, sizeof(double), compare_double);
+    double spread = 1.96 * sqrt((double)n);
+    long lo_rank = (long)floor(((double)n - spread) / 2.0);
+    long hi_rank = (long)ceil(1.0 + ((double)n + spread) / 2.0) - 1;
+    *lo = samples[lo_rank < 0 ? 0 : lo_rank];
+    *hi = samples[hi_rank >= (long)n ? (long)n - 1 : hi_rank];
+    return n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+}
+
+static size_t read_baseline(const char* path, BaselineEntry* entries, size_t max) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) return 0;
+    char line[256];
+    size_t n = 0;
+    while (n < max && fgets(line, sizeof(line), fp)) {
+        if (line[0] == '#') continue;
+        BaselineEntry* e = &entries[n];
+        if (sscanf(line, "%63s %lf %lf", e->name, &e->throughput, &e->allocs_per_op) == 3) n++;
+    }
+    fclose(fp);
+    return n;
+}
+
+static int write_baseline(const char* path, const BaselineEntry* entries, size_t n) {
+    FILE* fp = fopen(path, "w");
+    if (!fp) return errno;
+    fprintf(fp, "# Perf gate baseline, regenerate with `make perf_baseline`\n");
+    fprintf(fp, "# workload  throughput_vs_calibration  allocs_per_op\n");
+    for (size_t i = 0; i < n; i++) {
+        fprintf(fp, "%s %.6g %.6g\n", entries[i].name, entries[i].throughput, entries[i].allocs_per_op);
+    }
+    return fclose(fp) == 0 ? 0 : errno;
+}
+
+static int setup(PerfContext* ctx) {
+    CorpusConfig cfg;
+    corpus_config_init(&cfg);
+    cfg.num_keys = 5000;
+    cfg.num_postings = 50000;
+    int err = 0;
+    ctx->corpus = corpus_generate(&cfg, &err);
+    if (!ctx->corpus) return err;
+    const Corpus* c = ctx->corpus;
+
+    ctx->trie = gtrie_create(&err);
+    if (!ctx->trie) return err;
+    for (size_t p = 0; p < c->num_postings; p++) {
+        gtrie_insert(ctx->trie, c->keys[c->key_of[p]], c->docs[c->doc_of[p]]);
+    }
+
+    const char* tmpdir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    snprintf(ctx->path, sizeof(ctx->path), "%s/perf_gate_XXXXXX", tmpdir);
+    int fd = mkstemp(ctx->path);
+    if (fd < 0) return errno;
+    close(fd);
+    int rc = gtrie_save(ctx->trie, ctx->path, NULL, NULL);
+    if (rc != 0) return rc;
+
+    // Load the saved copy so that lookups go through the key filter
+    gtrie_destroy(ctx->trie);
+    ctx->trie = gtrie_load(ctx->path, &err, NULL, NULL);
+    if (!ctx->trie) return err;
+
+    ctx->input = tmpfile();
+    if (!ctx->input) return errno;
+    rc = corpus_write(c, ctx->input);
+    if (rc != 0) return rc;
+
+    // Misses are keys of an unrelated corpus
+    cfg.seed ^= 0x5bd1e995;
+    cfg.num_postings = 0;
+    Corpus* misses = corpus_generate(&cfg, &err);
+    if (!misses) return err;
+    ctx->num_queries = 2 * c->num_postings;
+    ctx->queries = malloc(ctx->num_queries * sizeof(char*));
+    if (!ctx->queries) return ENOMEM;
+    for (size_t q = 0; q < c->num_postings; q++) {
+        ctx->queries[2 * q] = strdup(c->keys[c->key_of[q]]);
+        ctx->queries[2 * q + 1] = strdup(misses->keys[q % misses->num_keys]);
+    }
+    corpus_destroy(misses);
+    return 0;
+}
+
+static void teardown(PerfContext* ctx) {
+    for (size_t q = 0; ctx->queries && q < ctx->num_queries; q++) free(ctx->queries[q]);
+    free(ctx->queries);
+    if (ctx->input) fclose(ctx->input);
+    if (ctx->path[0]) unlink(ctx->path);
+    gtrie_destroy(ctx->trie);
+    corpus_destroy(ctx->corpus);
+}
+
+static void print_usage(const char* program) {
+    fprintf(stderr, "Usage: %s -b baseline [-w workload] [-r repeats] [-t tolerance] [-a alloc_tolerance] [-u]\n", program);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -b file        Baseline file (workload throughput allocs_per_op)\n");
+    fprintf(stderr, "  -w workload    insert, search, save, load or process_file (default: all)\n");
+    fprintf(stderr, "  -r repeats     Runs per workload (default: %d)\n", PERF_DEFAULT_REPEATS);
+    fprintf(stderr, "  -t tolerance   Allowed throughput drop, 0..1 (default: %.2f)\n", PERF_DEFAULT_TOLERANCE);
+    fprintf(stderr, "  -a tolerance   Allowed growth of allocations per op (default: %.2f)\n", PERF_DEFAULT_ALLOC_TOLERANCE);
+    fprintf(stderr, "  -u             Write the measured values to the baseline instead of checking\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* baseline_path = NULL;
+    const char* only = NULL;
+    int repeats = PERF_DEFAULT_REPEATS;
+    double tolerance = PERF_DEFAULT_TOLERANCE;
+    double alloc_tolerance = PERF_DEFAULT_ALLOC_TOLERANCE;
+    bool update = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:w:r:t:a:uh")) != -1) {
+        switch (opt) {
+            case 'b': baseline_path = optarg; break;
+            case 'w': only = optarg; break;
+            case 'r': repeats = atoi(optarg) > 2 ? atoi(optarg) : 3; break;
+            case 't': tolerance = atof(optarg); break;
+            case 'a': alloc_tolerance = atof(optarg); break;
+            case 'u': update = true; break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (!baseline_path) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    log_init(argv[0], LOG_LEVEL_ERROR, LOG_DEST_STDERR);
+    BaselineEntry baseline[PERF_MAX_WORKLOADS];
+    size_t num_baseline = read_baseline(baseline_path, baseline, PERF_MAX_WORKLOADS);
+
+    PerfContext ctx = { 0 };
+    int rc = setup(&ctx);
+    if (rc != 0) {
+        fprintf(stderr, "Setup failed: %s\n", strerror(rc));
+        teardown(&ctx);
+        return 1;
+    }
+    double calibration = calibrate(repeats);
+    printf("calibration: %.4g chased loads/s\n", calibration);
+
+    int failures = 0;
+    bool matched = false;
+    double* samples = malloc((size_t)repeats * sizeof(double));
+    for (size_t w = 0; w < NUM_WORKLOADS && samples; w++) {
+        const Workload* wl = &workloads[w];
+        if (only && strcmp(only, wl->name) != 0) continue;
+        matched = true;
+
+        // The first run warms caches and the allocator and is not counted
+        double allocs_per_op = 0;
+        for (int r = -1; r < repeats; r++) {
+            uint64_t ns = 0, allocs = 0;
+            size_t ops = 0;
+            rc = wl->run(&ctx, &ns, &ops, &allocs);
+            if (rc != 0 || ops == 0) {
+                fprintf(stderr, "%s: run failed: %s\n", wl->name, strerror(rc ? rc : EINVAL));
+                failures++;
+                break;
+            }
+            if (r < 0) continue;
+            samples[r] = (double)ops * 1e9 / (double)(ns ? ns : 1);
+            allocs_per_op = (double)allocs / (double)ops;
+        }
+        if (rc != 0) continue;
+
+        double lo, hi;
+        double median = median_ci(samples, (size_t)repeats, &lo, &hi);
+        double normalized = median / calibration;
+        printf("%s: %.4g ops/s median (95%% CI %.4g..%.4g, n=%d), %.4g vs calibration, %.4g allocs/op\n",
+               wl->name, median, lo, hi, repeats, normalized, allocs_per_op);
+
+        BaselineEntry* base = NULL;
+        for (size_t b = 0; b < num_baseline; b++) {
+            if (strcmp(baseline[b].name, wl->name) == 0) base = &baseline[b];
+        }
+        if (update) {
+            if (!base && num_baseline < PERF_MAX_WORKLOADS) base = &baseline[num_baseline++];
+            if (base) {
+                snprintf(base->name, sizeof(base->name), "%s", wl->name);
+                base->throughput = normalized;
+                base->allocs_per_op = allocs_per_op;
+            }
+            continue;
+        }
+        if (!base) {
+            printf("%s: no baseline, not checked\n", wl->name);
+            continue;
+        }
+
+        double floor_throughput = base->throughput * (1.0 - tolerance);
+        if (hi / calibration < floor_throughput) {
+            printf("%s: REGRESSION: throughput %.4g (CI upper %.4g) below %.4g = baseline %.4g - %.0f%%\n",
+                   wl->name, normalized, hi / calibration, floor_throughput, base->throughput, tolerance * 100);
+            failures++;
+        } else if (lo / calibration > base->throughput * (1.0 + tolerance)) {
+            printf("%s: faster than baseline %.4g; consider updating it with -u\n", wl->name, base->throughput);
+        }
+#ifdef PERF_COUNT_ALLOCS
+        if (allocs_per_op > base->allocs_per_op * (1.0 + alloc_tolerance) + 0.01) {
+            printf("%s: REGRESSION: %.4g allocs/op, baseline %.4g + %.0f%%\n",
+                   wl->name, allocs_per_op, base->allocs_per_op, alloc_tolerance * 100);
+            failures++;
+        }
+#endif
+    }
+    free(samples);
+    teardown(&ctx);
+
+    if (!matched) {
+        fprintf(stderr, "Unknown workload: %s\n", only);
+        return 1;
+    }
+    if (update) {
+        rc = write_baseline(baseline_path, baseline, num_baseline);
+        if (rc != 0) {
+            fprintf(stderr, "Failed to write %s: %s\n", baseline_path, strerror(rc));
+            return 1;
+        }
+        printf("Updated %s\n", baseline_path);
+    }
+    return failures ? 1 : 0;
+}
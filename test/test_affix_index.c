@@ -0,0 +1,229 @@
+#include "../include/affix_index.h"
+#include "../include/gtrie_io.h"
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <errno.h>
+
+#define AFFIX_TEST_DIR "./Testing/Temporary/test_affix_index"
+#define AFFIX_TEST_FILE "./Testing/Temporary/test_affix_index/test.trie"
+#define AFFIX_TEST_KEYS 2000
+
+static GTrie* trie;
+
+void setUp(void) {
+    int err = 0;
+    trie = gtrie_create(&err);
+    TEST_ASSERT_NOT_NULL(trie);
+    mkdir(AFFIX_TEST_DIR, 0755);
+}
+
+void tearDown(void) {
+    gtrie_destroy(trie);
+    unlink(AFFIX_TEST_FILE AFFIX_REVERSED_EXT);
+    unlink(AFFIX_TEST_FILE AFFIX_SUFFIX_EXT);
+    unlink(AFFIX_TEST_FILE);
+    rmdir(AFFIX_TEST_DIR);
+}
+
+// Deterministic pseudo-random numbers
+static uint32_t next_random(uint32_t* state) {
+    *state = *state * 1103515245u + 12345u;
+    return (*state >> 16) & 0x7FFF;
+}
+
+static bool has_suffix(const char* s, const char* suffix) {
+    size_t n = strlen(s), m = strlen(suffix);
+    return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+// Compare a query against a scan of every stored key
+static void check_query(const AffixIndex* index, AffixQuery query, const char* text) {
+    size_t stored = 0;
+    int err = 0;
+    char** all = gtrie_prefix_search(trie, "", &stored, &err);
+    TEST_ASSERT_NOT_NULL(all);
+
+    size_t expected = 0;
+    for (size_t i = 0; i < stored; i++) {
+        bool hit = query == AFFIX_SUFFIX ? has_suffix(all[i], text) : strstr(all[i], text) != NULL;
+        if (hit) expected++;
+    }
+    free(all);
+
+    const char** keys = malloc((stored + 1) * sizeof(char*));
+    TEST_ASSERT_NOT_NULL(keys);
+    size_t count = 0;
+    int rc = affix_index_search(index, query, text, keys, stored + 1, &count);
+    TEST_ASSERT_EQUAL_INT(expected > 0 ? 0 : ENOENT, rc);
+    TEST_ASSERT_EQUAL_size_t(expected, count);
+    for (size_t i = 0; i < count; i++) {
+        if (query == AFFIX_SUFFIX) TEST_ASSERT_TRUE(has_suffix(keys[i], text));
+        else TEST_ASSERT_NOT_NULL(strstr(keys[i], text));
+        if (i > 0) TEST_ASSERT_TRUE(strcmp(keys[i - 1], keys[i]) < 0);
+        TEST_ASSERT_NOT_NULL(gtrie_search(trie, keys[i], &err));
+    }
+    free(keys);
+}
+
+static void insert_random_keys(void) {
+    const char* parts[] = { "sku", "-", "12", "ab", "phone", "x", "9", "caf\xc3\xa9" };
+    uint32_t seed = 11;
+    char key[64];
+    for (int i = 0; i < AFFIX_TEST_KEYS; i++) {
+        key[0] = '\0';
+        int n = 1 + (int)(next_random(&seed) % 5);
+        for (int j = 0; j < n; j++) {
+            strcat(key, parts[next_random(&seed) % (sizeof(parts) / sizeof(parts[0]))]);
+        }
+        TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, key, "doc"));
+    }
+}
+
+void test_matches_scan(void) {
+    insert_random_keys();
+
+    int err = 0;
+    AffixIndex* index = affix_index_build(trie, &err);
+    TEST_ASSERT_NOT_NULL(index);
+
+    const char* texts[] = { "phone", "12ab", "-", "x9", "\xc3\xa9", "ab-12", "missing" };
+    for (size_t i = 0; i < sizeof(texts) / sizeof(texts[0]); i++) {
+        check_query(index, AFFIX_SUFFIX, texts[i]);
+        check_query(index, AFFIX_INFIX, texts[i]);
+    }
+    affix_index_destroy(index);
+}
+
+void test_limit(void) {
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, "iphone", "doc1"));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, "phone", "doc2"));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, "phonebook", "doc3"));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, "telephone", "doc4"));
+
+    int err = 0;
+    AffixIndex* index = affix_index_build(trie, &err);
+    TEST_ASSERT_NOT_NULL(index);
+    TEST_ASSERT_EQUAL_size_t(4, affix_index_key_count(index));
+
+    const char* keys[4];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(0, affix_index_search(index, AFFIX_INFIX, "phone", keys, 2, &count));
+    TEST_ASSERT_EQUAL_size_t(2, count);
+    TEST_ASSERT_EQUAL_STRING("iphone", keys[0]);
+    TEST_ASSERT_EQUAL_STRING("phone", keys[1]);
+
+    TEST_ASSERT_EQUAL_INT(0, affix_index_search(index, AFFIX_SUFFIX, "phone", keys, 4, &count));
+    TEST_ASSERT_EQUAL_size_t(3, count);
+    TEST_ASSERT_EQUAL_STRING("telephone", keys[2]);
+
+    TEST_ASSERT_EQUAL_INT(EINVAL, affix_index_search(index, AFFIX_INFIX, "phone", keys, 0, &count));
+    TEST_ASSERT_EQUAL_INT(EINVAL, affix_index_search(index, AFFIX_INFIX, NULL, keys, 4, &count));
+    TEST_ASSERT_EQUAL_INT(EINVAL, affix_index_search(NULL, AFFIX_INFIX, "phone", keys, 4, &count));
+    affix_index_destroy(index);
+}
+
+void test_save_load(void) {
+    insert_random_keys();
+
+    int err = 0;
+    AffixIndex* built = affix_index_build(trie, &err);
+    TEST_ASSERT_NOT_NULL(built);
+    TEST_ASSERT_EQUAL_INT(0, gtrie_save(trie, AFFIX_TEST_FILE, NULL, NULL));
+    TEST_ASSERT_EQUAL_INT(0, affix_index_save(built, AFFIX_TEST_FILE));
+
+    GTrie* main_index = gtrie_load(AFFIX_TEST_FILE, &err, NULL, NULL);
+    TEST_ASSERT_NOT_NULL(main_index);
+    AffixIndex* loaded = affix_index_load(AFFIX_TEST_FILE, main_index, &err);
+    TEST_ASSERT_NOT_NULL(loaded);
+    TEST_ASSERT_EQUAL_size_t(affix_index_key_count(built), affix_index_key_count(loaded));
+    check_query(loaded, AFFIX_SUFFIX, "phone");
+    check_query(loaded, AFFIX_INFIX, "12ab");
+
+    affix_index_destroy(loaded);
+    affix_index_destroy(built);
+    gtrie_destroy(main_index);
+}
+
+void test_load_errors(void) {
+    int err = 0;
+    TEST_ASSERT_NULL(affix_index_load(AFFIX_TEST_FILE, trie, &err));
+    TEST_ASSERT_EQUAL_INT(ENOENT, err);
+    TEST_ASSERT_NULL(affix_index_load(AFFIX_TEST_FILE, NULL, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, "phone", "doc1"));
+    AffixIndex* built = affix_index_build(trie, &err);
+    TEST_ASSERT_NOT_NULL(built);
+    // Sidecars are written for a saved index only
+    TEST_ASSERT_EQUAL_INT(ENOENT, affix_index_save(built, AFFIX_TEST_FILE));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_save(trie, AFFIX_TEST_FILE, NULL, NULL));
+    TEST_ASSERT_EQUAL_INT(0, affix_index_save(built, AFFIX_TEST_FILE));
+    affix_index_destroy(built);
+
+    // Truncated suffix array
+    TEST_ASSERT_EQUAL_INT(0, truncate(AFFIX_TEST_FILE AFFIX_SUFFIX_EXT, 20));
+    TEST_ASSERT_NULL(affix_index_load(AFFIX_TEST_FILE, trie, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+
+    // Offsets pointing outside the dictionary
+    FILE* fp = fopen(AFFIX_TEST_FILE AFFIX_SUFFIX_EXT, "wb");
+    TEST_ASSERT_NOT_NULL(fp);
+    uint32_t words32[2] = { 0x58534641, 2 };
+    uint64_t counts[3] = { 1, 6, 1 };
+    uint32_t width[2] = { 8, 0 };
+    uint64_t source[2] = { 0, 1 };
+    uint64_t packed[2] = { 0, 200 };
+    fwrite(words32, sizeof(words32), 1, fp);
+    fwrite(counts, sizeof(counts), 1, fp);
+    fwrite(width, sizeof(width), 1, fp);
+    fwrite(source, sizeof(source), 1, fp);
+    fwrite("phone", 1, 6, fp);
+    fwrite(packed, sizeof(packed), 1, fp);
+    fclose(fp);
+    TEST_ASSERT_NULL(affix_index_load(AFFIX_TEST_FILE, trie, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+}
+
+void test_stale_sidecars(void) {
+    int err = 0;
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, "phone", "doc1"));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_save(trie, AFFIX_TEST_FILE, NULL, NULL));
+    AffixIndex* built = affix_index_build(trie, &err);
+    TEST_ASSERT_EQUAL_INT(0, affix_index_save(built, AFFIX_TEST_FILE));
+    affix_index_destroy(built);
+
+    // The index is rebuilt without sidecars; the old ones no longer apply
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, "headphone", "doc2"));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_save(trie, AFFIX_TEST_FILE, NULL, NULL));
+    GTrie* rebuilt = gtrie_load(AFFIX_TEST_FILE, &err, NULL, NULL);
+    TEST_ASSERT_NOT_NULL(rebuilt);
+    TEST_ASSERT_NULL(affix_index_load(AFFIX_TEST_FILE, rebuilt, &err));
+    TEST_ASSERT_EQUAL_INT(ESTALE, err);
+
+    // A trie from another file has another timestamp (0 when built in memory)
+    TEST_ASSERT_NULL(affix_index_load(AFFIX_TEST_FILE, trie, &err));
+    TEST_ASSERT_EQUAL_INT(ESTALE, err);
+
+    TEST_ASSERT_EQUAL_INT(0, affix_index_remove(AFFIX_TEST_FILE));
+    TEST_ASSERT_NULL(affix_index_load(AFFIX_TEST_FILE, rebuilt, &err));
+    TEST_ASSERT_EQUAL_INT(ENOENT, err);
+    TEST_ASSERT_EQUAL_INT(0, affix_index_remove(AFFIX_TEST_FILE));  // Nothing left to remove
+    TEST_ASSERT_EQUAL_INT(EINVAL, affix_index_remove(NULL));
+    gtrie_destroy(rebuilt);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_matches_scan);
+    RUN_TEST(test_limit);
+    RUN_TEST(test_save_load);
+    RUN_TEST(test_load_errors);
+    RUN_TEST(test_stale_sidecars);
+
+    return UNITY_END();
+}
@@ -0,0 +1,412 @@
+#include "../include/coordinator.h"
+#include "../include/search_server.h"
+#include "../include/indexer.h"
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define TEST_SHARDS 3
+
+// Documents of each shard process; shards hold disjoint documents
+static const char* shard_docs[TEST_SHARDS][6][2] = {
+    { { "apple", "doc1" }, { "red", "doc1" }, { "red", "doc2" }, { "green", "doc2" },
+      { "apple", "doc2" }, { NULL, NULL } },
+    { { "apple", "doc5" }, { "red", "doc5" }, { "green", "doc5" }, { "green", "doc6" },
+      { NULL, NULL } },
+    { { "apple", "doc9" }, { "green", "doc9" }, { "blue", "doc9" }, { NULL, NULL } },
+};
+
+static pid_t children[TEST_SHARDS];
+static int stop_fds[TEST_SHARDS];
+static uint16_t ports[TEST_SHARDS];
+static int blackhole_fd = -1;   // Accepts connections but never answers
+static uint16_t blackhole_port;
+static uint16_t refused_port;   // Nothing listens here
+
+// Child: serve one shard until the parent closes the stop pipe
+static void run_shard(int shard, int port_fd, int stop_fd) {
+    Indexer* idx = indexer_create();
+    for (int i = 0; shard_docs[shard][i][0]; i++) {
+        indexer_add_document(idx, shard_docs[shard][i][0], shard_docs[shard][i][1]);
+    }
+
+    SearchServerConfig cfg;
+    search_server_config_init(&cfg);
+    cfg.bind_addr = "127.0.0.1";
+    cfg.port = 0;
+    cfg.num_workers = 2;
+    int err = 0;
+    SearchServer* srv = search_server_create(idx, &cfg, &err);
+    uint16_t port = 0;
+    if (srv && search_server_start(srv) == 0) port = search_server_port(srv);
+    if (write(port_fd, &port, sizeof(port)) != sizeof(port)) _exit(1);
+
+    char byte;
+    while (read(stop_fd, &byte, 1) > 0) {}
+
+    search_server_destroy(srv);
+    indexer_destroy(idx);
+    _exit(0);
+}
+
+static void start_shards(void) {
+    for (int s = 0; s < TEST_SHARDS; s++) {
+        int port_pipe[2];
+        int stop_pipe[2];
+        if (pipe(port_pipe) != 0 || pipe(stop_pipe) != 0) exit(1);
+
+        children[s] = fork();
+        if (children[s] == 0) {
+            close(port_pipe[0]);
+            close(stop_pipe[1]);
+            for (int prev = 0; prev < s; prev++) close(stop_fds[prev]);
+            run_shard(s, port_pipe[1], stop_pipe[0]);
+        }
+        close(port_pipe[1]);
+        close(stop_pipe[0]);
+        stop_fds[s] = stop_pipe[1];
+        if (read(port_pipe[0], &ports[s], sizeof(ports[s])) != sizeof(ports[s]) || ports[s] == 0) {
+            fprintf(stderr, "shard %d failed to start\n", s);
+            exit(1);
+        }
+        close(port_pipe[0]);
+    }
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+
+    blackhole_fd = socket(AF_INET, SOCK_STREAM, 0);
+    bind(blackhole_fd, (struct sockaddr*)&addr, sizeof(addr));
+    listen(blackhole_fd, 16);
+    getsockname(blackhole_fd, (struct sockaddr*)&addr, &len);
+    blackhole_port = ntohs(addr.sin_port);
+
+    addr.sin_port = 0;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    bind(fd, (struct sockaddr*)&addr, sizeof(addr));
+    getsockname(fd, (struct sockaddr*)&addr, &len);
+    refused_port = ntohs(addr.sin_port);
+    close(fd);
+}
+
+static void stop_shards(void) {
+    for (int s = 0; s < TEST_SHARDS; s++) {
+        close(stop_fds[s]);
+        waitpid(children[s], NULL, 0);
+    }
+    close(blackhole_fd);
+}
+
+static char specs[TEST_SHARDS][64];
+static const char* spec_ptrs[TEST_SHARDS];
+
+// Shard addresses; shard s may be given a replica list instead
+static Coordinator* make_coordinator(int timeout_ms, int hedge_ms, int shard, const char* spec) {
+    for (int s = 0; s < TEST_SHARDS; s++) {
+        snprintf(specs[s], sizeof(specs[s]), "127.0.0.1:%u", ports[s]);
+        spec_ptrs[s] = specs[s];
+    }
+    if (spec) spec_ptrs[shard] = spec;
+
+    CoordinatorConfig cfg;
+    coordinator_config_init(&cfg);
+    cfg.timeout_ms = timeout_ms;
+    cfg.hedge_ms = hedge_ms;
+    int err = -1;
+    Coordinator* c = coordinator_create(spec_ptrs, TEST_SHARDS, &cfg, &err);
+    TEST_ASSERT_NOT_NULL(c);
+    TEST_ASSERT_EQUAL_INT(0, err);
+    return c;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_search_merges_shards(void) {
+    Coordinator* c = make_coordinator(2000, 0, 0, NULL);
+    TEST_ASSERT_EQUAL_size_t(TEST_SHARDS, coordinator_shard_count(c));
+
+    CoordinatorResult result;
+    TEST_ASSERT_EQUAL_INT(0, coordinator_search(c, "apple", SIZE_MAX, &result));
+    TEST_ASSERT_EQUAL_size_t(TEST_SHARDS, result.shards_ok);
+    TEST_ASSERT_EQUAL_size_t(0, result.shards_failed);
+    TEST_ASSERT_EQUAL_size_t(4, result.count);
+    TEST_ASSERT_EQUAL_size_t(4, result.total);
+    TEST_ASSERT_EQUAL_STRING("doc1", result.hits[0].doc_id);
+    TEST_ASSERT_EQUAL_STRING("doc2", result.hits[1].doc_id);
+    TEST_ASSERT_EQUAL_STRING("doc5", result.hits[2].doc_id);
+    TEST_ASSERT_EQUAL_STRING("doc9", result.hits[3].doc_id);
+    coordinator_result_free(&result);
+
+    TEST_ASSERT_EQUAL_INT(0, coordinator_search(c, "apple", 2, &result));
+    TEST_ASSERT_EQUAL_size_t(2, result.count);
+    TEST_ASSERT_EQUAL_size_t(4, result.total);
+    coordinator_result_free(&result);
+
+    TEST_ASSERT_EQUAL_INT(0, coordinator_search(c, "missing", SIZE_MAX, &result));
+    TEST_ASSERT_EQUAL_size_t(0, result.count);
+    coordinator_result_free(&result);
+
+    coordinator_destroy(c);
+}
+
+void test_boolean_queries(void) {
+    Coordinator* c = make_coordinator(2000, 0, 0, NULL);
+    const char* red_green[] = { "red", "green" };
+
+    CoordinatorResult result;
+    TEST_ASSERT_EQUAL_INT(0, coordinator_search_bool(c, red_green, 2, SHARD_QUERY_AND, SIZE_MAX, &result));
+    TEST_ASSERT_EQUAL_size_t(2, result.count);
+    TEST_ASSERT_EQUAL_STRING("doc2", result.hits[0].doc_id);
+    TEST_ASSERT_EQUAL_STRING("doc5", result.hits[1].doc_id);
+    coordinator_result_free(&result);
+
+    TEST_ASSERT_EQUAL_INT(0, coordinator_search_bool(c, red_green, 2, SHARD_QUERY_OR, SIZE_MAX, &result));
+    const char* expected[] = { "doc1", "doc2", "doc5", "doc6", "doc9" };
+    TEST_ASSERT_EQUAL_size_t(5, result.count);
+    for (size_t i = 0; i < 5; i++) TEST_ASSERT_EQUAL_STRING(expected[i], result.hits[i].doc_id);
+    coordinator_result_free(&result);
+
+    const char* spaced[] = { "red green" };
+    TEST_ASSERT_EQUAL_INT(EINVAL, coordinator_search_bool(c, spaced, 1, SHARD_QUERY_OR, SIZE_MAX, &result));
+    coordinator_destroy(c);
+}
+
+void test_ranked_merge(void) {
+    Coordinator* c = make_coordinator(2000, 0, 0, NULL);
+    const char* terms[] = { "green", "blue" };
+
+    CoordinatorResult all;
+    TEST_ASSERT_EQUAL_INT(0, coordinator_search_ranked(c, terms, 2, 10, &all));
+    TEST_ASSERT_EQUAL_size_t(4, all.count);
+    for (size_t i = 1; i < all.count; i++) {
+        TEST_ASSERT_TRUE(all.hits[i - 1].score >= all.hits[i].score);
+    }
+
+    // The merged top 2 is the head of the full ranking
+    CoordinatorResult top;
+    TEST_ASSERT_EQUAL_INT(0, coordinator_search_ranked(c, terms, 2, 2, &top));
+    TEST_ASSERT_EQUAL_size_t(2, top.count);
+    for (size_t i = 0; i < top.count; i++) {
+        TEST_ASSERT_EQUAL_STRING(all.hits[i].doc_id, top.hits[i].doc_id);
+        TEST_ASSERT_TRUE(all.hits[i].score == top.hits[i].score);
+    }
+    coordinator_result_free(&top);
+    coordinator_result_free(&all);
+    coordinator_destroy(c);
+}
+
+void test_hedged_request(void) {
+    // The first replica never answers; the hedge goes to a healthy one
+    char spec[64];
+    snprintf(spec, sizeof(spec), "127.0.0.1:%u,127.0.0.1:%u", blackhole_port, ports[1]);
+    Coordinator* c = make_coordinator(2000, 20, 1, spec);
+
+    CoordinatorResult result;
+    TEST_ASSERT_EQUAL_INT(0, coordinator_search(c, "apple", SIZE_MAX, &result));
+    TEST_ASSERT_EQUAL_size_t(TEST_SHARDS, result.shards_ok);
+    TEST_ASSERT_EQUAL_size_t(1, result.hedged);
+    TEST_ASSERT_EQUAL_size_t(4, result.count);
+    coordinator_result_free(&result);
+    coordinator_destroy(c);
+}
+
+void test_failover_without_hedging(void) {
+    // A refused connection moves on to the replica immediately
+    char spec[64];
+    snprintf(spec, sizeof(spec), "127.0.0.1:%u,127.0.0.1:%u", refused_port, ports[2]);
+    Coordinator* c = make_coordinator(2000, 0, 2, spec);
+
+    CoordinatorResult result;
+    TEST_ASSERT_EQUAL_INT(0, coordinator_search(c, "blue", SIZE_MAX, &result));
+    TEST_ASSERT_EQUAL_size_t(0, result.shards_failed);
+    TEST_ASSERT_EQUAL_size_t(0, result.hedged);
+    TEST_ASSERT_EQUAL_size_t(1, result.count);
+    TEST_ASSERT_EQUAL_STRING("doc9", result.hits[0].doc_id);
+    coordinator_result_free(&result);
+    coordinator_destroy(c);
+}
+
+void test_shard_timeout(void) {
+    char spec[64];
+    snprintf(spec, sizeof(spec), "127.0.0.1:%u", blackhole_port);
+    Coordinator* c = make_coordinator(100, 0, 0, spec);
+
+    // The slow shard is left out and the answer is marked partial
+    CoordinatorResult result;
+    TEST_ASSERT_EQUAL_INT(0, coordinator_search(c, "apple", SIZE_MAX, &result));
+    TEST_ASSERT_EQUAL_size_t(2, result.shards_ok);
+    TEST_ASSERT_EQUAL_size_t(1, result.shards_failed);
+    TEST_ASSERT_EQUAL_size_t(2, result.count);
+    coordinator_result_free(&result);
+    coordinator_destroy(c);
+
+    const char* dead[] = { spec };
+    CoordinatorConfig cfg;
+    coordinator_config_init(&cfg);
+    cfg.timeout_ms = 50;
+    int err = 0;
+    c = coordinator_create(dead, 1, &cfg, &err);
+    TEST_ASSERT_NOT_NULL(c);
+    TEST_ASSERT_EQUAL_INT(ETIMEDOUT, coordinator_search(c, "apple", SIZE_MAX, &result));
+    TEST_ASSERT_EQUAL_size_t(0, result.count);
+    coordinator_destroy(c);
+}
+
+void test_invalid_shard_specs(void) {
+    const char* bad[] = { "127.0.0.1", "localhost:80", "127.0.0.1:0", "127.0.0.1:80,", "" };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        int err = 0;
+        TEST_ASSERT_NULL(coordinator_create(&bad[i], 1, NULL, &err));
+        TEST_ASSERT_EQUAL_INT(EINVAL, err);
+    }
+}
+
+// Send raw requests to a server without waiting for the answer
+static int send_requests(uint16_t port, const char* requests) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT_TRUE(fd >= 0);
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL_INT(0, connect(fd, (struct sockaddr*)&addr, sizeof(addr)));
+    size_t len = strlen(requests);
+    TEST_ASSERT_EQUAL_INT((int)len, (int)send(fd, requests, len, 0));
+    return fd;
+}
+
+// Read until the server closes the connection
+static void read_all(int fd, char* buf, size_t size) {
+    size_t len = 0;
+    ssize_t n;
+    while (len + 1 < size && (n = recv(fd, buf + len, size - len - 1, 0)) > 0) len += (size_t)n;
+    buf[len] = '\0';
+    close(fd);
+}
+
+static long elapsed_ms(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000 + (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+void test_coordinator_server(void) {
+    Coordinator* c = make_coordinator(2000, 0, 0, NULL);
+
+    SearchServerConfig cfg;
+    search_server_config_init(&cfg);
+    cfg.bind_addr = "127.0.0.1";
+    cfg.port = 0;
+    cfg.num_workers = 1;
+    cfg.coordinator = c;
+    int err = 0;
+    SearchServer* srv = search_server_create(NULL, &cfg, &err);
+    TEST_ASSERT_NOT_NULL(srv);
+    TEST_ASSERT_EQUAL_INT(0, search_server_start(srv));
+
+    // A second coordinator tier treats the first one as its only shard
+    char spec[32];
+    snprintf(spec, sizeof(spec), "127.0.0.1:%u", search_server_port(srv));
+    const char* front[] = { spec };
+    Coordinator* outer = coordinator_create(front, 1, NULL, &err);
+    TEST_ASSERT_NOT_NULL(outer);
+
+    CoordinatorResult result;
+    TEST_ASSERT_EQUAL_INT(0, coordinator_search(outer, "apple", SIZE_MAX, &result));
+    TEST_ASSERT_EQUAL_size_t(4, result.count);
+    TEST_ASSERT_EQUAL_size_t(4, result.total);
+    coordinator_result_free(&result);
+
+    const char* terms[] = { "green" };
+    TEST_ASSERT_EQUAL_INT(0, coordinator_search_ranked(outer, terms, 1, 3, &result));
+    TEST_ASSERT_EQUAL_size_t(3, result.count);
+    TEST_ASSERT_TRUE(result.hits[0].score > 0);
+    coordinator_result_free(&result);
+
+    // Pipelined requests are answered in order around a fan-out
+    char buf[4096];
+    int fd = send_requests(search_server_port(srv),
+                           "GET /rank?q=green HTTP/1.1\r\n\r\n"
+                           "GET /health HTTP/1.1\r\nConnection: close\r\n\r\n");
+    read_all(fd, buf, sizeof(buf));
+    char* ranked = strstr(buf, "\"results\"");
+    char* health = strstr(buf, "\"status\"");
+    TEST_ASSERT_NOT_NULL(ranked);
+    TEST_ASSERT_NOT_NULL(health);
+    TEST_ASSERT_TRUE(ranked < health);
+
+    coordinator_destroy(outer);
+    search_server_destroy(srv);
+    coordinator_destroy(c);
+}
+
+void test_fanout_does_not_block_worker(void) {
+    char spec[64];
+    snprintf(spec, sizeof(spec), "127.0.0.1:%u", blackhole_port);
+    Coordinator* c = make_coordinator(1000, 0, 0, spec);
+
+    SearchServerConfig cfg;
+    search_server_config_init(&cfg);
+    cfg.bind_addr = "127.0.0.1";
+    cfg.port = 0;
+    cfg.num_workers = 1;
+    cfg.coordinator = c;
+    int err = 0;
+    SearchServer* srv = search_server_create(NULL, &cfg, &err);
+    TEST_ASSERT_NOT_NULL(srv);
+    TEST_ASSERT_EQUAL_INT(0, search_server_start(srv));
+    uint16_t port = search_server_port(srv);
+
+    // The only worker hands the search to the fan-out pool while the silent
+    // shard runs out its deadline, and keeps answering other connections
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int slow = send_requests(port, "GET /search?q=apple HTTP/1.1\r\nConnection: close\r\n\r\n");
+    usleep(50000);
+    char buf[4096];
+    int fast = send_requests(port, "GET /health HTTP/1.1\r\nConnection: close\r\n\r\n");
+    read_all(fast, buf, sizeof(buf));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"shards\":3"));
+    TEST_ASSERT_TRUE(elapsed_ms(&start) < 500);
+
+    read_all(slow, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_INT(0, strncmp(buf, "HTTP/1.1 200", 12));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"shards_failed\":1"));
+    TEST_ASSERT_TRUE(elapsed_ms(&start) >= 1000);
+
+    search_server_destroy(srv);
+    coordinator_destroy(c);
+}
+
+int main(void) {
+    signal(SIGPIPE, SIG_IGN);
+    start_shards();
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_search_merges_shards);
+    RUN_TEST(test_boolean_queries);
+    RUN_TEST(test_ranked_merge);
+    RUN_TEST(test_hedged_request);
+    RUN_TEST(test_failover_without_hedging);
+    RUN_TEST(test_shard_timeout);
+    RUN_TEST(test_invalid_shard_specs);
+    RUN_TEST(test_coordinator_server);
+    RUN_TEST(test_fanout_does_not_block_worker);
+
+    int failures = UNITY_END();
+    stop_shards();
+    return failures;
+}
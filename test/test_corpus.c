@@ -0,0 +1,160 @@
+#include "../include/corpus.h"
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+
+static CorpusConfig cfg;
+
+void setUp(void) {
+    corpus_config_init(&cfg);
+    cfg.num_keys = 500;
+    cfg.num_docs = 50;
+    cfg.num_postings = 5000;
+}
+
+void tearDown(void) {
+}
+
+static size_t utf8_codepoints(const char* s) {
+    size_t n = 0;
+    for (; *s; s++) n += ((unsigned char)*s & 0xC0) != 0x80;
+    return n;
+}
+
+void test_deterministic_per_seed(void) {
+    int err = -1;
+    Corpus* a = corpus_generate(&cfg, &err);
+    Corpus* b = corpus_generate(&cfg, &err);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_EQUAL_INT(0, err);
+    for (size_t k = 0; k < cfg.num_keys; k++) TEST_ASSERT_EQUAL_STRING(a->keys[k], b->keys[k]);
+    TEST_ASSERT_EQUAL_MEMORY(a->key_of, b->key_of, cfg.num_postings * sizeof(uint32_t));
+    TEST_ASSERT_EQUAL_MEMORY(a->doc_of, b->doc_of, cfg.num_postings * sizeof(uint32_t));
+    corpus_destroy(b);
+
+    cfg.seed++;
+    b = corpus_generate(&cfg, &err);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_TRUE(memcmp(a->key_of, b->key_of, cfg.num_postings * sizeof(uint32_t)) != 0);
+    corpus_destroy(a);
+    corpus_destroy(b);
+}
+
+void test_keys_distinct_and_sized(void) {
+    cfg.min_key_len = 3;
+    cfg.max_key_len = 6;
+    cfg.utf8_ratio = 0.5;
+    Corpus* corpus = corpus_generate(&cfg, NULL);
+    TEST_ASSERT_NOT_NULL(corpus);
+
+    size_t non_ascii = 0, codepoints = 0, bytes = 0;
+    for (size_t k = 0; k < corpus->num_keys; k++) {
+        const char* key = corpus->keys[k];
+        size_t len = utf8_codepoints(key);
+        TEST_ASSERT_TRUE(len >= 3 && len <= 6);
+        TEST_ASSERT_NULL(strchr(key, ':'));
+        codepoints += len;
+        bytes += strlen(key);
+        for (const char* p = key; *p; p++) non_ascii += ((unsigned char)*p & 0xC0) == 0xC0;
+        for (size_t j = 0; j < k; j++) TEST_ASSERT_TRUE(strcmp(key, corpus->keys[j]) != 0);
+    }
+    TEST_ASSERT_EQUAL_size_t(bytes, corpus->key_bytes);
+    // Roughly half the codepoints are multi-byte
+    TEST_ASSERT_TRUE(non_ascii > codepoints * 4 / 10 && non_ascii < codepoints * 6 / 10);
+    corpus_destroy(corpus);
+
+    cfg.utf8_ratio = 0;
+    corpus = corpus_generate(&cfg, NULL);
+    TEST_ASSERT_NOT_NULL(corpus);
+    for (size_t k = 0; k < corpus->num_keys; k++) {
+        TEST_ASSERT_EQUAL_size_t(strlen(corpus->keys[k]), utf8_codepoints(corpus->keys[k]));
+    }
+    corpus_destroy(corpus);
+}
+
+void test_zipf_skew(void) {
+    Corpus* corpus = corpus_generate(&cfg, NULL);
+    TEST_ASSERT_NOT_NULL(corpus);
+    size_t* freq = calloc(cfg.num_keys, sizeof(size_t));
+    for (size_t p = 0; p < cfg.num_postings; p++) {
+        TEST_ASSERT_TRUE(corpus->key_of[p] < cfg.num_keys);
+        TEST_ASSERT_TRUE(corpus->doc_of[p] < cfg.num_docs);
+        freq[corpus->key_of[p]]++;
+    }
+    // With s = 1 over 500 keys the first key takes about 15% of postings
+    TEST_ASSERT_TRUE(freq[0] > cfg.num_postings / 10);
+    TEST_ASSERT_TRUE(freq[0] > 5 * freq[10]);
+    free(freq);
+    corpus_destroy(corpus);
+
+    // Skew 0 is uniform
+    cfg.key_skew = 0;
+    corpus = corpus_generate(&cfg, NULL);
+    TEST_ASSERT_NOT_NULL(corpus);
+    size_t first = 0;
+    for (size_t p = 0; p < cfg.num_postings; p++) first += corpus->key_of[p] == 0;
+    TEST_ASSERT_TRUE(first < cfg.num_postings / 100);
+    corpus_destroy(corpus);
+}
+
+void test_write(void) {
+    cfg.num_postings = 3;
+    Corpus* corpus = corpus_generate(&cfg, NULL);
+    TEST_ASSERT_NOT_NULL(corpus);
+    FILE* fp = tmpfile();
+    TEST_ASSERT_NOT_NULL(fp);
+    TEST_ASSERT_EQUAL_INT(0, corpus_write(corpus, fp));
+    rewind(fp);
+
+    char line[256];
+    for (size_t p = 0; p < 3; p++) {
+        char expected[256];
+        snprintf(expected, sizeof(expected), "%s:%s\n", corpus->keys[corpus->key_of[p]],
+                 corpus->docs[corpus->doc_of[p]]);
+        TEST_ASSERT_NOT_NULL(fgets(line, sizeof(line), fp));
+        TEST_ASSERT_EQUAL_STRING(expected, line);
+    }
+    TEST_ASSERT_NULL(fgets(line, sizeof(line), fp));
+    fclose(fp);
+    corpus_destroy(corpus);
+
+    TEST_ASSERT_EQUAL_INT(EINVAL, corpus_write(NULL, stdout));
+}
+
+void test_invalid_config(void) {
+    int err = 0;
+    cfg.min_key_len = 5;
+    cfg.max_key_len = 4;
+    TEST_ASSERT_NULL(corpus_generate(&cfg, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+
+    setUp();
+    cfg.utf8_ratio = 1.5;
+    TEST_ASSERT_NULL(corpus_generate(&cfg, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+
+    // 36 one-character ASCII keys cannot fill a vocabulary of 500
+    setUp();
+    cfg.min_key_len = cfg.max_key_len = 1;
+    cfg.utf8_ratio = 0;
+    err = 0;
+    TEST_ASSERT_NULL(corpus_generate(&cfg, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+
+    TEST_ASSERT_NULL(corpus_generate(NULL, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_deterministic_per_seed);
+    RUN_TEST(test_keys_distinct_and_sized);
+    RUN_TEST(test_zipf_skew);
+    RUN_TEST(test_write);
+    RUN_TEST(test_invalid_config);
+
+    return UNITY_END();
+}
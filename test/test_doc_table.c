@@ -0,0 +1,75 @@
+#include "../include/doc_table.h"
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_add_find(void) {
+    int err = 0;
+    DocTable* table = doc_table_create(&err);
+    TEST_ASSERT_EQUAL_INT(0, err);
+    TEST_ASSERT_NOT_NULL(table);
+
+    uint32_t a = 0, b = 0, again = 0;
+    TEST_ASSERT_EQUAL_INT(0, doc_table_add(table, "doc1", 3, &a));
+    TEST_ASSERT_EQUAL_INT(0, doc_table_add(table, "doc2", 1, &b));
+    TEST_ASSERT_EQUAL_INT(0, doc_table_add(table, "doc1", 2, &again));
+    TEST_ASSERT_EQUAL_UINT32(a, again);
+    TEST_ASSERT_NOT_EQUAL(a, b);
+
+    TEST_ASSERT_EQUAL_size_t(2, doc_table_count(table));
+    TEST_ASSERT_EQUAL_UINT32(5, doc_table_length(table, a));
+    TEST_ASSERT_EQUAL_UINT32(1, doc_table_length(table, b));
+    TEST_ASSERT_EQUAL_UINT64(6, doc_table_total_length(table));
+    TEST_ASSERT_EQUAL_STRING("doc2", doc_table_id(table, b));
+
+    uint32_t found = 0;
+    TEST_ASSERT_EQUAL_INT(0, doc_table_find(table, "doc2", &found));
+    TEST_ASSERT_EQUAL_UINT32(b, found);
+    TEST_ASSERT_EQUAL_INT(ENOENT, doc_table_find(table, "doc3", &found));
+    TEST_ASSERT_NULL(doc_table_id(table, 99));
+    TEST_ASSERT_EQUAL_INT(EINVAL, doc_table_add(table, NULL, 1, &found));
+
+    doc_table_destroy(table);
+}
+
+void test_growth(void) {
+    int err = 0;
+    DocTable* table = doc_table_create(&err);
+    TEST_ASSERT_NOT_NULL(table);
+
+    // Ordinals are dense and stable across rehashing
+    char id[32];
+    for (uint32_t i = 0; i < 10000; i++) {
+        snprintf(id, sizeof(id), "doc%u", i);
+        uint32_t ord = 0;
+        TEST_ASSERT_EQUAL_INT(0, doc_table_add(table, id, 1, &ord));
+        TEST_ASSERT_EQUAL_UINT32(i, ord);
+    }
+    for (uint32_t i = 0; i < 10000; i += 97) {
+        snprintf(id, sizeof(id), "doc%u", i);
+        uint32_t ord = 0;
+        TEST_ASSERT_EQUAL_INT(0, doc_table_find(table, id, &ord));
+        TEST_ASSERT_EQUAL_UINT32(i, ord);
+        TEST_ASSERT_EQUAL_STRING(id, doc_table_id(table, ord));
+    }
+    TEST_ASSERT_EQUAL_size_t(10000, doc_table_count(table));
+
+    doc_table_destroy(table);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_add_find);
+    RUN_TEST(test_growth);
+
+    return UNITY_END();
+}
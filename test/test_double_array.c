@@ -0,0 +1,316 @@
+#include "../include/double_array.h"
+#include "../include/gtrie_io.h"
+#include "../include/logging.h"
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <errno.h>
+
+#define DA_TEST_FILE "./Testing/Temporary/test_double_array.da"
+#define DA_TEST_TRIE "./Testing/Temporary/test_double_array.trie"
+
+// 63 bytes, then a 2-byte character across the 64-byte lookup chunk
+#define LONG_KEY "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx" \
+                 "\xC3\xA9" "yyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyy" "z"
+
+static const char* keys[] = {
+    "hello", "help", "helping", "world", "a", "test",
+    "caf\xC3\xA9", "\xE4\xB8\xAD\xE6\x96\x87", "\xF0\x9F\x8D\xA3", LONG_KEY,
+};
+
+static GTrie* create_test_trie(void) {
+    int err = 0;
+    GTrie* trie = gtrie_create(&err);
+    TEST_ASSERT_NOT_NULL(trie);
+
+    char doc[32];
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        for (size_t d = 0; d <= i % 3; d++) {
+            snprintf(doc, sizeof(doc), "doc%zu", (i + d) % 5);
+            TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, keys[i], doc));
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, "hello", "doc0"));  // tf 2
+    return trie;
+}
+
+// The double array must return what the trie returns, entry for entry
+static void assert_same(const GTrie* trie, const DoubleArray* da, const char* key) {
+    int trie_err = 0, da_err = 0;
+    const PostingList* expected = gtrie_search(trie, key, &trie_err);
+    const PostingList* actual = double_array_search(da, key, &da_err);
+    if (!expected) {
+        TEST_ASSERT_NULL(actual);
+        TEST_ASSERT_EQUAL_INT(trie_err, da_err);
+        return;
+    }
+    TEST_ASSERT_NOT_NULL(actual);
+    TEST_ASSERT_EQUAL_INT(0, da_err);
+    TEST_ASSERT_EQUAL_size_t(expected->count, actual->count);
+    const PostingEntry* e = expected->head;
+    const PostingEntry* a = actual->head;
+    for (; e && a; e = e->next, a = a->next) {
+        TEST_ASSERT_EQUAL_STRING(e->doc_id, a->doc_id);
+        TEST_ASSERT_EQUAL_UINT32(e->doc, a->doc);
+        TEST_ASSERT_EQUAL_UINT32(e->tf, a->tf);
+    }
+    TEST_ASSERT_NULL(e);
+    TEST_ASSERT_NULL(a);
+}
+
+void setUp(void) {
+    log_init("test_double_array", LOG_LEVEL_ERROR, LOG_DEST_STDERR);
+}
+
+void tearDown(void) {
+    unlink(DA_TEST_FILE);
+    unlink(DA_TEST_TRIE);
+    log_cleanup();
+}
+
+void test_build_matches_trie(void) {
+    GTrie* trie = create_test_trie();
+    int err = -1;
+    DoubleArray* da = double_array_build(trie, &err);
+    TEST_ASSERT_NOT_NULL(da);
+    TEST_ASSERT_EQUAL_INT(0, err);
+
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        assert_same(trie, da, keys[i]);
+    }
+    // '-' shares a slot with 'a', so the trie and the array both find "a"
+    assert_same(trie, da, "-");
+    assert_same(trie, da, "hel");
+    assert_same(trie, da, "helpings");
+    assert_same(trie, da, "zzz");
+    assert_same(trie, da, "");
+
+    TEST_ASSERT_EQUAL_size_t(trie->total_words, double_array_key_count(da));
+    TEST_ASSERT_EQUAL_size_t(trie->doc_count, double_array_posting_count(da));
+    TEST_ASSERT_GREATER_THAN(trie->node_count, double_array_cell_count(da));
+
+    double_array_destroy(da);
+    gtrie_destroy(trie);
+}
+
+void test_search_errors(void) {
+    GTrie* trie = create_test_trie();
+    DoubleArray* da = double_array_build(trie, NULL);
+    TEST_ASSERT_NOT_NULL(da);
+
+    int err = 0;
+    TEST_ASSERT_NULL(double_array_search(da, "zzz", &err));
+    TEST_ASSERT_EQUAL_INT(ENOENT, err);
+    TEST_ASSERT_NULL(double_array_search(da, "hel", &err));
+    TEST_ASSERT_EQUAL_INT(ENOENT, err);
+    TEST_ASSERT_NULL(double_array_search(da, "caf\xC3", &err));  // Truncated
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+    TEST_ASSERT_NULL(double_array_search(da, "\xC0\x80", &err));  // Overlong
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+    TEST_ASSERT_NULL(double_array_search(da, NULL, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+    TEST_ASSERT_NULL(double_array_search(NULL, "hello", &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+    TEST_ASSERT_NOT_NULL(double_array_search(da, "hello", NULL));
+
+    TEST_ASSERT_NULL(double_array_build(NULL, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+
+    double_array_destroy(da);
+    double_array_destroy(NULL);
+    gtrie_destroy(trie);
+}
+
+void test_empty_trie(void) {
+    int err = 0;
+    GTrie* trie = gtrie_create(&err);
+    DoubleArray* da = double_array_build(trie, &err);
+    TEST_ASSERT_NOT_NULL(da);
+    TEST_ASSERT_EQUAL_size_t(0, double_array_key_count(da));
+    TEST_ASSERT_NULL(double_array_search(da, "a", &err));
+    TEST_ASSERT_EQUAL_INT(ENOENT, err);
+
+    TEST_ASSERT_EQUAL_INT(0, double_array_save(da, DA_TEST_FILE));
+    DoubleArray* loaded = double_array_load(DA_TEST_FILE, &err);
+    TEST_ASSERT_NOT_NULL(loaded);
+    TEST_ASSERT_NULL(double_array_search(loaded, "", &err));
+    TEST_ASSERT_EQUAL_INT(ENOENT, err);
+
+    double_array_destroy(loaded);
+    double_array_destroy(da);
+    gtrie_destroy(trie);
+}
+
+void test_many_keys(void) {
+    // Enough keys with shared prefixes to exercise relocation of bases
+    int err = 0;
+    GTrie* trie = gtrie_create(&err);
+    char key[16];
+    unsigned state = 12345;
+    for (int i = 0; i < 5000; i++) {
+        int len = 1 + i % 8;
+        for (int c = 0; c < len; c++) {
+            state = state * 1103515245 + 12345;
+            key[c] = (char)('a' + (state >> 16) % (c == 0 ? 26 : 4 + i % 23));
+        }
+        key[len] = '\0';
+        TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, key, i % 2 ? "odd" : "even"));
+    }
+
+    DoubleArray* da = double_array_build(trie, &err);
+    TEST_ASSERT_NOT_NULL(da);
+    state = 12345;
+    for (int i = 0; i < 5000; i++) {
+        int len = 1 + i % 8;
+        for (int c = 0; c < len; c++) {
+            state = state * 1103515245 + 12345;
+            key[c] = (char)('a' + (state >> 16) % (c == 0 ? 26 : 4 + i % 23));
+        }
+        key[len] = '\0';
+        assert_same(trie, da, key);
+        key[len - 1] = 'z';  // Mostly misses
+        assert_same(trie, da, key);
+    }
+
+    double_array_destroy(da);
+    gtrie_destroy(trie);
+}
+
+void test_save_load_round_trip(void) {
+    GTrie* trie = create_test_trie();
+    int err = 0;
+    DoubleArray* da = double_array_build(trie, &err);
+    TEST_ASSERT_EQUAL_INT(0, double_array_save(da, DA_TEST_FILE));
+    TEST_ASSERT_TRUE(double_array_detect(DA_TEST_FILE));
+
+    DoubleArray* loaded = double_array_load(DA_TEST_FILE, &err);
+    TEST_ASSERT_NOT_NULL(loaded);
+    TEST_ASSERT_EQUAL_INT(0, err);
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        assert_same(trie, loaded, keys[i]);
+    }
+    assert_same(trie, loaded, "zzz");
+    TEST_ASSERT_EQUAL_size_t(double_array_cell_count(da), double_array_cell_count(loaded));
+    TEST_ASSERT_EQUAL_size_t(trie->total_words, double_array_key_count(loaded));
+
+    // GTrie files are told apart by their magic
+    TEST_ASSERT_EQUAL_INT(0, gtrie_save(trie, DA_TEST_TRIE, NULL, NULL));
+    TEST_ASSERT_FALSE(double_array_detect(DA_TEST_TRIE));
+    TEST_ASSERT_NULL(double_array_load(DA_TEST_TRIE, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+    TEST_ASSERT_FALSE(double_array_detect("./Testing/Temporary/missing.da"));
+    TEST_ASSERT_NULL(double_array_load("./Testing/Temporary/missing.da", &err));
+    TEST_ASSERT_EQUAL_INT(ENOENT, err);
+
+    double_array_destroy(loaded);
+    double_array_destroy(da);
+    gtrie_destroy(trie);
+}
+
+// Write a copy of the saved file with size bytes, optionally overwriting one word
+static void write_damaged(const char* data, size_t size, long offset, uint32_t value) {
+    FILE* fp = fopen(DA_TEST_FILE, "wb");
+    TEST_ASSERT_NOT_NULL(fp);
+    TEST_ASSERT_EQUAL_size_t(size, fwrite(data, 1, size, fp));
+    if (offset >= 0) {
+        fseek(fp, offset, SEEK_SET);
+        fwrite(&value, sizeof(value), 1, fp);
+    }
+    fclose(fp);
+}
+
+void test_load_rejects_damaged_files(void) {
+    GTrie* trie = create_test_trie();
+    int err = 0;
+    DoubleArray* da = double_array_build(trie, &err);
+    TEST_ASSERT_EQUAL_INT(0, double_array_save(da, DA_TEST_FILE));
+    double_array_destroy(da);
+    gtrie_destroy(trie);
+
+    FILE* fp = fopen(DA_TEST_FILE, "rb");
+    TEST_ASSERT_NOT_NULL(fp);
+    fseek(fp, 0, SEEK_END);
+    size_t size = (size_t)ftell(fp);
+    rewind(fp);
+    char* data = malloc(size);
+    TEST_ASSERT_EQUAL_size_t(size, fread(data, 1, size, fp));
+    fclose(fp);
+
+    // Truncated in the header, in the cells, and by one byte
+    size_t cuts[] = { 8, 100, size - 1 };
+    for (size_t i = 0; i < sizeof(cuts) / sizeof(cuts[0]); i++) {
+        write_damaged(data, cuts[i], -1, 0);
+        TEST_ASSERT_NULL(double_array_load(DA_TEST_FILE, &err));
+        TEST_ASSERT_EQUAL_INT(EINVAL, err);
+    }
+
+    // Header is 72 bytes; the root cell (1) follows cell 0
+    long root_base = 72 + 8;
+    long root_check = 72 + 12;
+    write_damaged(data, size, 4, 99);                       // Version
+    TEST_ASSERT_NULL(double_array_load(DA_TEST_FILE, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+    write_damaged(data, size, root_base, 0xFFFFFFF0u);      // Base past the end
+    TEST_ASSERT_NULL(double_array_load(DA_TEST_FILE, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+    write_damaged(data, size, root_check, 0xFFFFFFF0u);     // Check past the end
+    TEST_ASSERT_NULL(double_array_load(DA_TEST_FILE, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+    write_damaged(data, size, 0, 0);                        // Magic
+    TEST_ASSERT_FALSE(double_array_detect(DA_TEST_FILE));
+    TEST_ASSERT_NULL(double_array_load(DA_TEST_FILE, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+
+    // Trailing garbage
+    char* longer = calloc(1, size + 8);
+    memcpy(longer, data, size);
+    write_damaged(longer, size + 8, -1, 0);
+    TEST_ASSERT_NULL(double_array_load(DA_TEST_FILE, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+    free(longer);
+
+    // Undamaged, it still loads
+    write_damaged(data, size, -1, 0);
+    DoubleArray* loaded = double_array_load(DA_TEST_FILE, &err);
+    TEST_ASSERT_NOT_NULL(loaded);
+    double_array_destroy(loaded);
+    free(data);
+}
+
+// Smallest well-formed layout around a doc_bytes that wraps when padded to 8:
+// 28 empty cells, no keys or postings, two documents
+void test_load_rejects_wrapping_doc_bytes(void) {
+    uint64_t header[9] = {
+        0x0000000141445254ULL,          // Magic "TRDA", version 1
+        0, 28, 0, 0, 2,                 // timestamp, cells, keys, postings, docs
+        0xFFFFFFFFFFFFFFF9ULL,          // doc_bytes
+        0, 0
+    };
+    char image[72 + 28 * 8 + 28 * 4 + 8 + 3 * 8];
+    memset(image, 0, sizeof(image));
+    memcpy(image, header, sizeof(header));
+    memset(image + 72 + 28 * 8, 0xFF, 28 * 4);      // No key ends anywhere
+    uint64_t doc_offsets[3] = { 0, 0x40000000, header[6] };
+    memcpy(image + sizeof(image) - sizeof(doc_offsets), doc_offsets, sizeof(doc_offsets));
+    write_damaged(image, sizeof(image), -1, 0);
+
+    int err = 0;
+    TEST_ASSERT_NULL(double_array_load(DA_TEST_FILE, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_build_matches_trie);
+    RUN_TEST(test_search_errors);
+    RUN_TEST(test_empty_trie);
+    RUN_TEST(test_many_keys);
+    RUN_TEST(test_save_load_round_trip);
+    RUN_TEST(test_load_rejects_damaged_files);
+    RUN_TEST(test_load_rejects_wrapping_doc_bytes);
+
+    return UNITY_END();
+}
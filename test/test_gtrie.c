@@ -2,6 +2,7 @@
 #include "unity.h"
 #include <string.h>
 #include <stdlib.h>
+#include <stdio.h>
 
 void setUp(void) {
 }
@@ -285,11 +286,302 @@ void test_utf8_support(void) {
     // Test invalid UTF-8 sequence
     int rc = gtrie_insert(trie, "\xFF\xFF", "invalid");  // Invalid UTF-8
     TEST_ASSERT_EQUAL_INT(EINVAL, rc);
+    rc = gtrie_insert(trie, "caf\xC3", "truncated");  // Cut-off sequence
+    TEST_ASSERT_EQUAL_INT(EINVAL, rc);
+    rc = gtrie_insert(trie, "\xC0\xAF", "overlong");  // Overlong '/'
+    TEST_ASSERT_EQUAL_INT(EINVAL, rc);
+    rc = gtrie_insert(trie, "\xED\xA0\x80", "surrogate");
+    TEST_ASSERT_EQUAL_INT(EINVAL, rc);
+    PostingList* truncated = gtrie_search(trie, "\xE4\xB8", &err);
+    TEST_ASSERT_NULL(truncated);
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
 
     rc = gtrie_destroy(trie);
     TEST_ASSERT_EQUAL_INT(0, rc);
 }
 
+void test_search_many(void) {
+    int err = 0;
+    GTrie* trie = gtrie_create(&err);
+    TEST_ASSERT_EQUAL_INT(0, err);
+
+    const char* inserted[] = {"car", "cart", "carton", "care", "dog", "café", ""};
+    const int num_inserted = sizeof(inserted) / sizeof(inserted[0]);
+    for (int i = 0; i < num_inserted; i++) {
+        TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, inserted[i], inserted[i][0] ? inserted[i] : "empty"));
+    }
+
+    // Unsorted input with duplicates, misses, a bare prefix and invalid UTF-8
+    const char* keys[] = {"carton", "dog", "ca", "car", "cats", "care", "carton", "café", "\xFF", "", NULL};
+    const int num_keys = sizeof(keys) / sizeof(keys[0]);
+    PostingList* postings[sizeof(keys) / sizeof(keys[0])];
+    int errs[sizeof(keys) / sizeof(keys[0])];
+
+    TEST_ASSERT_EQUAL_INT(0, gtrie_search_many(trie, keys, num_keys, postings, errs));
+
+    // Every key must agree with a single gtrie_search
+    for (int i = 0; i < num_keys; i++) {
+        if (!keys[i]) {
+            TEST_ASSERT_EQUAL_INT(EINVAL, errs[i]);
+            TEST_ASSERT_NULL(postings[i]);
+            continue;
+        }
+        int single_err = 0;
+        PostingList* single = gtrie_search(trie, keys[i], &single_err);
+        TEST_ASSERT_TRUE(single == postings[i]);
+        if (single) {
+            TEST_ASSERT_EQUAL_INT(0, errs[i]);
+        } else {
+            TEST_ASSERT_NOT_EQUAL(0, errs[i]);
+        }
+    }
+
+    TEST_ASSERT_EQUAL_STRING("carton", postings[0]->head->doc_id);
+    TEST_ASSERT_EQUAL_STRING("dog", postings[1]->head->doc_id);
+    TEST_ASSERT_EQUAL_INT(ENOENT, errs[2]);
+    TEST_ASSERT_EQUAL_INT(ENOENT, errs[4]);
+    TEST_ASSERT_EQUAL_STRING("café", postings[7]->head->doc_id);
+    TEST_ASSERT_EQUAL_INT(EINVAL, errs[8]);
+    TEST_ASSERT_EQUAL_STRING("empty", postings[9]->head->doc_id);
+
+    // Argument checks
+    TEST_ASSERT_EQUAL_INT(0, gtrie_search_many(trie, NULL, 0, NULL, NULL));
+    TEST_ASSERT_EQUAL_INT(EINVAL, gtrie_search_many(NULL, keys, 1, postings, errs));
+    TEST_ASSERT_EQUAL_INT(EINVAL, gtrie_search_many(trie, keys, 1, NULL, errs));
+
+    TEST_ASSERT_EQUAL_INT(0, gtrie_destroy(trie));
+}
+
+// Reference Levenshtein distance for short ASCII keys
+static int reference_distance(const char* a, const char* b) {
+    size_t n = strlen(a), m = strlen(b);
+    int prev[64], cur[64];
+    for (size_t j = 0; j <= m; j++) prev[j] = (int)j;
+    for (size_t i = 1; i <= n; i++) {
+        cur[0] = (int)i;
+        for (size_t j = 1; j <= m; j++) {
+            int v = prev[j - 1] + (a[i - 1] != b[j - 1]);
+            if (prev[j] + 1 < v) v = prev[j] + 1;
+            if (cur[j - 1] + 1 < v) v = cur[j - 1] + 1;
+            cur[j] = v;
+        }
+        memcpy(prev, cur, sizeof(prev));
+    }
+    return prev[m];
+}
+
+void test_fuzzy_search(void) {
+    int err = 0;
+    GTrie* trie = gtrie_create(&err);
+    TEST_ASSERT_EQUAL_INT(0, err);
+
+    const char* words[] = {"laptop", "laptops", "lapdog", "desktop", "tablet", "table",
+                           "cable", "label", "upple", "apple", "apples", "ample"};
+    const int num_words = sizeof(words) / sizeof(words[0]);
+    for (int i = 0; i < num_words; i++) {
+        TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, words[i], "doc1"));
+    }
+    gtrie_insert(trie, "apple", "doc2");
+
+    FuzzyMatch matches[16];
+    size_t count = 0;
+
+    // Exact match only
+    TEST_ASSERT_EQUAL_INT(0, gtrie_fuzzy_search(trie, "laptop", 0, matches, 16, &count));
+    TEST_ASSERT_EQUAL_size_t(1, count);
+    TEST_ASSERT_EQUAL_STRING("laptop", matches[0].word);
+    TEST_ASSERT_EQUAL_INT(0, matches[0].distance);
+
+    // Misspelling: substitution, insertion and deletion all within one edit
+    TEST_ASSERT_EQUAL_INT(0, gtrie_fuzzy_search(trie, "laptip", 1, matches, 16, &count));
+    TEST_ASSERT_EQUAL_size_t(1, count);
+    TEST_ASSERT_EQUAL_STRING("laptop", matches[0].word);
+    TEST_ASSERT_EQUAL_INT(1, matches[0].distance);
+
+    // Ranked by distance, then by posting count
+    TEST_ASSERT_EQUAL_INT(0, gtrie_fuzzy_search(trie, "appel", 2, matches, 16, &count));
+    TEST_ASSERT_EQUAL_STRING("apple", matches[0].word);
+    TEST_ASSERT_EQUAL_INT(2, matches[0].distance);
+    for (size_t i = 1; i < count; i++) {
+        TEST_ASSERT_TRUE(matches[i - 1].distance <= matches[i].distance);
+    }
+
+    // Every result set must agree with a brute-force scan
+    const char* queries[] = {"labtop", "tabel", "aple", "desk", "xyz", "apple"};
+    for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); q++) {
+        for (int edits = 0; edits <= 2; edits++) {
+            int rc = gtrie_fuzzy_search(trie, queries[q], edits, matches, 16, &count);
+            size_t expected = 0;
+            for (int i = 0; i < num_words; i++) {
+                if (reference_distance(queries[q], words[i]) <= edits) expected++;
+            }
+            TEST_ASSERT_EQUAL_INT(expected ? 0 : ENOENT, rc);
+            TEST_ASSERT_EQUAL_size_t(expected, count);
+            for (size_t i = 0; i < count; i++) {
+                TEST_ASSERT_EQUAL_INT(reference_distance(queries[q], matches[i].word), matches[i].distance);
+            }
+        }
+    }
+
+    // 'A' and 'u' share a child slot; the stored key tells them apart
+    TEST_ASSERT_EQUAL_INT(ENOENT, gtrie_fuzzy_search(trie, "Apple", 0, matches, 16, &count));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_fuzzy_search(trie, "Apple", 1, matches, 16, &count));
+    TEST_ASSERT_EQUAL_STRING("apple", matches[0].word);
+
+    // A small result buffer keeps the best matches
+    TEST_ASSERT_EQUAL_INT(0, gtrie_fuzzy_search(trie, "apple", 2, matches, 2, &count));
+    TEST_ASSERT_EQUAL_size_t(2, count);
+    TEST_ASSERT_EQUAL_STRING("apple", matches[0].word);
+    TEST_ASSERT_EQUAL_INT(1, matches[1].distance);
+
+    // Argument checks
+    TEST_ASSERT_EQUAL_INT(EINVAL, gtrie_fuzzy_search(NULL, "apple", 1, matches, 16, &count));
+    TEST_ASSERT_EQUAL_INT(EINVAL, gtrie_fuzzy_search(trie, "apple", GTRIE_MAX_EDITS + 1, matches, 16, &count));
+    TEST_ASSERT_EQUAL_INT(EINVAL, gtrie_fuzzy_search(trie, "apple", 1, NULL, 16, &count));
+    TEST_ASSERT_EQUAL_INT(EINVAL, gtrie_fuzzy_search(trie, "\xFF", 1, matches, 16, &count));
+
+    TEST_ASSERT_EQUAL_INT(0, gtrie_destroy(trie));
+}
+
+void test_complete(void) {
+    int err = 0;
+    GTrie* trie = gtrie_create(&err);
+    TEST_ASSERT_EQUAL_INT(0, err);
+
+    // Pseudo-random weights over keys sharing short prefixes
+    char key[16];
+    uint32_t weights[500];
+    uint32_t state = 7;
+    for (int i = 0; i < 500; i++) {
+        snprintf(key, sizeof(key), "%c%c%d", 'a' + i % 3, 'a' + i % 7, i);
+        TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, key, "doc"));
+        state = state * 1103515245u + 12345u;
+        weights[i] = (state >> 16) % 10000;
+        TEST_ASSERT_EQUAL_INT(0, gtrie_set_weight(trie, key, weights[i]));
+    }
+
+    // Completions come back heaviest first and match a full scan
+    Completion out[10];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(0, gtrie_complete(trie, "a", out, 10, &count));
+    TEST_ASSERT_EQUAL_size_t(10, count);
+    uint32_t heavier = 0;
+    for (int i = 0; i < 500; i++) {
+        if (i % 3 == 0 && weights[i] > out[9].weight) heavier++;
+    }
+    TEST_ASSERT_LESS_THAN(10, heavier);
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_INT('a', out[i].word[0]);
+        if (i > 0) TEST_ASSERT_TRUE(out[i - 1].weight >= out[i].weight);
+    }
+
+    // Lowering the heaviest key's weight updates the subtree maxima
+    const char* top = out[0].word;
+    uint32_t second = out[1].weight;
+    TEST_ASSERT_EQUAL_INT(0, gtrie_set_weight(trie, top, 0));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_complete(trie, "a", out, 1, &count));
+    TEST_ASSERT_EQUAL_UINT32(second, out[0].weight);
+
+    // Exact key as prefix, slot collisions and misses
+    gtrie_insert(trie, "upple", "doc");
+    gtrie_set_weight(trie, "upple", 100000);
+    TEST_ASSERT_EQUAL_INT(0, gtrie_complete(trie, "upple", out, 10, &count));
+    TEST_ASSERT_EQUAL_size_t(1, count);
+    TEST_ASSERT_EQUAL_STRING("upple", out[0].word);
+    TEST_ASSERT_EQUAL_INT(ENOENT, gtrie_complete(trie, "A", out, 10, &count));
+    TEST_ASSERT_EQUAL_INT(ENOENT, gtrie_complete(trie, "zzz", out, 10, &count));
+    TEST_ASSERT_EQUAL_INT(ENOENT, gtrie_set_weight(trie, "zzz", 1));
+    TEST_ASSERT_EQUAL_INT(EINVAL, gtrie_complete(trie, "a", out, 0, &count));
+
+    // Unranked prefix enumeration
+    size_t n = 0;
+    char** words = gtrie_prefix_search(trie, "b", &n, &err);
+    TEST_ASSERT_EQUAL_INT(0, err);
+    TEST_ASSERT_EQUAL_size_t(167, n);
+    for (size_t i = 0; i < n; i++) {
+        TEST_ASSERT_EQUAL_INT('b', words[i][0]);
+    }
+    free(words);
+    TEST_ASSERT_NULL(gtrie_prefix_search(trie, "A", &n, &err));
+    TEST_ASSERT_EQUAL_INT(ENOENT, err);
+
+    TEST_ASSERT_EQUAL_INT(0, gtrie_destroy(trie));
+}
+
+// Count the nodes under node that lie in [first, first + count)
+static size_t count_nodes_within(const TrieNode* node, const TrieNode* first, size_t count) {
+    size_t inside = node >= first && node < first + count;
+    for (int i = 0; i < ALPHABET_SIZE; i++) {
+        if (node->children[i]) inside += count_nodes_within(node->children[i], first, count);
+    }
+    return inside;
+}
+
+void test_freeze(void) {
+    int err = 0;
+    GTrie* trie = gtrie_create(&err);
+    TEST_ASSERT_NOT_NULL(trie);
+
+    // Enough nodes to spill past the breadth-first top levels
+    enum { KEYS = 3000 };
+    char keys[KEYS][24];
+    PostingList* before[KEYS];
+    for (int i = 0; i < KEYS; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "%s%x", (i % 5) ? "k" : "ключ", (unsigned)(i * 2654435761u));
+        TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, keys[i], (i % 2) ? "doc1" : "doc2"));
+    }
+    for (int i = 0; i < KEYS; i++) {
+        before[i] = gtrie_search(trie, keys[i], &err);
+        TEST_ASSERT_NOT_NULL(before[i]);
+    }
+    size_t nodes = trie->node_count;
+    size_t words = trie->total_words;
+
+    TEST_ASSERT_EQUAL_INT(0, gtrie_freeze(trie));
+    TEST_ASSERT_TRUE(trie->frozen);
+    TEST_ASSERT_EQUAL_INT(0, gtrie_freeze(trie));  // Already frozen
+    TEST_ASSERT_EQUAL_size_t(nodes, trie->node_count);
+    TEST_ASSERT_EQUAL_size_t(words, trie->total_words);
+
+    // Every node sits in one block starting at the root, its children next
+    TEST_ASSERT_EQUAL_size_t(nodes, count_nodes_within(trie->root, trie->root, nodes));
+    const TrieNode* first_child = NULL;
+    for (int i = 0; i < ALPHABET_SIZE && !first_child; i++) first_child = trie->root->children[i];
+    TEST_ASSERT_TRUE(first_child == trie->root + 1);
+
+    // Postings moved with their nodes
+    for (int i = 0; i < KEYS; i++) {
+        TEST_ASSERT_TRUE(gtrie_search(trie, keys[i], &err) == before[i]);
+    }
+    TEST_ASSERT_NULL(gtrie_search(trie, "missing", &err));
+    TEST_ASSERT_EQUAL_INT(ENOENT, err);
+    const char* batch[] = { keys[0], keys[1], "missing" };
+    PostingList* found[3];
+    TEST_ASSERT_EQUAL_INT(0, gtrie_search_many(trie, batch, 3, found, NULL));
+    TEST_ASSERT_TRUE(found[0] == before[0] && found[1] == before[1] && found[2] == NULL);
+    size_t n = 0;
+    char** prefixed = gtrie_prefix_search(trie, "ключ", &n, &err);
+    TEST_ASSERT_EQUAL_INT(0, err);
+    TEST_ASSERT_EQUAL_size_t(KEYS / 5, n);
+    free(prefixed);
+
+    // Read-only from now on
+    TEST_ASSERT_EQUAL_INT(EPERM, gtrie_insert(trie, "new", "doc1"));
+    TEST_ASSERT_EQUAL_INT(EPERM, gtrie_insert(trie, keys[0], "doc3"));
+    TEST_ASSERT_EQUAL_INT(EPERM, gtrie_insert_at(trie, "new", "doc1", 0));
+    TEST_ASSERT_EQUAL_INT(EPERM, gtrie_set_weight(trie, keys[0], 5));
+    TEST_ASSERT_EQUAL_size_t(before[0]->count, gtrie_search(trie, keys[0], &err)->count);
+
+    TEST_ASSERT_EQUAL_INT(EINVAL, gtrie_freeze(NULL));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_destroy(trie));
+
+    // A trie with only its root
+    trie = gtrie_create(&err);
+    TEST_ASSERT_EQUAL_INT(0, gtrie_freeze(trie));
+    TEST_ASSERT_NULL(gtrie_search(trie, "a", &err));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_destroy(trie));
+}
+
 int main(void) {
     UNITY_BEGIN();
     
@@ -300,6 +592,10 @@ int main(void) {
     RUN_TEST(test_node_count);
     RUN_TEST(test_product_keywords);
     RUN_TEST(test_utf8_support);
+    RUN_TEST(test_search_many);
+    RUN_TEST(test_fuzzy_search);
+    RUN_TEST(test_complete);
+    RUN_TEST(test_freeze);
     
     return UNITY_END();
 } 
\ No newline at end of file
@@ -222,6 +222,205 @@ void test_version_compatibility(void) {
     gtrie_destroy(trie);
 }
 
+void test_save_load_words(void) {
+    GTrie* original = create_test_trie();
+    TEST_ASSERT_EQUAL_INT(0, gtrie_save(original, GTRIEIO_TEST_FILE, NULL, NULL));
+
+    int err = 0;
+    GTrie* loaded = gtrie_load(GTRIEIO_TEST_FILE, &err, NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(0, err);
+    TEST_ASSERT_NOT_NULL(loaded);
+
+    // Stored keys survive the round trip
+    FuzzyMatch matches[4];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(0, gtrie_fuzzy_search(loaded, "helo", 1, matches, 4, &count));
+    TEST_ASSERT_EQUAL_size_t(1, count);
+    TEST_ASSERT_EQUAL_STRING("hello", matches[0].word);
+    TEST_ASSERT_EQUAL_size_t(2, matches[0].postings->count);
+
+    gtrie_destroy(loaded);
+    gtrie_destroy(original);
+}
+
+void test_save_load_term_frequency(void) {
+    GTrie* original = create_test_trie();
+    gtrie_insert(original, "hello", "doc1");
+    gtrie_insert(original, "hello", "doc1");
+    TEST_ASSERT_EQUAL_INT(0, gtrie_save(original, GTRIEIO_TEST_FILE, NULL, NULL));
+
+    int err = 0;
+    GTrie* loaded = gtrie_load(GTRIEIO_TEST_FILE, &err, NULL, NULL);
+    TEST_ASSERT_NOT_NULL(loaded);
+
+    PostingList* list = gtrie_search(loaded, "hello", &err);
+    TEST_ASSERT_NOT_NULL(list);
+    for (PostingEntry* e = list->head; e; e = e->next) {
+        TEST_ASSERT_EQUAL_UINT32(strcmp(e->doc_id, "doc1") == 0 ? 3 : 1, e->tf);
+    }
+
+    // Document lengths are rebuilt from the stored frequencies
+    uint32_t doc = 0;
+    TEST_ASSERT_EQUAL_INT(0, doc_table_find(loaded->docs, "doc1", &doc));
+    TEST_ASSERT_EQUAL_UINT32(4, doc_table_length(loaded->docs, doc));
+    TEST_ASSERT_EQUAL_size_t(doc_table_count(original->docs), doc_table_count(loaded->docs));
+    TEST_ASSERT_EQUAL_UINT64(doc_table_total_length(original->docs), doc_table_total_length(loaded->docs));
+
+    gtrie_destroy(loaded);
+    gtrie_destroy(original);
+}
+
+void test_save_load_positions(void) {
+    GTrie* original = create_test_trie();
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert_at(original, "quick", "doc5", 3));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert_at(original, "quick", "doc5", 200));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert_at(original, "quick", "doc5", 70000));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_save(original, GTRIEIO_TEST_FILE, NULL, NULL));
+
+    int err = 0;
+    GTrie* loaded = gtrie_load(GTRIEIO_TEST_FILE, &err, NULL, NULL);
+    TEST_ASSERT_NOT_NULL(loaded);
+
+    PostingList* list = gtrie_search(loaded, "quick", &err);
+    TEST_ASSERT_NOT_NULL(list);
+    uint32_t positions[8];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(0, gtrie_decode_positions(list->head->positions, list->head->positions_size,
+                                                    positions, 8, &count));
+    TEST_ASSERT_EQUAL_size_t(3, count);
+    TEST_ASSERT_EQUAL_UINT32(3, positions[0]);
+    TEST_ASSERT_EQUAL_UINT32(200, positions[1]);
+    TEST_ASSERT_EQUAL_UINT32(70000, positions[2]);
+
+    // Loaded lists keep growing from the last stored position
+    TEST_ASSERT_EQUAL_INT(EINVAL, gtrie_insert_at(loaded, "quick", "doc5", 70000));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert_at(loaded, "quick", "doc5", 70001));
+    TEST_ASSERT_EQUAL_UINT32(4, list->head->tf);
+
+    // Postings without positions stay without them
+    list = gtrie_search(loaded, "hello", &err);
+    TEST_ASSERT_NOT_NULL(list);
+    TEST_ASSERT_NULL(list->head->positions);
+
+    gtrie_destroy(loaded);
+    gtrie_destroy(original);
+}
+
+void test_save_load_weights(void) {
+    GTrie* original = create_test_trie();
+    gtrie_insert(original, "help", "doc4");
+    TEST_ASSERT_EQUAL_INT(0, gtrie_set_weight(original, "hello", 5));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_set_weight(original, "help", 9));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_save(original, GTRIEIO_TEST_FILE, NULL, NULL));
+
+    int err = 0;
+    GTrie* loaded = gtrie_load(GTRIEIO_TEST_FILE, &err, NULL, NULL);
+    TEST_ASSERT_NOT_NULL(loaded);
+
+    // Subtree maxima are rebuilt from the key weights
+    TEST_ASSERT_EQUAL_UINT32(9, loaded->root->max_weight);
+    Completion out[4];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(0, gtrie_complete(loaded, "hel", out, 4, &count));
+    TEST_ASSERT_EQUAL_size_t(2, count);
+    TEST_ASSERT_EQUAL_STRING("help", out[0].word);
+    TEST_ASSERT_EQUAL_STRING("hello", out[1].word);
+    TEST_ASSERT_EQUAL_UINT32(5, out[1].weight);
+
+    gtrie_destroy(loaded);
+    gtrie_destroy(original);
+}
+
+void test_save_load_filter(void) {
+    GTrie* original = create_test_trie();
+    char key[16];
+    for (int i = 0; i < 500; i++) {
+        snprintf(key, sizeof(key), "sku%c%c", 'a' + i % 26, 'a' + i / 26);
+        TEST_ASSERT_EQUAL_INT(0, gtrie_insert(original, key, "doc9"));
+    }
+    TEST_ASSERT_NULL(original->filter);
+    TEST_ASSERT_EQUAL_INT(0, gtrie_save(original, GTRIEIO_TEST_FILE, NULL, NULL));
+
+    int err = 0;
+    GTrie* loaded = gtrie_load(GTRIEIO_TEST_FILE, &err, NULL, NULL);
+    TEST_ASSERT_NOT_NULL(loaded);
+    TEST_ASSERT_NOT_NULL(loaded->filter);
+
+    // Every stored key passes the filter
+    for (int i = 0; i < 500; i++) {
+        snprintf(key, sizeof(key), "sku%c%c", 'a' + i % 26, 'a' + i / 26);
+        TEST_ASSERT_NOT_NULL(gtrie_search(loaded, key, &err));
+    }
+    TEST_ASSERT_NOT_NULL(gtrie_search(loaded, "hello", &err));
+
+    // Misses, including prefixes of stored keys, report ENOENT
+    err = 0;
+    TEST_ASSERT_NULL(gtrie_search(loaded, "unknown", &err));
+    TEST_ASSERT_EQUAL_INT(ENOENT, err);
+    err = 0;
+    TEST_ASSERT_NULL(gtrie_search(loaded, "sku", &err));
+    TEST_ASSERT_EQUAL_INT(ENOENT, err);
+
+    // Keys inserted after loading are added to the filter
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert(loaded, "zebra", "doc1"));
+    TEST_ASSERT_NOT_NULL(gtrie_search(loaded, "zebra", &err));
+
+    const char* words[] = { "zebra", "missing", "world" };
+    PostingList* lists[3];
+    int errs[3];
+    TEST_ASSERT_EQUAL_INT(0, gtrie_search_many(loaded, words, 3, lists, errs));
+    TEST_ASSERT_NOT_NULL(lists[0]);
+    TEST_ASSERT_EQUAL_INT(ENOENT, errs[1]);
+    TEST_ASSERT_NOT_NULL(lists[2]);
+
+    gtrie_destroy(loaded);
+    gtrie_destroy(original);
+}
+
+void test_load_version1(void) {
+    // Hand-written version 1 file: root -> 'a' with one posting, no stored keys
+    FILE* fp = fopen(GTRIEIO_TEST_FILE, "wb");
+    TEST_ASSERT_NOT_NULL(fp);
+    IndexHeader header = {0};
+    header.magic = 0x45495254;
+    header.version = 1;
+    header.node_count = 2;
+    header.doc_count = 1;
+    header.total_words = 1;
+    fwrite(&header, offsetof(IndexHeader, flags), 1, fp);
+
+    uint32_t root_children = 1, index = 'a' % ALPHABET_SIZE, leaf_children = 0, postings = 1;
+    size_t len = 5;
+    uint32_t root_postings = 0;
+    fwrite(&root_children, sizeof(uint32_t), 1, fp);
+    fwrite(&index, sizeof(uint32_t), 1, fp);
+    fwrite(&leaf_children, sizeof(uint32_t), 1, fp);
+    fwrite(&postings, sizeof(uint32_t), 1, fp);
+    fwrite(&len, sizeof(size_t), 1, fp);
+    fwrite("doc1", 1, len, fp);
+    fwrite(&root_postings, sizeof(uint32_t), 1, fp);
+    fclose(fp);
+
+    int err = 0;
+    GTrie* loaded = gtrie_load(GTRIEIO_TEST_FILE, &err, NULL, NULL);
+    TEST_ASSERT_EQUAL_INT(0, err);
+    TEST_ASSERT_NOT_NULL(loaded);
+
+    PostingList* list = gtrie_search(loaded, "a", &err);
+    TEST_ASSERT_NOT_NULL(list);
+    TEST_ASSERT_EQUAL_STRING("doc1", list->head->doc_id);
+
+    // Fuzzy search still works, without the matched key
+    FuzzyMatch matches[4];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(0, gtrie_fuzzy_search(loaded, "b", 1, matches, 4, &count));
+    TEST_ASSERT_EQUAL_size_t(1, count);
+    TEST_ASSERT_NULL(matches[0].word);
+    TEST_ASSERT_EQUAL_INT(1, matches[0].distance);
+
+    gtrie_destroy(loaded);
+}
+
 int main(void) {
     UNITY_BEGIN();
     
@@ -231,6 +430,12 @@ int main(void) {
     RUN_TEST(test_list_indices);
     RUN_TEST(test_file_integrity);
     RUN_TEST(test_version_compatibility);
+    RUN_TEST(test_save_load_words);
+    RUN_TEST(test_save_load_term_frequency);
+    RUN_TEST(test_save_load_positions);
+    RUN_TEST(test_save_load_weights);
+    RUN_TEST(test_save_load_filter);
+    RUN_TEST(test_load_version1);
     
     return UNITY_END();
 } 
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "../include/gtrie_stats.h"
+#include "../include/gtrie_io.h"
+#include "../include/indexer.h"
+#include "../include/ranking.h"
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <errno.h>
+
+#define STATS_TEST_FILE "test_gtrie_stats.idx"
+
+static GTrie* trie;
+
+void setUp(void) {
+    int err = 0;
+    trie = gtrie_create(&err);
+    TEST_ASSERT_NOT_NULL(trie);
+
+    // root -> a -> {b, c}, root -> b
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, "ab", "d1"));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, "ab", "d2"));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, "ac", "d1"));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, "b", "d3"));
+}
+
+void tearDown(void) {
+    gtrie_destroy(trie);
+}
+
+void test_shape(void) {
+    GTrieStats stats;
+    TEST_ASSERT_EQUAL_INT(0, gtrie_stats(trie, &stats));
+
+    TEST_ASSERT_EQUAL_size_t(5, stats.nodes);
+    TEST_ASSERT_EQUAL_size_t(trie->node_count, stats.nodes);
+    TEST_ASSERT_EQUAL_size_t(3, stats.keys);
+    TEST_ASSERT_EQUAL_size_t(4, stats.postings);
+    TEST_ASSERT_EQUAL_size_t(trie->doc_count, stats.postings);
+    TEST_ASSERT_EQUAL_size_t(3, stats.unique_docs);
+
+    TEST_ASSERT_EQUAL_size_t(3, stats.fanout[0]);
+    TEST_ASSERT_EQUAL_size_t(0, stats.fanout[1]);
+    TEST_ASSERT_EQUAL_size_t(2, stats.fanout[2]);
+    TEST_ASSERT_EQUAL_size_t(2, stats.max_depth);
+    TEST_ASSERT_EQUAL_size_t(1, stats.depth[0]);
+    TEST_ASSERT_EQUAL_size_t(2, stats.depth[1]);
+    TEST_ASSERT_EQUAL_size_t(2, stats.depth[2]);
+
+    TEST_ASSERT_EQUAL_size_t(2, stats.max_posting_length);
+    TEST_ASSERT_EQUAL_size_t(2, stats.posting_lengths[0]);
+    TEST_ASSERT_EQUAL_size_t(1, stats.posting_lengths[1]);
+
+    // Every node but the root fills exactly one slot of its parent
+    TEST_ASSERT_EQUAL_size_t(5 * TRIE_CHILDREN_SIZE, stats.child_slots);
+    TEST_ASSERT_EQUAL_size_t(5 * TRIE_CHILDREN_SIZE - 4, stats.wasted_child_slots);
+}
+
+void test_bytes(void) {
+    GTrieStats stats;
+    TEST_ASSERT_EQUAL_INT(0, gtrie_stats(trie, &stats));
+
+    TEST_ASSERT_EQUAL_size_t(node_pool_bytes(trie->nodes), stats.node_bytes);
+    TEST_ASSERT_TRUE(stats.node_bytes >= 5 * sizeof(TrieNode));
+    TEST_ASSERT_EQUAL_size_t(4 * strlen("d1") + 4, stats.doc_string_bytes);
+    TEST_ASSERT_EQUAL_size_t(strlen("ab") + strlen("ac") + strlen("b") + 3, stats.key_bytes);
+    TEST_ASSERT_EQUAL_size_t(3 * sizeof(PostingList) + 4 * sizeof(PostingEntry), stats.posting_bytes);
+    TEST_ASSERT_EQUAL_size_t(doc_table_bytes(trie->docs), stats.doc_table_bytes);
+    TEST_ASSERT_EQUAL_size_t(0, stats.filter_bytes);
+    TEST_ASSERT_TRUE(stats.total_bytes > stats.node_bytes + stats.posting_bytes);
+
+    // Ranking views are accounted to the postings once built
+    const char* terms[] = { "ab" };
+    RankedDoc out[2];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(0, rank_bm25_top_k(trie, terms, 1, 2, out, &count, NULL));
+    GTrieStats ranked;
+    TEST_ASSERT_EQUAL_INT(0, gtrie_stats(trie, &ranked));
+    TEST_ASSERT_TRUE(ranked.posting_bytes > stats.posting_bytes);
+}
+
+void test_loaded_trie(void) {
+    TEST_ASSERT_EQUAL_INT(0, gtrie_save(trie, STATS_TEST_FILE, NULL, NULL));
+    int err = 0;
+    GTrie* loaded = gtrie_load(STATS_TEST_FILE, &err, NULL, NULL);
+    unlink(STATS_TEST_FILE);
+    TEST_ASSERT_NOT_NULL(loaded);
+
+    GTrieStats built, stats;
+    TEST_ASSERT_EQUAL_INT(0, gtrie_stats(trie, &built));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_stats(loaded, &stats));
+    TEST_ASSERT_EQUAL_size_t(built.nodes, stats.nodes);
+    TEST_ASSERT_EQUAL_size_t(built.postings, stats.postings);
+    TEST_ASSERT_EQUAL_MEMORY(built.fanout, stats.fanout, sizeof(built.fanout));
+    TEST_ASSERT_TRUE(stats.filter_bytes > 0);
+    gtrie_destroy(loaded);
+}
+
+void test_indexer_stats(void) {
+    Indexer* idx = indexer_create();
+    TEST_ASSERT_NOT_NULL(idx);
+    TEST_ASSERT_EQUAL_INT(0, indexer_add_document(idx, "apple", "d1"));
+    TEST_ASSERT_EQUAL_INT(0, indexer_add_document(idx, "apricot", "d1"));
+
+    GTrieStats stats;
+    TEST_ASSERT_EQUAL_INT(0, indexer_get_trie_stats(idx, &stats));
+    TEST_ASSERT_EQUAL_size_t(2, stats.keys);
+    TEST_ASSERT_EQUAL_size_t(2, stats.postings);
+    TEST_ASSERT_EQUAL_size_t(1, stats.unique_docs);
+    TEST_ASSERT_EQUAL_size_t(7, stats.max_depth);
+
+    FILE* out = tmpfile();
+    TEST_ASSERT_NOT_NULL(out);
+    gtrie_stats_print(&stats, out);
+    TEST_ASSERT_TRUE(ftell(out) > 0);
+    fclose(out);
+
+    TEST_ASSERT_EQUAL_INT(EINVAL, indexer_get_trie_stats(idx, NULL));
+    indexer_destroy(idx);
+    TEST_ASSERT_EQUAL_INT(EINVAL, gtrie_stats(NULL, &stats));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_shape);
+    RUN_TEST(test_bytes);
+    RUN_TEST(test_loaded_trie);
+    RUN_TEST(test_indexer_stats);
+
+    return UNITY_END();
+}
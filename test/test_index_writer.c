@@ -90,11 +90,58 @@ void test_process_file(void) {
     indexer_destroy(idx);
 }
 
+void test_process_weighted_line(void) {
+    Indexer* idx = indexer_create();
+    TEST_ASSERT_NOT_NULL(idx);
+
+    TEST_ASSERT_EQUAL_INT(0, process_weighted_line(idx, "apple:doc1.txt:40\n"));
+    TEST_ASSERT_EQUAL_INT(0, process_weighted_line(idx, "apricot:doc:2.txt:90"));
+    TEST_ASSERT_EQUAL_INT(EINVAL, process_weighted_line(idx, "avocado:doc3.txt"));
+    TEST_ASSERT_EQUAL_INT(EINVAL, process_weighted_line(idx, "avocado:doc3.txt:heavy"));
+    TEST_ASSERT_EQUAL_INT(EINVAL, process_weighted_line(idx, "avocado:doc3.txt:99999999999"));
+    TEST_ASSERT_EQUAL_size_t(2, indexer_get_key_count(idx));
+
+    // The weight is split off; doc ids may themselves contain ':'
+    CompletionResult results[4];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(0, indexer_complete(idx, "a", results, 4, &count));
+    TEST_ASSERT_EQUAL_size_t(2, count);
+    TEST_ASSERT_EQUAL_STRING("apricot", results[0].key);
+    TEST_ASSERT_EQUAL_UINT32(90, results[0].weight);
+    TEST_ASSERT_EQUAL_STRING("doc:2.txt", indexer_cursor_next(&results[0].cursor));
+    TEST_ASSERT_EQUAL_UINT32(40, results[1].weight);
+    indexer_cursor_close(&results[0].cursor);
+    indexer_cursor_close(&results[1].cursor);
+
+    indexer_destroy(idx);
+}
+
+void test_process_document_line(void) {
+    Indexer* idx = indexer_create();
+    TEST_ASSERT_NOT_NULL(idx);
+
+    TEST_ASSERT_EQUAL_INT(0, process_document_line(idx, "doc1:the quick brown fox\n"));
+    TEST_ASSERT_EQUAL_INT(0, process_document_line(idx, "doc2:brown  quick\tthe fox"));
+    TEST_ASSERT_EQUAL_INT(EINVAL, process_document_line(idx, "no separator"));
+    TEST_ASSERT_EQUAL_size_t(4, indexer_get_key_count(idx));
+
+    const char* phrase[] = { "quick", "brown" };
+    const char* docs[4];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(0, indexer_search_phrase(idx, phrase, 2, 0, docs, 4, &count, NULL));
+    TEST_ASSERT_EQUAL_size_t(1, count);
+    TEST_ASSERT_EQUAL_STRING("doc1", docs[0]);
+
+    indexer_destroy(idx);
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_process_line_basic);
     RUN_TEST(test_process_line_invalid);
     RUN_TEST(test_process_line_multiple);
     RUN_TEST(test_process_file);
+    RUN_TEST(test_process_weighted_line);
+    RUN_TEST(test_process_document_line);
     return UNITY_END();
 } 
\ No newline at end of file
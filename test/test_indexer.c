@@ -4,6 +4,9 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
 #include "../include/logging.h"
 
 
@@ -274,6 +277,604 @@ void test_save_and_load(void) {
     indexer_destroy(loaded);
 }
 
+void test_search_cache(void) {
+    Indexer* idx = indexer_create();
+    TEST_ASSERT_NOT_NULL(idx);
+    TEST_ASSERT_EQUAL_INT(0, indexer_enable_cache(idx, 1024 * 1024));
+
+    indexer_add_document(idx, "apple", "doc1");
+    indexer_add_document(idx, "apple", "doc2");
+
+    // First search misses, second is served from the cache with the same results
+    SearchResult* first = indexer_search(idx, "apple");
+    SearchResult* second = indexer_search(idx, "apple");
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_NOT_NULL(second);
+    TEST_ASSERT_EQUAL_STRING(first->doc_id, second->doc_id);
+    TEST_ASSERT_EQUAL_STRING(first->next->doc_id, second->next->doc_id);
+    TEST_ASSERT_NULL(second->next->next);
+    search_results_free(first);
+    search_results_free(second);
+
+    // Misses are cached too
+    TEST_ASSERT_NULL(indexer_search(idx, "orange"));
+    TEST_ASSERT_NULL(indexer_search(idx, "orange"));
+
+    QueryCacheStats stats;
+    TEST_ASSERT_EQUAL_INT(0, indexer_get_cache_stats(idx, &stats));
+    TEST_ASSERT_EQUAL_INT(2, stats.hits);
+    TEST_ASSERT_EQUAL_INT(2, stats.misses);
+
+    // A write invalidates cached results
+    uint64_t generation = indexer_get_generation(idx);
+    indexer_add_document(idx, "orange", "doc3");
+    TEST_ASSERT_GREATER_THAN(generation, indexer_get_generation(idx));
+
+    SearchResult* results = indexer_search(idx, "orange");
+    TEST_ASSERT_NOT_NULL(results);
+    TEST_ASSERT_EQUAL_STRING("doc3", results->doc_id);
+    search_results_free(results);
+
+    // Reloading invalidates as well
+    TEST_ASSERT_EQUAL_INT(0, indexer_save(idx, INDEXER_TEST_FILE));
+    Indexer* other = indexer_create();
+    indexer_add_document(other, "apple", "doc9");
+    TEST_ASSERT_EQUAL_INT(0, indexer_save(other, INDEXER_TEST_FILE));
+    TEST_ASSERT_EQUAL_INT(0, indexer_load(idx, INDEXER_TEST_FILE));
+
+    results = indexer_search(idx, "apple");
+    TEST_ASSERT_NOT_NULL(results);
+    TEST_ASSERT_EQUAL_STRING("doc9", results->doc_id);
+    TEST_ASSERT_NULL(results->next);
+    search_results_free(results);
+
+    // Disabling the cache
+    TEST_ASSERT_EQUAL_INT(0, indexer_enable_cache(idx, 0));
+    TEST_ASSERT_EQUAL_INT(ENOENT, indexer_get_cache_stats(idx, &stats));
+
+    indexer_destroy(other);
+    indexer_destroy(idx);
+}
+
+void test_search_page(void) {
+    Indexer* idx = indexer_create();
+    TEST_ASSERT_NOT_NULL(idx);
+
+    char doc_id[16];
+    for (int i = 0; i < 50; i++) {
+        snprintf(doc_id, sizeof(doc_id), "doc%d", i);
+        TEST_ASSERT_EQUAL_INT(0, indexer_add_document(idx, "page", doc_id));
+    }
+
+    // Walk all pages and make sure every doc appears exactly once
+    const char* page[20];
+    bool seen[50] = {false};
+    size_t offset = 0;
+    for (;;) {
+        size_t count = 0, total = 0;
+        TEST_ASSERT_EQUAL_INT(0, indexer_search_page(idx, "page", offset, 20, page, &count, &total, NULL));
+        TEST_ASSERT_EQUAL_size_t(50, total);
+        if (count == 0) break;
+
+        for (size_t i = 0; i < count; i++) {
+            int n = atoi(page[i] + 3);
+            TEST_ASSERT_FALSE(seen[n]);
+            seen[n] = true;
+        }
+        offset += count;
+    }
+    TEST_ASSERT_EQUAL_size_t(50, offset);
+
+    // Missing key
+    size_t count = 1, total = 1;
+    TEST_ASSERT_EQUAL_INT(ENOENT, indexer_search_page(idx, "none", 0, 20, page, &count, &total, NULL));
+    TEST_ASSERT_EQUAL_size_t(0, count);
+    TEST_ASSERT_EQUAL_size_t(0, total);
+
+    // Invalid arguments
+    TEST_ASSERT_EQUAL_INT(EINVAL, indexer_search_page(NULL, "page", 0, 20, page, &count, &total, NULL));
+    TEST_ASSERT_EQUAL_INT(EINVAL, indexer_search_page(idx, "page", 0, 20, NULL, &count, &total, NULL));
+
+    indexer_destroy(idx);
+}
+
+void test_search_cursor(void) {
+    Indexer* idx = indexer_create();
+    TEST_ASSERT_NOT_NULL(idx);
+
+    indexer_add_document(idx, "apple", "doc1");
+    indexer_add_document(idx, "apple", "doc2");
+    indexer_add_document(idx, "apple", "doc3");
+
+    SearchCursor cursor;
+    TEST_ASSERT_EQUAL_INT(0, indexer_cursor_open(idx, "apple", &cursor));
+    TEST_ASSERT_EQUAL_size_t(3, cursor.total);
+
+    // Most recent first; stop early after skipping one
+    TEST_ASSERT_EQUAL_size_t(1, indexer_cursor_skip(&cursor, 1));
+    TEST_ASSERT_EQUAL_STRING("doc2", indexer_cursor_next(&cursor));
+    TEST_ASSERT_EQUAL_size_t(2, cursor.position);
+    indexer_cursor_close(&cursor);
+
+    TEST_ASSERT_EQUAL_INT(0, indexer_cursor_open(idx, "apple", &cursor));
+    TEST_ASSERT_EQUAL_size_t(3, indexer_cursor_skip(&cursor, 10));
+    TEST_ASSERT_NULL(indexer_cursor_next(&cursor));
+    indexer_cursor_close(&cursor);
+
+    TEST_ASSERT_EQUAL_INT(ENOENT, indexer_cursor_open(idx, "pear", &cursor));
+    TEST_ASSERT_NULL(indexer_cursor_next(&cursor));
+
+    indexer_destroy(idx);
+}
+
+void test_search_many(void) {
+    Indexer* idx = indexer_create();
+    TEST_ASSERT_NOT_NULL(idx);
+
+    indexer_add_document(idx, "apple", "doc1");
+    indexer_add_document(idx, "apple", "doc2");
+    indexer_add_document(idx, "applet", "doc3");
+    indexer_add_document(idx, "banana", "doc4");
+
+    const char* keys[] = {"banana", "apple", "pear", "applet"};
+    SearchManyResult results[4];
+    TEST_ASSERT_EQUAL_INT(0, indexer_search_many(idx, keys, 4, results));
+
+    TEST_ASSERT_EQUAL_INT(0, results[0].err);
+    TEST_ASSERT_EQUAL_STRING("doc4", indexer_cursor_next(&results[0].cursor));
+    TEST_ASSERT_EQUAL_INT(0, results[1].err);
+    TEST_ASSERT_EQUAL_size_t(2, results[1].cursor.total);
+    TEST_ASSERT_EQUAL_INT(ENOENT, results[2].err);
+    TEST_ASSERT_NULL(indexer_cursor_next(&results[2].cursor));
+    TEST_ASSERT_EQUAL_INT(0, results[3].err);
+    TEST_ASSERT_EQUAL_STRING("doc3", indexer_cursor_next(&results[3].cursor));
+
+    for (int i = 0; i < 4; i++) {
+        indexer_cursor_close(&results[i].cursor);
+    }
+
+    TEST_ASSERT_EQUAL_INT(EINVAL, indexer_search_many(NULL, keys, 4, results));
+    TEST_ASSERT_EQUAL_INT(EINVAL, indexer_search_many(idx, keys, 4, NULL));
+
+    indexer_destroy(idx);
+}
+
+void test_search_fuzzy(void) {
+    Indexer* idx = indexer_create();
+    TEST_ASSERT_NOT_NULL(idx);
+
+    indexer_add_document(idx, "keyboard", "doc1");
+    indexer_add_document(idx, "keyboards", "doc2");
+    indexer_add_document(idx, "keyboards", "doc3");
+    indexer_add_document(idx, "headphones", "doc4");
+
+    FuzzyResult results[8];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(0, indexer_search_fuzzy(idx, "keybord", 2, results, 8, &count));
+    TEST_ASSERT_EQUAL_size_t(2, count);
+    TEST_ASSERT_EQUAL_STRING("keyboard", results[0].key);
+    TEST_ASSERT_EQUAL_INT(1, results[0].distance);
+    TEST_ASSERT_EQUAL_STRING("doc1", indexer_cursor_next(&results[0].cursor));
+    TEST_ASSERT_EQUAL_STRING("keyboards", results[1].key);
+    TEST_ASSERT_EQUAL_INT(2, results[1].distance);
+    TEST_ASSERT_EQUAL_size_t(2, results[1].cursor.total);
+    for (size_t i = 0; i < count; i++) {
+        indexer_cursor_close(&results[i].cursor);
+    }
+
+    TEST_ASSERT_EQUAL_INT(ENOENT, indexer_search_fuzzy(idx, "mouse", 2, results, 8, &count));
+    TEST_ASSERT_EQUAL_size_t(0, count);
+    TEST_ASSERT_EQUAL_INT(EINVAL, indexer_search_fuzzy(idx, NULL, 2, results, 8, &count));
+    TEST_ASSERT_EQUAL_INT(EINVAL, indexer_search_fuzzy(idx, "mouse", -1, results, 8, &count));
+
+    // Keys are persisted with the index
+    TEST_ASSERT_EQUAL_INT(0, indexer_save(idx, INDEXER_TEST_FILE));
+    Indexer* loaded = indexer_create();
+    TEST_ASSERT_EQUAL_INT(0, indexer_load(loaded, INDEXER_TEST_FILE));
+    TEST_ASSERT_EQUAL_INT(0, indexer_search_fuzzy(loaded, "hedphones", 1, results, 8, &count));
+    TEST_ASSERT_EQUAL_size_t(1, count);
+    TEST_ASSERT_EQUAL_STRING("headphones", results[0].key);
+    indexer_cursor_close(&results[0].cursor);
+
+    indexer_destroy(loaded);
+    indexer_destroy(idx);
+}
+
+void test_search_pattern(void) {
+    Indexer* idx = indexer_create();
+    TEST_ASSERT_NOT_NULL(idx);
+
+    indexer_add_document(idx, "keyboard", "doc1");
+    indexer_add_document(idx, "keycap", "doc2");
+    indexer_add_document(idx, "keycap", "doc3");
+    indexer_add_document(idx, "monkey", "doc4");
+
+    PatternResult results[8];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(0, indexer_search_pattern(idx, "key*", PATTERN_GLOB, 8, 0,
+                                                    results, &count));
+    TEST_ASSERT_EQUAL_size_t(2, count);
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(results[i].key, "keycap") == 0) {
+            TEST_ASSERT_EQUAL_size_t(2, results[i].cursor.total);
+        } else {
+            TEST_ASSERT_EQUAL_STRING("keyboard", results[i].key);
+            TEST_ASSERT_EQUAL_STRING("doc1", indexer_cursor_next(&results[i].cursor));
+        }
+        indexer_cursor_close(&results[i].cursor);
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, indexer_search_pattern(idx, "key$", PATTERN_REGEX, 8, 0,
+                                                    results, &count));
+    TEST_ASSERT_EQUAL_size_t(1, count);
+    TEST_ASSERT_EQUAL_STRING("monkey", results[0].key);
+    indexer_cursor_close(&results[0].cursor);
+
+    TEST_ASSERT_EQUAL_INT(ENOENT, indexer_search_pattern(idx, "mouse*", PATTERN_GLOB, 8, 0,
+                                                         results, &count));
+    TEST_ASSERT_EQUAL_size_t(0, count);
+    TEST_ASSERT_EQUAL_INT(EINVAL, indexer_search_pattern(idx, "(key", PATTERN_REGEX, 8, 0,
+                                                         results, &count));
+    TEST_ASSERT_EQUAL_INT(EINVAL, indexer_search_pattern(idx, "key*", PATTERN_GLOB, 0, 0,
+                                                         results, &count));
+
+    indexer_destroy(idx);
+}
+
+void test_search_pattern_sidecars(void) {
+    Indexer* idx = indexer_create();
+    TEST_ASSERT_NOT_NULL(idx);
+
+    indexer_add_document(idx, "iphone", "doc1");
+    indexer_add_document(idx, "phonebook", "doc2");
+    indexer_add_document(idx, "telephone", "doc3");
+    indexer_add_document(idx, "telephone", "doc4");
+    indexer_add_document(idx, "sku-12ab-7", "doc5");
+
+    TEST_ASSERT_EQUAL_INT(0, indexer_save(idx, INDEXER_TEST_FILE));
+    TEST_ASSERT_EQUAL_INT(0, indexer_save_affix(idx, INDEXER_TEST_FILE));
+    Indexer* loaded = indexer_create();
+    TEST_ASSERT_EQUAL_INT(0, indexer_load(loaded, INDEXER_TEST_FILE));
+
+    // Sidecar answers come back in byte order and agree with the trie walk
+    const struct {
+        const char* pattern;
+        PatternSyntax syntax;
+        size_t count;
+    } cases[] = {
+        { "*phone", PATTERN_GLOB, 2 },
+        { "*phone*", PATTERN_GLOB, 3 },
+        { "12ab", PATTERN_REGEX, 1 },
+        { "phone$", PATTERN_REGEX, 2 },
+        { "*tablet", PATTERN_GLOB, 0 },
+    };
+    PatternResult results[8];
+    PatternResult walked[8];
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        size_t count = 0, walked_count = 0;
+        int rc = indexer_search_pattern(loaded, cases[c].pattern, cases[c].syntax, 8, 0,
+                                        results, &count);
+        TEST_ASSERT_EQUAL_INT(cases[c].count ? 0 : ENOENT, rc);
+        TEST_ASSERT_EQUAL_size_t(cases[c].count, count);
+        indexer_search_pattern(idx, cases[c].pattern, cases[c].syntax, 8, 0, walked, &walked_count);
+        TEST_ASSERT_EQUAL_size_t(walked_count, count);
+        for (size_t i = 0; i < count; i++) {
+            if (i > 0) TEST_ASSERT_TRUE(strcmp(results[i - 1].key, results[i].key) < 0);
+            if (strcmp(results[i].key, "telephone") == 0) {
+                TEST_ASSERT_EQUAL_size_t(2, results[i].cursor.total);
+            }
+            indexer_cursor_close(&results[i].cursor);
+        }
+        for (size_t i = 0; i < walked_count; i++) {
+            indexer_cursor_close(&walked[i].cursor);
+        }
+    }
+
+    // A write makes the sidecars stale; queries fall back to the trie walk
+    indexer_add_document(loaded, "headphone", "doc6");
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(0, indexer_search_pattern(loaded, "*phone", PATTERN_GLOB, 8, 0,
+                                                    results, &count));
+    TEST_ASSERT_EQUAL_size_t(3, count);
+    for (size_t i = 0; i < count; i++) {
+        indexer_cursor_close(&results[i].cursor);
+    }
+
+    // Rebuilt without sidecars: the old ones are ignored rather than served
+    TEST_ASSERT_EQUAL_INT(0, indexer_save(loaded, INDEXER_TEST_FILE));
+    TEST_ASSERT_EQUAL_INT(0, indexer_load(idx, INDEXER_TEST_FILE));
+    TEST_ASSERT_EQUAL_INT(0, indexer_search_pattern(idx, "*phone", PATTERN_GLOB, 8, 0,
+                                                    results, &count));
+    TEST_ASSERT_EQUAL_size_t(3, count);
+    for (size_t i = 0; i < count; i++) {
+        indexer_cursor_close(&results[i].cursor);
+    }
+
+    indexer_destroy(loaded);
+    indexer_destroy(idx);
+    unlink(INDEXER_TEST_FILE ".rev");
+    unlink(INDEXER_TEST_FILE ".sa");
+}
+
+void test_search_ranked(void) {
+    Indexer* idx = indexer_create();
+    TEST_ASSERT_NOT_NULL(idx);
+
+    indexer_add_document(idx, "wireless", "doc1");
+    indexer_add_document(idx, "mouse", "doc1");
+    indexer_add_document(idx, "wireless", "doc2");
+    indexer_add_document(idx, "keyboard", "doc2");
+    indexer_add_document(idx, "mouse", "doc3");
+    indexer_add_document(idx, "pad", "doc3");
+
+    // Only doc1 matches both terms
+    const char* terms[] = {"wireless", "mouse"};
+    RankedDoc results[4];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(0, indexer_search_ranked(idx, terms, 2, 4, results, &count, NULL));
+    TEST_ASSERT_EQUAL_size_t(3, count);
+    TEST_ASSERT_EQUAL_STRING("doc1", results[0].doc_id);
+    TEST_ASSERT_TRUE(results[0].score > results[1].score);
+
+    TEST_ASSERT_EQUAL_INT(0, indexer_search_ranked(idx, terms, 2, 1, results, &count, NULL));
+    TEST_ASSERT_EQUAL_size_t(1, count);
+
+    const char* missing[] = {"monitor"};
+    TEST_ASSERT_EQUAL_INT(ENOENT, indexer_search_ranked(idx, missing, 1, 4, results, &count, NULL));
+    TEST_ASSERT_EQUAL_INT(EINVAL, indexer_search_ranked(idx, terms, 2, 0, results, &count, NULL));
+
+    indexer_destroy(idx);
+}
+
+void test_complete(void) {
+    Indexer* idx = indexer_create();
+    TEST_ASSERT_NOT_NULL(idx);
+
+    indexer_add_document(idx, "phone", "doc1");
+    indexer_add_document(idx, "phone case", "doc2");
+    indexer_add_document(idx, "phone charger", "doc3");
+    indexer_add_document(idx, "photo", "doc4");
+    TEST_ASSERT_EQUAL_INT(0, indexer_set_key_weight(idx, "phone", 10));
+    TEST_ASSERT_EQUAL_INT(0, indexer_set_key_weight(idx, "phone charger", 30));
+    TEST_ASSERT_EQUAL_INT(0, indexer_set_key_weight(idx, "photo", 20));
+    TEST_ASSERT_EQUAL_INT(ENOENT, indexer_set_key_weight(idx, "tablet", 5));
+
+    CompletionResult results[4];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(0, indexer_complete(idx, "pho", results, 3, &count));
+    TEST_ASSERT_EQUAL_size_t(3, count);
+    TEST_ASSERT_EQUAL_STRING("phone charger", results[0].key);
+    TEST_ASSERT_EQUAL_STRING("photo", results[1].key);
+    TEST_ASSERT_EQUAL_STRING("phone", results[2].key);
+    TEST_ASSERT_EQUAL_STRING("doc3", indexer_cursor_next(&results[0].cursor));
+    for (size_t i = 0; i < count; i++) {
+        indexer_cursor_close(&results[i].cursor);
+    }
+
+    TEST_ASSERT_EQUAL_INT(ENOENT, indexer_complete(idx, "tab", results, 3, &count));
+    TEST_ASSERT_EQUAL_INT(EINVAL, indexer_complete(idx, "pho", results, 0, &count));
+
+    indexer_destroy(idx);
+}
+
+void test_reload_pins_snapshot(void) {
+    Indexer* idx = indexer_create();
+    TEST_ASSERT_NOT_NULL(idx);
+    indexer_add_document(idx, "lamp", "new1");
+    indexer_add_document(idx, "lamp", "new2");
+    TEST_ASSERT_EQUAL_INT(0, indexer_save(idx, INDEXER_TEST_FILE));
+    indexer_destroy(idx);
+
+    idx = indexer_create();
+    indexer_add_document(idx, "lamp", "old1");
+    uint64_t generation = indexer_get_generation(idx);
+
+    // A cursor opened before the swap keeps reading the old index
+    SearchCursor cursor;
+    TEST_ASSERT_EQUAL_INT(0, indexer_cursor_open(idx, "lamp", &cursor));
+
+    // So do pinned page and ranked results
+    const char* page[4];
+    size_t count = 0;
+    IndexPin page_pin;
+    TEST_ASSERT_EQUAL_INT(0, indexer_search_page(idx, "lamp", 0, 4, page, &count, NULL, &page_pin));
+    TEST_ASSERT_NOT_NULL(page_pin.snapshot);
+    const char* terms[] = {"lamp"};
+    RankedDoc ranked[4];
+    size_t ranked_count = 0;
+    IndexPin rank_pin;
+    TEST_ASSERT_EQUAL_INT(0, indexer_search_ranked(idx, terms, 1, 4, ranked, &ranked_count, &rank_pin));
+
+    TEST_ASSERT_EQUAL_INT(0, indexer_load(idx, INDEXER_TEST_FILE));
+    TEST_ASSERT_TRUE(indexer_get_generation(idx) > generation);
+
+    TEST_ASSERT_EQUAL_STRING("old1", indexer_cursor_next(&cursor));
+    TEST_ASSERT_NULL(indexer_cursor_next(&cursor));
+    indexer_cursor_close(&cursor);
+    TEST_ASSERT_EQUAL_size_t(1, count);
+    TEST_ASSERT_EQUAL_STRING("old1", page[0]);
+    indexer_unpin(&page_pin);
+    TEST_ASSERT_NULL(page_pin.snapshot);
+    TEST_ASSERT_EQUAL_size_t(1, ranked_count);
+    TEST_ASSERT_EQUAL_STRING("old1", ranked[0].doc_id);
+    indexer_unpin(&rank_pin);
+
+    // A failed search holds nothing
+    const char* missing[] = {"desk"};
+    TEST_ASSERT_EQUAL_INT(ENOENT, indexer_search_ranked(idx, missing, 1, 4, ranked, &ranked_count, &rank_pin));
+    TEST_ASSERT_NULL(rank_pin.snapshot);
+
+    // New queries see the new index
+    SearchCursor fresh;
+    TEST_ASSERT_EQUAL_INT(0, indexer_cursor_open(idx, "lamp", &fresh));
+    TEST_ASSERT_EQUAL_size_t(2, fresh.total);
+    indexer_cursor_close(&fresh);
+
+    indexer_destroy(idx);
+}
+
+typedef struct {
+    Indexer* idx;
+    int* stop;
+    size_t queries;
+    size_t inconsistent;
+} ReaderArgs;
+
+static void* reload_reader(void* arg) {
+    ReaderArgs* args = arg;
+    while (!__atomic_load_n(args->stop, __ATOMIC_ACQUIRE)) {
+        SearchCursor cursor;
+        if (indexer_cursor_open(args->idx, "shared", &cursor) != 0) {
+            args->inconsistent++;
+            continue;
+        }
+
+        // Every snapshot holds either all "a" or all "b" documents
+        const char* first = indexer_cursor_next(&cursor);
+        const char* doc_id;
+        while ((doc_id = indexer_cursor_next(&cursor)) != NULL) {
+            if (doc_id[0] != first[0]) args->inconsistent++;
+        }
+        if (cursor.position != cursor.total) args->inconsistent++;
+        indexer_cursor_close(&cursor);
+
+        SearchResult* results = indexer_search(args->idx, "shared");
+        if (!results) args->inconsistent++;
+        search_results_free(results);
+        args->queries++;
+    }
+    return NULL;
+}
+
+void test_concurrent_reload(void) {
+    char path_a[] = INDEXER_TEST_DIR "/a.trie";
+    char path_b[] = INDEXER_TEST_DIR "/b.trie";
+    char doc_id[32];
+
+    Indexer* writer = indexer_create();
+    for (int i = 0; i < 200; i++) {
+        snprintf(doc_id, sizeof(doc_id), "a%d", i);
+        indexer_add_document(writer, "shared", doc_id);
+    }
+    TEST_ASSERT_EQUAL_INT(0, indexer_save(writer, path_a));
+    indexer_destroy(writer);
+
+    writer = indexer_create();
+    for (int i = 0; i < 300; i++) {
+        snprintf(doc_id, sizeof(doc_id), "b%d", i);
+        indexer_add_document(writer, "shared", doc_id);
+    }
+    TEST_ASSERT_EQUAL_INT(0, indexer_save(writer, path_b));
+    indexer_destroy(writer);
+
+    Indexer* idx = indexer_create();
+    TEST_ASSERT_EQUAL_INT(0, indexer_load(idx, path_a));
+    TEST_ASSERT_EQUAL_INT(0, indexer_enable_cache(idx, 64 * 1024));
+
+    int stop = 0;
+    pthread_t threads[4];
+    ReaderArgs args[4];
+    for (int t = 0; t < 4; t++) {
+        args[t] = (ReaderArgs){ idx, &stop, 0, 0 };
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&threads[t], NULL, reload_reader, &args[t]));
+    }
+
+    for (int i = 0; i < 20; i++) {
+        TEST_ASSERT_EQUAL_INT(0, indexer_load(idx, (i % 2) ? path_a : path_b));
+        sched_yield();
+    }
+
+    __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+    for (int t = 0; t < 4; t++) {
+        pthread_join(threads[t], NULL);
+        TEST_ASSERT_EQUAL_size_t(0, args[t].inconsistent);
+    }
+
+    indexer_destroy(idx);
+    unlink(path_a);
+    unlink(path_b);
+}
+
+void test_freeze_on_load(void) {
+    Indexer* idx = indexer_create();
+    TEST_ASSERT_NOT_NULL(idx);
+    indexer_add_document(idx, "apple", "doc1");
+    indexer_add_document(idx, "apple", "doc2");
+    indexer_add_document(idx, "banana", "doc3");
+    TEST_ASSERT_EQUAL_INT(0, indexer_save(idx, INDEXER_TEST_FILE));
+
+    TEST_ASSERT_EQUAL_INT(0, indexer_enable_freeze(idx, true));
+    TEST_ASSERT_EQUAL_INT(0, indexer_load(idx, INDEXER_TEST_FILE));
+    SearchResult* results = indexer_search(idx, "apple");
+    TEST_ASSERT_NOT_NULL(results);
+    TEST_ASSERT_NOT_NULL(results->next);
+    search_results_free(results);
+    TEST_ASSERT_EQUAL_INT(EPERM, indexer_add_document(idx, "cherry", "doc4"));
+    TEST_ASSERT_EQUAL_INT(EPERM, indexer_set_key_weight(idx, "apple", 3));
+
+    // The next load without freezing is writable again
+    TEST_ASSERT_EQUAL_INT(0, indexer_enable_freeze(idx, false));
+    TEST_ASSERT_EQUAL_INT(0, indexer_load(idx, INDEXER_TEST_FILE));
+    TEST_ASSERT_EQUAL_INT(0, indexer_add_document(idx, "cherry", "doc4"));
+
+    TEST_ASSERT_EQUAL_INT(EINVAL, indexer_enable_freeze(NULL, true));
+    indexer_destroy(idx);
+}
+
+void test_double_array_load(void) {
+    Indexer* idx = indexer_create();
+    TEST_ASSERT_NOT_NULL(idx);
+    indexer_add_document(idx, "apple", "doc1");
+    indexer_add_document(idx, "apple", "doc2");
+    indexer_add_document(idx, "banana", "doc3");
+    TEST_ASSERT_EQUAL_INT(0, indexer_save_double_array(idx, INDEXER_TEST_FILE));
+
+    TEST_ASSERT_EQUAL_INT(0, indexer_load(idx, INDEXER_TEST_FILE));
+    TEST_ASSERT_EQUAL_size_t(2, indexer_get_key_count(idx));
+    TEST_ASSERT_EQUAL_size_t(3, indexer_get_doc_count(idx));
+    SearchResult* results = indexer_search(idx, "apple");
+    TEST_ASSERT_NOT_NULL(results);
+    TEST_ASSERT_NOT_NULL(results->next);
+    TEST_ASSERT_TRUE(strcmp(results->doc_id, results->next->doc_id) != 0);
+    TEST_ASSERT_NULL(results->next->next);
+    search_results_free(results);
+    TEST_ASSERT_NULL(indexer_search(idx, "cherry"));
+
+    const char* keys[] = {"banana", "pear", NULL};
+    SearchManyResult many[3];
+    TEST_ASSERT_EQUAL_INT(0, indexer_search_many(idx, keys, 3, many));
+    TEST_ASSERT_EQUAL_INT(0, many[0].err);
+    TEST_ASSERT_EQUAL_STRING("doc3", indexer_cursor_next(&many[0].cursor));
+    TEST_ASSERT_EQUAL_INT(ENOENT, many[1].err);
+    TEST_ASSERT_EQUAL_INT(EINVAL, many[2].err);
+    TEST_ASSERT_NULL(indexer_cursor_next(&many[2].cursor));
+    for (int i = 0; i < 3; i++) indexer_cursor_close(&many[i].cursor);
+
+    // Read-only, and only exact lookups
+    TEST_ASSERT_EQUAL_INT(EPERM, indexer_add_document(idx, "cherry", "doc4"));
+    TEST_ASSERT_EQUAL_INT(EPERM, indexer_set_key_weight(idx, "apple", 3));
+    CompletionResult completions[2];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(ENOTSUP, indexer_complete(idx, "app", completions, 2, &count));
+    TEST_ASSERT_EQUAL_size_t(0, count);
+    TEST_ASSERT_EQUAL_INT(ENOTSUP, indexer_save(idx, INDEXER_TEST_FILE ".trie"));
+
+    // Saving again writes the same array; a GTrie file loads as before
+    TEST_ASSERT_EQUAL_INT(0, indexer_save_double_array(idx, INDEXER_TEST_FILE));
+    Indexer* other = indexer_create();
+    indexer_add_document(other, "kiwi", "doc5");
+    TEST_ASSERT_EQUAL_INT(0, indexer_save(other, INDEXER_TEST_FILE ".trie"));
+    TEST_ASSERT_EQUAL_INT(0, indexer_load(other, INDEXER_TEST_FILE));
+    TEST_ASSERT_EQUAL_size_t(2, indexer_get_key_count(other));
+    TEST_ASSERT_EQUAL_INT(0, indexer_load(idx, INDEXER_TEST_FILE ".trie"));
+    TEST_ASSERT_EQUAL_INT(0, indexer_add_document(idx, "cherry", "doc4"));
+    unlink(INDEXER_TEST_FILE ".trie");
+
+    TEST_ASSERT_EQUAL_INT(EINVAL, indexer_save_double_array(NULL, INDEXER_TEST_FILE));
+    indexer_destroy(other);
+    indexer_destroy(idx);
+}
+
 int main(void) {
     UNITY_BEGIN();
     
@@ -285,6 +886,19 @@ int main(void) {
     RUN_TEST(test_error_cases);
     RUN_TEST(test_save_basic);
     RUN_TEST(test_save_and_load);
+    RUN_TEST(test_search_cache);
+    RUN_TEST(test_search_page);
+    RUN_TEST(test_search_cursor);
+    RUN_TEST(test_search_many);
+    RUN_TEST(test_search_fuzzy);
+    RUN_TEST(test_search_pattern);
+    RUN_TEST(test_search_pattern_sidecars);
+    RUN_TEST(test_search_ranked);
+    RUN_TEST(test_complete);
+    RUN_TEST(test_reload_pins_snapshot);
+    RUN_TEST(test_concurrent_reload);
+    RUN_TEST(test_freeze_on_load);
+    RUN_TEST(test_double_array_load);
     
     return UNITY_END();
 } 
\ No newline at end of file
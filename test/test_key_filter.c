@@ -0,0 +1,91 @@
+#include "../include/key_filter.h"
+#include "../include/gtrie.h"
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+
+#define FILTER_TEST_KEYS 20000
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Path hash of an ASCII key, as the trie computes it
+static uint64_t path_hash(const char* key) {
+    uint64_t h = KEY_FILTER_PATH_SEED;
+    for (const char* p = key; *p; p++) h = KEY_FILTER_PATH_STEP(h, (unsigned char)*p % ALPHABET_SIZE);
+    return h;
+}
+
+static void make_key(char* buf, size_t size, const char* prefix, int i) {
+    snprintf(buf, size, "%s%c%c%c%c", prefix, 'a' + i % 26, 'a' + i / 26 % 26,
+             'a' + i / 676 % 26, 'a' + i / 17576 % 26);
+}
+
+void test_no_false_negatives(void) {
+    int err = -1;
+    KeyFilter* filter = key_filter_create(FILTER_TEST_KEYS, &err);
+    TEST_ASSERT_NOT_NULL(filter);
+    TEST_ASSERT_EQUAL_INT(0, err);
+
+    char key[32];
+    for (int i = 0; i < FILTER_TEST_KEYS; i++) {
+        make_key(key, sizeof(key), "sku", i);
+        key_filter_add(filter, path_hash(key));
+    }
+    for (int i = 0; i < FILTER_TEST_KEYS; i++) {
+        make_key(key, sizeof(key), "sku", i);
+        TEST_ASSERT_TRUE(key_filter_may_contain(filter, path_hash(key)));
+    }
+    key_filter_destroy(filter);
+}
+
+void test_false_positive_rate(void) {
+    int err = -1;
+    KeyFilter* filter = key_filter_create(FILTER_TEST_KEYS, &err);
+    TEST_ASSERT_NOT_NULL(filter);
+    TEST_ASSERT_EQUAL_size_t((FILTER_TEST_KEYS * KEY_FILTER_BITS_PER_KEY + 255) / 256,
+                             key_filter_blocks(filter));
+
+    char key[32];
+    for (int i = 0; i < FILTER_TEST_KEYS; i++) {
+        make_key(key, sizeof(key), "sku", i);
+        key_filter_add(filter, path_hash(key));
+    }
+
+    // Keys under another prefix were never added
+    size_t false_positives = 0;
+    for (int i = 0; i < FILTER_TEST_KEYS; i++) {
+        make_key(key, sizeof(key), "upc", i);
+        if (key_filter_may_contain(filter, path_hash(key))) false_positives++;
+    }
+    TEST_ASSERT_TRUE(false_positives < FILTER_TEST_KEYS / 50);
+    key_filter_destroy(filter);
+}
+
+void test_create_errors(void) {
+    int err = 0;
+    TEST_ASSERT_NULL(key_filter_create_blocks(0, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+
+    // An empty filter still has one block and rejects everything
+    KeyFilter* filter = key_filter_create(0, &err);
+    TEST_ASSERT_NOT_NULL(filter);
+    TEST_ASSERT_EQUAL_size_t(1, key_filter_blocks(filter));
+    TEST_ASSERT_FALSE(key_filter_may_contain(filter, path_hash("anything")));
+    key_filter_destroy(filter);
+
+    // No filter admits everything
+    TEST_ASSERT_TRUE(key_filter_may_contain(NULL, path_hash("anything")));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_no_false_negatives);
+    RUN_TEST(test_false_positive_rate);
+    RUN_TEST(test_create_errors);
+
+    return UNITY_END();
+}
@@ -0,0 +1,191 @@
+#include "../include/logging.h"
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+
+#define LOGGING_TEST_FILE "test_logging.log"
+#define TEST_THREADS 4
+#define TEST_LINES_PER_THREAD 2000
+
+static int saved_stderr = -1;
+
+// Capture stderr in LOGGING_TEST_FILE for the duration of a test
+void setUp(void) {
+    fflush(stderr);
+    saved_stderr = dup(STDERR_FILENO);
+    int fd = open(LOGGING_TEST_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    TEST_ASSERT_TRUE(fd >= 0);
+    dup2(fd, STDERR_FILENO);
+    close(fd);
+    TEST_ASSERT_EQUAL_INT(0, log_init("test_logging", LOG_LEVEL_INFO, LOG_DEST_STDERR));
+}
+
+void tearDown(void) {
+    log_cleanup();
+    dup2(saved_stderr, STDERR_FILENO);
+    close(saved_stderr);
+    unlink(LOGGING_TEST_FILE);
+}
+
+static size_t count_lines(const char* needle) {
+    FILE* fp = fopen(LOGGING_TEST_FILE, "r");
+    TEST_ASSERT_NOT_NULL(fp);
+    char line[8192];
+    size_t n = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        if (strstr(line, needle)) n++;
+    }
+    fclose(fp);
+    return n;
+}
+
+static void* log_thread(void* arg) {
+    int thread = (int)(intptr_t)arg;
+    for (int i = 0; i < TEST_LINES_PER_THREAD; i++) {
+        ERROR_LOG("thread %d line %d", thread, i);
+    }
+    return NULL;
+}
+
+static void run_threads(void) {
+    pthread_t threads[TEST_THREADS];
+    for (int t = 0; t < TEST_THREADS; t++) {
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&threads[t], NULL, log_thread, (void*)(intptr_t)t));
+    }
+    for (int t = 0; t < TEST_THREADS; t++) pthread_join(threads[t], NULL);
+}
+
+void test_sync_format_and_level(void) {
+    INFO_LOG("hello %d", 42);
+    WARN_LOG("careful");
+    log_set_level(LOG_LEVEL_WARN);
+    INFO_LOG("hidden");
+
+    FILE* fp = fopen(LOGGING_TEST_FILE, "r");
+    TEST_ASSERT_NOT_NULL(fp);
+    char line[512];
+    TEST_ASSERT_NOT_NULL(fgets(line, sizeof(line), fp));
+    // "YYYY-MM-DD HH:MM:SS.uuuuuu [INFO ] file:line func(): msg"
+    TEST_ASSERT_TRUE(line[4] == '-' && line[10] == ' ' && line[19] == '.' && line[26] == ' ');
+    TEST_ASSERT_NOT_NULL(strstr(line, "[INFO ] "));
+    TEST_ASSERT_NOT_NULL(strstr(line, "test_sync_format_and_level(): hello 42\n"));
+    TEST_ASSERT_NOT_NULL(fgets(line, sizeof(line), fp));
+    TEST_ASSERT_NOT_NULL(strstr(line, "[WARN ] "));
+    TEST_ASSERT_NULL(fgets(line, sizeof(line), fp));
+    fclose(fp);
+}
+
+// One call site for every message
+static void log_repeated(int i) {
+    ERROR_LOG("repeated %d", i);
+}
+
+void test_rate_limit(void) {
+    log_set_rate_limit(10);
+    LogStats before, after;
+    log_get_stats(&before);
+    for (int i = 0; i < 1000; i++) log_repeated(i);
+    log_get_stats(&after);
+
+    // All 1000 fall into at most two seconds
+    size_t written = count_lines("repeated");
+    TEST_ASSERT_TRUE(written >= 10 && written <= 20);
+    TEST_ASSERT_EQUAL_UINT64(1000 - written, after.suppressed - before.suppressed);
+
+    // The next message after a new second reports what was held back
+    sleep(1);
+    log_repeated(-1);
+    TEST_ASSERT_EQUAL_size_t(1, count_lines("repeated -1 ("));
+    TEST_ASSERT_TRUE(count_lines("similar messages suppressed)") >= 1);
+    log_set_rate_limit(LOG_DEFAULT_RATE_LIMIT);
+}
+
+void test_async_block_keeps_everything(void) {
+    log_set_rate_limit(0);
+    TEST_ASSERT_EQUAL_INT(0, log_start_async(LOG_RING_MIN_BYTES, LOG_OVERFLOW_BLOCK));
+    run_threads();
+    log_flush();
+    TEST_ASSERT_EQUAL_size_t(TEST_THREADS * TEST_LINES_PER_THREAD, count_lines(" line "));
+
+    // Lines from each thread stay in order
+    FILE* fp = fopen(LOGGING_TEST_FILE, "r");
+    char line[512];
+    int next[TEST_THREADS] = { 0 };
+    while (fgets(line, sizeof(line), fp)) {
+        int thread, i;
+        const char* msg = strstr(line, "thread ");
+        TEST_ASSERT_NOT_NULL(msg);
+        TEST_ASSERT_EQUAL_INT(2, sscanf(msg, "thread %d line %d", &thread, &i));
+        TEST_ASSERT_EQUAL_INT(next[thread], i);
+        next[thread]++;
+    }
+    fclose(fp);
+    log_set_rate_limit(LOG_DEFAULT_RATE_LIMIT);
+}
+
+void test_async_drop_counts_losses(void) {
+    log_set_rate_limit(0);
+    LogStats before, after;
+    log_get_stats(&before);
+    TEST_ASSERT_EQUAL_INT(0, log_start_async(LOG_RING_MIN_BYTES, LOG_OVERFLOW_DROP));
+    run_threads();
+    log_flush();
+    log_get_stats(&after);
+    log_cleanup();  // Writes the drop report
+
+    size_t written = count_lines(" line ");
+    TEST_ASSERT_EQUAL_UINT64(TEST_THREADS * TEST_LINES_PER_THREAD, written + (after.dropped - before.dropped));
+    if (after.dropped > before.dropped) {
+        TEST_ASSERT_TRUE(count_lines("log messages dropped") >= 1);
+    }
+    log_init("test_logging", LOG_LEVEL_INFO, LOG_DEST_STDERR);
+    log_set_rate_limit(LOG_DEFAULT_RATE_LIMIT);
+}
+
+void test_cleanup_writes_queued_lines(void) {
+    log_set_rate_limit(0);
+    TEST_ASSERT_EQUAL_INT(0, log_start_async(LOG_RING_MIN_BYTES, LOG_OVERFLOW_BLOCK));
+    usleep(10000);  // Let the writer go idle first
+    run_threads();
+    log_cleanup();  // No log_flush: the writer's last drain must catch everything
+    TEST_ASSERT_EQUAL_size_t(TEST_THREADS * TEST_LINES_PER_THREAD, count_lines(" line "));
+    log_init("test_logging", LOG_LEVEL_INFO, LOG_DEST_STDERR);
+    log_set_rate_limit(LOG_DEFAULT_RATE_LIMIT);
+}
+
+void test_log_file(void) {
+    const char* path = "test_logging_file.log";
+    unlink(path);
+    log_cleanup();
+    TEST_ASSERT_EQUAL_INT(0, log_init("test_logging", LOG_LEVEL_INFO, LOG_DEST_FILE));
+    TEST_ASSERT_EQUAL_INT(0, log_set_file(path));
+    TEST_ASSERT_EQUAL_INT(0, log_start_async(0, LOG_OVERFLOW_BLOCK));
+    INFO_LOG("to the file");
+    log_flush();
+
+    FILE* fp = fopen(path, "r");
+    TEST_ASSERT_NOT_NULL(fp);
+    char line[512];
+    TEST_ASSERT_NOT_NULL(fgets(line, sizeof(line), fp));
+    TEST_ASSERT_NOT_NULL(strstr(line, "to the file\n"));
+    fclose(fp);
+    unlink(path);
+    TEST_ASSERT_EQUAL_size_t(0, count_lines("to the file"));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_sync_format_and_level);
+    RUN_TEST(test_rate_limit);
+    RUN_TEST(test_async_block_keeps_everything);
+    RUN_TEST(test_async_drop_counts_losses);
+    RUN_TEST(test_cleanup_writes_queued_lines);
+    RUN_TEST(test_log_file);
+
+    return UNITY_END();
+}
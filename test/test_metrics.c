@@ -0,0 +1,182 @@
+#include "../include/metrics.h"
+#include "../include/gtrie.h"
+#include "../include/indexer.h"
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#define TEST_THREADS 4
+#define TEST_RECORDS_PER_THREAD 10000
+
+static MetricsSnapshot before;
+static MetricsSnapshot after;
+
+void setUp(void) {
+    TEST_ASSERT_EQUAL_INT(0, metrics_snapshot(&before));
+}
+
+void tearDown(void) {
+}
+
+// Counts recorded for op since setUp
+static void take_delta(MetricOp op, MetricsHistogram* delta) {
+    TEST_ASSERT_EQUAL_INT(0, metrics_snapshot(&after));
+    const MetricsHistogram* a = &after.ops[op];
+    const MetricsHistogram* b = &before.ops[op];
+    delta->count = a->count - b->count;
+    delta->errors = a->errors - b->errors;
+    delta->samples = a->samples - b->samples;
+    delta->sum_ns = a->sum_ns - b->sum_ns;
+    delta->max_ns = a->max_ns;
+    for (size_t i = 0; i < METRICS_BUCKETS; i++) delta->buckets[i] = a->buckets[i] - b->buckets[i];
+}
+
+static char* write_to_string(MetricsFormat format) {
+    FILE* fp = tmpfile();
+    TEST_ASSERT_NOT_NULL(fp);
+    TEST_ASSERT_EQUAL_INT(0, metrics_write(fp, format));
+    long len = ftell(fp);
+    rewind(fp);
+    char* text = calloc((size_t)len + 1, 1);
+    TEST_ASSERT_EQUAL_size_t((size_t)len, fread(text, 1, (size_t)len, fp));
+    fclose(fp);
+    return text;
+}
+
+void test_percentiles(void) {
+    // No loads happen in this test binary, so the op is ours alone
+    for (uint64_t ns = 1; ns <= 10000; ns++) metrics_record(METRIC_GTRIE_LOAD, ns, ns % 100 == 0);
+
+    static MetricsHistogram delta;
+    take_delta(METRIC_GTRIE_LOAD, &delta);
+    TEST_ASSERT_EQUAL_UINT64(10000, delta.count);
+    TEST_ASSERT_EQUAL_UINT64(100, delta.errors);
+    TEST_ASSERT_EQUAL_UINT64(10000, delta.samples);
+    TEST_ASSERT_EQUAL_UINT64(10000ULL * 10001 / 2, delta.sum_ns);
+    TEST_ASSERT_EQUAL_UINT64(10000, delta.max_ns);
+
+    // Bucket limits are never below the true value and at most 1/16 above it
+    uint64_t p50 = metrics_percentile(&delta, 50);
+    uint64_t p99 = metrics_percentile(&delta, 99);
+    TEST_ASSERT_TRUE(p50 >= 5000 && p50 <= 5000 + 5000 / 16);
+    TEST_ASSERT_TRUE(p99 >= 9900 && p99 <= 10000);
+    TEST_ASSERT_EQUAL_UINT64(10000, metrics_percentile(&delta, 100));
+    TEST_ASSERT_EQUAL_UINT64(1, metrics_percentile(&delta, 0));
+
+    // Small values are exact, huge ones are clamped into the last bucket
+    metrics_record(METRIC_GTRIE_LOAD, 1ULL << 50, false);
+    take_delta(METRIC_GTRIE_LOAD, &delta);
+    TEST_ASSERT_EQUAL_UINT64(1, delta.buckets[METRICS_BUCKETS - 1]);
+    TEST_ASSERT_EQUAL_UINT64(1ULL << 50, metrics_percentile(&delta, 100));
+}
+
+void test_instrumented_operations(void) {
+    int err = 0;
+    GTrie* trie = gtrie_create(&err);
+    TEST_ASSERT_NOT_NULL(trie);
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, "apple", "d1"));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, "apple", "d2"));
+    TEST_ASSERT_EQUAL_INT(EINVAL, gtrie_insert(trie, NULL, "d3"));
+
+    TEST_ASSERT_NOT_NULL(gtrie_search(trie, "apple", &err));
+    TEST_ASSERT_NULL(gtrie_search(trie, "pear", &err));
+    TEST_ASSERT_EQUAL_INT(ENOENT, err);
+    TEST_ASSERT_NULL(gtrie_search(trie, NULL, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+    gtrie_destroy(trie);
+
+    static MetricsHistogram delta;
+    take_delta(METRIC_GTRIE_INSERT, &delta);
+#ifdef SEARCH_ENGINE_NO_METRICS
+    TEST_ASSERT_EQUAL_UINT64(0, delta.count);
+#else
+    TEST_ASSERT_EQUAL_UINT64(3, delta.count);
+    TEST_ASSERT_EQUAL_UINT64(1, delta.errors);
+
+    // A miss is not an error
+    take_delta(METRIC_GTRIE_SEARCH, &delta);
+    TEST_ASSERT_EQUAL_UINT64(3, delta.count);
+    TEST_ASSERT_EQUAL_UINT64(1, delta.errors);
+
+    // Every call is counted, one in METRICS_SAMPLE_PERIOD is timed
+    trie = gtrie_create(&err);
+    TEST_ASSERT_NOT_NULL(trie);
+    TEST_ASSERT_EQUAL_INT(0, metrics_snapshot(&before));
+    for (int i = 0; i < 10 * METRICS_SAMPLE_PERIOD; i++) gtrie_search(trie, "pear", &err);
+    gtrie_destroy(trie);
+    take_delta(METRIC_GTRIE_SEARCH, &delta);
+    TEST_ASSERT_EQUAL_UINT64(10 * METRICS_SAMPLE_PERIOD, delta.count);
+    TEST_ASSERT_EQUAL_UINT64(10, delta.samples);
+
+    Indexer* idx = indexer_create();
+    TEST_ASSERT_NOT_NULL(idx);
+    TEST_ASSERT_EQUAL_INT(0, indexer_add_document(idx, "apple", "d1"));
+    SearchResult* results = indexer_search(idx, "apple");
+    TEST_ASSERT_NOT_NULL(results);
+    search_results_free(results);
+    TEST_ASSERT_NULL(indexer_search(idx, "pear"));
+    indexer_destroy(idx);
+
+    take_delta(METRIC_INDEXER_SEARCH, &delta);
+    TEST_ASSERT_EQUAL_UINT64(2, delta.count);
+    TEST_ASSERT_EQUAL_UINT64(0, delta.errors);
+    TEST_ASSERT_EQUAL_UINT64(2, delta.samples);
+    TEST_ASSERT_TRUE(delta.sum_ns > 0);
+#endif
+}
+
+static void* record_thread(void* arg) {
+    (void)arg;
+    for (int i = 0; i < TEST_RECORDS_PER_THREAD; i++) metrics_record(METRIC_GTRIE_SAVE, 100, false);
+    return NULL;
+}
+
+void test_threads(void) {
+    // Two rounds: the second round's threads reuse the shards of the first
+    for (int round = 0; round < 2; round++) {
+        pthread_t threads[TEST_THREADS];
+        for (int t = 0; t < TEST_THREADS; t++) {
+            TEST_ASSERT_EQUAL_INT(0, pthread_create(&threads[t], NULL, record_thread, NULL));
+        }
+        for (int t = 0; t < TEST_THREADS; t++) pthread_join(threads[t], NULL);
+    }
+
+    static MetricsHistogram delta;
+    take_delta(METRIC_GTRIE_SAVE, &delta);
+    TEST_ASSERT_EQUAL_UINT64(2 * TEST_THREADS * TEST_RECORDS_PER_THREAD, delta.count);
+    TEST_ASSERT_EQUAL_UINT64(2 * TEST_THREADS * TEST_RECORDS_PER_THREAD * 100ULL, delta.sum_ns);
+}
+
+void test_output_formats(void) {
+    metrics_record(METRIC_GTRIE_SEARCH, 250, false);
+
+    char* json = write_to_string(METRICS_FORMAT_JSON);
+    TEST_ASSERT_TRUE(json[0] == '{');
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"gtrie_search\":{\"count\":"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"p999_ns\":"));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"gtrie_load\":"));
+    free(json);
+
+    char* text = write_to_string(METRICS_FORMAT_PROMETHEUS);
+    TEST_ASSERT_NOT_NULL(strstr(text, "# TYPE search_engine_op_duration_seconds summary\n"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "search_engine_op_duration_seconds{op=\"gtrie_search\",quantile=\"0.99\"} "));
+    TEST_ASSERT_NOT_NULL(strstr(text, "search_engine_op_duration_seconds_count{op=\"indexer_search\"} "));
+    TEST_ASSERT_NOT_NULL(strstr(text, "search_engine_op_errors_total{op=\"gtrie_insert\"} "));
+    free(text);
+
+    TEST_ASSERT_EQUAL_INT(EINVAL, metrics_write(NULL, METRICS_FORMAT_JSON));
+    TEST_ASSERT_EQUAL_STRING("indexer_search", metrics_op_name(METRIC_INDEXER_SEARCH));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_percentiles);
+    RUN_TEST(test_instrumented_operations);
+    RUN_TEST(test_threads);
+    RUN_TEST(test_output_formats);
+
+    return UNITY_END();
+}
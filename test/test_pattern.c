@@ -0,0 +1,214 @@
+#include "../include/pattern.h"
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+
+#define PATTERN_TEST_KEYS 3000
+
+static GTrie* trie;
+
+void setUp(void) {
+    int err = 0;
+    trie = gtrie_create(&err);
+    TEST_ASSERT_NOT_NULL(trie);
+}
+
+void tearDown(void) {
+    gtrie_destroy(trie);
+}
+
+static bool matches(const char* pattern, PatternSyntax syntax, const char* str) {
+    int err = 0;
+    Pattern* p = pattern_compile(pattern, syntax, &err);
+    TEST_ASSERT_NOT_NULL(p);
+    bool result = pattern_match(p, str);
+    pattern_free(p);
+    return result;
+}
+
+static int compile_error(const char* pattern, PatternSyntax syntax) {
+    int err = 0;
+    Pattern* p = pattern_compile(pattern, syntax, &err);
+    pattern_free(p);
+    return p ? 0 : err;
+}
+
+// Deterministic pseudo-random numbers
+static uint32_t next_random(uint32_t* state) {
+    *state = *state * 1103515245u + 12345u;
+    return (*state >> 16) & 0x7FFF;
+}
+
+void test_glob_match(void) {
+    TEST_ASSERT_TRUE(matches("key*", PATTERN_GLOB, "keyboard"));
+    TEST_ASSERT_TRUE(matches("key*", PATTERN_GLOB, "key"));
+    TEST_ASSERT_FALSE(matches("key*", PATTERN_GLOB, "monkey"));
+    TEST_ASSERT_TRUE(matches("*board", PATTERN_GLOB, "keyboard"));
+    TEST_ASSERT_TRUE(matches("k?y", PATTERN_GLOB, "key"));
+    TEST_ASSERT_FALSE(matches("k?y", PATTERN_GLOB, "ky"));
+    TEST_ASSERT_TRUE(matches("[a-c]at", PATTERN_GLOB, "bat"));
+    TEST_ASSERT_FALSE(matches("[a-c]at", PATTERN_GLOB, "rat"));
+    TEST_ASSERT_TRUE(matches("[!a-c]at", PATTERN_GLOB, "rat"));
+    TEST_ASSERT_TRUE(matches("a\\*b", PATTERN_GLOB, "a*b"));
+    TEST_ASSERT_FALSE(matches("a\\*b", PATTERN_GLOB, "axb"));
+    TEST_ASSERT_TRUE(matches("caf?", PATTERN_GLOB, "caf\xc3\xa9"));  // 'é' is one codepoint
+    TEST_ASSERT_EQUAL_INT(EINVAL, compile_error("[abc", PATTERN_GLOB));
+    TEST_ASSERT_EQUAL_INT(EINVAL, compile_error("[z-a]", PATTERN_GLOB));
+}
+
+void test_regex_match(void) {
+    TEST_ASSERT_TRUE(matches("board", PATTERN_REGEX, "keyboard"));  // Unanchored
+    TEST_ASSERT_FALSE(matches("^board", PATTERN_REGEX, "keyboard"));
+    TEST_ASSERT_TRUE(matches("^key", PATTERN_REGEX, "keyboard"));
+    TEST_ASSERT_FALSE(matches("key$", PATTERN_REGEX, "keyboard"));
+    TEST_ASSERT_TRUE(matches("^(cat|dog)s?$", PATTERN_REGEX, "dogs"));
+    TEST_ASSERT_FALSE(matches("^(cat|dog)s?$", PATTERN_REGEX, "cow"));
+    TEST_ASSERT_TRUE(matches("^a+b*$", PATTERN_REGEX, "aaa"));
+    TEST_ASSERT_FALSE(matches("^a+b*$", PATTERN_REGEX, "b"));
+    TEST_ASSERT_TRUE(matches("^\\d{3}-\\d{2,}$", PATTERN_REGEX, "555-1234"));
+    TEST_ASSERT_FALSE(matches("^\\d{3}-\\d{2,}$", PATTERN_REGEX, "55-1234"));
+    TEST_ASSERT_TRUE(matches("^x{1,3}$", PATTERN_REGEX, "xxx"));
+    TEST_ASSERT_FALSE(matches("^x{1,3}$", PATTERN_REGEX, "xxxx"));
+    TEST_ASSERT_TRUE(matches("^(ab){0,2}$", PATTERN_REGEX, ""));
+    TEST_ASSERT_TRUE(matches("^(ab){0,2}$", PATTERN_REGEX, "abab"));
+    TEST_ASSERT_TRUE(matches("^\\w+\\s\\w+$", PATTERN_REGEX, "hello world"));
+    TEST_ASSERT_TRUE(matches("^[^0-9]+$", PATTERN_REGEX, "abc"));
+    TEST_ASSERT_FALSE(matches("^[^0-9]+$", PATTERN_REGEX, "a1c"));
+    TEST_ASSERT_TRUE(matches("^a\\.b$", PATTERN_REGEX, "a.b"));
+    TEST_ASSERT_FALSE(matches("^a\\.b$", PATTERN_REGEX, "axb"));
+
+    TEST_ASSERT_EQUAL_INT(EINVAL, compile_error("(ab", PATTERN_REGEX));
+    TEST_ASSERT_EQUAL_INT(EINVAL, compile_error("ab)", PATTERN_REGEX));
+    TEST_ASSERT_EQUAL_INT(EINVAL, compile_error("*a", PATTERN_REGEX));
+    TEST_ASSERT_EQUAL_INT(EINVAL, compile_error("a{3,1}", PATTERN_REGEX));
+    TEST_ASSERT_EQUAL_INT(EINVAL, compile_error("a{1000}", PATTERN_REGEX));
+    TEST_ASSERT_EQUAL_INT(EINVAL, compile_error("a*{2}", PATTERN_REGEX));
+    TEST_ASSERT_EQUAL_INT(EINVAL, compile_error("a^b", PATTERN_REGEX));
+    TEST_ASSERT_EQUAL_INT(EINVAL, compile_error("\\", PATTERN_REGEX));
+    TEST_ASSERT_EQUAL_INT(EINVAL, compile_error("abc", (PatternSyntax)7));
+}
+
+void test_search_matches_brute_force(void) {
+    char keys[PATTERN_TEST_KEYS][12];
+    uint32_t seed = 7;
+    const char* alphabet = "abcdeAu01";  // 'A' and 'u' share a child slot
+    for (int i = 0; i < PATTERN_TEST_KEYS; i++) {
+        int len = 1 + (int)(next_random(&seed) % 8);
+        for (int j = 0; j < len; j++) {
+            keys[i][j] = alphabet[next_random(&seed) % strlen(alphabet)];
+        }
+        keys[i][len] = '\0';
+        TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, keys[i], "doc"));
+    }
+
+    const struct {
+        const char* pattern;
+        PatternSyntax syntax;
+    } cases[] = {
+        { "a*", PATTERN_GLOB },
+        { "*u?", PATTERN_GLOB },
+        { "[A-C]*[01]", PATTERN_GLOB },
+        { "^u", PATTERN_REGEX },
+        { "A.b", PATTERN_REGEX },
+        { "^(ab|ba)+$", PATTERN_REGEX },
+        { "^[abc]{2,3}\\d$", PATTERN_REGEX },
+        { "[^a-e]{3}", PATTERN_REGEX },
+    };
+
+    PatternMatch* out = malloc(PATTERN_TEST_KEYS * sizeof(PatternMatch));
+    TEST_ASSERT_NOT_NULL(out);
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        int err = 0;
+        Pattern* p = pattern_compile(cases[c].pattern, cases[c].syntax, &err);
+        TEST_ASSERT_NOT_NULL(p);
+
+        size_t count = 0;
+        int rc = gtrie_pattern_search(trie, p, out, PATTERN_TEST_KEYS, 0, &count);
+        TEST_ASSERT_TRUE(rc == 0 || rc == ENOENT);
+
+        // Keys sharing child slots share a node, so compare against stored keys
+        size_t stored = 0;
+        char** all = gtrie_prefix_search(trie, "", &stored, &err);
+        TEST_ASSERT_NOT_NULL(all);
+        size_t expected = 0;
+        for (size_t i = 0; i < stored; i++) {
+            if (pattern_match(p, all[i])) expected++;
+        }
+        free(all);
+        TEST_ASSERT_EQUAL_size_t(expected, count);
+        for (size_t i = 0; i < count; i++) {
+            TEST_ASSERT_TRUE(pattern_match(p, out[i].word));
+            TEST_ASSERT_TRUE(gtrie_search(trie, out[i].word, &err) == out[i].postings);
+        }
+        pattern_free(p);
+    }
+    free(out);
+}
+
+void test_search_limit_and_budget(void) {
+    char key[16];
+    for (int i = 0; i < 200; i++) {
+        snprintf(key, sizeof(key), "item%d", i);
+        TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, key, "doc"));
+    }
+
+    int err = 0;
+    Pattern* p = pattern_compile("item1*", PATTERN_GLOB, &err);
+    TEST_ASSERT_NOT_NULL(p);
+
+    PatternMatch out[200];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(0, gtrie_pattern_search(trie, p, out, 200, 0, &count));
+    TEST_ASSERT_EQUAL_size_t(111, count);  // item1, item10-19, item100-199
+
+    TEST_ASSERT_EQUAL_INT(0, gtrie_pattern_search(trie, p, out, 5, 0, &count));
+    TEST_ASSERT_EQUAL_size_t(5, count);
+
+    // A generous budget finishes the walk
+    TEST_ASSERT_EQUAL_INT(0, gtrie_pattern_search(trie, p, out, 200, 10000000, &count));
+    TEST_ASSERT_EQUAL_size_t(111, count);
+    pattern_free(p);
+
+    p = pattern_compile("^nothing$", PATTERN_REGEX, &err);
+    TEST_ASSERT_EQUAL_INT(ENOENT, gtrie_pattern_search(trie, p, out, 200, 0, &count));
+    TEST_ASSERT_EQUAL_size_t(0, count);
+    TEST_ASSERT_EQUAL_INT(EINVAL, gtrie_pattern_search(trie, p, out, 0, 0, &count));
+    TEST_ASSERT_EQUAL_INT(EINVAL, gtrie_pattern_search(NULL, p, out, 200, 0, &count));
+    pattern_free(p);
+}
+
+void test_search_times_out(void) {
+    // Deep chains so the walk visits many nodes before finishing
+    char key[32];
+    for (int i = 0; i < 20000; i++) {
+        snprintf(key, sizeof(key), "k%dx%dy%d", i % 97, i, i * 7);
+        TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, key, "doc"));
+    }
+
+    int err = 0;
+    Pattern* p = pattern_compile("*", PATTERN_GLOB, &err);
+    TEST_ASSERT_NOT_NULL(p);
+
+    PatternMatch* out = malloc(20000 * sizeof(PatternMatch));
+    TEST_ASSERT_NOT_NULL(out);
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(ETIMEDOUT, gtrie_pattern_search(trie, p, out, 20000, 1, &count));
+    TEST_ASSERT_TRUE(count < 20000);
+
+    free(out);
+    pattern_free(p);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_glob_match);
+    RUN_TEST(test_regex_match);
+    RUN_TEST(test_search_matches_brute_force);
+    RUN_TEST(test_search_limit_and_budget);
+    RUN_TEST(test_search_times_out);
+
+    return UNITY_END();
+}
@@ -0,0 +1,193 @@
+#include "../include/phrase.h"
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+
+#define PHRASE_TEST_DOCS 300
+#define PHRASE_TEST_LENGTH 40
+
+static GTrie* trie;
+
+void setUp(void) {
+    int err = 0;
+    trie = gtrie_create(&err);
+    TEST_ASSERT_NOT_NULL(trie);
+}
+
+void tearDown(void) {
+    gtrie_destroy(trie);
+}
+
+// Deterministic pseudo-random numbers
+static uint32_t next_random(uint32_t* state) {
+    *state = *state * 1103515245u + 12345u;
+    return (*state >> 16) & 0x7FFF;
+}
+
+static void add_text(const char* doc_id, const char* text) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", text);
+    uint32_t position = 0;
+    char* save = NULL;
+    for (char* t = strtok_r(buf, " ", &save); t; t = strtok_r(NULL, " ", &save)) {
+        TEST_ASSERT_EQUAL_INT(0, gtrie_insert_at(trie, t, doc_id, position++));
+    }
+}
+
+static size_t search(const char* const* terms, size_t n, uint32_t slop, const char** docs,
+                     PhraseStats* stats) {
+    size_t count = 0;
+    int rc = phrase_search(trie, terms, n, slop, docs, 16, &count, stats);
+    TEST_ASSERT_TRUE(rc == 0 || rc == ENOENT);
+    return count;
+}
+
+void test_exact_phrase(void) {
+    add_text("doc1", "the quick brown fox");
+    add_text("doc2", "the brown quick fox");
+    add_text("doc3", "quick and brown");
+
+    const char* docs[16];
+    const char* quick_brown[] = { "quick", "brown" };
+    TEST_ASSERT_EQUAL_size_t(1, search(quick_brown, 2, 0, docs, NULL));
+    TEST_ASSERT_EQUAL_STRING("doc1", docs[0]);
+
+    // One word allowed in between
+    TEST_ASSERT_EQUAL_size_t(2, search(quick_brown, 2, 1, docs, NULL));
+    TEST_ASSERT_EQUAL_STRING("doc1", docs[0]);
+    TEST_ASSERT_EQUAL_STRING("doc3", docs[1]);
+
+    // Order matters
+    const char* brown_quick[] = { "brown", "quick" };
+    TEST_ASSERT_EQUAL_size_t(1, search(brown_quick, 2, 0, docs, NULL));
+    TEST_ASSERT_EQUAL_STRING("doc2", docs[0]);
+
+    const char* single[] = { "fox" };
+    TEST_ASSERT_EQUAL_size_t(2, search(single, 1, 0, docs, NULL));
+
+    const char* repeated[] = { "the", "the" };
+    TEST_ASSERT_EQUAL_size_t(0, search(repeated, 2, 3, docs, NULL));
+}
+
+void test_proximity_needs_every_chain(void) {
+    // Greedily taking the first "b" after "a" misses the match through the second
+    add_text("doc1", "a b b x c");
+
+    const char* docs[16];
+    const char* terms[] = { "a", "b", "c" };
+    TEST_ASSERT_EQUAL_size_t(1, search(terms, 3, 1, docs, NULL));
+    TEST_ASSERT_EQUAL_size_t(0, search(terms, 3, 0, docs, NULL));
+}
+
+void test_positions_decoded_only_for_candidates(void) {
+    char doc[16];
+    for (int i = 0; i < 100; i++) {
+        snprintf(doc, sizeof(doc), "doc%d", i);
+        add_text(doc, i == 42 ? "common rare" : "common filler common");
+    }
+
+    const char* docs[16];
+    const char* terms[] = { "common", "rare" };
+    PhraseStats stats;
+    TEST_ASSERT_EQUAL_size_t(1, search(terms, 2, 0, docs, &stats));
+    TEST_ASSERT_EQUAL_STRING("doc42", docs[0]);
+    TEST_ASSERT_EQUAL_size_t(1, stats.candidates);
+    TEST_ASSERT_EQUAL_size_t(2, stats.decoded);
+    TEST_ASSERT_EQUAL_size_t(101, stats.postings);
+}
+
+void test_matches_brute_force(void) {
+    static uint8_t text[PHRASE_TEST_DOCS][PHRASE_TEST_LENGTH];
+    const char* words[] = { "w", "x", "y", "z", "v" };
+    char doc[16];
+    uint32_t seed = 3;
+    for (int d = 0; d < PHRASE_TEST_DOCS; d++) {
+        snprintf(doc, sizeof(doc), "doc%d", d);
+        for (uint32_t p = 0; p < PHRASE_TEST_LENGTH; p++) {
+            text[d][p] = (uint8_t)(next_random(&seed) % 5);
+            TEST_ASSERT_EQUAL_INT(0, gtrie_insert_at(trie, words[text[d][p]], doc, p));
+        }
+    }
+
+    const char** found = malloc(PHRASE_TEST_DOCS * sizeof(char*));
+    TEST_ASSERT_NOT_NULL(found);
+    for (int q = 0; q < 50; q++) {
+        size_t n = 2 + next_random(&seed) % 3;
+        uint32_t slop = next_random(&seed) % 3;
+        uint8_t ids[4];
+        const char* terms[4];
+        for (size_t t = 0; t < n; t++) {
+            ids[t] = (uint8_t)(next_random(&seed) % 5);
+            terms[t] = words[ids[t]];
+        }
+
+        // Exhaustive search over every chain of positions
+        size_t expected = 0;
+        for (int d = 0; d < PHRASE_TEST_DOCS; d++) {
+            bool reach[PHRASE_TEST_LENGTH];
+            for (int p = 0; p < PHRASE_TEST_LENGTH; p++) reach[p] = text[d][p] == ids[0];
+            for (size_t t = 1; t < n; t++) {
+                bool next[PHRASE_TEST_LENGTH] = { false };
+                for (int p = 0; p < PHRASE_TEST_LENGTH; p++) {
+                    if (!reach[p]) continue;
+                    for (uint32_t g = 1; g <= slop + 1 && p + (int)g < PHRASE_TEST_LENGTH; g++) {
+                        if (text[d][p + g] == ids[t]) next[p + g] = true;
+                    }
+                }
+                memcpy(reach, next, sizeof(reach));
+            }
+            bool any = false;
+            for (int p = 0; p < PHRASE_TEST_LENGTH; p++) any |= reach[p];
+            if (any) expected++;
+        }
+
+        size_t count = 0;
+        int rc = phrase_search(trie, terms, n, slop, found, PHRASE_TEST_DOCS, &count, NULL);
+        TEST_ASSERT_EQUAL_INT(expected ? 0 : ENOENT, rc);
+        TEST_ASSERT_EQUAL_size_t(expected, count);
+    }
+    free(found);
+}
+
+void test_error_cases(void) {
+    add_text("doc1", "alpha beta");
+
+    const char* docs[4];
+    const char* terms[] = { "alpha", "beta" };
+    const char* missing[] = { "alpha", "gamma" };
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(ENOENT, phrase_search(trie, missing, 2, 0, docs, 4, &count, NULL));
+    TEST_ASSERT_EQUAL_INT(EINVAL, phrase_search(trie, terms, 0, 0, docs, 4, &count, NULL));
+    TEST_ASSERT_EQUAL_INT(EINVAL, phrase_search(trie, terms, 2, 0, docs, 0, &count, NULL));
+    TEST_ASSERT_EQUAL_INT(EINVAL, phrase_search(NULL, terms, 2, 0, docs, 4, &count, NULL));
+
+    // Out-of-order positions and mixing with plain inserts are rejected
+    TEST_ASSERT_EQUAL_INT(EINVAL, gtrie_insert_at(trie, "alpha", "doc1", 0));
+    TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, "delta", "doc1"));
+    TEST_ASSERT_EQUAL_INT(EINVAL, gtrie_insert_at(trie, "delta", "doc1", 5));
+
+    // Plain postings never match a phrase
+    const char* plain[] = { "beta", "delta" };
+    TEST_ASSERT_EQUAL_INT(ENOENT, phrase_search(trie, plain, 2, 5, docs, 4, &count, NULL));
+
+    // Malformed encodings are reported
+    uint8_t truncated[] = { 0x85 };
+    uint8_t zero_delta[] = { 0x01, 0x00 };
+    uint32_t out[4];
+    TEST_ASSERT_EQUAL_INT(EINVAL, gtrie_decode_positions(truncated, 1, out, 4, &count));
+    TEST_ASSERT_EQUAL_INT(EINVAL, gtrie_decode_positions(zero_delta, 2, out, 4, &count));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_exact_phrase);
+    RUN_TEST(test_proximity_needs_every_chain);
+    RUN_TEST(test_positions_decoded_only_for_candidates);
+    RUN_TEST(test_matches_brute_force);
+    RUN_TEST(test_error_cases);
+
+    return UNITY_END();
+}
@@ -0,0 +1,103 @@
+#include "../include/placement.h"
+#include "../include/node_pool.h"
+#include "unity.h"
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+    placement_set_huge_pages(HUGE_PAGES_OFF);
+}
+
+static bool is_zero(const unsigned char* p, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (p[i]) return false;
+    }
+    return true;
+}
+
+void test_parse_huge_pages(void) {
+    HugePageMode mode = HUGE_PAGES_OFF;
+    TEST_ASSERT_EQUAL_INT(0, placement_parse_huge_pages("thp", &mode));
+    TEST_ASSERT_EQUAL_INT(HUGE_PAGES_TRANSPARENT, mode);
+    TEST_ASSERT_EQUAL_INT(0, placement_parse_huge_pages("hugetlb", &mode));
+    TEST_ASSERT_EQUAL_INT(HUGE_PAGES_EXPLICIT, mode);
+    TEST_ASSERT_EQUAL_INT(0, placement_parse_huge_pages("off", &mode));
+    TEST_ASSERT_EQUAL_INT(HUGE_PAGES_OFF, mode);
+    TEST_ASSERT_EQUAL_INT(EINVAL, placement_parse_huge_pages("always", &mode));
+    TEST_ASSERT_EQUAL_INT(EINVAL, placement_parse_huge_pages(NULL, &mode));
+}
+
+void test_map_is_aligned_and_zeroed(void) {
+    // hugetlb falls back to THP when no huge pages are reserved
+    HugePageMode modes[] = { HUGE_PAGES_OFF, HUGE_PAGES_TRANSPARENT, HUGE_PAGES_EXPLICIT };
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        size_t mapped = 0;
+        unsigned char* p = placement_map(PLACEMENT_HUGE_PAGE + 1, modes[m], &mapped);
+        TEST_ASSERT_NOT_NULL(p);
+        TEST_ASSERT_EQUAL_size_t(2 * PLACEMENT_HUGE_PAGE, mapped);
+        TEST_ASSERT_EQUAL_INT(0, (int)((uintptr_t)p % PLACEMENT_HUGE_PAGE));
+        TEST_ASSERT_TRUE(is_zero(p, mapped));
+        memset(p, 0xAB, mapped);
+        placement_unmap(p, mapped);
+    }
+
+    size_t mapped = 0;
+    TEST_ASSERT_NULL(placement_map(0, HUGE_PAGES_TRANSPARENT, &mapped));
+    TEST_ASSERT_NULL(placement_map(1, HUGE_PAGES_TRANSPARENT, NULL));
+}
+
+void test_node_pool_on_huge_pages(void) {
+    placement_set_huge_pages(HUGE_PAGES_TRANSPARENT);
+    TEST_ASSERT_EQUAL_INT(HUGE_PAGES_TRANSPARENT, placement_huge_pages());
+
+    // Trie-node sized objects: slabs soon reach the huge page threshold
+    const size_t object_size = 2048;
+    const size_t count = 8192;
+    NodePool* pool = node_pool_create(object_size, NULL);
+    TEST_ASSERT_NOT_NULL(pool);
+    for (size_t i = 0; i < count; i++) {
+        unsigned char* object = node_pool_alloc(pool);
+        TEST_ASSERT_NOT_NULL(object);
+        TEST_ASSERT_TRUE(is_zero(object, object_size));
+        memset(object, 0xCD, object_size);
+    }
+    TEST_ASSERT_EQUAL_size_t(count, node_pool_count(pool));
+    TEST_ASSERT_TRUE(node_pool_bytes(pool) >= count * object_size);
+    node_pool_destroy(pool);
+}
+
+static void* record_cpu(void* arg) {
+    *(int*)arg = 1;
+    return NULL;
+}
+
+void test_nodes(void) {
+    int nodes = placement_node_count();
+    TEST_ASSERT_GREATER_THAN(0, nodes);
+    TEST_ASSERT_TRUE(nodes <= PLACEMENT_MAX_NODES);
+
+    for (int n = 0; n < nodes; n++) {
+        int ran = 0;
+        int rc = placement_run_on_node(n, record_cpu, &ran);
+        // Memory-only nodes have no CPUs to run on
+        TEST_ASSERT_TRUE(rc == 0 || rc == ENOENT);
+        TEST_ASSERT_EQUAL_INT(rc == 0, ran);
+    }
+
+    TEST_ASSERT_EQUAL_INT(EINVAL, placement_bind_node(-1));
+    TEST_ASSERT_EQUAL_INT(EINVAL, placement_bind_node(nodes));
+    TEST_ASSERT_EQUAL_INT(EINVAL, placement_run_on_node(0, NULL, NULL));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_huge_pages);
+    RUN_TEST(test_map_is_aligned_and_zeroed);
+    RUN_TEST(test_node_pool_on_huge_pages);
+    RUN_TEST(test_nodes);
+    return UNITY_END();
+}
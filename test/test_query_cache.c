@@ -0,0 +1,186 @@
+#include "../include/query_cache.h"
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_create_destroy(void) {
+    int err = 0;
+    QueryCache* cache = query_cache_create(1024 * 1024, &err);
+    TEST_ASSERT_EQUAL_INT(0, err);
+    TEST_ASSERT_NOT_NULL(cache);
+
+    QueryCacheStats stats;
+    query_cache_get_stats(cache, &stats);
+    TEST_ASSERT_EQUAL_size_t(0, stats.entries);
+    TEST_ASSERT_EQUAL_size_t(1024 * 1024, stats.max_bytes);
+
+    query_cache_destroy(cache);
+
+    TEST_ASSERT_NULL(query_cache_create(0, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+}
+
+void test_insert_lookup(void) {
+    int err = 0;
+    QueryCache* cache = query_cache_create(1024 * 1024, &err);
+    TEST_ASSERT_NOT_NULL(cache);
+
+    char out[64];
+    size_t len = 0;
+    TEST_ASSERT_EQUAL_INT(ENOENT, query_cache_lookup(cache, "apple", 5, 1, out, sizeof(out), &len));
+
+    TEST_ASSERT_EQUAL_INT(0, query_cache_insert(cache, "apple", 5, 1, "doc1", 5));
+    TEST_ASSERT_EQUAL_INT(0, query_cache_lookup(cache, "apple", 5, 1, out, sizeof(out), &len));
+    TEST_ASSERT_EQUAL_size_t(5, len);
+    TEST_ASSERT_EQUAL_STRING("doc1", out);
+
+    // Replacing a value
+    TEST_ASSERT_EQUAL_INT(0, query_cache_insert(cache, "apple", 5, 1, "doc22", 6));
+    TEST_ASSERT_EQUAL_INT(0, query_cache_lookup(cache, "apple", 5, 1, out, sizeof(out), &len));
+    TEST_ASSERT_EQUAL_STRING("doc22", out);
+
+    // Empty values are valid (cached misses)
+    TEST_ASSERT_EQUAL_INT(0, query_cache_insert(cache, "none", 4, 1, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(0, query_cache_lookup(cache, "none", 4, 1, out, sizeof(out), &len));
+    TEST_ASSERT_EQUAL_size_t(0, len);
+
+    // Small output buffer reports the required size
+    TEST_ASSERT_EQUAL_INT(ENOSPC, query_cache_lookup(cache, "apple", 5, 1, out, 2, &len));
+    TEST_ASSERT_EQUAL_size_t(6, len);
+
+    QueryCacheStats stats;
+    query_cache_get_stats(cache, &stats);
+    TEST_ASSERT_EQUAL_INT(3, stats.hits);
+    TEST_ASSERT_EQUAL_INT(1, stats.misses);
+    TEST_ASSERT_EQUAL_size_t(2, stats.entries);
+
+    query_cache_destroy(cache);
+}
+
+void test_generation_invalidates(void) {
+    int err = 0;
+    QueryCache* cache = query_cache_create(1024 * 1024, &err);
+    TEST_ASSERT_NOT_NULL(cache);
+
+    char out[64];
+    size_t len = 0;
+    query_cache_insert(cache, "apple", 5, 7, "doc1", 5);
+    TEST_ASSERT_EQUAL_INT(0, query_cache_lookup(cache, "apple", 5, 7, out, sizeof(out), &len));
+    TEST_ASSERT_EQUAL_INT(ENOENT, query_cache_lookup(cache, "apple", 5, 8, out, sizeof(out), &len));
+
+    // The stale entry was dropped on lookup
+    QueryCacheStats stats;
+    query_cache_get_stats(cache, &stats);
+    TEST_ASSERT_EQUAL_size_t(0, stats.entries);
+    TEST_ASSERT_EQUAL_size_t(0, stats.bytes);
+
+    query_cache_destroy(cache);
+}
+
+void test_byte_bound_and_eviction(void) {
+    int err = 0;
+    const size_t max_bytes = 4096;
+    QueryCache* cache = query_cache_create(max_bytes, &err);
+    TEST_ASSERT_NOT_NULL(cache);
+
+    char key[32];
+    char value[100];
+    memset(value, 'x', sizeof(value));
+
+    for (int i = 0; i < 500; i++) {
+        int len = snprintf(key, sizeof(key), "key%d", i);
+        TEST_ASSERT_EQUAL_INT(0, query_cache_insert(cache, key, (size_t)len, 1, value, sizeof(value)));
+
+        QueryCacheStats stats;
+        query_cache_get_stats(cache, &stats);
+        TEST_ASSERT_LESS_OR_EQUAL(max_bytes, stats.bytes);
+    }
+
+    QueryCacheStats stats;
+    query_cache_get_stats(cache, &stats);
+    TEST_ASSERT_GREATER_THAN(0, stats.entries);
+    TEST_ASSERT_GREATER_THAN(0, stats.evictions + stats.rejections);
+
+    // Oversized values are never admitted
+    char big[8192] = {0};
+    TEST_ASSERT_EQUAL_INT(0, query_cache_insert(cache, "big", 3, 1, big, sizeof(big)));
+    char out[16];
+    size_t len = 0;
+    TEST_ASSERT_EQUAL_INT(ENOENT, query_cache_lookup(cache, "big", 3, 1, out, sizeof(out), &len));
+
+    query_cache_destroy(cache);
+}
+
+void test_frequent_keys_survive(void) {
+    int err = 0;
+    QueryCache* cache = query_cache_create(4096, &err);
+    TEST_ASSERT_NOT_NULL(cache);
+
+    char value[64];
+    memset(value, 'v', sizeof(value));
+    char out[128];
+    size_t len = 0;
+
+    // A hot key is looked up many times
+    query_cache_insert(cache, "hot", 3, 1, value, sizeof(value));
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL_INT(0, query_cache_lookup(cache, "hot", 3, 1, out, sizeof(out), &len));
+    }
+
+    // A scan of one-off keys must not flush it out
+    char key[32];
+    for (int i = 0; i < 1000; i++) {
+        int klen = snprintf(key, sizeof(key), "scan%d", i);
+        query_cache_lookup(cache, key, (size_t)klen, 1, out, sizeof(out), &len);
+        query_cache_insert(cache, key, (size_t)klen, 1, value, sizeof(value));
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, query_cache_lookup(cache, "hot", 3, 1, out, sizeof(out), &len));
+
+    query_cache_destroy(cache);
+}
+
+void test_clear(void) {
+    int err = 0;
+    QueryCache* cache = query_cache_create(1024 * 1024, &err);
+    TEST_ASSERT_NOT_NULL(cache);
+
+    query_cache_insert(cache, "a", 1, 1, "1", 2);
+    query_cache_insert(cache, "b", 1, 1, "2", 2);
+    query_cache_clear(cache);
+
+    QueryCacheStats stats;
+    query_cache_get_stats(cache, &stats);
+    TEST_ASSERT_EQUAL_size_t(0, stats.entries);
+    TEST_ASSERT_EQUAL_size_t(0, stats.bytes);
+    TEST_ASSERT_EQUAL_INT(2, stats.insertions);
+
+    // Still usable after clearing
+    char out[8];
+    size_t len = 0;
+    query_cache_insert(cache, "a", 1, 1, "1", 2);
+    TEST_ASSERT_EQUAL_INT(0, query_cache_lookup(cache, "a", 1, 1, out, sizeof(out), &len));
+
+    query_cache_destroy(cache);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_create_destroy);
+    RUN_TEST(test_insert_lookup);
+    RUN_TEST(test_generation_invalidates);
+    RUN_TEST(test_byte_bound_and_eviction);
+    RUN_TEST(test_frequent_keys_survive);
+    RUN_TEST(test_clear);
+
+    return UNITY_END();
+}
@@ -0,0 +1,155 @@
+#include "../include/query_replay.h"
+#include "../include/indexer.h"
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+
+static Indexer* idx;
+
+void setUp(void) {
+    idx = indexer_create();
+    TEST_ASSERT_NOT_NULL(idx);
+    indexer_add_document(idx, "apple", "doc1");
+    indexer_add_document(idx, "apple", "doc2");
+    indexer_add_document(idx, "apricot", "doc3");
+    indexer_add_document(idx, "banana", "doc2");
+}
+
+void tearDown(void) {
+    indexer_destroy(idx);
+}
+
+static QueryLog* read_log(const char* text) {
+    FILE* fp = fmemopen((void*)text, strlen(text), "r");
+    TEST_ASSERT_NOT_NULL(fp);
+    int err = -1;
+    QueryLog* log = query_log_read(fp, &err);
+    fclose(fp);
+    TEST_ASSERT_NOT_NULL(log);
+    TEST_ASSERT_EQUAL_INT(0, err);
+    return log;
+}
+
+void test_parse_log(void) {
+    QueryLog* log = read_log(
+        "apple\n"
+        "/search?q=b%61nana&offset=1&limit=5\n"
+        "GET /complete?limit=500&q=ap HTTP/1.1\r\n"
+        "/rank?q=apple+banana\n"
+        "\n"
+        "/bool?op=and&q=apple\n"
+        "/search?limit=x&q=apple\n"
+        "/search\n");
+
+    TEST_ASSERT_EQUAL_size_t(4, log->count);
+    TEST_ASSERT_EQUAL_size_t(4, log->skipped);
+
+    TEST_ASSERT_TRUE(log->queries[0].type == REPLAY_SEARCH);
+    TEST_ASSERT_EQUAL_STRING("apple", log->queries[0].text);
+    TEST_ASSERT_TRUE(log->queries[0].limit == SIZE_MAX);
+
+    TEST_ASSERT_TRUE(log->queries[1].type == REPLAY_SEARCH);
+    TEST_ASSERT_EQUAL_STRING("banana", log->queries[1].text);
+    TEST_ASSERT_EQUAL_size_t(1, log->queries[1].offset);
+    TEST_ASSERT_EQUAL_size_t(5, log->queries[1].limit);
+
+    TEST_ASSERT_TRUE(log->queries[2].type == REPLAY_COMPLETE);
+    TEST_ASSERT_EQUAL_STRING("ap", log->queries[2].text);
+    TEST_ASSERT_EQUAL_size_t(REPLAY_MAX_RESULTS, log->queries[2].limit);
+
+    TEST_ASSERT_TRUE(log->queries[3].type == REPLAY_RANK);
+    TEST_ASSERT_EQUAL_STRING("apple banana", log->queries[3].text);
+    TEST_ASSERT_EQUAL_size_t(10, log->queries[3].limit);
+
+    query_log_destroy(log);
+}
+
+void test_closed_loop(void) {
+    QueryLog* log = read_log("apple\nmissing\n/complete?q=ap\n/rank?q=apple+banana&limit=2\n");
+    ReplayConfig cfg;
+    replay_config_init(&cfg);
+    cfg.num_threads = 3;
+    cfg.num_queries = 1000;
+
+    ReplayReport report;
+    TEST_ASSERT_EQUAL_INT(0, query_replay_run(idx, log, &cfg, &report));
+    TEST_ASSERT_EQUAL_INT(3, report.threads);
+    TEST_ASSERT_EQUAL_UINT64(1000, report.queries);
+    TEST_ASSERT_EQUAL_UINT64(0, report.errors);  // A miss is not an error
+    TEST_ASSERT_TRUE(report.qps > 0);
+    TEST_ASSERT_TRUE(report.p50_ns <= report.p90_ns);
+    TEST_ASSERT_TRUE(report.p90_ns <= report.p99_ns);
+    TEST_ASSERT_TRUE(report.p99_ns <= report.p999_ns);
+    TEST_ASSERT_TRUE(report.p999_ns <= report.max_ns);
+
+    // One pass over the log by default
+    cfg.num_queries = 0;
+    TEST_ASSERT_EQUAL_INT(0, query_replay_run(idx, log, &cfg, &report));
+    TEST_ASSERT_EQUAL_UINT64(4, report.queries);
+
+    query_log_destroy(log);
+}
+
+void test_open_loop_follows_schedule(void) {
+    QueryLog* log = read_log("apple\nbanana\n");
+    ReplayConfig cfg;
+    replay_config_init(&cfg);
+    cfg.mode = REPLAY_OPEN_LOOP;
+    cfg.num_threads = 2;
+    cfg.target_qps = 10000;
+    cfg.num_queries = 500;
+
+    // 500 arrivals at 10k/s take about 50 ms, however fast the queries are
+    ReplayReport report;
+    TEST_ASSERT_EQUAL_INT(0, query_replay_run(idx, log, &cfg, &report));
+    TEST_ASSERT_EQUAL_UINT64(500, report.queries);
+    TEST_ASSERT_TRUE(report.elapsed_ns > 25000000ULL);
+    TEST_ASSERT_TRUE(report.qps < 20000);
+
+    char* text = NULL;
+    size_t len = 0;
+    FILE* fp = open_memstream(&text, &len);
+    replay_report_write(&report, &cfg, fp);
+    fclose(fp);
+    TEST_ASSERT_NOT_NULL(strstr(text, "\"mode\":\"open\""));
+    TEST_ASSERT_NOT_NULL(strstr(text, "\"queries\":500"));
+    free(text);
+
+    query_log_destroy(log);
+}
+
+void test_invalid_arguments(void) {
+    int err = 0;
+    TEST_ASSERT_NULL(query_log_read(NULL, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+
+    QueryLog* log = read_log("apple\n");
+    ReplayConfig cfg;
+    replay_config_init(&cfg);
+    ReplayReport report;
+    TEST_ASSERT_EQUAL_INT(EINVAL, query_replay_run(NULL, log, &cfg, &report));
+    TEST_ASSERT_EQUAL_INT(EINVAL, query_replay_run(idx, NULL, &cfg, &report));
+    cfg.mode = REPLAY_OPEN_LOOP;
+    cfg.target_qps = 0;
+    TEST_ASSERT_EQUAL_INT(EINVAL, query_replay_run(idx, log, &cfg, &report));
+    query_log_destroy(log);
+
+    // A log without replayable queries cannot be run
+    log = read_log("/health\n");
+    TEST_ASSERT_EQUAL_size_t(0, log->count);
+    replay_config_init(&cfg);
+    TEST_ASSERT_EQUAL_INT(EINVAL, query_replay_run(idx, log, &cfg, &report));
+    query_log_destroy(log);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_parse_log);
+    RUN_TEST(test_closed_loop);
+    RUN_TEST(test_open_loop_follows_schedule);
+    RUN_TEST(test_invalid_arguments);
+
+    return UNITY_END();
+}
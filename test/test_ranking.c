@@ -0,0 +1,198 @@
+#include "../include/ranking.h"
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <errno.h>
+
+#define RANK_TEST_DOCS 2000
+
+static GTrie* trie;
+
+void setUp(void) {
+    int err = 0;
+    trie = gtrie_create(&err);
+    TEST_ASSERT_NOT_NULL(trie);
+}
+
+void tearDown(void) {
+    gtrie_destroy(trie);
+}
+
+// Deterministic pseudo-random numbers
+static uint32_t next_random(uint32_t* state) {
+    *state = *state * 1103515245u + 12345u;
+    return (*state >> 16) & 0x7FFF;
+}
+
+// Exhaustive BM25 over every document, for comparison
+static double reference_score(const char* const* terms, size_t num_terms, uint32_t doc) {
+    size_t num_docs = doc_table_count(trie->docs);
+    double avg_len = (double)doc_table_total_length(trie->docs) / (double)num_docs;
+    double score = 0.0;
+    for (size_t t = 0; t < num_terms; t++) {
+        int err = 0;
+        PostingList* list = gtrie_search(trie, terms[t], &err);
+        if (!list) continue;
+        for (PostingEntry* e = list->head; e; e = e->next) {
+            if (e->doc == doc) {
+                score += rank_bm25_term_score(rank_bm25_idf(list->count, num_docs), e->tf,
+                                              doc_table_length(trie->docs, doc), avg_len);
+            }
+        }
+    }
+    return score;
+}
+
+static int compare_desc(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+static void check_against_reference(const char* const* terms, size_t num_terms, size_t k) {
+    RankedDoc out[64];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(0, rank_bm25_top_k(trie, terms, num_terms, k, out, &count, NULL));
+
+    size_t num_docs = doc_table_count(trie->docs);
+    double* expected = malloc(num_docs * sizeof(double));
+    size_t matching = 0;
+    for (uint32_t d = 0; d < num_docs; d++) {
+        expected[d] = reference_score(terms, num_terms, d);
+        if (expected[d] > 0.0) matching++;
+    }
+    qsort(expected, num_docs, sizeof(double), compare_desc);
+
+    TEST_ASSERT_EQUAL_size_t(matching < k ? matching : k, count);
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT_TRUE(fabs(expected[i] - out[i].score) < 1e-9);
+        uint32_t doc = 0;
+        TEST_ASSERT_EQUAL_INT(0, doc_table_find(trie->docs, out[i].doc_id, &doc));
+        TEST_ASSERT_TRUE(fabs(reference_score(terms, num_terms, doc) - out[i].score) < 1e-9);
+    }
+    free(expected);
+}
+
+void test_term_frequency(void) {
+    gtrie_insert(trie, "apple", "doc1");
+    gtrie_insert(trie, "apple", "doc1");
+    gtrie_insert(trie, "apple", "doc2");
+    gtrie_insert(trie, "pie", "doc1");
+    gtrie_insert(trie, "pie", "doc2");
+    gtrie_insert(trie, "tart", "doc2");
+
+    int err = 0;
+    PostingList* list = gtrie_search(trie, "apple", &err);
+    TEST_ASSERT_EQUAL_size_t(2, list->count);
+    TEST_ASSERT_EQUAL_STRING("doc2", list->head->doc_id);
+    TEST_ASSERT_EQUAL_UINT32(1, list->head->tf);
+    TEST_ASSERT_EQUAL_UINT32(2, list->head->next->tf);
+
+    uint32_t doc1 = 0;
+    TEST_ASSERT_EQUAL_INT(0, doc_table_find(trie->docs, "doc1", &doc1));
+    TEST_ASSERT_EQUAL_UINT32(3, doc_table_length(trie->docs, doc1));
+
+    // Same length: higher term frequency ranks first
+    const char* terms[] = {"apple"};
+    RankedDoc out[4];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(0, rank_bm25_top_k(trie, terms, 1, 4, out, &count, NULL));
+    TEST_ASSERT_EQUAL_size_t(2, count);
+    TEST_ASSERT_EQUAL_STRING("doc1", out[0].doc_id);
+    TEST_ASSERT_TRUE(out[0].score > out[1].score);
+}
+
+void test_matches_exhaustive(void) {
+    const char* vocabulary[] = {"red", "green", "blue", "shoe", "shirt", "hat", "sock", "coat"};
+    char doc_id[32];
+    uint32_t state = 42;
+    for (int d = 0; d < RANK_TEST_DOCS; d++) {
+        snprintf(doc_id, sizeof(doc_id), "doc%d", d);
+        int tokens = 1 + (int)(next_random(&state) % 12);
+        for (int t = 0; t < tokens; t++) {
+            // Skewed term distribution
+            uint32_t r = next_random(&state) % 64;
+            int term = r < 32 ? 0 : r < 48 ? 1 : r < 56 ? 2 : 3 + (int)(r % 5);
+            TEST_ASSERT_EQUAL_INT(0, gtrie_insert(trie, vocabulary[term], doc_id));
+        }
+    }
+
+    const char* q1[] = {"red"};
+    const char* q2[] = {"red", "sock"};
+    const char* q3[] = {"green", "shoe", "hat", "missing"};
+    check_against_reference(q1, 1, 10);
+    check_against_reference(q2, 2, 10);
+    check_against_reference(q3, 4, 25);
+    check_against_reference(q2, 2, 1);
+}
+
+void test_pruning_skips_postings(void) {
+    char doc_id[32];
+    for (int d = 0; d < RANK_TEST_DOCS; d++) {
+        snprintf(doc_id, sizeof(doc_id), "doc%d", d);
+        gtrie_insert(trie, "common", doc_id);
+        if (d % 100 == 0) {
+            for (int t = 0; t < 5; t++) gtrie_insert(trie, "rare", doc_id);
+        }
+    }
+
+    const char* terms[] = {"common", "rare"};
+    RankedDoc out[10];
+    size_t count = 0;
+    RankStats stats;
+    TEST_ASSERT_EQUAL_INT(0, rank_bm25_top_k(trie, terms, 2, 10, out, &count, &stats));
+    TEST_ASSERT_EQUAL_size_t(10, count);
+    TEST_ASSERT_EQUAL_size_t(RANK_TEST_DOCS + RANK_TEST_DOCS / 100, stats.postings);
+    TEST_ASSERT_LESS_THAN(stats.postings / 4, stats.scored);
+
+    // Every returned document contains the rare term
+    for (size_t i = 0; i < count; i++) {
+        uint32_t doc = 0;
+        TEST_ASSERT_EQUAL_INT(0, doc_table_find(trie->docs, out[i].doc_id, &doc));
+        TEST_ASSERT_EQUAL_INT(0, atoi(out[i].doc_id + 3) % 100);
+    }
+    check_against_reference(terms, 2, 10);
+}
+
+void test_view_rebuilt_after_insert(void) {
+    gtrie_insert(trie, "lamp", "doc1");
+    gtrie_insert(trie, "lamp", "doc2");
+
+    const char* terms[] = {"lamp"};
+    RankedDoc out[4];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL_INT(0, rank_bm25_top_k(trie, terms, 1, 4, out, &count, NULL));
+    TEST_ASSERT_EQUAL_size_t(2, count);
+
+    gtrie_insert(trie, "lamp", "doc3");
+    gtrie_insert(trie, "lamp", "doc3");
+    TEST_ASSERT_EQUAL_INT(0, rank_bm25_top_k(trie, terms, 1, 4, out, &count, NULL));
+    TEST_ASSERT_EQUAL_size_t(3, count);
+    TEST_ASSERT_EQUAL_STRING("doc3", out[0].doc_id);
+}
+
+void test_error_cases(void) {
+    const char* terms[] = {"nothing"};
+    const char* invalid[] = {"\xFF"};
+    RankedDoc out[4];
+    size_t count = 1;
+
+    TEST_ASSERT_EQUAL_INT(ENOENT, rank_bm25_top_k(trie, terms, 1, 4, out, &count, NULL));
+    TEST_ASSERT_EQUAL_size_t(0, count);
+    TEST_ASSERT_EQUAL_INT(EINVAL, rank_bm25_top_k(trie, terms, 1, 0, out, &count, NULL));
+    TEST_ASSERT_EQUAL_INT(EINVAL, rank_bm25_top_k(NULL, terms, 1, 4, out, &count, NULL));
+    TEST_ASSERT_EQUAL_INT(EINVAL, rank_bm25_top_k(trie, invalid, 1, 4, out, &count, NULL));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_term_frequency);
+    RUN_TEST(test_matches_exhaustive);
+    RUN_TEST(test_pruning_skips_postings);
+    RUN_TEST(test_view_rebuilt_after_insert);
+    RUN_TEST(test_error_cases);
+
+    return UNITY_END();
+}
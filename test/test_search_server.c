@@ -0,0 +1,338 @@
+#include "../include/search_server.h"
+#include "../include/indexer.h"
+#include "../include/placement.h"
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+static Indexer* idx;
+static SearchServer* srv;
+
+void setUp(void) {
+    idx = indexer_create();
+    TEST_ASSERT_NOT_NULL(idx);
+    indexer_add_document(idx, "apple", "doc1");
+    indexer_add_document(idx, "apple", "doc2");
+    indexer_add_document(idx, "banana", "doc3");
+    indexer_add_document(idx, "café", "doc4");
+
+    SearchServerConfig cfg;
+    search_server_config_init(&cfg);
+    cfg.bind_addr = "127.0.0.1";
+    cfg.port = 0;
+    cfg.num_workers = 2;
+    cfg.cache_bytes = 1024 * 1024;
+
+    int err = 0;
+    srv = search_server_create(idx, &cfg, &err);
+    TEST_ASSERT_EQUAL_INT(0, err);
+    TEST_ASSERT_NOT_NULL(srv);
+    TEST_ASSERT_EQUAL_INT(0, search_server_start(srv));
+    TEST_ASSERT_GREATER_THAN(0, search_server_port(srv));
+}
+
+void tearDown(void) {
+    search_server_destroy(srv);
+    indexer_destroy(idx);
+    srv = NULL;
+    idx = NULL;
+}
+
+static int connect_server(void) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(search_server_port(srv));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL_INT(0, connect(fd, (struct sockaddr*)&addr, sizeof(addr)));
+    return fd;
+}
+
+static void send_all(int fd, const char* data) {
+    size_t len = strlen(data);
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, 0);
+        TEST_ASSERT_GREATER_THAN(0, n);
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+// Read one response; returns status and copies the body into body
+static int read_response(int fd, char* body, size_t body_size) {
+    static char buf[8192];
+    static size_t buf_len = 0;
+    static int buf_fd = -1;
+
+    if (buf_fd != fd) {
+        buf_len = 0;
+        buf_fd = fd;
+    }
+
+    for (;;) {
+        buf[buf_len] = '\0';
+        char* head_end = strstr(buf, "\r\n\r\n");
+        if (head_end) {
+            size_t head_len = (size_t)(head_end - buf) + 4;
+            const char* cl = strstr(buf, "Content-Length: ");
+            TEST_ASSERT_NOT_NULL(cl);
+            size_t content_length = strtoul(cl + 16, NULL, 10);
+
+            if (buf_len >= head_len + content_length) {
+                int status = atoi(buf + 9);
+                TEST_ASSERT_LESS_THAN(body_size, content_length);
+                memcpy(body, buf + head_len, content_length);
+                body[content_length] = '\0';
+
+                size_t used = head_len + content_length;
+                memmove(buf, buf + used, buf_len - used);
+                buf_len -= used;
+                return status;
+            }
+        }
+
+        ssize_t n = recv(fd, buf + buf_len, sizeof(buf) - buf_len - 1, 0);
+        if (n <= 0) return -1;
+        buf_len += (size_t)n;
+    }
+}
+
+void test_search_hit(void) {
+    int fd = connect_server();
+    char body[1024];
+
+    send_all(fd, "GET /search?q=banana HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(200, read_response(fd, body, sizeof(body)));
+    TEST_ASSERT_EQUAL_STRING("{\"key\":\"banana\",\"results\":[\"doc3\"],\"count\":1,\"total\":1}", body);
+
+    close(fd);
+}
+
+void test_search_miss(void) {
+    int fd = connect_server();
+    char body[1024];
+
+    send_all(fd, "GET /search?q=orange HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(200, read_response(fd, body, sizeof(body)));
+    TEST_ASSERT_EQUAL_STRING("{\"key\":\"orange\",\"results\":[],\"count\":0,\"total\":0}", body);
+
+    close(fd);
+}
+
+void test_search_pagination(void) {
+    int fd = connect_server();
+    char body[1024];
+
+    // Postings are returned most recent first: doc2, doc1
+    send_all(fd, "GET /search?q=apple&limit=1 HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(200, read_response(fd, body, sizeof(body)));
+    TEST_ASSERT_EQUAL_STRING("{\"key\":\"apple\",\"results\":[\"doc2\"],\"count\":1,\"total\":2}", body);
+
+    send_all(fd, "GET /search?q=apple&offset=1&limit=1 HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(200, read_response(fd, body, sizeof(body)));
+    TEST_ASSERT_EQUAL_STRING("{\"key\":\"apple\",\"results\":[\"doc1\"],\"count\":1,\"total\":2}", body);
+
+    send_all(fd, "GET /search?q=apple&offset=5 HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(200, read_response(fd, body, sizeof(body)));
+    TEST_ASSERT_EQUAL_STRING("{\"key\":\"apple\",\"results\":[],\"count\":0,\"total\":2}", body);
+
+    send_all(fd, "GET /search?q=apple&limit=x HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(400, read_response(fd, body, sizeof(body)));
+
+    close(fd);
+}
+
+void test_response_cache(void) {
+    int fd = connect_server();
+    char first[1024];
+    char second[1024];
+
+    send_all(fd, "GET /search?q=banana HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(200, read_response(fd, first, sizeof(first)));
+    send_all(fd, "GET /search?q=banana HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(200, read_response(fd, second, sizeof(second)));
+    TEST_ASSERT_EQUAL_STRING(first, second);
+
+    QueryCacheStats stats;
+    TEST_ASSERT_EQUAL_INT(0, search_server_cache_stats(srv, &stats));
+    TEST_ASSERT_EQUAL_INT(1, stats.hits);
+    TEST_ASSERT_EQUAL_INT(1, stats.misses);
+
+    // An index change invalidates the cached body
+    indexer_add_document(idx, "banana", "doc5");
+    send_all(fd, "GET /search?q=banana HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(200, read_response(fd, second, sizeof(second)));
+    TEST_ASSERT_NOT_NULL(strstr(second, "doc5"));
+
+    close(fd);
+}
+
+void test_complete(void) {
+    indexer_add_document(idx, "apricot", "doc5");
+    indexer_set_key_weight(idx, "apple", 50);
+    indexer_set_key_weight(idx, "apricot", 70);
+
+    int fd = connect_server();
+    char body[1024];
+
+    send_all(fd, "GET /complete?q=ap HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(200, read_response(fd, body, sizeof(body)));
+    TEST_ASSERT_EQUAL_STRING("{\"prefix\":\"ap\",\"completions\":["
+                             "{\"key\":\"apricot\",\"weight\":70,\"total\":1},"
+                             "{\"key\":\"apple\",\"weight\":50,\"total\":2}]}", body);
+
+    send_all(fd, "GET /complete?q=ap&limit=1 HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(200, read_response(fd, body, sizeof(body)));
+    TEST_ASSERT_EQUAL_STRING("{\"prefix\":\"ap\",\"completions\":["
+                             "{\"key\":\"apricot\",\"weight\":70,\"total\":1}]}", body);
+
+    send_all(fd, "GET /complete?q=zz HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(200, read_response(fd, body, sizeof(body)));
+    TEST_ASSERT_EQUAL_STRING("{\"prefix\":\"zz\",\"completions\":[]}", body);
+
+    send_all(fd, "GET /complete?q=ap&limit=0 HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(400, read_response(fd, body, sizeof(body)));
+
+    close(fd);
+}
+
+void test_keep_alive_and_pipelining(void) {
+    int fd = connect_server();
+    char body[1024];
+
+    // Sequential requests on one connection
+    for (int i = 0; i < 10; i++) {
+        send_all(fd, "GET /search?q=apple HTTP/1.1\r\n\r\n");
+        TEST_ASSERT_EQUAL_INT(200, read_response(fd, body, sizeof(body)));
+        TEST_ASSERT_NOT_NULL(strstr(body, "\"count\":2"));
+    }
+
+    // Pipelined requests in a single write
+    send_all(fd, "GET /search?q=banana HTTP/1.1\r\n\r\n"
+                 "GET /health HTTP/1.1\r\n\r\n"
+                 "GET /search?q=caf%C3%A9 HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(200, read_response(fd, body, sizeof(body)));
+    TEST_ASSERT_NOT_NULL(strstr(body, "doc3"));
+    TEST_ASSERT_EQUAL_INT(200, read_response(fd, body, sizeof(body)));
+    TEST_ASSERT_NOT_NULL(strstr(body, "\"status\":\"ok\""));
+    TEST_ASSERT_EQUAL_INT(200, read_response(fd, body, sizeof(body)));
+    TEST_ASSERT_NOT_NULL(strstr(body, "doc4"));
+
+    close(fd);
+}
+
+void test_connection_close(void) {
+    int fd = connect_server();
+    char body[1024];
+
+    send_all(fd, "GET /search?q=apple HTTP/1.1\r\nConnection: close\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(200, read_response(fd, body, sizeof(body)));
+
+    // Server closes after the response
+    char tmp[16];
+    TEST_ASSERT_EQUAL_INT(0, recv(fd, tmp, sizeof(tmp), 0));
+    close(fd);
+}
+
+void test_error_responses(void) {
+    int fd = connect_server();
+    char body[1024];
+
+    send_all(fd, "GET /nowhere HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(404, read_response(fd, body, sizeof(body)));
+
+    send_all(fd, "GET /search HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(400, read_response(fd, body, sizeof(body)));
+
+    send_all(fd, "POST /search?q=apple HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc");
+    TEST_ASSERT_EQUAL_INT(405, read_response(fd, body, sizeof(body)));
+
+    // Connection is still usable after those errors
+    send_all(fd, "GET /search?q=apple HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(200, read_response(fd, body, sizeof(body)));
+
+    // Malformed request line closes the connection
+    send_all(fd, "garbage\r\n\r\n");
+    TEST_ASSERT_EQUAL_INT(400, read_response(fd, body, sizeof(body)));
+
+    close(fd);
+}
+
+void test_numa_replicas(void) {
+    // Replace the fixture server with one serving a replica per node
+    search_server_destroy(srv);
+    int nodes = placement_node_count();
+    TEST_ASSERT_GREATER_THAN(0, nodes);
+    Indexer* replicas[PLACEMENT_MAX_NODES];
+    replicas[0] = idx;
+    for (int n = 1; n < nodes; n++) {
+        replicas[n] = indexer_create();
+        TEST_ASSERT_NOT_NULL(replicas[n]);
+        indexer_add_document(replicas[n], "banana", "doc3");
+    }
+
+    SearchServerConfig cfg;
+    search_server_config_init(&cfg);
+    cfg.bind_addr = "127.0.0.1";
+    cfg.port = 0;
+    cfg.num_workers = 2 * nodes;
+    cfg.replicas = replicas;
+    cfg.num_replicas = nodes;
+
+    int err = 0;
+    srv = search_server_create(NULL, &cfg, &err);
+    TEST_ASSERT_EQUAL_INT(0, err);
+    TEST_ASSERT_NOT_NULL(srv);
+    TEST_ASSERT_EQUAL_INT(0, search_server_start(srv));
+
+    for (int i = 0; i < 4; i++) {
+        int fd = connect_server();
+        char body[1024];
+        send_all(fd, "GET /search?q=banana HTTP/1.1\r\n\r\n");
+        TEST_ASSERT_EQUAL_INT(200, read_response(fd, body, sizeof(body)));
+        TEST_ASSERT_EQUAL_STRING("{\"key\":\"banana\",\"results\":[\"doc3\"],\"count\":1,\"total\":1}", body);
+        close(fd);
+    }
+
+    search_server_destroy(srv);
+    srv = NULL;
+    for (int n = 1; n < nodes; n++) indexer_destroy(replicas[n]);
+
+    // More replicas than nodes
+    cfg.num_replicas = nodes + 1;
+    TEST_ASSERT_NULL(search_server_create(NULL, &cfg, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+}
+
+void test_invalid_arguments(void) {
+    int err = 0;
+    TEST_ASSERT_NULL(search_server_create(NULL, NULL, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+    TEST_ASSERT_EQUAL_INT(EINVAL, search_server_start(NULL));
+    TEST_ASSERT_EQUAL_INT(0, search_server_port(NULL));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_search_hit);
+    RUN_TEST(test_search_miss);
+    RUN_TEST(test_search_pagination);
+    RUN_TEST(test_response_cache);
+    RUN_TEST(test_complete);
+    RUN_TEST(test_keep_alive_and_pipelining);
+    RUN_TEST(test_connection_close);
+    RUN_TEST(test_error_responses);
+    RUN_TEST(test_numa_replicas);
+    RUN_TEST(test_invalid_arguments);
+
+    return UNITY_END();
+}
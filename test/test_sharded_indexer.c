@@ -0,0 +1,252 @@
+#include "../include/sharded_indexer.h"
+#include "../include/node_pool.h"
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define TEST_SHARDS 4
+#define TEST_THREADS 4
+#define TEST_KEYS_PER_THREAD 200
+#define TEST_MANIFEST "test_sharded.idx"
+
+static ShardedIndexer* si;
+
+void setUp(void) {
+    si = sharded_indexer_create(TEST_SHARDS);
+    TEST_ASSERT_NOT_NULL(si);
+}
+
+void tearDown(void) {
+    sharded_indexer_destroy(si);
+}
+
+static size_t result_count(SearchResult* results) {
+    size_t n = 0;
+    for (SearchResult* r = results; r; r = r->next) n++;
+    return n;
+}
+
+static void make_key(char* buf, size_t size, int thread, int i) {
+    // Letters only; the trie maps codepoints into 26 slots
+    snprintf(buf, size, "key%c%c%c", 'a' + thread, 'a' + i / 26 % 26, 'a' + i % 26);
+}
+
+void test_routing(void) {
+    TEST_ASSERT_EQUAL_size_t(TEST_SHARDS, sharded_indexer_shard_count(si));
+
+    size_t used[TEST_SHARDS] = { 0 };
+    char key[16];
+    for (int i = 0; i < 200; i++) {
+        make_key(key, sizeof(key), 0, i);
+        size_t shard = sharded_indexer_shard_of(si, key);
+        TEST_ASSERT_TRUE(shard < TEST_SHARDS);
+        TEST_ASSERT_EQUAL_size_t(shard, sharded_indexer_shard_of(si, key));
+        used[shard]++;
+    }
+    for (int s = 0; s < TEST_SHARDS; s++) TEST_ASSERT_TRUE(used[s] > 0);
+
+    ShardedIndexer* cpus = sharded_indexer_create(0);
+    TEST_ASSERT_NOT_NULL(cpus);
+    TEST_ASSERT_TRUE(sharded_indexer_shard_count(cpus) >= 1);
+    sharded_indexer_destroy(cpus);
+
+    TEST_ASSERT_NULL(sharded_indexer_create(SHARDED_MAX_SHARDS + 1));
+}
+
+static void* add_thread(void* arg) {
+    int thread = (int)(intptr_t)arg;
+    char key[16];
+    char doc[16];
+    for (int i = 0; i < TEST_KEYS_PER_THREAD; i++) {
+        make_key(key, sizeof(key), thread, i);
+        snprintf(doc, sizeof(doc), "doc%d", i);
+        if (sharded_indexer_add_document(si, key, doc) != 0) return (void*)1;
+        if (sharded_indexer_add_document(si, "shared", doc) != 0) return (void*)1;
+    }
+    return NULL;
+}
+
+void test_concurrent_adds(void) {
+    pthread_t threads[TEST_THREADS];
+    for (int t = 0; t < TEST_THREADS; t++) {
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&threads[t], NULL, add_thread, (void*)(intptr_t)t));
+    }
+    for (int t = 0; t < TEST_THREADS; t++) {
+        void* failed = NULL;
+        pthread_join(threads[t], &failed);
+        TEST_ASSERT_NULL(failed);
+    }
+
+    TEST_ASSERT_EQUAL_size_t(TEST_THREADS * TEST_KEYS_PER_THREAD + 1, sharded_indexer_get_key_count(si));
+
+    SearchCursor cursor;
+    TEST_ASSERT_EQUAL_INT(0, sharded_indexer_cursor_open(si, "shared", &cursor));
+    TEST_ASSERT_EQUAL_size_t(TEST_KEYS_PER_THREAD, cursor.total);
+    indexer_cursor_close(&cursor);
+
+    char key[16];
+    make_key(key, sizeof(key), 2, 7);
+    TEST_ASSERT_EQUAL_INT(0, sharded_indexer_cursor_open(si, key, &cursor));
+    TEST_ASSERT_EQUAL_STRING("doc7", indexer_cursor_next(&cursor));
+    indexer_cursor_close(&cursor);
+}
+
+void test_batch_and_search_many(void) {
+    const char* keys[] = { "apple", "banana", "cherry", "apple", "date", NULL };
+    const char* docs[] = { "d1", "d2", "d3", "d4", "d5", "d6" };
+    size_t failed = 0;
+    TEST_ASSERT_EQUAL_INT(0, sharded_indexer_add_batch(si, keys, docs, 6, &failed));
+    TEST_ASSERT_EQUAL_size_t(1, failed);
+    TEST_ASSERT_EQUAL_size_t(4, sharded_indexer_get_key_count(si));
+    TEST_ASSERT_EQUAL_size_t(5, sharded_indexer_get_doc_count(si));
+
+    const char* queries[] = { "date", "apple", "missing", "cherry" };
+    SearchManyResult results[4];
+    TEST_ASSERT_EQUAL_INT(0, sharded_indexer_search_many(si, queries, 4, results));
+    TEST_ASSERT_EQUAL_INT(0, results[0].err);
+    TEST_ASSERT_EQUAL_size_t(1, results[0].cursor.total);
+    TEST_ASSERT_EQUAL_INT(0, results[1].err);
+    TEST_ASSERT_EQUAL_size_t(2, results[1].cursor.total);
+    TEST_ASSERT_EQUAL_INT(ENOENT, results[2].err);
+    TEST_ASSERT_EQUAL_INT(0, results[3].err);
+    TEST_ASSERT_EQUAL_STRING("d3", indexer_cursor_next(&results[3].cursor));
+    for (int i = 0; i < 4; i++) indexer_cursor_close(&results[i].cursor);
+
+    TEST_ASSERT_EQUAL_INT(EINVAL, sharded_indexer_add_batch(NULL, keys, docs, 1, NULL));
+}
+
+void test_boolean_queries(void) {
+    // Keys spread over shards; each doc's keys are encoded in its name
+    const char* pairs[][2] = {
+        { "red", "d1" }, { "green", "d1" }, { "blue", "d1" },
+        { "red", "d2" }, { "blue", "d2" },
+        { "green", "d3" },
+        { "red", "d4" }, { "green", "d4" },
+    };
+    for (size_t i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++) {
+        TEST_ASSERT_EQUAL_INT(0, sharded_indexer_add_document(si, pairs[i][0], pairs[i][1]));
+    }
+
+    int err = -1;
+    const char* red_green[] = { "red", "green" };
+    SearchResult* results = sharded_indexer_search_bool(si, red_green, 2, SHARD_QUERY_AND, &err);
+    TEST_ASSERT_EQUAL_INT(0, err);
+    TEST_ASSERT_EQUAL_size_t(2, result_count(results));
+    TEST_ASSERT_EQUAL_STRING("d1", results->doc_id);
+    TEST_ASSERT_EQUAL_STRING("d4", results->next->doc_id);
+    search_results_free(results);
+
+    results = sharded_indexer_search_bool(si, red_green, 2, SHARD_QUERY_OR, &err);
+    TEST_ASSERT_EQUAL_INT(0, err);
+    TEST_ASSERT_EQUAL_size_t(4, result_count(results));
+    const char* expected[] = { "d1", "d2", "d3", "d4" };
+    size_t i = 0;
+    for (SearchResult* r = results; r; r = r->next) TEST_ASSERT_EQUAL_STRING(expected[i++], r->doc_id);
+    search_results_free(results);
+
+    const char* all[] = { "blue", "red", "green" };
+    results = sharded_indexer_search_bool(si, all, 3, SHARD_QUERY_AND, &err);
+    TEST_ASSERT_EQUAL_INT(0, err);
+    TEST_ASSERT_EQUAL_size_t(1, result_count(results));
+    TEST_ASSERT_EQUAL_STRING("d1", results->doc_id);
+    search_results_free(results);
+
+    // A missing key empties an AND but not an OR
+    const char* with_missing[] = { "red", "purple" };
+    TEST_ASSERT_NULL(sharded_indexer_search_bool(si, with_missing, 2, SHARD_QUERY_AND, &err));
+    TEST_ASSERT_EQUAL_INT(ENOENT, err);
+    results = sharded_indexer_search_bool(si, with_missing, 2, SHARD_QUERY_OR, &err);
+    TEST_ASSERT_EQUAL_size_t(3, result_count(results));
+    search_results_free(results);
+
+    TEST_ASSERT_NULL(sharded_indexer_search_bool(si, red_green, 0, SHARD_QUERY_OR, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+}
+
+void test_save_load(void) {
+    char key[16];
+    char doc[16];
+    for (int i = 0; i < 100; i++) {
+        make_key(key, sizeof(key), 1, i);
+        snprintf(doc, sizeof(doc), "doc%d", i);
+        TEST_ASSERT_EQUAL_INT(0, sharded_indexer_add_document(si, key, doc));
+    }
+    TEST_ASSERT_EQUAL_INT(0, sharded_indexer_save(si, TEST_MANIFEST));
+
+    int err = -1;
+    ShardedIndexer* loaded = sharded_indexer_load(TEST_MANIFEST, &err);
+    TEST_ASSERT_NOT_NULL(loaded);
+    TEST_ASSERT_EQUAL_INT(0, err);
+    TEST_ASSERT_EQUAL_size_t(TEST_SHARDS, sharded_indexer_shard_count(loaded));
+    TEST_ASSERT_EQUAL_size_t(100, sharded_indexer_get_key_count(loaded));
+
+    make_key(key, sizeof(key), 1, 42);
+    SearchCursor cursor;
+    TEST_ASSERT_EQUAL_INT(0, sharded_indexer_cursor_open(loaded, key, &cursor));
+    TEST_ASSERT_EQUAL_STRING("doc42", indexer_cursor_next(&cursor));
+    indexer_cursor_close(&cursor);
+    sharded_indexer_destroy(loaded);
+
+    // A missing shard file fails the whole load
+    char path[64];
+    snprintf(path, sizeof(path), "%s%s%d", TEST_MANIFEST, SHARD_FILE_SUFFIX, 2);
+    unlink(path);
+    TEST_ASSERT_NULL(sharded_indexer_load(TEST_MANIFEST, &err));
+    TEST_ASSERT_TRUE(err != 0);
+
+    for (int s = 0; s < TEST_SHARDS; s++) {
+        snprintf(path, sizeof(path), "%s%s%d", TEST_MANIFEST, SHARD_FILE_SUFFIX, s);
+        unlink(path);
+    }
+
+    FILE* fp = fopen(TEST_MANIFEST, "w");
+    TEST_ASSERT_NOT_NULL(fp);
+    fputs("gtrie-shards 1\nshards 0\n", fp);
+    fclose(fp);
+    TEST_ASSERT_NULL(sharded_indexer_load(TEST_MANIFEST, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+    unlink(TEST_MANIFEST);
+
+    TEST_ASSERT_NULL(sharded_indexer_load(TEST_MANIFEST, &err));
+    TEST_ASSERT_EQUAL_INT(ENOENT, err);
+}
+
+void test_node_pool(void) {
+    int err = -1;
+    NodePool* pool = node_pool_create(24, &err);
+    TEST_ASSERT_NOT_NULL(pool);
+    TEST_ASSERT_EQUAL_INT(0, err);
+
+    char* prev = NULL;
+    for (int i = 0; i < 5000; i++) {
+        char* object = node_pool_alloc(pool);
+        TEST_ASSERT_NOT_NULL(object);
+        for (int b = 0; b < 24; b++) TEST_ASSERT_EQUAL_INT(0, object[b]);
+        memset(object, 0xAB, 24);
+        TEST_ASSERT_TRUE(object != prev);
+        prev = object;
+    }
+    TEST_ASSERT_EQUAL_size_t(5000, node_pool_count(pool));
+    TEST_ASSERT_TRUE(node_pool_bytes(pool) >= 5000 * 24);
+    node_pool_destroy(pool);
+
+    TEST_ASSERT_NULL(node_pool_create(0, &err));
+    TEST_ASSERT_EQUAL_INT(EINVAL, err);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_routing);
+    RUN_TEST(test_concurrent_adds);
+    RUN_TEST(test_batch_and_search_many);
+    RUN_TEST(test_boolean_queries);
+    RUN_TEST(test_save_load);
+    RUN_TEST(test_node_pool);
+
+    return UNITY_END();
+}
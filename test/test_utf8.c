@@ -0,0 +1,145 @@
+#include "../include/utf8.h"
+#include "unity.h"
+#include <string.h>
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+// Reference slots: decode one codepoint at a time
+static int scalar_slots(const char* s, size_t len, uint8_t* out, size_t max, unsigned modulus) {
+    size_t i = 0, count = 0;
+    while (i < len) {
+        uint32_t cp;
+        int n = utf8_decode_char(s + i, len - i, &cp);
+        if (n < 0 || count == max) return -1;
+        out[count++] = (uint8_t)(cp % modulus);
+        i += (size_t)n;
+    }
+    return (int)count;
+}
+
+void test_decode_valid(void) {
+    uint32_t cp = 0;
+    TEST_ASSERT_EQUAL_INT(1, utf8_decode_char("a", 1, &cp));
+    TEST_ASSERT_EQUAL_UINT32('a', cp);
+    TEST_ASSERT_EQUAL_INT(2, utf8_decode_char("\xC3\xA9", 2, &cp));
+    TEST_ASSERT_EQUAL_UINT32(0xE9, cp);
+    TEST_ASSERT_EQUAL_INT(3, utf8_decode_char("\xE4\xB8\xAD", 3, &cp));
+    TEST_ASSERT_EQUAL_UINT32(0x4E2D, cp);
+    TEST_ASSERT_EQUAL_INT(4, utf8_decode_char("\xF0\x9F\x8D\xA3", 4, &cp));
+    TEST_ASSERT_EQUAL_UINT32(0x1F363, cp);
+    TEST_ASSERT_EQUAL_INT(4, utf8_decode_char("\xF4\x8F\xBF\xBF", 4, &cp));
+    TEST_ASSERT_EQUAL_UINT32(0x10FFFF, cp);
+}
+
+void test_decode_rejects_invalid(void) {
+    const char* bad[] = {
+        "\xC0\x80",             // overlong NUL
+        "\xC1\xBF",             // overlong ASCII
+        "\xE0\x80\x80",         // overlong 3-byte
+        "\xF0\x80\x80\x80",     // overlong 4-byte
+        "\xED\xA0\x80",         // surrogate U+D800
+        "\xED\xBF\xBF",         // surrogate U+DFFF
+        "\xF4\x90\x80\x80",     // U+110000
+        "\xF5\x80\x80\x80",     // lead byte above F4
+        "\xFF",
+        "\x80",                 // stray continuation
+        "\xC3\x28",             // bad continuation
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        uint32_t cp;
+        TEST_ASSERT_EQUAL_INT(-1, utf8_decode_char(bad[i], strlen(bad[i]), &cp));
+        TEST_ASSERT_FALSE(utf8_validate(bad[i], strlen(bad[i])));
+    }
+}
+
+void test_decode_rejects_truncated(void) {
+    // The length cuts each sequence short; the bytes after it must not be read
+    const char* s = "\xF0\x9F\x8D\xA3";
+    uint32_t cp;
+    for (size_t len = 1; len < 4; len++) {
+        TEST_ASSERT_EQUAL_INT(-1, utf8_decode_char(s, len, &cp));
+        TEST_ASSERT_FALSE(utf8_validate(s, len));
+    }
+    TEST_ASSERT_FALSE(utf8_validate("abc\xE4\xB8", 5));
+    TEST_ASSERT_EQUAL_INT(-1, utf8_decode_char("", 0, &cp));
+}
+
+void test_decode_string(void) {
+    uint32_t out[8];
+    TEST_ASSERT_EQUAL_INT(3, utf8_decode("a\xC3\xA9\xE4\xB8\xAD", 6, out, 8));
+    TEST_ASSERT_EQUAL_UINT32('a', out[0]);
+    TEST_ASSERT_EQUAL_UINT32(0xE9, out[1]);
+    TEST_ASSERT_EQUAL_UINT32(0x4E2D, out[2]);
+    TEST_ASSERT_EQUAL_INT(0, utf8_decode("", 0, out, 8));
+
+    // More codepoints than fit
+    TEST_ASSERT_EQUAL_INT(-1, utf8_decode("abc", 3, out, 2));
+    TEST_ASSERT_EQUAL_INT(-1, utf8_decode("a\xED\xA0\x80", 4, out, 8));
+}
+
+void test_slots_match_scalar(void) {
+    // ASCII, CJK and emoji at every offset around the 16-byte blocks
+    const char* pieces[] = { "a", "Z", "\xE4\xB8\xAD", "\xC3\xA9", "\xF0\x9F\x8D\xA3", "~" };
+    const unsigned moduli[] = { 2, 26, 97, 255, 256 };
+    for (size_t p = 0; p < sizeof(pieces) / sizeof(pieces[0]); p++) {
+        for (size_t len = 0; len <= 40; len++) {
+            char text[256] = { 0 };
+            size_t bytes = 0;
+            for (size_t i = 0; i < len; i++) {
+                // One non-ASCII piece at position len - 1, ASCII elsewhere
+                const char* piece = (i + 1 == len) ? pieces[p] : (i % 2 ? "q" : "7");
+                memcpy(text + bytes, piece, strlen(piece));
+                bytes += strlen(piece);
+            }
+            for (size_t m = 0; m < sizeof(moduli) / sizeof(moduli[0]); m++) {
+                uint8_t expected[64], actual[64];
+                int want = scalar_slots(text, bytes, expected, sizeof(expected), moduli[m]);
+                int got = utf8_slots(text, bytes, actual, sizeof(actual), moduli[m]);
+                TEST_ASSERT_EQUAL_INT(want, got);
+                TEST_ASSERT_EQUAL_INT((int)len, got);
+                if (got > 0) TEST_ASSERT_EQUAL_MEMORY(expected, actual, (size_t)got);
+            }
+        }
+    }
+}
+
+void test_slots_all_ascii_bytes(void) {
+    char text[128];
+    uint8_t out[128];
+    for (int i = 0; i < 128; i++) text[i] = (char)i;
+    for (unsigned m = 2; m <= 256; m++) {
+        TEST_ASSERT_EQUAL_INT(128, utf8_slots(text, sizeof(text), out, sizeof(out), m));
+        for (int i = 0; i < 128; i++) TEST_ASSERT_EQUAL_INT((int)((unsigned)i % m), out[i]);
+    }
+}
+
+void test_slots_limits(void) {
+    uint8_t out[32];
+    const char* key = "abcdefghijklmnopqrstuvwxyz";
+
+    TEST_ASSERT_EQUAL_INT(26, utf8_slots(key, 26, out, 26, 26));
+    TEST_ASSERT_EQUAL_INT(-1, utf8_slots(key, 26, out, 25, 26));
+    TEST_ASSERT_EQUAL_INT(-1, utf8_slots(key, 26, out, 16, 26));
+    TEST_ASSERT_EQUAL_INT(-1, utf8_slots(key, 26, out, 32, 1));
+    TEST_ASSERT_EQUAL_INT(-1, utf8_slots(key, 26, out, 32, 257));
+
+    // Invalid bytes inside and after an ASCII block
+    TEST_ASSERT_EQUAL_INT(-1, utf8_slots("abcdefghijklmnop\xC0\x80", 18, out, 32, 26));
+    TEST_ASSERT_EQUAL_INT(-1, utf8_slots("abc\xE4\xB8", 5, out, 32, 26));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_decode_valid);
+    RUN_TEST(test_decode_rejects_invalid);
+    RUN_TEST(test_decode_rejects_truncated);
+    RUN_TEST(test_decode_string);
+    RUN_TEST(test_slots_match_scalar);
+    RUN_TEST(test_slots_all_ascii_bytes);
+    RUN_TEST(test_slots_limits);
+    return UNITY_END();
+}